@@ -0,0 +1,53 @@
+#!/usr/bin/env bash
+# Seek latency with the keyframe index off and on: p50/p95/p99 of the `seek` stage from
+# `livim-cli --seek-bench`, once with LIVIM_KEYFRAME_INDEX=0 and once with 1. Without FILE it makes
+# a long-GOP test clip with ffmpeg: 1080p30 H.264, 2 minutes, one keyframe every 10 s.
+#
+# Usage:
+#   scripts/seek-latency.sh [--cli PATH] [--seeks N] [FILE]
+#     --cli PATH   livim-cli to run (default: the gcc preset's RelWithDebInfo build)
+#     --seeks N    seeks per run (default: 200)
+set -euo pipefail
+
+REPO_ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+CLI="$REPO_ROOT/build/gcc/RelWithDebInfo/livim-cli"
+SEEKS=200
+FILE=""
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --cli)      CLI="${2:?--cli needs a path}"; shift ;;
+        --seeks)    SEEKS="${2:?--seeks needs a count}"; shift ;;
+        -h|--help)  sed -n '2,9p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'; exit 0 ;;
+        -*)         echo "unknown arg: $1" >&2; exit 2 ;;
+        *)          FILE="$1" ;;
+    esac
+    shift
+done
+[ -x "$CLI" ] || { echo "no livim-cli at $CLI (build it, or pass --cli)" >&2; exit 1; }
+
+if [ -z "$FILE" ]; then
+    command -v ffmpeg >/dev/null || { echo "ffmpeg is needed to make the test clip" >&2; exit 1; }
+    FILE="${TMPDIR:-/tmp}/livim-long-gop.mp4"
+    if [ ! -f "$FILE" ]; then
+        echo "making $FILE ..." >&2
+        ffmpeg -loglevel error -f lavfi -i testsrc2=size=1920x1080:rate=30:duration=120 \
+            -c:v libx264 -preset veryfast -g 300 -keyint_min 300 -sc_threshold 0 \
+            -pix_fmt yuv420p -y "$FILE"
+    fi
+fi
+
+# The first indexed run may scan the file; doing it here keeps that out of the timings either way.
+LIVIM_KEYFRAME_INDEX=1 "$CLI" --seek-bench 1 --quiet "$FILE" >/dev/null
+
+field() { sed -n "s/.*\"$1\":\([0-9.]*\).*/\1/p"; }
+
+printf '%-6s %7s %9s %9s %9s\n' index seeks "p50 ms" "p95 ms" "p99 ms"
+for index in 0 1; do
+    # A run with failed seeks exits 1 but still prints its timings.
+    json="$(LIVIM_KEYFRAME_INDEX=$index "$CLI" --seek-bench "$SEEKS" --stats-json --quiet \
+        "$FILE")" || true
+    printf '%-6s %7s %9s %9s %9s\n' "$([ $index = 1 ] && echo on || echo off)" \
+        "$(field seeks <<<"$json")" "$(field p50_ms <<<"$json")" \
+        "$(field p95_ms <<<"$json")" "$(field p99_ms <<<"$json")"
+done
@@ -4,6 +4,7 @@
 #include <QStyleHints>
 #include <QSurfaceFormat>
 
+#include "core/OpenCvParallel.hpp"
 #include "ui/MainWindow.hpp"
 #include "ui/Theme.hpp"
 
@@ -25,6 +26,8 @@ int main(int argc, char** argv) {
 
     QApplication app(argc, argv);
 
+    livim::configureOpenCvThreading(livim::openCvThreadingFromEnvironment());
+
     // Disable freedesktop icon-theme lookups: the desktop's theme icons render inconsistently
     // against our QSS palette, and a theme icon Qt cannot decode yields a null pixmap behind a
     // non-null QIcon, which crashes Qt's own file dialog. All app icons are drawn in ui/Icons.cpp.
@@ -46,6 +49,8 @@ int main(int argc, char** argv) {
     // Re-apply once with widgets present so QSS-driven size hints settle before the first show.
     livim::theme::apply(app, livim::theme::appliedScheme());
     window.show();
+    // "livim PATH" opens it straight away; a "synthetic:..." clip can't be picked in the dialog.
+    if (argc > 1) window.openPath(QString::fromLocal8Bit(argv[1]));
 
     return app.exec();
 }
@@ -0,0 +1,514 @@
+#include "cli/JobOptions.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "source/SyntheticVideo.hpp"
+
+namespace livim::cli {
+namespace {
+
+using Pairs = std::vector<std::pair<std::string, std::string>>;
+
+// Flags that take no value on the command line; a job file gives them true/false.
+const std::set<std::string> kSwitches = {"labels", "grayscale", "verify-seams", "sheet", "quiet",
+                                         "stats-json", "help"};
+
+// Keys a sweep may vary. Not `mode`: it resets the others (see applyAll).
+const std::set<std::string> kSweepKeys = {"amplification", "wavelength", "low", "high", "chroma",
+                                          "levels"};
+constexpr std::size_t kMaxSweepVariants = 64;
+
+std::vector<std::string> splitOn(const std::string& s, char sep) {
+    std::vector<std::string> parts;
+    std::size_t from = 0;
+    for (;;) {
+        const std::size_t at = s.find(sep, from);
+        parts.push_back(s.substr(from, at - from));
+        if (at == std::string::npos) return parts;
+        from = at + 1;
+    }
+}
+
+bool toInt(const std::string& s, int& v) {
+    const char* end = s.data() + s.size();
+    const auto r = std::from_chars(s.data(), end, v);
+    return r.ec == std::errc() && r.ptr == end;
+}
+
+// strtod, not from_chars: libc++ only recently gained floating-point from_chars. The CLI never
+// calls setlocale(), so the decimal point is always '.'.
+bool toDouble(const std::string& s, double& v) {
+    if (s.empty()) return false;
+    char* end = nullptr;
+    v = std::strtod(s.c_str(), &end);
+    return end == s.c_str() + s.size();
+}
+
+bool toBool(const std::string& s, bool& v) {
+    if (s == "true" || s == "1" || s == "yes") { v = true; return true; }
+    if (s == "false" || s == "0" || s == "no") { v = false; return true; }
+    return false;
+}
+
+// Minimal reader for a FLAT JSON object: string, number and boolean values only. Numbers and
+// booleans keep their literal text and are converted by applyOption like command-line values.
+class JsonObjectReader {
+public:
+    explicit JsonObjectReader(const std::string& text) : s_(text) {}
+
+    bool read(Pairs& out, std::string& error) {
+        skipWs();
+        if (!eat('{')) return fail("expected '{'", error);
+        skipWs();
+        if (eat('}')) return trailing(error);
+        for (;;) {
+            std::string key, value;
+            skipWs();
+            if (!readString(key)) return fail("expected a quoted key", error);
+            skipWs();
+            if (!eat(':')) return fail("expected ':'", error);
+            skipWs();
+            if (peek() == '"') {
+                if (!readString(value)) return fail("unterminated string", error);
+            } else if (peek() == '{' || peek() == '[') {
+                return fail("nested values are not supported (key \"" + key + "\")", error);
+            } else {
+                while (pos_ < s_.size() && (std::isalnum(static_cast<unsigned char>(s_[pos_])) ||
+                                            s_[pos_] == '.' || s_[pos_] == '-' || s_[pos_] == '+'))
+                    value += s_[pos_++];
+                if (value.empty()) return fail("expected a value", error);
+            }
+            out.emplace_back(std::move(key), std::move(value));
+            skipWs();
+            if (eat(',')) continue;
+            if (eat('}')) return trailing(error);
+            return fail("expected ',' or '}'", error);
+        }
+    }
+
+private:
+    char peek() const { return pos_ < s_.size() ? s_[pos_] : '\0'; }
+    bool eat(char c) {
+        if (peek() != c) return false;
+        ++pos_;
+        return true;
+    }
+    void skipWs() {
+        while (pos_ < s_.size() && std::isspace(static_cast<unsigned char>(s_[pos_]))) ++pos_;
+    }
+    bool trailing(std::string& error) {
+        skipWs();
+        return pos_ == s_.size() || fail("trailing characters after the object", error);
+    }
+    bool fail(const std::string& what, std::string& error) {
+        error = "job file, offset " + std::to_string(pos_) + ": " + what;
+        return false;
+    }
+
+    bool readString(std::string& out) {
+        if (!eat('"')) return false;
+        while (pos_ < s_.size()) {
+            const char c = s_[pos_++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) return false;
+            const char e = s_[pos_++];
+            switch (e) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                // Paths are the only strings; encode the code point as UTF-8 (no surrogate pairs).
+                if (pos_ + 4 > s_.size()) return false;
+                unsigned cp = 0;
+                const auto r = std::from_chars(s_.data() + pos_, s_.data() + pos_ + 4, cp, 16);
+                if (r.ptr != s_.data() + pos_ + 4) return false;
+                pos_ += 4;
+                if (cp < 0x80) {
+                    out += static_cast<char>(cp);
+                } else if (cp < 0x800) {
+                    out += static_cast<char>(0xC0 | (cp >> 6));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                } else {
+                    out += static_cast<char>(0xE0 | (cp >> 12));
+                    out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default: out += e; break; // \" \\ \/
+            }
+        }
+        return false;
+    }
+
+    const std::string& s_;
+    std::size_t pos_ = 0;
+};
+
+bool readJobFile(const std::string& path, Pairs& out, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot read job file " + path;
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return JsonObjectReader(text).read(out, error);
+}
+
+bool parseMode(const std::string& v, MagnificationMode& m) {
+    if (v == "laplace") m = MagnificationMode::Laplace;
+    else if (v == "phase") m = MagnificationMode::Phase;
+    else if (v == "color") m = MagnificationMode::Color;
+    else return false;
+    return true;
+}
+
+bool applyOption(JobOptions& job, const std::string& key, const std::string& v,
+                 std::string& error) {
+    ExportRequest& r = job.request;
+    MagUiValues& m = job.mag;
+    bool ok = true;
+    if (key == "input") job.inputs.push_back(v);
+    else if (key == "output") r.outputPath = v;
+    else if (key == "output-dir") job.outputDir = v;
+    else if (key == "cores") ok = toInt(v, job.coreBudget) && job.coreBudget >= 0;
+    else if (key == "mode") {
+        MagnificationMode mode{};
+        ok = parseMode(v, mode);
+        if (ok) {
+            const double fps = m.captureFps;
+            m = defaultsFor(mode); // the other magnification keys refine these
+            m.captureFps = fps;
+        }
+    }
+    else if (key == "amplification") ok = toInt(v, m.amplification);
+    else if (key == "wavelength") ok = toDouble(v, m.wavelength);
+    else if (key == "low") ok = toDouble(v, m.low);
+    else if (key == "high") ok = toDouble(v, m.high);
+    else if (key == "chroma") ok = toInt(v, m.chroma);
+    else if (key == "levels") ok = toInt(v, m.levels) && m.levels > 0;
+    else if (key == "capture-fps")
+        ok = job.captureFpsSet = toDouble(v, m.captureFps) && m.captureFps > 0.0;
+    else if (key == "fps") ok = toDouble(v, r.fileFps) && r.fileFps > 0.0;
+    else if (key == "split") {
+        if (v == "none") r.split = SplitMode::None;
+        else if (v == "side-by-side") r.split = SplitMode::LeftRight;
+        else if (v == "top-bottom") r.split = SplitMode::TopBottom;
+        else ok = false;
+    }
+    else if (key == "labels") ok = toBool(v, r.textOverlay);
+    else if (key == "format") {
+        if (v == "mp4") r.format = ExportFormat::Mp4H264;
+        else if (v == "avi") r.format = ExportFormat::AviMjpg;
+        else if (v == "mkv") r.format = ExportFormat::MkvFfv1;
+        else ok = false;
+    }
+    else if (key == "encoder") {
+        if (v == "auto") r.encoder = EncoderBackend::Auto;
+        else if (v == "libav") r.encoder = EncoderBackend::Libav;
+        else if (v == "opencv") r.encoder = EncoderBackend::OpenCv;
+        else ok = false;
+    }
+    else if (key == "preset") {
+        if (v == "fast") r.preset = EncodePreset::Fast;
+        else if (v == "balanced") r.preset = EncodePreset::Balanced;
+        else if (v == "quality") r.preset = EncodePreset::Quality;
+        else ok = false;
+    }
+    else if (key == "quality") ok = toInt(v, r.quality) && r.quality >= 0;
+    else if (key == "encoder-threads") ok = toInt(v, r.encoderThreads) && r.encoderThreads >= 0;
+    else if (key == "start") ok = toInt(v, r.startFrame) && r.startFrame >= 0;
+    else if (key == "end") ok = toInt(v, r.endFrame);
+    else if (key == "downscale") {
+        int d = 0;
+        ok = toInt(v, d) && (d == 1 || d == 2 || d == 4 || d == 8);
+        if (ok) r.config.preprocess.downscale = d;
+    }
+    else if (key == "roi") {
+        // x,y,w,h as fractions of the frame
+        PreprocessParams& p = r.config.preprocess;
+        std::istringstream ss(v);
+        char c1 = 0, c2 = 0, c3 = 0;
+        ok = static_cast<bool>(ss >> p.roiX >> c1 >> p.roiY >> c2 >> p.roiW >> c3 >> p.roiH) &&
+             c1 == ',' && c2 == ',' && c3 == ',' && p.roiW > 0.0f && p.roiH > 0.0f;
+        p.roiEnabled = ok;
+    }
+    else if (key == "sweep") {
+        // key=v1,v2,...; a job file lists several axes separated by ';'
+        for (const std::string& axis : splitOn(v, ';')) {
+            const auto eq = axis.find('=');
+            ok = eq != std::string::npos && kSweepKeys.count(axis.substr(0, eq));
+            if (!ok) break;
+            std::vector<std::string> values = splitOn(axis.substr(eq + 1), ',');
+            ok = std::none_of(values.begin(), values.end(),
+                              [](const std::string& s) { return s.empty(); });
+            if (!ok) break;
+            job.sweep.emplace_back(axis.substr(0, eq), std::move(values));
+        }
+    }
+    else if (key == "sheet") ok = toBool(v, job.sheet);
+    else if (key == "sheet-columns") ok = toInt(v, job.sheetColumns) && job.sheetColumns >= 0;
+    else if (key == "grayscale") ok = toBool(v, r.config.grayscale);
+    else if (key == "segments") ok = toInt(v, r.segments) && r.segments >= 1;
+    else if (key == "warmup") ok = toInt(v, r.warmupFrames) && r.warmupFrames >= 0;
+    else if (key == "verify-seams") ok = toBool(v, r.verifySeams);
+    else if (key == "quiet") ok = toBool(v, job.quiet);
+    else if (key == "stats-json") ok = toBool(v, job.statsJson);
+    else if (key == "seek-bench") ok = toInt(v, job.seekBench) && job.seekBench > 0;
+    else if (key == "help") ok = toBool(v, job.help);
+    else {
+        error = "unknown option '" + key + "'";
+        return false;
+    }
+    if (!ok) error = "invalid value '" + v + "' for '" + key + "'";
+    return ok;
+}
+
+// Mode first: it resets the magnification values the other keys refine.
+bool applyAll(JobOptions& job, const Pairs& pairs, std::string& error) {
+    for (const auto& [k, v] : pairs)
+        if (k == "mode" && !applyOption(job, k, v, error)) return false;
+    for (const auto& [k, v] : pairs)
+        if (k != "mode" && !applyOption(job, k, v, error)) return false;
+    return true;
+}
+
+} // namespace
+
+bool parseCommandLine(int argc, char** argv, JobOptions& job, std::string& error) {
+    job = JobOptions{};
+    job.mag = defaultsFor(MagnificationMode::Laplace);
+
+    Pairs flags;
+    std::string jobFile;
+    bool formatGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h") arg = "--help";
+        if (arg == "-o") arg = "--output";
+        if (arg.rfind("--", 0) != 0) {
+            flags.emplace_back("input", arg);
+            continue;
+        }
+        std::string key = arg.substr(2);
+        std::string value;
+        if (const auto eq = key.find('='); eq != std::string::npos) {
+            value = key.substr(eq + 1);
+            key.resize(eq);
+        } else if (kSwitches.count(key)) {
+            value = "true";
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        } else {
+            error = "missing value for --" + key;
+            return false;
+        }
+        if (key == "job") jobFile = value;
+        else flags.emplace_back(key, value);
+        if (key == "format") formatGiven = true;
+    }
+
+    if (!jobFile.empty()) {
+        Pairs fromFile;
+        if (!readJobFile(jobFile, fromFile, error)) return false;
+        for (const auto& p : fromFile)
+            if (p.first == "format") formatGiven = true;
+        // A relative input/output in a job file is relative to the file, not the shell.
+        const std::filesystem::path base = std::filesystem::path(jobFile).parent_path();
+        for (auto& [k, v] : fromFile)
+            if ((k == "input" || k == "output" || k == "output-dir") &&
+                std::filesystem::path(v).is_relative() && !SyntheticVideo::handles(v))
+                v = (base / v).string();
+        if (!applyAll(job, fromFile, error)) return false;
+        // Inputs named on the command line replace the file's rather than adding to them.
+        if (std::any_of(flags.begin(), flags.end(),
+                        [](const auto& p) { return p.first == "input"; }))
+            job.inputs.clear();
+    }
+    if (!applyAll(job, flags, error)) return false;
+    if (job.help) return true;
+
+    if (job.inputs.empty()) {
+        error = "no input file";
+        return false;
+    }
+    for (const std::string& input : job.inputs) {
+        SyntheticParams unused;
+        if (SyntheticVideo::handles(input) && !SyntheticVideo::parse(input, unused, error))
+            return false;
+    }
+    if (job.seekBench > 0) {
+        if (job.inputs.size() > 1 || SyntheticVideo::handles(job.inputs.front())) {
+            error = "--seek-bench times a single video file";
+            return false;
+        }
+        return true; // nothing is exported
+    }
+    if (!job.outputDir.empty() && !job.request.outputPath.empty()) {
+        error = "--output and --output-dir are exclusive";
+        return false;
+    }
+    if (job.outputDir.empty() && job.inputs.size() > 1) {
+        error = "several inputs need --output-dir";
+        return false;
+    }
+    if (job.outputDir.empty() && job.request.outputPath.empty()) {
+        error = "no output file (--output)";
+        return false;
+    }
+    if (!formatGiven) {
+        // Follow the output's extension, like the GUI's save dialog does the other way round.
+        std::string ext = std::filesystem::path(job.request.outputPath).extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (ext == ".avi") job.request.format = ExportFormat::AviMjpg;
+        else if (ext == ".mkv") job.request.format = ExportFormat::MkvFfv1;
+        else job.request.format = ExportFormat::Mp4H264;
+    }
+    if (!job.sweep.empty()) {
+        if (job.inputs.size() > 1 || !job.outputDir.empty()) {
+            error = "--sweep renders a single input to --output";
+            return false;
+        }
+        if (job.request.segments > 1) {
+            error = "--sweep and --segments are exclusive";
+            return false;
+        }
+        SweepRequest probe; // reject bad sweep values now rather than after probing the input
+        if (!sweepFor(job, job.inputs.front(), 30.0, probe, error)) return false;
+    }
+    if (job.request.split == SplitMode::None && !job.sheet) job.request.textOverlay = false;
+    if (job.request.segments <= 1) job.request.verifySeams = false;
+    return true;
+}
+
+ExportRequest requestFor(const JobOptions& job, const std::string& input, double captureFps) {
+    ExportRequest r = job.request;
+    MagUiValues mag = job.mag;
+    mag.captureFps = captureFps;
+    r.config.magnification = toParams(mag);
+    if (!job.outputDir.empty()) {
+        std::filesystem::path in(input);
+        if (!in.has_filename()) in = in.parent_path(); // an image sequence given as "frames/"
+        std::string stem = in.stem().string();
+        // "synthetic:640x480,fps=60" writes synthetic_640x480_fps_60_magnified.<ext>.
+        if (SyntheticVideo::handles(input)) {
+            stem = input;
+            std::replace_if(stem.begin(), stem.end(),
+                            [](unsigned char c) { return !std::isalnum(c); }, '_');
+        }
+        const std::string name = stem + "_magnified." + extensionFor(r.format);
+        r.outputPath = (std::filesystem::path(job.outputDir) / name).string();
+    }
+    return r;
+}
+
+bool sweepFor(const JobOptions& job, const std::string& input, double captureFps,
+              SweepRequest& sweep, std::string& error) {
+    sweep = SweepRequest{};
+    sweep.base = requestFor(job, input, captureFps);
+    sweep.layout = job.sheet ? SweepLayout::ContactSheet : SweepLayout::Files;
+    sweep.sheetColumns = job.sheetColumns;
+
+    std::size_t count = 1;
+    for (const auto& axis : job.sweep) count *= axis.second.size();
+    if (count > kMaxSweepVariants) {
+        error = "the sweep has " + std::to_string(count) + " variants, at most " +
+                std::to_string(kMaxSweepVariants) + " are supported";
+        return false;
+    }
+    // Odometer over the axes, the last one fastest.
+    std::vector<std::size_t> at(job.sweep.size(), 0);
+    for (std::size_t n = 0; n < count; ++n) {
+        JobOptions variant = job;
+        std::string label;
+        for (std::size_t a = 0; a < job.sweep.size(); ++a) {
+            const std::string& key = job.sweep[a].first;
+            const std::string& value = job.sweep[a].second[at[a]];
+            if (!applyOption(variant, key, value, error)) return false;
+            label += (label.empty() ? "" : " ") + key + "=" + value;
+        }
+        sweep.variants.push_back(requestFor(variant, input, captureFps).config);
+        sweep.labels.push_back(std::move(label));
+        for (std::size_t a = job.sweep.size(); a-- > 0;) {
+            if (++at[a] < job.sweep[a].second.size()) break;
+            at[a] = 0;
+        }
+    }
+    return true;
+}
+
+const char* usage() {
+    return R"(Usage: livim-cli [--job FILE] [OPTIONS] INPUT -o OUTPUT
+       livim-cli [--job FILE] [OPTIONS] INPUT... --output-dir DIR
+       livim-cli --seek-bench N [--stats-json] INPUT
+
+Renders magnified exports of video files without a display. Several inputs are queued and
+rendered concurrently, shortest first, within a core budget.
+
+An INPUT is a video file, a .y4m or raw dump, an image sequence (a directory or any one of its
+frames), or a generated test clip such as synthetic:1280x720,fps=120,frames=600,noise=2. A
+synthetic clip takes these comma-separated options: WxH, channels, fps, frames, motion (px),
+motion-hz, pulse, pulse-hz, noise and seed.
+
+  -o, --output PATH       output file (.mp4 H.264, .avi MJPG, .mkv FFV1)
+      --output-dir DIR    one <name>_magnified.<ext> per input
+      --cores N           core budget shared by concurrent jobs (default: all)
+      --job FILE          flat JSON object with any of these keys (without "--");
+                          command-line flags override it
+      --format F          mp4 | avi | mkv (default: from the output extension)
+      --encoder E         auto | libav | opencv (default auto: libav, else OpenCV's writer)
+      --preset P          fast | balanced | quality encoder speed (default balanced)
+      --quality N         H.264 CRF, or MJPEG/MPEG-4 qscale (default: the preset's)
+      --encoder-threads N encoder threads (default: the codec's choice)
+      --mode M            laplace | phase | color (default laplace; resets the values below)
+      --amplification N   effect strength
+      --wavelength P      spatial cutoff, % (laplace, phase)
+      --low HZ            lower edge of the temporal band
+      --high HZ           upper edge of the temporal band
+      --chroma N          chroma attenuation, % (laplace)
+      --levels N          pyramid levels
+      --capture-fps F     true footage rate for the filters (default: the file's rate)
+      --fps F             output file rate (default: the capture rate)
+      --start N           first frame (inclusive)
+      --end N             last frame (exclusive)
+      --downscale D       process at 1/D resolution: 1, 2, 4 or 8
+      --roi X,Y,W,H       process only this region (fractions of the frame)
+      --grayscale         magnify a single-channel image
+      --split S           none | side-by-side | top-bottom
+      --labels            burn "Original"/"Processed" captions into split output
+      --segments N        render N segments in parallel
+      --warmup N          warm-up frames per segment (default: enough for the mode)
+      --verify-seams      compare each seam against a serial run
+      --sweep KEY=V1,V2   render every value of a magnification key from one decode;
+                          repeat for a grid. Writes <output>_v1.<ext>, ... (see --sheet)
+      --sheet             tile the sweep into one video; --labels captions each tile
+      --sheet-columns N   tiles per row (default: near-square)
+      --quiet             no progress output
+      --stats-json        print final stats as one JSON line on stdout
+      --seek-bench N      time N seeks to random frames of INPUT, as the player seeks
+                          (LIVIM_KEYFRAME_INDEX=0: without the keyframe index), and
+                          print their p50/p95/p99 instead of exporting
+  -h, --help              this text
+
+Exit status: 0 done, 1 failed, 2 bad arguments, 130 interrupted.
+)";
+}
+
+} // namespace livim::cli
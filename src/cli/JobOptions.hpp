@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "export/ExportTypes.hpp"
+#include "processing/MagnificationParamsUi.hpp"
+
+namespace livim::cli {
+
+// One livim-cli invocation: the same settings applied to one or more inputs. Magnification values
+// are in UI units (Hz, %), mapped to algorithm units by toParams() exactly like the GUI, so a job
+// reproduces a GUI export.
+struct JobOptions {
+    std::vector<std::string> inputs;
+    std::string   outputDir;        // several inputs: <dir>/<stem>_magnified.<ext> each
+    ExportRequest request;          // template; see requestFor()
+    MagUiValues   mag;
+    bool          captureFpsSet = false; // false -> use each input's own rate
+    int           coreBudget = 0;        // several inputs: cores shared by concurrent jobs, 0 = all
+    // Parameter sweep: each axis is a magnification key and its values; the variants are their
+    // cartesian product, rendered from one decode (see Exporter::startSweep).
+    std::vector<std::pair<std::string, std::vector<std::string>>> sweep;
+    bool          sheet = false;         // sweep into one tiled video instead of a file per variant
+    int           sheetColumns = 0;
+    bool          quiet = false;
+    bool          statsJson = false;     // print the final stats as one JSON line on stdout
+    int           seekBench = 0;         // > 0: time this many random seeks instead of exporting
+    bool          help = false;
+};
+
+// Parses `livim-cli [--job FILE] [--key value ...] [INPUT...]`. A job file is a flat JSON object
+// with the same keys as the long flags (without the dashes); flags given on the command line
+// override it.
+// Returns false with `error` set on a malformed flag, value or file.
+bool parseCommandLine(int argc, char** argv, JobOptions& job, std::string& error);
+
+// The request for one input: magnification mapped at `captureFps`, output path resolved.
+ExportRequest requestFor(const JobOptions& job, const std::string& input, double captureFps);
+
+// The sweep for one input: base request from requestFor(), one config and label per variant.
+bool sweepFor(const JobOptions& job, const std::string& input, double captureFps,
+              SweepRequest& sweep, std::string& error);
+
+// Multi-line flag reference for --help.
+const char* usage();
+
+} // namespace livim::cli
@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/videoio.hpp>
+
+#include "cli/JobOptions.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/OpenCvParallel.hpp"
+#include "core/Trace.hpp"
+#include "export/ExportQueue.hpp"
+#include "export/Exporter.hpp"
+#include "export/FileExportFrameSource.hpp"
+#include "source/ImageSequence.hpp"
+#include "source/KeyframeIndex.hpp"
+#include "source/LibavDecoder.hpp"
+#include "source/RawVideoFile.hpp"
+#include "source/SyntheticVideo.hpp"
+
+namespace {
+
+using namespace livim;
+
+volatile std::sig_atomic_t gInterrupted = 0;
+
+extern "C" void onSignal(int) { gInterrupted = 1; }
+
+struct Probe {
+    double fps = 30.0;
+    std::int64_t frames = -1; // container estimate; only orders the queue
+};
+
+// The GUI seeds Capture FPS from the file the same way.
+Probe probe(const std::string& path) {
+    Probe p;
+    if (SyntheticVideo::handles(path)) {
+        SyntheticParams params;
+        std::string error;
+        if (!SyntheticVideo::parse(path, params, error)) return p;
+        p.fps = params.fps;
+        p.frames = params.frames;
+        return p;
+    }
+    if (RawVideoFile::handles(path)) {
+        RawVideoFile raw;
+        if (!raw.open(path)) return p;
+        if (raw.fps() > 0.0) p.fps = raw.fps();
+        p.frames = raw.frameCount();
+        return p;
+    }
+    if (ImageSequence::handles(path)) {
+        const auto seq = ImageSequence::open(path);
+        if (!seq) return p;
+        if (seq->fps() > 0.0) p.fps = seq->fps();
+        p.frames = seq->frameCount();
+        return p;
+    }
+    cv::VideoCapture cap(path);
+    if (!cap.isOpened()) return p;
+    const double fps = cap.get(cv::CAP_PROP_FPS);
+    if (fps > 0.0 && fps < 10000.0) p.fps = fps;
+    const double n = cap.get(cv::CAP_PROP_FRAME_COUNT);
+    if (n > 0.0) p.frames = static_cast<std::int64_t>(n);
+    return p;
+}
+
+const char* phaseWord(ExportPhase p) {
+    return p == ExportPhase::Done ? "done" : p == ExportPhase::Aborted ? "aborted" : "error";
+}
+
+void printProgress(const ExportProgress& p, double elapsedS) {
+    const double rate = elapsedS > 0.0 ? p.framesDone / elapsedS : 0.0;
+    const char* what = p.phase == ExportPhase::Finalizing ? "finalizing" : "rendering";
+    if (p.framesTotal > 0)
+        std::fprintf(stderr, "\r%s %d/%d frames (%3d%%)  %.1f fps   ", what, p.framesDone,
+                     p.framesTotal, p.framesDone * 100 / p.framesTotal, rate);
+    else
+        std::fprintf(stderr, "\r%s %d frames  %.1f fps   ", what, p.framesDone, rate);
+    std::fflush(stderr);
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (const char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+void printStatsJson(const ExportProgress& p, const StatsSnapshot& s, double wallS) {
+    std::printf("{\"status\":\"%s\",\"frames\":%d,\"wall_s\":%.3f,\"fps\":%.3f,\"output\":\"%s\","
+                "\"codec\":\"%s\",\"decode_fps\":%.3f,\"process_fps\":%.3f,\"encode_fps\":%.3f,"
+                "\"seam_max_diff\":[",
+                phaseWord(p.phase),
+                p.framesDone, wallS, wallS > 0.0 ? p.framesDone / wallS : 0.0,
+                jsonEscape(p.outputPath).c_str(), jsonEscape(p.codecUsed).c_str(), p.decodeFps,
+                p.processFps, p.encodeFps);
+    for (std::size_t i = 0; i < p.seamMaxDiff.size(); ++i)
+        std::printf("%s%.0f", i ? "," : "", p.seamMaxDiff[i]);
+    std::printf("],\"variant_outputs\":[");
+    for (std::size_t i = 0; i < p.variantOutputs.size(); ++i)
+        std::printf("%s\"%s\"", i ? "," : "", jsonEscape(p.variantOutputs[i]).c_str());
+    std::printf("],\"stages\":{");
+    bool first = true;
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageTiming& t = s.stages[i];
+        if (t.count == 0) continue;
+        std::printf("%s\"%s\":{\"count\":%llu,\"p50_ms\":%.3f,\"p95_ms\":%.3f,\"p99_ms\":%.3f}",
+                    first ? "" : ",", stageName(static_cast<Stage>(i)),
+                    static_cast<unsigned long long>(t.count), t.p50Ms, t.p95Ms, t.p99Ms);
+        first = false;
+    }
+    std::printf("}}\n");
+}
+
+void printSummary(const ExportProgress& p, const StatsSnapshot& s, double wallS) {
+    std::fprintf(stderr, "Wrote %d frames to %s (%s) in %.1f s, %.1f fps\n", p.framesDone,
+                 p.outputPath.c_str(), p.codecUsed.c_str(), wallS,
+                 wallS > 0.0 ? p.framesDone / wallS : 0.0);
+    std::fprintf(stderr,
+                 "  decoding %.1f fps, processing %.1f fps, encoding %.1f fps (each alone)\n",
+                 p.decodeFps, p.processFps, p.encodeFps);
+    for (std::size_t i = 0; i < p.seamMaxDiff.size(); ++i)
+        std::fprintf(stderr, "  seam %zu: max pixel difference %.0f\n", i + 1, p.seamMaxDiff[i]);
+    for (std::size_t i = 1; i < p.variantOutputs.size(); ++i)
+        std::fprintf(stderr, "  and %s\n", p.variantOutputs[i].c_str());
+    std::fprintf(stderr, "  %-12s %8s %9s %9s %9s\n", "stage", "count", "p50 ms", "p95 ms",
+                 "p99 ms");
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageTiming& t = s.stages[i];
+        if (t.count == 0) continue;
+        std::fprintf(stderr, "  %-12s %8llu %9.2f %9.2f %9.2f\n", stageName(static_cast<Stage>(i)),
+                     static_cast<unsigned long long>(t.count), t.p50Ms, t.p95Ms, t.p99Ms);
+    }
+}
+
+void printQueueProgress(const ExportQueueStats& s, std::size_t total) {
+    std::fprintf(stderr, "\rjobs %d/%zu done, %d running (%d/%d cores)  %llu frames  %.1f fps   ",
+                 s.finished, total, s.running, s.coresInUse, s.coreBudget,
+                 static_cast<unsigned long long>(s.framesDone), s.framesPerSec);
+    std::fflush(stderr);
+}
+
+void printQueueJson(const std::vector<ExportJobStatus>& jobs, const ExportQueueStats& s,
+                    double wallS) {
+    std::printf("{\"jobs\":[");
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        const ExportProgress& p = jobs[i].progress;
+        std::printf("%s{\"input\":\"%s\",\"status\":\"%s\",\"frames\":%d,\"output\":\"%s\","
+                    "\"codec\":\"%s\",\"error\":\"%s\"}",
+                    i ? "," : "", jsonEscape(jobs[i].label).c_str(), phaseWord(p.phase),
+                    p.framesDone, jsonEscape(p.outputPath).c_str(),
+                    jsonEscape(p.codecUsed).c_str(), jsonEscape(p.error).c_str());
+    }
+    std::printf("],\"frames\":%llu,\"wall_s\":%.3f,\"fps\":%.3f,\"core_budget\":%d}\n",
+                static_cast<unsigned long long>(s.framesDone), wallS, s.meanFramesPerSec,
+                s.coreBudget);
+}
+
+// Several inputs: one queued job each, run side by side within the core budget.
+int runQueue(const cli::JobOptions& job, const char* tracePath) {
+    std::error_code ec;
+    std::filesystem::create_directories(job.outputDir, ec);
+
+    ExportQueue queue(ExportQueue::Options{job.coreBudget});
+    const auto t0 = std::chrono::steady_clock::now();
+    for (const std::string& input : job.inputs) {
+        const Probe pr = probe(input);
+        ExportRequest r =
+            cli::requestFor(job, input, job.captureFpsSet ? job.mag.captureFps : pr.fps);
+        std::int64_t frames = pr.frames;
+        if (frames >= 0 && r.endFrame >= 0) frames = std::min<std::int64_t>(frames, r.endFrame);
+        if (frames >= 0) frames = std::max<std::int64_t>(0, frames - r.startFrame);
+        auto source = makeFileExportFrameSource(input, r.startFrame, r.endFrame);
+        queue.enqueue(std::move(source), std::move(r), input, frames);
+    }
+
+    bool aborted = false;
+    ExportQueueStats s;
+    for (;;) {
+        s = queue.stats();
+        if (s.queued == 0 && s.running == 0) break;
+        if (gInterrupted && !aborted) {
+            queue.abortAll();
+            aborted = true;
+        }
+        if (!job.quiet) printQueueProgress(s, job.inputs.size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    queue.waitIdle();
+    const double wallS =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (!job.quiet) std::fputc('\n', stderr);
+
+    const std::vector<ExportJobStatus> jobs = queue.jobs();
+    s = queue.stats();
+    if (job.statsJson) printQueueJson(jobs, s, wallS);
+    if (tracePath && *tracePath && !trace::dumpJson(tracePath))
+        std::fprintf(stderr, "livim-cli: could not write trace %s\n", tracePath);
+
+    int failed = 0;
+    for (const ExportJobStatus& j : jobs) {
+        const ExportProgress& p = j.progress;
+        if (p.phase == ExportPhase::Error) ++failed;
+        if (p.phase == ExportPhase::Done && job.quiet) continue;
+        std::fprintf(stderr, "  %-7s %s -> %s%s%s\n", phaseWord(p.phase), j.label.c_str(),
+                     p.outputPath.c_str(), p.error.empty() ? "" : ": ", p.error.c_str());
+    }
+    if (!job.quiet)
+        std::fprintf(stderr, "%zu jobs, %llu frames in %.1f s, %.1f fps aggregate\n",
+                     jobs.size(), static_cast<unsigned long long>(s.framesDone), wallS,
+                     s.meanFramesPerSec);
+    if (aborted) return 130;
+    return failed ? 1 : 0;
+}
+
+// Times job.seekBench seeks to random frames of the input, made the way the player makes them:
+// LibavDecoder::seek() with the keyframe index unless LIVIM_KEYFRAME_INDEX=0, each one timed into
+// Stage::Seek. The index is loaded (or scanned) before the clock starts, as the player does in
+// the background. The targets come from a fixed seed, so runs on the same file compare.
+int runSeekBench(const cli::JobOptions& job) {
+    const std::string& input = job.inputs.front();
+    LibavDecoder decoder;
+    if (!decoder.open(input)) {
+        std::fprintf(stderr, "livim-cli: cannot open %s\n", input.c_str());
+        return 1;
+    }
+    const std::int64_t frames = decoder.frameCount();
+    if (frames < 2) {
+        std::fprintf(stderr, "livim-cli: %s has no frame count to seek in\n", input.c_str());
+        return 1;
+    }
+    const char* useIndex = std::getenv("LIVIM_KEYFRAME_INDEX");
+    const bool indexed = !(useIndex && useIndex[0] == '0');
+    if (indexed) {
+        const std::atomic<bool> cancel{false};
+        std::shared_ptr<const KeyframeIndex> index = KeyframeIndex::loadOrBuild(input, cancel);
+        if (!index) {
+            std::fprintf(stderr, "livim-cli: cannot index %s\n", input.c_str());
+            return 1;
+        }
+        decoder.setKeyframeIndex(std::move(index));
+    }
+
+    Instrumentation instr;
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<std::int64_t> pick(0, frames - 1);
+    int done = 0, failed = 0;
+    for (; done < job.seekBench && !gInterrupted; ++done) {
+        const std::int64_t target = pick(rng);
+        StageTimer timer(&instr, Stage::Seek);
+        if (!decoder.seek(target)) ++failed;
+    }
+    const StageTiming t = instr.snapshot().stages[static_cast<int>(Stage::Seek)];
+    if (job.statsJson)
+        std::printf("{\"input\":\"%s\",\"frames\":%lld,\"keyframe_index\":%s,\"seeks\":%d,"
+                    "\"failed\":%d,\"p50_ms\":%.3f,\"p95_ms\":%.3f,\"p99_ms\":%.3f}\n",
+                    jsonEscape(input).c_str(), static_cast<long long>(frames),
+                    indexed ? "true" : "false", done, failed, t.p50Ms, t.p95Ms, t.p99Ms);
+    if (!job.quiet)
+        std::fprintf(stderr,
+                     "%d seeks in %lld frames, keyframe index %s: p50 %.2f ms, p95 %.2f ms, "
+                     "p99 %.2f ms%s\n",
+                     done, static_cast<long long>(frames), indexed ? "on" : "off", t.p50Ms,
+                     t.p95Ms, t.p99Ms, failed ? " (some seeks failed)" : "");
+    if (gInterrupted) return 130;
+    return failed ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    cli::JobOptions job;
+    std::string error;
+    if (!cli::parseCommandLine(argc, argv, job, error)) {
+        std::fprintf(stderr, "livim-cli: %s\n\n%s", error.c_str(), cli::usage());
+        return 2;
+    }
+    if (job.help) {
+        std::fputs(cli::usage(), stdout);
+        return 0;
+    }
+
+    configureOpenCvThreading(openCvThreadingFromEnvironment());
+    const char* tracePath = std::getenv("LIVIM_TRACE");
+    if (tracePath && *tracePath) trace::setEnabled(true);
+    trace::setThreadName("main");
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    if (job.seekBench > 0) return runSeekBench(job);
+    if (!job.outputDir.empty()) return runQueue(job, tracePath);
+
+    const std::string& input = job.inputs.front();
+    const double captureFps = job.captureFpsSet ? job.mag.captureFps : probe(input).fps;
+    job.request = cli::requestFor(job, input, captureFps);
+
+    Exporter exporter;
+    const auto t0 = std::chrono::steady_clock::now();
+    if (!job.sweep.empty()) {
+        SweepRequest sweep;
+        if (!cli::sweepFor(job, input, captureFps, sweep, error)) {
+            std::fprintf(stderr, "livim-cli: %s\n", error.c_str());
+            return 2;
+        }
+        exporter.startSweep(makeFileExportFrameSource(input, job.request.startFrame,
+                                                      job.request.endFrame),
+                            std::move(sweep));
+    } else if (job.request.segments > 1) {
+        exporter.startSegmented(
+            [path = input](int start, int end) {
+                return makeFileExportFrameSource(path, start, end);
+            },
+            job.request);
+    } else {
+        exporter.start(makeFileExportFrameSource(input, job.request.startFrame,
+                                                 job.request.endFrame),
+                       job.request);
+    }
+
+    auto elapsed = [&] {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+    ExportProgress p;
+    for (;;) {
+        p = exporter.progress();
+        if (p.phase == ExportPhase::Done || p.phase == ExportPhase::Error ||
+            p.phase == ExportPhase::Aborted)
+            break;
+        if (gInterrupted) exporter.abort();
+        if (!job.quiet) printProgress(p, elapsed());
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    exporter.join();
+    const double wallS = elapsed();
+    if (!job.quiet) std::fputc('\n', stderr);
+
+    const StatsSnapshot s = exporter.stats();
+    if (job.statsJson) printStatsJson(p, s, wallS);
+    if (tracePath && *tracePath && !trace::dumpJson(tracePath))
+        std::fprintf(stderr, "livim-cli: could not write trace %s\n", tracePath);
+
+    switch (p.phase) {
+    case ExportPhase::Done:
+        if (!job.quiet) printSummary(p, s, wallS);
+        return 0;
+    case ExportPhase::Aborted:
+        std::fprintf(stderr, "livim-cli: interrupted, partial output removed\n");
+        return 130;
+    default:
+        std::fprintf(stderr, "livim-cli: %s\n", p.error.c_str());
+        return 1;
+    }
+}
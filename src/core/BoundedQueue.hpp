@@ -1,12 +1,15 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
 #include <mutex>
 
+#include "core/Clock.hpp"
+
 namespace livim {
 
 // Overflow behaviour when full:
@@ -24,7 +27,17 @@ public:
     [[nodiscard]] bool push(T item) {
         std::unique_lock<std::mutex> lk(m_);
         if (policy_ == OverflowPolicy::Block) {
-            notFull_.wait(lk, [&] { return q_.size() < cap_ || stopped_; });
+            const auto hasRoom = [&] { return q_.size() < cap_ || stopped_; };
+            if (!hasRoom()) {
+                // Slow path only: the common no-wait push pays for no clock read or extra atomic.
+                const Timestamp t0 = now();
+                notFull_.wait(lk, hasRoom);
+                pushWaits_.fetch_add(1, std::memory_order_relaxed);
+                pushBlockedNs_.fetch_add(
+                    static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now() - t0).count()),
+                    std::memory_order_relaxed);
+            }
             if (stopped_) return false;
             q_.push_back(std::move(item));
         } else {
@@ -64,6 +77,8 @@ public:
         std::deque<T>().swap(q_);
         stopped_ = false;
         drops_.store(0, std::memory_order_relaxed);
+        pushWaits_.store(0, std::memory_order_relaxed);
+        pushBlockedNs_.store(0, std::memory_order_relaxed);
     }
 
     // Call only while no producer/consumer is running.
@@ -81,6 +96,10 @@ public:
 
     std::uint64_t drops() const { return drops_.load(std::memory_order_relaxed); }
 
+    // Block policy: pushes that had to wait for space, and their cumulative blocked time.
+    std::uint64_t pushWaits() const { return pushWaits_.load(std::memory_order_relaxed); }
+    std::uint64_t pushBlockedNs() const { return pushBlockedNs_.load(std::memory_order_relaxed); }
+
 private:
     mutable std::mutex m_;
     std::condition_variable notEmpty_;
@@ -90,6 +109,8 @@ private:
     OverflowPolicy policy_;
     bool stopped_ = false;
     std::atomic<std::uint64_t> drops_{0};
+    std::atomic<std::uint64_t> pushWaits_{0};
+    std::atomic<std::uint64_t> pushBlockedNs_{0};
 };
 
 } // namespace livim
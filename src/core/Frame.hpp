@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <memory>
 
@@ -9,7 +10,29 @@
 
 namespace livim {
 
-enum class PixelFormat { BGR8, Gray8 };
+// Layout of Frame::image, which is width x height unless noted (helpers in core/FrameFormat):
+//  - BGR8, Gray8: CV_8UC3 / CV_8UC1.
+//  - I420: one continuous CV_8UC1 of height * 3/2 rows: the Y plane, then U and V at half size,
+//    whose rows are half the Y stride (as OpenCV's COLOR_YUV2BGR_I420 takes it).
+//  - NV12: one CV_8UC1 of height * 3/2 rows: the Y plane, then interleaved U/V rows.
+//  - YUYV: CV_8UC2, each pixel pair being Y0 U Y1 V.
+// The YUV formats need an even width and height, and are BT.601 limited range. Stages that only
+// use luminance take the Y plane as is, so a camera or decoder frame isn't converted to BGR first.
+enum class PixelFormat { BGR8, Gray8, I420, NV12, YUYV };
+
+// Checkpoints a frame passes after capture, for latency attribution. Processor stamps follow the
+// ChainBuilder order; Uploaded is written by the GUI thread after the mailbox hand-off.
+enum class FrameStamp : int {
+    Dequeued,     // popped by the processing thread
+    Preprocessed,
+    Grayscaled,
+    Magnified,
+    Published,    // handed to the display mailbox
+    Uploaded,     // GL texture upload finished
+    Count
+};
+
+inline constexpr int kFrameStampCount = static_cast<int>(FrameStamp::Count);
 
 // Frames come from FramePool and are recycled when the last reference drops, so
 // transport does no per-frame allocation.
@@ -22,6 +45,17 @@ struct Frame {
     PixelFormat   format = PixelFormat::BGR8;
 
     cv::Mat image;
+    // Keeps external storage `image` views alive (e.g. RawFileSource's file mapping) while the
+    // frame is in flight. The pool drops both when the frame comes back, so a recycled frame
+    // always owns its pixels.
+    std::shared_ptr<const void> backing;
+
+    // Timestamp{} = not reached. Mutable so the stages can stamp an otherwise-immutable FrameRef;
+    // each slot has exactly one writer thread, and processor copies carry earlier stamps forward.
+    mutable std::array<Timestamp, kFrameStampCount> stamps{};
+
+    void stamp(FrameStamp s, Timestamp t = now()) const { stamps[static_cast<int>(s)] = t; }
+    Timestamp stampOf(FrameStamp s) const { return stamps[static_cast<int>(s)]; }
 };
 
 // Consumers see frames as immutable. Producers fill a MutableFrameRef, then publish it
@@ -0,0 +1,99 @@
+#include "core/FrameFormat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/imgproc.hpp>
+
+namespace livim {
+
+Planes420 planes420(const cv::Mat& image, int width, int height, PixelFormat format) {
+    Planes420 p;
+    auto* base = const_cast<std::uint8_t*>(image.ptr<std::uint8_t>(0));
+    const std::size_t step = image.step;
+    p.y = cv::Mat(height, width, CV_8UC1, base, step);
+    std::uint8_t* chroma = base + step * static_cast<std::size_t>(height);
+    const int cw = width / 2, ch = height / 2;
+    if (format == PixelFormat::NV12) {
+        p.uv = cv::Mat(ch, cw, CV_8UC2, chroma, step);
+    } else {
+        // Half-stride rows, so two chroma rows share one row of `image`. Only true of a
+        // continuous image: a padded or cropped one has no such layout.
+        CV_Assert(image.isContinuous() && step == static_cast<std::size_t>(width));
+        p.u = cv::Mat(ch, cw, CV_8UC1, chroma, step / 2);
+        p.v = cv::Mat(ch, cw, CV_8UC1, chroma + step / 2 * static_cast<std::size_t>(ch), step / 2);
+    }
+    return p;
+}
+
+cv::Mat lumaOf(const Frame& f) {
+    cv::Mat y;
+    switch (f.format) {
+    case PixelFormat::Gray8:
+        return f.image;
+    case PixelFormat::I420:
+    case PixelFormat::NV12:
+        return planes420(f.image, f.width, f.height, f.format).y;
+    case PixelFormat::YUYV:
+        cv::extractChannel(f.image, y, 0);
+        return y;
+    case PixelFormat::BGR8:
+        cv::cvtColor(f.image, y, cv::COLOR_BGR2GRAY);
+        return y;
+    }
+    return y;
+}
+
+cv::Mat bgrOf(const Frame& f) {
+    if (f.image.empty() || f.format == PixelFormat::BGR8) return f.image;
+    cv::Mat bgr;
+    switch (f.format) {
+    case PixelFormat::Gray8: cv::cvtColor(f.image, bgr, cv::COLOR_GRAY2BGR); break;
+    case PixelFormat::I420:  cv::cvtColor(f.image, bgr, cv::COLOR_YUV2BGR_I420); break;
+    case PixelFormat::NV12:  cv::cvtColor(f.image, bgr, cv::COLOR_YUV2BGR_NV12); break;
+    case PixelFormat::YUYV:  cv::cvtColor(f.image, bgr, cv::COLOR_YUV2BGR_YUYV); break;
+    case PixelFormat::BGR8:  break;
+    }
+    return bgr;
+}
+
+void yuyvToI420(const cv::Mat& yuyv, cv::Mat& dst) {
+    const int w = yuyv.cols, h = yuyv.rows;
+    dst.create(h * 3 / 2, w, CV_8UC1);
+    const Planes420 out = planes420(dst, w, h, PixelFormat::I420);
+    cv::Mat y = out.y;
+    cv::extractChannel(yuyv, y, 0);
+    // Each Y0 U Y1 V quad is one 4-channel pixel of a half-width image: U and V are channels 1
+    // and 3 at full height, so only the vertical subsampling is left.
+    const cv::Mat quads(h, w / 2, CV_8UC4, const_cast<std::uint8_t*>(yuyv.ptr<std::uint8_t>(0)),
+                        yuyv.step);
+    cv::Mat full;
+    for (int c = 0; c < 2; ++c) {
+        cv::extractChannel(quads, full, c == 0 ? 1 : 3);
+        cv::Mat plane = c == 0 ? out.u : out.v;
+        cv::resize(full, plane, plane.size(), 0, 0, cv::INTER_AREA);
+    }
+}
+
+void replaceLuma(const Frame& in, const cv::Mat& y, cv::Mat& dst) {
+    if (in.format == PixelFormat::YUYV) {
+        in.image.copyTo(dst);
+        cv::insertChannel(y, dst, 0);
+        return;
+    }
+    dst.create(in.height * 3 / 2, in.width, CV_8UC1);
+    const Planes420 src = planes420(in.image, in.width, in.height, in.format);
+    const Planes420 out = planes420(dst, in.width, in.height, in.format);
+    cv::Mat outY = out.y;
+    y.copyTo(outY);
+    if (in.format == PixelFormat::NV12) {
+        cv::Mat outUv = out.uv;
+        src.uv.copyTo(outUv);
+    } else {
+        cv::Mat outU = out.u, outV = out.v;
+        src.u.copyTo(outU);
+        src.v.copyTo(outV);
+    }
+}
+
+} // namespace livim
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include "core/Frame.hpp"
+
+namespace livim {
+
+inline bool isYuv(PixelFormat f) {
+    return f == PixelFormat::I420 || f == PixelFormat::NV12 || f == PixelFormat::YUYV;
+}
+
+// 1 for Gray8, else 3: what the picture is, not how Frame::image stores it.
+inline int colourChannels(PixelFormat f) { return f == PixelFormat::Gray8 ? 1 : 3; }
+
+// Views of a 4:2:0 image's planes: `y` is width x height, then I420 fills `u` and `v` and NV12
+// fills `uv` (CV_8UC2), each half size. Writable only if `image` is. An I420 image must be
+// continuous (asserted): its chroma rows are half its stride; NV12 may be padded.
+struct Planes420 {
+    cv::Mat y, u, v, uv;
+};
+Planes420 planes420(const cv::Mat& image, int width, int height, PixelFormat format);
+
+// The frame's luminance, width x height: a view for Gray8, I420 and NV12 (valid while the frame
+// is), extracted for YUYV and converted for BGR8.
+cv::Mat lumaOf(const Frame& f);
+
+// The frame as BGR8 for consumers that need it (encoders, colour magnification): the image itself
+// for BGR8, else converted (gray expanded). Callers only read it.
+cv::Mat bgrOf(const Frame& f);
+
+// Packed YUYV to I420, chroma averaged vertically. `dst` is reallocated only if it doesn't fit.
+void yuyvToI420(const cv::Mat& yuyv, cv::Mat& dst);
+
+// A fresh image in `in`'s YUV layout with its Y plane replaced by `y` (width x height, CV_8UC1),
+// the chroma carried over untouched.
+void replaceLuma(const Frame& in, const cv::Mat& y, cv::Mat& dst);
+
+} // namespace livim
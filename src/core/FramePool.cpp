@@ -1,6 +1,7 @@
 #include "core/FramePool.hpp"
 
 #include <cassert>
+#include <chrono>
 
 namespace livim {
 
@@ -20,16 +21,31 @@ MutableFrameRef FramePool::acquire() {
     Frame* f = nullptr;
     {
         std::unique_lock<std::mutex> lk(core_->m);
-        core_->cv.wait(lk, [&] { return !core_->freeList.empty() || core_->stopped; });
+        const auto ready = [&] { return !core_->freeList.empty() || core_->stopped; };
+        if (!ready()) {
+            // Only a dry pool pays for the clock reads and counter updates.
+            const Timestamp t0 = now();
+            core_->cv.wait(lk, ready);
+            waits_.fetch_add(1, std::memory_order_relaxed);
+            blockedNs_.fetch_add(
+                static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now() - t0).count()),
+                std::memory_order_relaxed);
+        }
         if (core_->stopped) return nullptr;
         f = core_->freeList.back();
         core_->freeList.pop_back();
     }
+    f->stamps.fill(Timestamp{}); // a recycled frame must not report its previous life's stamps
 
     // The deleter keeps the core (which owns `f` via storage) alive and only returns the
     // pointer to the free list; it never deletes `f`.
     std::shared_ptr<Core> core = core_;
     return MutableFrameRef(f, [core](Frame* p) {
+        if (p->backing) { // outside the lock: this may unmap
+            p->image = cv::Mat();
+            p->backing.reset();
+        }
         std::lock_guard<std::mutex> lg(core->m);
         core->freeList.push_back(p);
         core->cv.notify_one();
@@ -47,6 +63,8 @@ void FramePool::stop() {
 void FramePool::reset() {
     std::lock_guard<std::mutex> lg(core_->m);
     core_->stopped = false;
+    waits_.store(0, std::memory_order_relaxed);
+    blockedNs_.store(0, std::memory_order_relaxed);
     // In-flight frames rejoin the free list via their deleter; storage is not rebuilt.
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <cstddef>
 #include <memory>
 #include <mutex>
@@ -33,6 +35,10 @@ public:
 
     std::size_t capacity() const { return capacity_; }
 
+    // acquire() calls that found the pool dry, and their cumulative blocked time.
+    std::uint64_t waits() const { return waits_.load(std::memory_order_relaxed); }
+    std::uint64_t blockedNs() const { return blockedNs_.load(std::memory_order_relaxed); }
+
 private:
     struct Core {
         std::mutex m;
@@ -44,6 +50,8 @@ private:
 
     std::shared_ptr<Core> core_;
     std::size_t capacity_;
+    std::atomic<std::uint64_t> waits_{0};
+    std::atomic<std::uint64_t> blockedNs_{0};
 };
 
 } // namespace livim
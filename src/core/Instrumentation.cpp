@@ -1,20 +1,51 @@
 #include "core/Instrumentation.hpp"
 
 #include <algorithm>
+#include <chrono>
+
+#include "core/Frame.hpp"
 
 namespace livim {
 
+const char* stageName(Stage s) {
+    switch (s) {
+    case Stage::SourceRead: return "source_read";
+    case Stage::Preprocess: return "preprocess";
+    case Stage::Grayscale:  return "grayscale";
+    case Stage::Magnify:    return "magnify";
+    case Stage::Publish:    return "publish";
+    case Stage::Upload:     return "upload";
+    case Stage::Compose:    return "compose";
+    case Stage::Encode:     return "encode";
+    case Stage::Seek:       return "seek";
+    case Stage::QueueWait:  return "queue_wait";
+    case Stage::Present:    return "present";
+    case Stage::Glass:      return "glass";
+    case Stage::Count:      break;
+    }
+    return "unknown";
+}
+
 void Instrumentation::recordLatency(double ms) {
     if (ms < 0.0) ms = 0.0;
-    int bucket = static_cast<int>(ms / kBucketMs);
-    if (bucket >= kBuckets) bucket = kBuckets - 1;
-    std::lock_guard<std::mutex> lg(histMu_);
-    ++hist_[bucket];
-    ++latencyCount_;
-    latencySumMs_ += ms;
+    latency_.record(static_cast<std::uint64_t>(ms * 1000.0));
 }
 
-StatsSnapshot Instrumentation::snapshot() {
+void Instrumentation::recordStage(Stage s, Clock::duration d) {
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    stageHist_[static_cast<int>(s)].record(us > 0 ? static_cast<std::uint64_t>(us) : 0);
+}
+
+void Instrumentation::recordPresented(const Frame& f) {
+    const Timestamp published = f.stampOf(FrameStamp::Published);
+    const Timestamp uploaded = f.stampOf(FrameStamp::Uploaded);
+    // Export previews bypass the live chain and carry no Published stamp.
+    if (published == Timestamp{} || uploaded == Timestamp{}) return;
+    recordStage(Stage::Present, uploaded - published);
+    recordStage(Stage::Glass, uploaded - f.captureTs);
+}
+
+StatsSnapshot Instrumentation::sample() const {
     StatsSnapshot s;
     s.captured = captured_.load(std::memory_order_relaxed);
     s.processed = processed_.load(std::memory_order_relaxed);
@@ -24,6 +55,42 @@ StatsSnapshot Instrumentation::snapshot() {
     s.procErrors = procErrors_.load(std::memory_order_relaxed);
     s.readErrors = readErrors_.load(std::memory_order_relaxed);
     s.queueDepth = queueDepth_.load(std::memory_order_relaxed);
+    s.queueWaits = queueWaits_.load(std::memory_order_relaxed);
+    s.queueBlockedMs = static_cast<double>(queueBlockedNs_.load(std::memory_order_relaxed)) / 1e6;
+    s.poolWaits = poolWaits_.load(std::memory_order_relaxed);
+    s.poolBlockedMs = static_cast<double>(poolBlockedNs_.load(std::memory_order_relaxed)) / 1e6;
+    s.decodeThreads = decodeThreads_.load(std::memory_order_relaxed);
+    s.prefetchDepth = prefetchDepth_.load(std::memory_order_relaxed);
+    s.prefetchUnderruns = prefetchUnderruns_.load(std::memory_order_relaxed);
+    s.frameCacheHits = frameCacheHits_.load(std::memory_order_relaxed);
+    s.frameCacheMisses = frameCacheMisses_.load(std::memory_order_relaxed);
+    s.frameCacheBytes = frameCacheBytes_.load(std::memory_order_relaxed);
+    s.cameraBuffers = cameraBuffers_.load(std::memory_order_relaxed);
+    s.cameraBuffersQueued = cameraBuffersQueued_.load(std::memory_order_relaxed);
+    s.cameraDrops = cameraDrops_.load(std::memory_order_relaxed);
+    s.cameraDecodeThreads = cameraDecodeThreads_.load(std::memory_order_relaxed);
+    s.cameraDecodeBacklog = cameraDecodeBacklog_.load(std::memory_order_relaxed);
+
+    s.latencyMeanMs = latency_.meanUs() / 1000.0;
+    s.latencyP95Ms = latency_.quantileUs(0.95) / 1000.0;
+    for (int i = 0; i < kStageCount; ++i) {
+        const LatencyHistogram& h = stageHist_[i];
+        StageTiming& st = s.stages[i];
+        st.count = h.count();
+        if (st.count == 0) continue;
+        st.p50Ms = h.quantileUs(0.50) / 1000.0;
+        st.p95Ms = h.quantileUs(0.95) / 1000.0;
+        st.p99Ms = h.quantileUs(0.99) / 1000.0;
+    }
+    const double readUs = stageHist_[static_cast<int>(Stage::SourceRead)].meanUs();
+    s.decodeFps = readUs > 0.0 ? 1e6 / readUs : 0.0;
+    return s;
+}
+
+StatsSnapshot Instrumentation::snapshot() {
+    StatsSnapshot s = sample();
+    const std::uint64_t blockedNs = queueBlockedNs_.load(std::memory_order_relaxed) +
+                                    poolBlockedNs_.load(std::memory_order_relaxed);
 
     const Timestamp t = now();
     if (haveLastSnapshot_) {
@@ -43,31 +110,24 @@ StatsSnapshot Instrumentation::snapshot() {
                                         : instDrop;
                 haveDropEma_ = true;
             }
+
+            // The source blocks on one primitive at a time, so the sum is a share of wall time
+            // (a file's decode thread and pacer can overlap; hence the clamp).
+            const double blockedDelta =
+                blockedNs >= lastBlockedNs_ ? static_cast<double>(blockedNs - lastBlockedNs_) : 0.0;
+            const double instStall = std::min(1.0, blockedDelta / (dt * 1e9));
+            stallEma_ = kFpsEmaAlpha * instStall + (1.0 - kFpsEmaAlpha) * stallEma_;
         }
     }
     s.fps = fpsEma_;
     s.dropFraction = dropEma_;
+    s.stallFraction = stallEma_;
 
     lastSnapshotTs_ = t;
     lastProcessed_ = s.processed;
     lastSourceDrops_ = s.sourceDrops;
+    lastBlockedNs_ = blockedNs;
     haveLastSnapshot_ = true;
-
-    {
-        std::lock_guard<std::mutex> lg(histMu_);
-        if (latencyCount_ > 0) {
-            s.latencyMeanMs = latencySumMs_ / static_cast<double>(latencyCount_);
-            const std::uint64_t target = (latencyCount_ * 95 + 99) / 100; // ceil(0.95 * n)
-            std::uint64_t acc = 0;
-            for (int i = 0; i < kBuckets; ++i) {
-                acc += hist_[i];
-                if (acc >= target) {
-                    s.latencyP95Ms = (i + 0.5) * kBucketMs; // bucket center
-                    break;
-                }
-            }
-        }
-    }
     return s;
 }
 
@@ -80,11 +140,24 @@ void Instrumentation::reset() {
     procErrors_.store(0, std::memory_order_relaxed);
     readErrors_.store(0, std::memory_order_relaxed);
     queueDepth_.store(0, std::memory_order_relaxed);
+    queueWaits_.store(0, std::memory_order_relaxed);
+    queueBlockedNs_.store(0, std::memory_order_relaxed);
+    poolWaits_.store(0, std::memory_order_relaxed);
+    poolBlockedNs_.store(0, std::memory_order_relaxed);
+    decodeThreads_.store(0, std::memory_order_relaxed);
+    prefetchDepth_.store(0, std::memory_order_relaxed);
+    prefetchUnderruns_.store(0, std::memory_order_relaxed);
+    frameCacheHits_.store(0, std::memory_order_relaxed);
+    frameCacheMisses_.store(0, std::memory_order_relaxed);
+    frameCacheBytes_.store(0, std::memory_order_relaxed);
+    cameraBuffers_.store(0, std::memory_order_relaxed);
+    cameraBuffersQueued_.store(0, std::memory_order_relaxed);
+    cameraDrops_.store(0, std::memory_order_relaxed);
+    cameraDecodeThreads_.store(0, std::memory_order_relaxed);
+    cameraDecodeBacklog_.store(0, std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lg(histMu_);
-    hist_.fill(0);
-    latencyCount_ = 0;
-    latencySumMs_ = 0.0;
+    latency_.reset();
+    for (LatencyHistogram& h : stageHist_) h.reset();
     haveLastSnapshot_ = false;
     lastProcessed_ = 0;
     fpsEma_ = 0.0;
@@ -92,6 +165,8 @@ void Instrumentation::reset() {
     lastSourceDrops_ = 0;
     dropEma_ = 0.0;
     haveDropEma_ = false;
+    lastBlockedNs_ = 0;
+    stallEma_ = 0.0;
 }
 
 } // namespace livim
@@ -4,17 +4,60 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
 
 #include "core/Clock.hpp"
+#include "core/LatencyHistogram.hpp"
+#include "core/Trace.hpp"
 
 namespace livim {
 
+struct Frame;
+
 // Hardcoded instead of std::hardware_destructive_interference_size, whose value GCC warns is
 // ABI-unstable (-Winterference-size); 64 is correct for mainstream x86-64/arm64.
 inline constexpr std::size_t kCacheLine = 64;
 
-// Pipeline health, polled by the GUI on a timer.
+// Timed pipeline stages, each with its own histogram. The three processing stages follow the
+// ChainBuilder order; Publish/Upload/Seek and the Frame-stamp intervals are live-only,
+// Compose/Encode export-only.
+enum class Stage : int {
+    SourceRead,  // decode / grab of one frame
+    Preprocess,
+    Grayscale,
+    Magnify,
+    Publish,     // mailbox publish
+    Upload,      // GL texture upload of a new frame
+    Compose,     // export canvas composition + colour conversion
+    Encode,      // export writer
+    Seek,        // file reposition: demuxer seek + decode up to the target frame
+    // Intervals between Frame stamps rather than timed scopes:
+    QueueWait,   // capture -> dequeued by the processing thread
+    Present,     // published -> uploaded (mailbox residency + upload)
+    Glass,       // capture -> uploaded, end to end
+    Count
+};
+
+inline constexpr int kStageCount = static_cast<int>(Stage::Count);
+
+const char* stageName(Stage s);
+
+// Per-stage duration percentiles, cumulative since the last reset().
+struct StageTiming {
+    std::uint64_t count = 0;
+    double        p50Ms = 0.0;
+    double        p95Ms = 0.0;
+    double        p99Ms = 0.0;
+};
+
+// Cumulative TaskPool counters (see TaskPool.hpp).
+struct TaskPoolStats {
+    int           workers = 0;
+    std::uint64_t tasks = 0;    // tasks executed by workers and helping callers
+    std::uint64_t steals = 0;   // tasks taken from another worker's deque
+    double        idleMs = 0.0; // summed time workers slept with nothing to run
+};
+
+// Pipeline health, polled by the GUI on a timer and by the StatsExporter thread.
 struct StatsSnapshot {
     std::uint64_t captured = 0;
     std::uint64_t processed = 0;       // processed == captured  =>  zero pipeline drops
@@ -24,10 +67,29 @@ struct StatsSnapshot {
     std::uint64_t procErrors = 0;      // frames a processing stage threw on (degraded, not crashed)
     std::uint64_t readErrors = 0;
     std::size_t   queueDepth = 0;
+    std::uint64_t queueWaits = 0;      // source pushes that blocked on a full queue
+    double        queueBlockedMs = 0.0;
+    std::uint64_t poolWaits = 0;       // frame acquires that blocked on an empty pool
+    double        poolBlockedMs = 0.0;
     double        fps = 0.0;           // processed frames/sec since the previous snapshot
     double        latencyMeanMs = 0.0; // capture -> processed
     double        latencyP95Ms = 0.0;
     double        dropFraction = 0.0;  // EMA of dropped/(dropped+processed)
+    double        stallFraction = 0.0; // EMA share of wall time the source spent blocked
+    std::array<StageTiming, kStageCount> stages{}; // indexed by Stage
+    TaskPoolStats taskPool;            // shared intra-frame pool, process-wide
+    int           decodeThreads = 0;   // file decoder threads; 0 = not a threaded decoder
+    std::size_t   prefetchDepth = 0;   // file frames decoded ahead of the pacer
+    std::uint64_t prefetchUnderruns = 0; // times the pacer found nothing decoded while playing
+    double        decodeFps = 0.0;     // frames/sec the source read sustains alone (1 / mean)
+    std::uint64_t frameCacheHits = 0;  // file frames served from FileSource's FrameCache
+    std::uint64_t frameCacheMisses = 0;
+    std::size_t   frameCacheBytes = 0;
+    int           cameraBuffers = 0;       // V4L2 streaming buffers; 0 = not a native V4L2 camera
+    int           cameraBuffersQueued = 0; // of those, with the driver (the rest are out in frames)
+    std::uint64_t cameraDrops = 0;         // frames the driver dropped (sequence gaps)
+    int           cameraDecodeThreads = 0; // MJPEG decode workers; 0 = decoded on the grab thread
+    std::size_t   cameraDecodeBacklog = 0; // frames grabbed but not yet decoded and delivered
 };
 
 // Counters are cache-line padded to avoid false sharing between the threads that bump them.
@@ -41,11 +103,47 @@ public:
     }
     void setQueueDepth(std::size_t d) { queueDepth_.store(d, std::memory_order_relaxed); }
     void setSourceDrops(std::uint64_t d) { sourceDrops_.store(d, std::memory_order_relaxed); }
+    // Cumulative backpressure from BoundedQueue::push / FramePool::acquire.
+    void setQueueWaits(std::uint64_t waits, std::uint64_t blockedNs) {
+        queueWaits_.store(waits, std::memory_order_relaxed);
+        queueBlockedNs_.store(blockedNs, std::memory_order_relaxed);
+    }
+    void setPoolWaits(std::uint64_t waits, std::uint64_t blockedNs) {
+        poolWaits_.store(waits, std::memory_order_relaxed);
+        poolBlockedNs_.store(blockedNs, std::memory_order_relaxed);
+    }
+    // Set by a file source at open(); see StatsSnapshot::decodeThreads.
+    void setDecodeThreads(int n) { decodeThreads_.store(n, std::memory_order_relaxed); }
+    // FileSource's decode-ahead ring (see FileSource::kPrefetchDepth).
+    void setPrefetchDepth(std::size_t d) { prefetchDepth_.store(d, std::memory_order_relaxed); }
+    void onPrefetchUnderrun() { prefetchUnderruns_.fetch_add(1, std::memory_order_relaxed); }
+    // FileSource's decoded-frame cache (see FrameCache).
+    void onFrameCacheHit() { frameCacheHits_.fetch_add(1, std::memory_order_relaxed); }
+    void onFrameCacheMiss() { frameCacheMisses_.fetch_add(1, std::memory_order_relaxed); }
+    void setFrameCacheBytes(std::size_t b) { frameCacheBytes_.store(b, std::memory_order_relaxed); }
+    // V4l2CameraSource's buffer ring and the driver's own drops.
+    void setCameraBuffers(int queued, int total) {
+        cameraBuffersQueued_.store(queued, std::memory_order_relaxed);
+        cameraBuffers_.store(total, std::memory_order_relaxed);
+    }
+    void addCameraDrops(std::uint64_t n) { cameraDrops_.fetch_add(n, std::memory_order_relaxed); }
+    // CameraDecoder's workers and the frames waiting on them.
+    void setCameraDecode(int threads, std::size_t backlog) {
+        cameraDecodeThreads_.store(threads, std::memory_order_relaxed);
+        cameraDecodeBacklog_.store(backlog, std::memory_order_relaxed);
+    }
     void onProcessingError() { procErrors_.fetch_add(1, std::memory_order_relaxed); }
     void onSourceReadError() { readErrors_.fetch_add(1, std::memory_order_relaxed); }
 
     void recordLatency(double ms);
+    void recordStage(Stage s, Clock::duration d);
+    // GUI thread, after a live frame's upload: Present and Glass from its stamps.
+    void recordPresented(const Frame& f);
     StatsSnapshot snapshot(); // also computes fps over the interval since the last call
+
+    // Counters and percentiles only (the EMA fields stay 0); const and safe from any thread,
+    // for readers that keep their own rate state (StatsExporter).
+    StatsSnapshot sample() const;
     void reset();
 
 private:
@@ -57,14 +155,28 @@ private:
     alignas(kCacheLine) std::atomic<std::uint64_t> procErrors_{0};
     alignas(kCacheLine) std::atomic<std::uint64_t> readErrors_{0};
     alignas(kCacheLine) std::atomic<std::size_t> queueDepth_{0};
+    // Written together by the GUI-thread setters above; one line is enough.
+    alignas(kCacheLine) std::atomic<std::uint64_t> queueWaits_{0};
+    std::atomic<std::uint64_t> queueBlockedNs_{0};
+    std::atomic<std::uint64_t> poolWaits_{0};
+    std::atomic<std::uint64_t> poolBlockedNs_{0};
+    std::atomic<int> decodeThreads_{0};
+    // Written by the file source's two threads.
+    alignas(kCacheLine) std::atomic<std::size_t> prefetchDepth_{0};
+    std::atomic<std::uint64_t> prefetchUnderruns_{0};
+    std::atomic<std::uint64_t> frameCacheHits_{0};
+    std::atomic<std::uint64_t> frameCacheMisses_{0};
+    std::atomic<std::size_t> frameCacheBytes_{0};
+    // Written by the camera source thread.
+    alignas(kCacheLine) std::atomic<int> cameraBuffers_{0};
+    std::atomic<int> cameraBuffersQueued_{0};
+    std::atomic<std::uint64_t> cameraDrops_{0};
+    // Written by the camera source thread and its decode workers.
+    alignas(kCacheLine) std::atomic<int> cameraDecodeThreads_{0};
+    std::atomic<std::size_t> cameraDecodeBacklog_{0};
 
-    static constexpr int kBuckets = 64;
-    static constexpr double kBucketMs = 5.0; // covers 0..320 ms; last bucket is a catch-all
-
-    std::mutex histMu_;
-    std::array<std::uint64_t, kBuckets> hist_{};
-    std::uint64_t latencyCount_ = 0;
-    double latencySumMs_ = 0.0;
+    LatencyHistogram latency_; // capture -> processed
+    std::array<LatencyHistogram, kStageCount> stageHist_;
 
     Timestamp lastSnapshotTs_{};
     std::uint64_t lastProcessed_ = 0;
@@ -78,6 +190,34 @@ private:
     std::uint64_t lastSourceDrops_ = 0;
     double dropEma_ = 0.0;
     bool haveDropEma_ = false;
+
+    std::uint64_t lastBlockedNs_ = 0;
+    double stallEma_ = 0.0;
+};
+
+// Times the enclosing scope into one stage histogram and, while tracing is on, also records it as a
+// trace span tagged with `seq`. With a null Instrumentation and tracing off it is a no-op.
+class StageTimer {
+public:
+    StageTimer(Instrumentation* instr, Stage stage, std::uint64_t seq = trace::kNoSeq)
+        : instr_(instr), stage_(stage), seq_(seq), trace_(trace::enabled()),
+          start_(instr || trace_ ? now() : Timestamp{}) {}
+    ~StageTimer() {
+        if (!instr_ && !trace_) return;
+        const Timestamp end = now();
+        if (instr_) instr_->recordStage(stage_, end - start_);
+        if (trace_) trace::complete(stageName(stage_), seq_, start_, end);
+    }
+
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    Instrumentation* instr_;
+    Stage stage_;
+    std::uint64_t seq_;
+    bool trace_;
+    Timestamp start_;
 };
 
 } // namespace livim
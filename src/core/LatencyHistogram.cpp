@@ -0,0 +1,66 @@
+#include "core/LatencyHistogram.hpp"
+
+#include <bit>
+#include <cmath>
+
+namespace livim {
+
+int LatencyHistogram::bucketOf(std::uint64_t us) {
+    if (us < static_cast<std::uint64_t>(kSub)) return static_cast<int>(us);
+    const int msb = static_cast<int>(std::bit_width(us)) - 1;
+    if (msb > kMaxMsb) return kBuckets - 1;
+    const int shift = msb - kSubBits;
+    const int sub = static_cast<int>(us >> shift) - kSub; // top kSubBits below the leading one
+    return kSub + shift * kSub + sub;
+}
+
+double LatencyHistogram::bucketMidUs(int index) {
+    if (index < kSub) return index + 0.5; // exact bucket [index, index + 1)
+    const int k = index - kSub;
+    const int shift = k / kSub;
+    const double width = std::ldexp(1.0, shift);
+    const double lower = static_cast<double>(kSub + k % kSub) * width;
+    return lower + 0.5 * width;
+}
+
+void LatencyHistogram::record(std::uint64_t us) {
+    buckets_[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sumUs_.fetch_add(us, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::quantileUs(double q) const {
+    // Copy first so the target and the walk agree even while writers keep recording.
+    std::array<std::uint64_t, kBuckets> local{};
+    std::uint64_t total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        local[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += local[i];
+    }
+    if (total == 0) return 0.0;
+
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+    std::uint64_t target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    if (target == 0) target = 1;
+    std::uint64_t acc = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        acc += local[i];
+        if (acc >= target) return bucketMidUs(i);
+    }
+    return bucketMidUs(kBuckets - 1);
+}
+
+double LatencyHistogram::meanUs() const {
+    const std::uint64_t n = count_.load(std::memory_order_relaxed);
+    if (n == 0) return 0.0;
+    return static_cast<double>(sumUs_.load(std::memory_order_relaxed)) / static_cast<double>(n);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sumUs_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace livim
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace livim {
+
+// Log-linear (HDR-style) histogram of microsecond durations: exact below 16 us, then 16 linear
+// sub-buckets per power of two (<= 6.25% relative error) up to 2^32 us (~71 min; larger values
+// clamp into the last bucket). record() is three relaxed atomic adds, so any number of threads
+// may record concurrently; readers see a slightly torn but never corrupt distribution.
+class LatencyHistogram {
+public:
+    void record(std::uint64_t us);
+
+    // Bucket midpoint holding quantile q in [0,1], in microseconds; 0 when empty.
+    double quantileUs(double q) const;
+
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    double meanUs() const;
+
+    // Not atomic with respect to concurrent record() calls; a racing sample may survive.
+    void reset();
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kMaxMsb = 31;
+    static constexpr int kBuckets = kSub + (kMaxMsb - kSubBits + 1) * kSub;
+
+    static int bucketOf(std::uint64_t us);
+    static double bucketMidUs(int index);
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sumUs_{0};
+};
+
+} // namespace livim
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace livim {
+
+// Read-only memory mapping of a whole file, shared so every view handed out can pin it. One
+// implementation per platform (MappedFile_Posix.cpp / MappedFile_Windows.cpp). The access hints
+// are advisory: they steer the kernel's read-ahead and are no-ops where unsupported.
+class MappedFile {
+public:
+    // Null if the file can't be opened or mapped (or is empty).
+    static std::shared_ptr<const MappedFile> open(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // Whole mapping: read mostly front to back (aggressive read-ahead) or at random (none).
+    void adviseSequential() const;
+    void adviseRandom() const;
+    // Starts paging in [offset, offset + len) in the background, e.g. the frames about to play.
+    void willNeed(std::size_t offset, std::size_t len) const;
+
+private:
+    MappedFile() = default;
+
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    void* handle_ = nullptr; // Windows: the file-mapping object
+};
+
+} // namespace livim
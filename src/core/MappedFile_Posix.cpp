@@ -0,0 +1,53 @@
+#include "core/MappedFile.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace livim {
+namespace {
+
+void advise(const std::uint8_t* data, std::size_t size, std::size_t offset, std::size_t len,
+            int advice) {
+    if (!data || offset >= size) return;
+    // madvise wants a page-aligned start; widen the range down to one.
+    static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset / page * page;
+    const std::size_t end = std::min(size, offset + len);
+    madvise(const_cast<std::uint8_t*>(data) + start, end - start, advice);
+}
+
+} // namespace
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return nullptr;
+    struct stat st{};
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps its own reference to the file
+    if (p == MAP_FAILED) return nullptr;
+
+    std::shared_ptr<MappedFile> m(new MappedFile);
+    m->data_ = static_cast<const std::uint8_t*>(p);
+    m->size_ = static_cast<std::size_t>(st.st_size);
+    return m;
+}
+
+MappedFile::~MappedFile() {
+    if (data_) munmap(const_cast<std::uint8_t*>(data_), size_);
+}
+
+void MappedFile::adviseSequential() const { advise(data_, size_, 0, size_, MADV_SEQUENTIAL); }
+
+void MappedFile::adviseRandom() const { advise(data_, size_, 0, size_, MADV_RANDOM); }
+
+void MappedFile::willNeed(std::size_t offset, std::size_t len) const {
+    advise(data_, size_, offset, len, MADV_WILLNEED);
+}
+
+} // namespace livim
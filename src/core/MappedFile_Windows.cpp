@@ -0,0 +1,57 @@
+#include "core/MappedFile.hpp"
+
+#include <algorithm>
+#include <string>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+
+namespace livim {
+
+std::shared_ptr<const MappedFile> MappedFile::open(const std::string& path) {
+    const int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    if (wlen <= 0) return nullptr;
+    std::wstring wpath(static_cast<std::size_t>(wlen), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wpath.data(), wlen);
+
+    HANDLE file = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER size{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file); // the mapping object keeps the file open
+    if (!mapping) return nullptr;
+    void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!p) {
+        CloseHandle(mapping);
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedFile> m(new MappedFile);
+    m->data_ = static_cast<const std::uint8_t*>(p);
+    m->size_ = static_cast<std::size_t>(size.QuadPart);
+    m->handle_ = mapping;
+    return m;
+}
+
+MappedFile::~MappedFile() {
+    if (data_) UnmapViewOfFile(data_);
+    if (handle_) CloseHandle(handle_);
+}
+
+// Windows has no whole-mapping access hints; its read-ahead for mapped files is fixed.
+void MappedFile::adviseSequential() const {}
+
+void MappedFile::adviseRandom() const {}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t len) const {
+    if (!data_ || offset >= size_) return;
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<std::uint8_t*>(data_) + offset,
+                                   std::min(len, size_ - offset)};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+} // namespace livim
@@ -0,0 +1,49 @@
+#include "core/OpenCvParallel.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+
+#include "core/TaskPool.hpp"
+
+namespace livim {
+namespace {
+
+// parallel_for_ hands over pre-split stripes; one chunk per stripe lets the pool balance them.
+// Each call goes to the caller's current pool, so an export job's OpenCV work stays on its own.
+class TaskPoolBackend : public cv::parallel::ParallelForAPI {
+public:
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body, void* data) override {
+        currentTaskPool().parallelFor(0, tasks, 1, [&](int lo, int hi) { body(lo, hi, data); });
+    }
+
+    // 0 is any non-worker caller; workers are 1..workerCount().
+    int getThreadNum() const override { return currentTaskPool().currentWorker() + 1; }
+    int getNumThreads() const override { return currentTaskPool().workerCount() + 1; }
+    // The pools are sized up front (LIVIM_THREADS); cv::setNumThreads cannot resize them.
+    int setNumThreads(int) override { return getNumThreads(); }
+    const char* getName() const override { return "livim-taskpool"; }
+};
+
+} // namespace
+
+OpenCvThreading openCvThreadingFromEnvironment() {
+    const char* v = std::getenv("LIVIM_CV_THREADS");
+    return v && std::strcmp(v, "native") == 0 ? OpenCvThreading::Native : OpenCvThreading::Pool;
+}
+
+void configureOpenCvThreading(OpenCvThreading mode) {
+    if (mode == OpenCvThreading::Pool) {
+        cv::parallel::setParallelForBackend(std::make_shared<TaskPoolBackend>(), false);
+        return;
+    }
+    const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    cv::setNumThreads(std::max(1, cores - sharedTaskPool().workerCount()));
+}
+
+} // namespace livim
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace livim {
+
+enum class OpenCvThreading {
+    Pool,   // OpenCV's parallel_for_ runs on the caller's currentTaskPool(): one set of threads
+            // process-wide, or an export job's own
+    Native  // OpenCV keeps its own threads, capped to the cores the task pool leaves free; an
+            // export job's core share does not cover them
+};
+
+// LIVIM_CV_THREADS=native selects Native; anything else (or unset) is Pool.
+OpenCvThreading openCvThreadingFromEnvironment();
+
+// Call once at startup, before any OpenCV call that may spawn threads. Without this, OpenCV's
+// own pool (hardware_concurrency threads) competes with the task pool for the same cores.
+void configureOpenCvThreading(OpenCvThreading mode);
+
+} // namespace livim
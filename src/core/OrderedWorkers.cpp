@@ -0,0 +1,17 @@
+#include "core/OrderedWorkers.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace livim {
+
+int defaultOrderedWorkerThreads() {
+    return std::clamp(static_cast<int>(std::thread::hardware_concurrency()) / 2, 1, 4);
+}
+
+int orderedWorkerThreadsFromEnvironment(const char* envVar) {
+    if (const char* v = std::getenv(envVar); v && *v) return std::max(0, std::atoi(v));
+    return defaultOrderedWorkerThreads();
+}
+
+} // namespace livim
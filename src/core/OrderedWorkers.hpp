@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/Trace.hpp"
+
+namespace livim {
+
+// Half the cores, at most 4: for decoders that run beside the pipeline rather than own the machine.
+int defaultOrderedWorkerThreads();
+
+// `envVar` as a thread count when it is set (negative reads as 0), else
+// defaultOrderedWorkerThreads().
+int orderedWorkerThreadsFromEnvironment(const char* envVar);
+
+// A few threads of their own working through a window of jobs whose results are taken back
+// strictly in submission order, e.g. frames decoded ahead of their reader. A worker always claims
+// the earliest unclaimed job, since the window's front is the one being waited on. The window is
+// two jobs per thread, which keeps every thread busy while bounding memory; push() waits for room
+// beyond that. Results come back through pop() or, given `deliver`, one at a time on whichever
+// worker finished the window's front.
+template <class Job>
+class OrderedWorkers {
+public:
+    using Work = std::function<void(Job&)>;    // on a worker, unlocked
+    using Deliver = std::function<bool(Job&&)>; // false stops: the window is dropped for good
+
+    OrderedWorkers(int threads, std::string threadName, Work work, Deliver deliver = {})
+        : work_(std::move(work)), deliver_(std::move(deliver)) {
+        const int n = std::max(1, threads);
+        depth_ = static_cast<std::size_t>(n) * 2;
+        threads_.reserve(static_cast<std::size_t>(n));
+        for (int i = 0; i < n; ++i)
+            threads_.emplace_back([this, threadName] {
+                trace::setThreadName(threadName.c_str());
+                workerLoop();
+            });
+    }
+
+    ~OrderedWorkers() { shutdown(); }
+
+    OrderedWorkers(const OrderedWorkers&) = delete;
+    OrderedWorkers& operator=(const OrderedWorkers&) = delete;
+
+    int threads() const { return static_cast<int>(threads_.size()); }
+    std::size_t capacity() const { return depth_; }
+
+    std::size_t size() const { // jobs in the window, running or done but not yet taken back
+        std::lock_guard<std::mutex> lg(mu_);
+        return window_.size();
+    }
+
+    // Queues `job`, waiting while the window is full; false once delivery has stopped.
+    bool push(Job job) {
+        auto slot = std::make_shared<Slot>();
+        slot->job = std::move(job);
+        {
+            std::unique_lock<std::mutex> lk(mu_);
+            roomCv_.wait(lk, [this] { return stopped_ || window_.size() < depth_; });
+            if (stopped_) return false;
+            window_.push_back(std::move(slot));
+        }
+        workCv_.notify_one();
+        return true;
+    }
+
+    // Without `deliver`: the oldest job, waiting for it to finish. False if the window is empty
+    // or the workers shut down.
+    bool pop(Job& out) {
+        std::unique_lock<std::mutex> lk(mu_);
+        if (window_.empty()) return false;
+        const std::shared_ptr<Slot> slot = window_.front();
+        doneCv_.wait(lk, [&] { return slot->done || quit_; });
+        if (!slot->done) return false;
+        window_.pop_front();
+        out = std::move(slot->job);
+        lk.unlock();
+        roomCv_.notify_one();
+        return true;
+    }
+
+    // Drops what is in flight and joins the threads; push() fails from then on. Idempotent.
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lg(mu_);
+            quit_ = true;
+            stopped_ = true;
+        }
+        workCv_.notify_all();
+        roomCv_.notify_all();
+        doneCv_.notify_all();
+        for (std::thread& t : threads_)
+            if (t.joinable()) t.join();
+    }
+
+    // Drops the window; jobs still running finish unseen.
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lg(mu_);
+            window_.clear();
+        }
+        roomCv_.notify_all();
+    }
+
+private:
+    struct Slot {
+        Job  job;
+        bool claimed = false;
+        bool done = false;
+    };
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lk(mu_);
+        for (;;) {
+            std::shared_ptr<Slot> slot;
+            workCv_.wait(lk, [&] {
+                if (quit_) return true;
+                for (const std::shared_ptr<Slot>& s : window_)
+                    if (!s->claimed) {
+                        slot = s;
+                        return true;
+                    }
+                return false;
+            });
+            if (quit_) return;
+            slot->claimed = true;
+            lk.unlock();
+            work_(slot->job);
+            lk.lock();
+            slot->done = true;
+            if (deliver_) drain(lk);
+            else doneCv_.notify_all();
+        }
+    }
+
+    // One deliverer at a time, always the window's front, keeps the order; a worker finishing a
+    // later job meanwhile leaves it for the one already delivering.
+    void drain(std::unique_lock<std::mutex>& lk) {
+        while (!delivering_ && !stopped_ && !window_.empty() && window_.front()->done) {
+            const std::shared_ptr<Slot> slot = window_.front();
+            window_.pop_front();
+            delivering_ = true;
+            lk.unlock();
+            roomCv_.notify_one();
+            const bool more = deliver_(std::move(slot->job));
+            lk.lock();
+            delivering_ = false;
+            if (!more) {
+                stopped_ = true;
+                window_.clear();
+                roomCv_.notify_all();
+            }
+        }
+    }
+
+    Work                    work_;
+    Deliver                 deliver_;
+    mutable std::mutex      mu_;
+    std::condition_variable workCv_; // an unclaimed job or quit_
+    std::condition_variable roomCv_; // the window shrank or delivery stopped
+    std::condition_variable doneCv_; // a job finished (pop())
+    std::deque<std::shared_ptr<Slot>> window_; // in submission order
+    std::size_t             depth_ = 2;
+    bool                    delivering_ = false; // a worker is inside deliver_
+    bool                    stopped_ = false;    // deliver_ returned false, or shutting down
+    bool                    quit_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace livim
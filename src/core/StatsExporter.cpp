@@ -0,0 +1,390 @@
+#include "core/StatsExporter.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+#include "core/Trace.hpp"
+
+namespace livim {
+namespace {
+
+constexpr char kUnixPrefix[] = "unix:";
+
+// std::to_chars is locale-independent; Qt calls setlocale(), which would turn printf's decimal
+// point into a comma on some systems and break both formats.
+void appendNum(std::string& out, double v) {
+    char buf[32];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 3);
+    out.append(buf, r.ptr);
+}
+
+void appendNum(std::string& out, std::uint64_t v) {
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+
+// Rates over the exporter's own interval, so they don't depend on the GUI's EMA.
+struct Rates {
+    double fps = 0.0;
+    double dropFraction = 0.0;
+    double stallFraction = 0.0;
+};
+
+void formatNdjson(std::string& out, const StatsSnapshot& s, const Rates& r, std::uint64_t unixMs) {
+    auto field = [&](const char* name, auto v) {
+        out += '"';
+        out += name;
+        out += "\":";
+        appendNum(out, v);
+        out += ',';
+    };
+    out += '{';
+    field("ts_ms", unixMs);
+    field("captured", s.captured);
+    field("processed", s.processed);
+    field("displayed", s.displayed);
+    field("display_skipped", s.displaySkipped);
+    field("source_drops", s.sourceDrops);
+    field("proc_errors", s.procErrors);
+    field("read_errors", s.readErrors);
+    field("queue_depth", static_cast<std::uint64_t>(s.queueDepth));
+    field("queue_waits", s.queueWaits);
+    field("queue_blocked_ms", s.queueBlockedMs);
+    field("pool_waits", s.poolWaits);
+    field("pool_blocked_ms", s.poolBlockedMs);
+    field("fps", r.fps);
+    field("drop_fraction", r.dropFraction);
+    field("stall_fraction", r.stallFraction);
+    field("latency_mean_ms", s.latencyMeanMs);
+    field("latency_p95_ms", s.latencyP95Ms);
+    field("task_workers", static_cast<std::uint64_t>(s.taskPool.workers));
+    field("task_count", s.taskPool.tasks);
+    field("task_steals", s.taskPool.steals);
+    field("task_idle_ms", s.taskPool.idleMs);
+    field("decode_threads", static_cast<std::uint64_t>(s.decodeThreads));
+    field("decode_fps", s.decodeFps);
+    field("prefetch_depth", static_cast<std::uint64_t>(s.prefetchDepth));
+    field("prefetch_underruns", s.prefetchUnderruns);
+    field("frame_cache_hits", s.frameCacheHits);
+    field("frame_cache_misses", s.frameCacheMisses);
+    field("frame_cache_bytes", static_cast<std::uint64_t>(s.frameCacheBytes));
+    field("camera_buffers", static_cast<std::uint64_t>(s.cameraBuffers));
+    field("camera_buffers_queued", static_cast<std::uint64_t>(s.cameraBuffersQueued));
+    field("camera_drops", s.cameraDrops);
+    field("camera_decode_threads", static_cast<std::uint64_t>(s.cameraDecodeThreads));
+    field("camera_decode_backlog", static_cast<std::uint64_t>(s.cameraDecodeBacklog));
+    out += "\"stages\":{";
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageTiming& t = s.stages[i];
+        if (i > 0) out += ',';
+        out += '"';
+        out += stageName(static_cast<Stage>(i));
+        out += "\":{";
+        field("count", t.count);
+        field("p50_ms", t.p50Ms);
+        field("p95_ms", t.p95Ms);
+        field("p99_ms", t.p99Ms);
+        out.back() = '}'; // replace the trailing comma
+    }
+    out += "}}\n";
+}
+
+void formatPrometheus(std::string& out, const StatsSnapshot& s, const Rates& r) {
+    auto metric = [&](const char* name, const char* type, const char* help, auto v) {
+        out += "# HELP livim_";
+        out += name;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE livim_";
+        out += name;
+        out += ' ';
+        out += type;
+        out += "\nlivim_";
+        out += name;
+        out += ' ';
+        appendNum(out, v);
+        out += '\n';
+    };
+    metric("frames_captured_total", "counter", "Frames produced by the source.", s.captured);
+    metric("frames_processed_total", "counter", "Frames through the processing chain.", s.processed);
+    metric("frames_displayed_total", "counter", "Frames uploaded for display.", s.displayed);
+    metric("frames_display_skipped_total", "counter", "Processed frames never displayed.",
+           s.displaySkipped);
+    metric("source_drops_total", "counter", "Frames dropped before processing.", s.sourceDrops);
+    metric("processing_errors_total", "counter", "Frames a processor threw on.", s.procErrors);
+    metric("read_errors_total", "counter", "Failed source reads.", s.readErrors);
+    metric("queue_depth", "gauge", "Source to processing queue depth.",
+           static_cast<std::uint64_t>(s.queueDepth));
+    metric("queue_waits_total", "counter", "Source pushes that blocked on a full queue.",
+           s.queueWaits);
+    metric("queue_blocked_ms_total", "counter", "Time the source spent blocked on the queue.",
+           s.queueBlockedMs);
+    metric("pool_waits_total", "counter", "Frame acquires that blocked on an empty pool.",
+           s.poolWaits);
+    metric("pool_blocked_ms_total", "counter", "Time spent blocked on the frame pool.",
+           s.poolBlockedMs);
+    metric("fps", "gauge", "Processed frames per second over the last interval.", r.fps);
+    metric("drop_fraction", "gauge", "Dropped share of resolved frames over the last interval.",
+           r.dropFraction);
+    metric("stall_fraction", "gauge", "Share of the last interval the source spent blocked.",
+           r.stallFraction);
+    metric("latency_mean_ms", "gauge", "Mean capture to processed latency.", s.latencyMeanMs);
+    metric("latency_p95_ms", "gauge", "p95 capture to processed latency.", s.latencyP95Ms);
+    metric("task_workers", "gauge", "Worker threads in the shared task pool.",
+           static_cast<std::uint64_t>(s.taskPool.workers));
+    metric("tasks_total", "counter", "Tasks run on the shared task pool.", s.taskPool.tasks);
+    metric("task_steals_total", "counter", "Tasks stolen between pool workers.",
+           s.taskPool.steals);
+    metric("task_idle_ms_total", "counter", "Summed time pool workers slept idle.",
+           s.taskPool.idleMs);
+    metric("decode_threads", "gauge", "Decoder threads of the open file (0 = none).",
+           static_cast<std::uint64_t>(s.decodeThreads));
+    metric("decode_fps", "gauge", "Frames per second the source read sustains on its own.",
+           s.decodeFps);
+    metric("prefetch_depth", "gauge", "File frames decoded ahead of playback.",
+           static_cast<std::uint64_t>(s.prefetchDepth));
+    metric("prefetch_underruns_total", "counter", "Times playback found no frame decoded ahead.",
+           s.prefetchUnderruns);
+    metric("frame_cache_hits_total", "counter", "File frames served from the decoded-frame cache.",
+           s.frameCacheHits);
+    metric("frame_cache_misses_total", "counter", "File frames that had to be decoded.",
+           s.frameCacheMisses);
+    metric("frame_cache_bytes", "gauge", "Memory held by the decoded-frame cache.",
+           static_cast<std::uint64_t>(s.frameCacheBytes));
+    metric("camera_buffers", "gauge", "V4L2 streaming buffers (0 = not a native V4L2 camera).",
+           static_cast<std::uint64_t>(s.cameraBuffers));
+    metric("camera_buffers_queued", "gauge", "V4L2 buffers queued with the driver.",
+           static_cast<std::uint64_t>(s.cameraBuffersQueued));
+    metric("camera_drops_total", "counter", "Frames the camera driver dropped.", s.cameraDrops);
+    metric("camera_decode_threads", "gauge", "Camera MJPEG decode threads (0 = grab thread).",
+           static_cast<std::uint64_t>(s.cameraDecodeThreads));
+    metric("camera_decode_backlog", "gauge", "Camera frames grabbed but not yet decoded.",
+           static_cast<std::uint64_t>(s.cameraDecodeBacklog));
+
+    out += "# HELP livim_stage_duration_ms Per-stage duration percentiles since reset.\n"
+           "# TYPE livim_stage_duration_ms gauge\n";
+    static constexpr const char* kQuantiles[] = {"0.5", "0.95", "0.99"};
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageTiming& t = s.stages[i];
+        if (t.count == 0) continue;
+        const double values[] = {t.p50Ms, t.p95Ms, t.p99Ms};
+        for (int q = 0; q < 3; ++q) {
+            out += "livim_stage_duration_ms{stage=\"";
+            out += stageName(static_cast<Stage>(i));
+            out += "\",quantile=\"";
+            out += kQuantiles[q];
+            out += "\"} ";
+            appendNum(out, values[q]);
+            out += '\n';
+        }
+    }
+    out += "# HELP livim_stage_samples_total Timed executions per stage.\n"
+           "# TYPE livim_stage_samples_total counter\n";
+    for (int i = 0; i < kStageCount; ++i) {
+        out += "livim_stage_samples_total{stage=\"";
+        out += stageName(static_cast<Stage>(i));
+        out += "\"} ";
+        appendNum(out, s.stages[i].count);
+        out += '\n';
+    }
+}
+
+} // namespace
+
+std::optional<StatsExportConfig> StatsExportConfig::fromEnvironment() {
+    const char* out = std::getenv("LIVIM_STATS_OUT");
+    if (!out || !*out) return std::nullopt;
+
+    StatsExportConfig c;
+    c.target = out;
+    const std::string fmt = std::getenv("LIVIM_STATS_FORMAT") ? std::getenv("LIVIM_STATS_FORMAT") : "";
+    if (fmt == "prometheus" || fmt == "prom")
+        c.format = StatsFormat::Prometheus;
+    else if (fmt.empty() && c.target.ends_with(".prom"))
+        c.format = StatsFormat::Prometheus;
+    if (const char* hz = std::getenv("LIVIM_STATS_HZ")) {
+        char* end = nullptr;
+        const double v = std::strtod(hz, &end);
+        if (end != hz && v > 0.0) c.hz = v;
+    }
+    return c;
+}
+
+StatsExporter::StatsExporter(Provider provider, StatsExportConfig config)
+    : provider_(std::move(provider)), config_(std::move(config)) {
+    config_.hz = std::clamp(config_.hz, 0.1, 100.0);
+    if (config_.target.starts_with(kUnixPrefix))
+        socketPath_ = config_.target.substr(sizeof(kUnixPrefix) - 1);
+}
+
+StatsExporter::~StatsExporter() { stop(); }
+
+void StatsExporter::start() {
+    if (thread_.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        stop_ = false;
+    }
+    thread_ = std::thread([this] {
+        trace::setThreadName("stats");
+        run();
+    });
+}
+
+void StatsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void StatsExporter::run() {
+    const auto period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(1.0 / config_.hz));
+    Timestamp next = now();
+    std::unique_lock<std::mutex> lk(m_);
+    while (!stop_) {
+        lk.unlock();
+        try {
+            tick();
+        } catch (const std::exception&) {
+            // Monitoring must never take the app down; drop this sample.
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        lk.lock();
+        next += period;
+        const Timestamp t = now();
+        if (next < t) next = t; // overran (e.g. slow disk): skip ahead, don't burst
+        cv_.wait_until(lk, next, [this] { return stop_; });
+    }
+    lk.unlock();
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    socket_.close();
+}
+
+void StatsExporter::tick() {
+    const StatsSnapshot s = provider_();
+    const Timestamp t = now();
+
+    Rates r;
+    // A counter going backwards means the pipeline reset (new source): restart the baseline.
+    if (havePrev_ && s.processed >= prevProcessed_ && s.sourceDrops >= prevDrops_) {
+        const double dt = std::chrono::duration<double>(t - prevTs_).count();
+        const std::uint64_t processed = s.processed - prevProcessed_;
+        const std::uint64_t drops = s.sourceDrops - prevDrops_;
+        if (dt > 0.0) r.fps = static_cast<double>(processed) / dt;
+        if (processed + drops > 0)
+            r.dropFraction = static_cast<double>(drops) / static_cast<double>(processed + drops);
+        const double blocked = s.queueBlockedMs + s.poolBlockedMs - prevBlockedMs_;
+        if (dt > 0.0 && blocked > 0.0) r.stallFraction = std::min(1.0, blocked / (dt * 1000.0));
+    }
+    havePrev_ = true;
+    prevTs_ = t;
+    prevProcessed_ = s.processed;
+    prevDrops_ = s.sourceDrops;
+    prevBlockedMs_ = s.queueBlockedMs + s.poolBlockedMs;
+
+    buf_.clear();
+    if (config_.format == StatsFormat::Ndjson) {
+        const auto unixMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::system_clock::now().time_since_epoch())
+                                .count();
+        formatNdjson(buf_, s, r, static_cast<std::uint64_t>(unixMs));
+    } else {
+        formatPrometheus(buf_, s, r);
+        // A stream has no file boundary, so terminate each exposition (OpenMetrics style).
+        if (!socketPath_.empty()) buf_ += "# EOF\n";
+    }
+    write(buf_);
+}
+
+void StatsExporter::write(const std::string& payload) {
+    if (!socketPath_.empty()) {
+        writeSocket(payload);
+        return;
+    }
+
+    if (config_.format == StatsFormat::Ndjson) {
+        if (!file_) file_ = std::fopen(config_.target.c_str(), "ab");
+        if (!file_ ||
+            std::fwrite(payload.data(), 1, payload.size(), file_) != payload.size() ||
+            std::fflush(file_) != 0) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        written_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Prometheus textfile: write aside, then rename, so a scraper never reads a partial file.
+    const std::string tmp = config_.target + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const bool ok = std::fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+    const bool closed = std::fclose(f) == 0;
+    std::error_code ec;
+    if (ok && closed) std::filesystem::rename(tmp, config_.target, ec);
+    if (!ok || !closed || ec) {
+        std::filesystem::remove(tmp, ec);
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatsExporter::writeSocket(const std::string& payload) {
+    if (!socket_.connected()) {
+        // Retry at most once a second so an absent collector costs nothing per tick.
+        const Timestamp t = now();
+        bool connected = false;
+        if (t - lastConnectTry_ >= std::chrono::seconds(1)) {
+            lastConnectTry_ = t;
+            connected = socket_.connect(socketPath_);
+        }
+        if (!connected) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        pending_.clear(); // never resume a half-sent record on a fresh connection
+    }
+
+    auto flush = [this] {
+        while (!pending_.empty()) {
+            const long n = socket_.send(pending_.data(), pending_.size());
+            if (n < 0) {
+                pending_.clear();
+                return;
+            }
+            if (n == 0) return; // peer not draining; keep the rest for the next tick
+            pending_.erase(0, static_cast<std::size_t>(n));
+        }
+    };
+
+    flush();
+    if (!pending_.empty() || !socket_.connected()) {
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    pending_ = payload;
+    flush();
+    if (socket_.connected())
+        written_.fetch_add(1, std::memory_order_relaxed);
+    else
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace livim
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "core/Clock.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/StatsSocket.hpp"
+
+namespace livim {
+
+enum class StatsFormat {
+    Ndjson,     // one JSON object per line, appended
+    Prometheus  // text exposition format; a file is replaced atomically each tick
+};
+
+struct StatsExportConfig {
+    std::string target;                        // file path, or "unix:<path>" for a Unix socket
+    StatsFormat format = StatsFormat::Ndjson;
+    double      hz = 1.0;                      // clamped to [0.1, 100]
+
+    // LIVIM_STATS_OUT (target), LIVIM_STATS_FORMAT ("ndjson" | "prometheus"; defaults to
+    // prometheus for a .prom file), LIVIM_STATS_HZ. nullopt when LIVIM_STATS_OUT is unset.
+    static std::optional<StatsExportConfig> fromEnvironment();
+};
+
+// Periodically samples pipeline stats on its own thread, independent of any event loop. The
+// provider must be callable from that thread (Instrumentation::sample() is; snapshot() is not).
+// Writes never block: a socket peer that stops draining costs skipped samples, not latency.
+class StatsExporter {
+public:
+    using Provider = std::function<StatsSnapshot()>;
+
+    StatsExporter(Provider provider, StatsExportConfig config);
+    ~StatsExporter();
+
+    StatsExporter(const StatsExporter&) = delete;
+    StatsExporter& operator=(const StatsExporter&) = delete;
+
+    void start();
+    void stop(); // joins; idempotent
+
+    std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    std::uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    void tick();
+    void write(const std::string& payload);
+    void writeSocket(const std::string& payload);
+
+    Provider provider_;
+    StatsExportConfig config_;
+    std::string socketPath_; // non-empty => socket target
+
+    std::thread thread_;
+    std::mutex m_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+
+    // Exporter-thread state below.
+    std::FILE*    file_ = nullptr;  // NDJSON file target
+    StatsSocket   socket_;
+    std::string   pending_;         // socket bytes the peer has not accepted yet
+    Timestamp     lastConnectTry_{};
+    std::string   buf_;             // reused formatting buffer
+    bool          havePrev_ = false;
+    Timestamp     prevTs_{};
+    std::uint64_t prevProcessed_ = 0;
+    std::uint64_t prevDrops_ = 0;
+    double        prevBlockedMs_ = 0.0;
+};
+
+} // namespace livim
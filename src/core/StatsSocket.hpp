@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace livim {
+
+// Non-blocking Unix-domain stream client for the StatsExporter. One implementation per platform
+// (StatsSocket_Posix.cpp / StatsSocket_Windows.cpp); the Windows one is unsupported and never
+// connects. Never raises SIGPIPE and never blocks the caller.
+class StatsSocket {
+public:
+    StatsSocket() = default;
+    ~StatsSocket() { close(); }
+
+    StatsSocket(const StatsSocket&) = delete;
+    StatsSocket& operator=(const StatsSocket&) = delete;
+
+    bool connect(const std::string& path);
+    bool connected() const { return fd_ >= 0; }
+
+    // Bytes accepted by the kernel (possibly fewer than `len`, 0 if the peer is not draining);
+    // -1 on a hard error, after which the socket is closed.
+    long send(const char* data, std::size_t len);
+
+    void close();
+
+private:
+    int fd_ = -1;
+};
+
+} // namespace livim
@@ -0,0 +1,12 @@
+#include "core/StatsSocket.hpp"
+
+namespace livim {
+
+// Unix-domain stats streaming is not offered on Windows; file output still works there.
+bool StatsSocket::connect(const std::string&) { return false; }
+
+long StatsSocket::send(const char*, std::size_t) { return -1; }
+
+void StatsSocket::close() { fd_ = -1; }
+
+} // namespace livim
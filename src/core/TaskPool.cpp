@@ -0,0 +1,256 @@
+#include "core/TaskPool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <utility>
+
+#include "core/Clock.hpp"
+#include "core/Trace.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace livim {
+namespace {
+
+thread_local TaskPool* tlsPool = nullptr;
+thread_local int tlsWorker = -1;
+thread_local TaskPool* tlsScoped = nullptr; // TaskPoolScope
+
+void pinCurrentThread(int cpu) {
+#ifdef __linux__
+    const unsigned n = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<unsigned>(cpu) % n, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+// One parallelFor call. Helpers and the caller claim chunks from `next`; the caller returns once
+// `done` reaches `chunks`, so `body` is never invoked after parallelFor() returns. Only a running
+// thread claims a chunk, so once none are left to claim the rest finish without the caller, and
+// it can sleep on `doneCv` instead of helping.
+struct ForJob {
+    const std::function<void(int, int)>* body = nullptr;
+    int begin = 0;
+    int end = 0;
+    int chunkSize = 1;
+    int chunks = 0;
+    std::atomic<int> next{0};
+    std::atomic<int> done{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error; // written once, by whoever flips `failed`
+    std::mutex doneMu;
+    std::condition_variable doneCv; // `done` reached `chunks`
+
+    void runChunks() {
+        for (;;) {
+            const int c = next.fetch_add(1, std::memory_order_relaxed);
+            if (c >= chunks) return;
+            if (!failed.load(std::memory_order_relaxed)) {
+                const int lo = begin + c * chunkSize;
+                const int hi = std::min(end, lo + chunkSize);
+                try {
+                    (*body)(lo, hi);
+                } catch (...) {
+                    if (!failed.exchange(true, std::memory_order_acq_rel))
+                        error = std::current_exception();
+                }
+            }
+            if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks) {
+                { std::lock_guard<std::mutex> lg(doneMu); } // pairs with the caller's wait
+                doneCv.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lk(doneMu);
+        doneCv.wait(lk, [this] { return done.load(std::memory_order_acquire) >= chunks; });
+    }
+};
+
+} // namespace
+
+TaskPool::TaskPool(Options options) {
+    int n = options.workers;
+    if (n < 0) n = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    n = std::max(0, n);
+    workers_.reserve(static_cast<std::size_t>(n));
+    for (int i = 0; i < n; ++i) workers_.push_back(std::make_unique<Worker>());
+    // Start only once every deque exists: workers steal from each other immediately.
+    for (int i = 0; i < n; ++i)
+        workers_[static_cast<std::size_t>(i)]->thread =
+            std::thread([this, i, pin = options.pinThreads] { workerLoop(i, pin); });
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lg(sleepMu_);
+        stop_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto& w : workers_)
+        if (w->thread.joinable()) w->thread.join();
+}
+
+int TaskPool::currentWorker() const { return tlsPool == this ? tlsWorker : -1; }
+
+void TaskPool::push(Task t) {
+    const int self = currentWorker();
+    const std::size_t n = workers_.size();
+    const std::size_t target = self >= 0 ? static_cast<std::size_t>(self)
+                                         : nextVictim_.fetch_add(1, std::memory_order_relaxed) % n;
+    {
+        std::lock_guard<std::mutex> lg(workers_[target]->m);
+        workers_[target]->q.push_back(std::move(t));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    { std::lock_guard<std::mutex> lg(sleepMu_); } // pairs with the predicate check in workerLoop
+    sleepCv_.notify_one();
+}
+
+bool TaskPool::runOne(int self) {
+    if (queued_.load(std::memory_order_acquire) <= 0) return false;
+
+    Task task;
+    bool stolen = false;
+    if (self >= 0) {
+        Worker& own = *workers_[static_cast<std::size_t>(self)];
+        std::lock_guard<std::mutex> lg(own.m);
+        if (!own.q.empty()) {
+            task = std::move(own.q.back());
+            own.q.pop_back();
+        }
+    }
+    if (!task) {
+        const std::size_t n = workers_.size();
+        const std::size_t start = nextVictim_.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t k = 0; k < n && !task; ++k) {
+            const std::size_t v = (start + k) % n;
+            if (static_cast<int>(v) == self) continue;
+            Worker& victim = *workers_[v];
+            std::lock_guard<std::mutex> lg(victim.m);
+            if (!victim.q.empty()) {
+                task = std::move(victim.q.front());
+                victim.q.pop_front();
+                stolen = true;
+            }
+        }
+    }
+    if (!task) return false;
+
+    queued_.fetch_sub(1, std::memory_order_acq_rel);
+    // A non-worker caller helping out "steals" too, but only worker-to-worker moves count.
+    if (stolen && self >= 0) steals_.fetch_add(1, std::memory_order_relaxed);
+    tasks_.fetch_add(1, std::memory_order_relaxed);
+    try {
+        task();
+    } catch (...) {
+        // parallelFor chunks report their own errors; a throwing submit() must not kill a worker.
+    }
+    return true;
+}
+
+void TaskPool::workerLoop(int index, bool pin) {
+    tlsPool = this;
+    tlsWorker = index;
+    trace::setThreadName("task-worker");
+    if (pin) pinCurrentThread(index);
+
+    for (;;) {
+        if (runOne(index)) continue;
+        std::unique_lock<std::mutex> lk(sleepMu_);
+        if (stop_) return;
+        if (queued_.load(std::memory_order_acquire) > 0) continue;
+        const Timestamp t0 = now();
+        sleepCv_.wait(lk, [&] { return stop_ || queued_.load(std::memory_order_acquire) > 0; });
+        idleNs_.fetch_add(static_cast<std::uint64_t>(
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(now() - t0)
+                                  .count()),
+                          std::memory_order_relaxed);
+        if (stop_) return;
+    }
+}
+
+void TaskPool::submit(std::function<void()> task) {
+    if (workers_.empty()) {
+        try {
+            task();
+        } catch (...) {
+        }
+        return;
+    }
+    push(std::move(task));
+}
+
+void TaskPool::parallelFor(int begin, int end, int grain,
+                           const std::function<void(int, int)>& body) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+    const int n = end - begin;
+    const int participants = workerCount() + 1;
+    // A few chunks per participant balances uneven rows without drowning in tiny tasks.
+    const int maxChunks = std::max(1, std::min((n + grain - 1) / grain, participants * 4));
+    if (maxChunks == 1 || workers_.empty()) {
+        body(begin, end);
+        return;
+    }
+
+    auto job = std::make_shared<ForJob>();
+    job->body = &body;
+    job->begin = begin;
+    job->end = end;
+    job->chunkSize = (n + maxChunks - 1) / maxChunks;
+    job->chunks = (n + job->chunkSize - 1) / job->chunkSize;
+
+    const int helpers = std::min(workerCount(), job->chunks - 1);
+    for (int i = 0; i < helpers; ++i) push([job] { job->runChunks(); });
+
+    // The caller works through this job's chunks only, never unrelated queued tasks, so a live
+    // stage can't stall behind another job's work; then it sleeps until the claimed ones finish.
+    job->runChunks();
+    job->wait();
+    if (job->failed.load(std::memory_order_acquire)) std::rethrow_exception(job->error);
+}
+
+TaskPoolStats TaskPool::stats() const {
+    TaskPoolStats s;
+    s.workers = workerCount();
+    s.tasks = tasks_.load(std::memory_order_relaxed);
+    s.steals = steals_.load(std::memory_order_relaxed);
+    s.idleMs = static_cast<double>(idleNs_.load(std::memory_order_relaxed)) / 1e6;
+    return s;
+}
+
+TaskPool& sharedTaskPool() {
+    static TaskPool pool([] {
+        TaskPool::Options o;
+        if (const char* t = std::getenv("LIVIM_THREADS"); t && std::atoi(t) > 0)
+            o.workers = std::atoi(t) - 1;
+        if (const char* p = std::getenv("LIVIM_PIN_THREADS")) o.pinThreads = p[0] == '1';
+        return o;
+    }());
+    return pool;
+}
+
+TaskPool& currentTaskPool() {
+    if (tlsPool) return *tlsPool;
+    if (tlsScoped) return *tlsScoped;
+    return sharedTaskPool();
+}
+
+TaskPoolScope::TaskPoolScope(TaskPool* pool) : previous_(tlsScoped) {
+    if (pool) tlsScoped = pool;
+}
+
+TaskPoolScope::~TaskPoolScope() { tlsScoped = previous_; }
+
+} // namespace livim
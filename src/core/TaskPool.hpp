@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/Instrumentation.hpp" // kCacheLine, TaskPoolStats
+
+namespace livim {
+
+// Work-stealing pool for intra-frame parallelism. Each worker owns a deque: it pushes and pops at
+// the back (LIFO, cache-warm), idle workers steal from the front of the others. parallelFor() is
+// fork/join and the calling thread runs its own job's chunks, so nested calls from inside a task
+// (or from OpenCV routed onto the pool, see OpenCvParallel.hpp) make progress instead of
+// deadlocking; once every chunk is claimed it blocks rather than spinning or running other work.
+class TaskPool {
+public:
+    struct Options {
+        int  workers = -1;        // < 0 = hardware_concurrency() - 1 (the caller is the extra one)
+        bool pinThreads = false;  // pin worker i to CPU i (Linux only; ignored elsewhere)
+    };
+
+    explicit TaskPool(Options options);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    int workerCount() const { return static_cast<int>(workers_.size()); }
+
+    // Calls body(lo, hi) over disjoint sub-ranges covering [begin, end), each at least `grain`
+    // long (except the tail), and returns once all have run. The first exception thrown by a
+    // body is rethrown here after the remaining chunks are skipped.
+    void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    // Fire-and-forget; runs inline when the pool has no workers. An exception is swallowed.
+    void submit(std::function<void()> task);
+
+    TaskPoolStats stats() const;
+
+    // Index of the calling worker of *this* pool, or -1 for any other thread.
+    int currentWorker() const;
+
+private:
+    using Task = std::function<void()>;
+
+    struct alignas(kCacheLine) Worker {
+        std::mutex m;
+        std::deque<Task> q;
+        std::thread thread;
+    };
+
+    void push(Task t);
+    bool runOne(int self); // pop own work or steal; false if every deque was empty
+    void workerLoop(int index, bool pin);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex sleepMu_;
+    std::condition_variable sleepCv_;
+    bool stop_ = false;
+    alignas(kCacheLine) std::atomic<int> queued_{0};
+    std::atomic<unsigned> nextVictim_{0};
+
+    alignas(kCacheLine) std::atomic<std::uint64_t> tasks_{0};
+    std::atomic<std::uint64_t> steals_{0};
+    std::atomic<std::uint64_t> idleNs_{0};
+};
+
+// Process-wide pool shared by the processing chain, magnification kernels and the exporter (a
+// queued export job runs on a pool of its own, see ExportRequest::poolThreads).
+// Options are read from the environment on first use: LIVIM_THREADS (total threads including the
+// caller, so 1 = serial) and LIVIM_PIN_THREADS=1 (affinity).
+TaskPool& sharedTaskPool();
+
+// The pool parallel work started on this thread goes to: a worker's own pool, else the one a
+// TaskPoolScope installed here, else sharedTaskPool().
+TaskPool& currentTaskPool();
+
+// Sends this thread's parallel work (parallelFor() and OpenCV's, see OpenCvParallel.hpp) to
+// `pool` until the scope ends, e.g. so an export job stays within its share of the cores. A null
+// `pool` leaves the thread as it was.
+class TaskPoolScope {
+public:
+    explicit TaskPoolScope(TaskPool* pool);
+    ~TaskPoolScope();
+
+    TaskPoolScope(const TaskPoolScope&) = delete;
+    TaskPoolScope& operator=(const TaskPoolScope&) = delete;
+
+private:
+    TaskPool* previous_;
+};
+
+// parallelFor on the current pool.
+inline void parallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    currentTaskPool().parallelFor(begin, end, grain, body);
+}
+
+} // namespace livim
@@ -0,0 +1,192 @@
+#include "core/Trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace livim::trace {
+namespace {
+
+constexpr std::uint64_t kCapacity = 1u << 16; // spans per thread (~2 MB); power of two
+constexpr std::uint64_t kMask = kCapacity - 1;
+
+// Fields are relaxed atomics so a dump racing the owning thread is a benign torn read, which the
+// head re-check in dumpJson() then discards, rather than a data race.
+struct Event {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<std::uint64_t> seq{kNoSeq};
+    std::atomic<std::int64_t> beginNs{0};
+    std::atomic<std::int64_t> durNs{0};
+};
+
+// Single writer (the owning thread), any number of readers.
+struct Buffer {
+    int tid = 0;
+    std::atomic<const char*> threadName{nullptr};
+    std::atomic<bool> retired{false};       // owning thread has exited
+    std::atomic<std::uint64_t> head{0};     // next write index, monotonic
+    std::atomic<std::uint64_t> floor{0};    // clear() hides everything below this index
+    std::unique_ptr<Event[]> events = std::make_unique<Event[]>(kCapacity);
+};
+
+struct Registry {
+    std::mutex m;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    int nextTid = 1;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+Timestamp epoch() {
+    static const Timestamp t = now();
+    return t;
+}
+
+std::int64_t sinceEpochNs(Timestamp t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch()).count();
+}
+
+// Buffers are created on a thread's first span, so an untraced session allocates nothing.
+struct ThreadState {
+    const char* name = nullptr;
+    std::shared_ptr<Buffer> buffer;
+
+    ~ThreadState() {
+        if (buffer) buffer->retired.store(true, std::memory_order_release);
+    }
+
+    Buffer& get() {
+        if (!buffer) {
+            auto b = std::make_shared<Buffer>();
+            b->threadName.store(name, std::memory_order_relaxed);
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lg(r.m);
+            b->tid = r.nextTid++;
+            r.buffers.push_back(b);
+            buffer = std::move(b);
+        }
+        return *buffer;
+    }
+};
+
+thread_local ThreadState tls;
+
+struct Copied {
+    const char* name;
+    std::uint64_t seq;
+    std::int64_t beginNs;
+    std::int64_t durNs;
+};
+
+} // namespace
+
+void setEnabled(bool on) {
+    epoch(); // pin the time origin before the first span
+    detail::gEnabled.store(on, std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    tls.name = name;
+    if (tls.buffer) tls.buffer->threadName.store(name, std::memory_order_relaxed);
+}
+
+void complete(const char* name, std::uint64_t seq, Timestamp begin, Timestamp end) {
+    Buffer& b = tls.get();
+    const std::uint64_t i = b.head.load(std::memory_order_relaxed);
+    // Pairs with the acquire fence in dumpJson(): a reader that sees any field below also sees
+    // head >= i, and so knows this slot is being rewritten.
+    std::atomic_thread_fence(std::memory_order_release);
+    Event& e = b.events[i & kMask];
+    e.name.store(name, std::memory_order_relaxed);
+    e.seq.store(seq, std::memory_order_relaxed);
+    e.beginNs.store(sinceEpochNs(begin), std::memory_order_relaxed);
+    e.durNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(),
+                  std::memory_order_relaxed);
+    b.head.store(i + 1, std::memory_order_release);
+}
+
+bool dumpJson(const std::string& path) {
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lg(r.m);
+        buffers = r.buffers;
+    }
+
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) return false;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+           "\"args\":{\"name\":\"livim\"}}";
+
+    char line[256];
+    std::vector<Copied> copied;
+    for (const auto& b : buffers) {
+        if (const char* tn = b->threadName.load(std::memory_order_relaxed)) {
+            std::snprintf(line, sizeof(line),
+                          ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                          "\"args\":{\"name\":\"%s\"}}",
+                          b->tid, tn);
+            out << line;
+        }
+
+        const std::uint64_t h1 = b->head.load(std::memory_order_acquire);
+        const std::uint64_t lo =
+            std::max(h1 > kCapacity ? h1 - kCapacity : 0, b->floor.load(std::memory_order_relaxed));
+        copied.clear();
+        for (std::uint64_t i = lo; i < h1; ++i) {
+            const Event& e = b->events[i & kMask];
+            copied.push_back({e.name.load(std::memory_order_relaxed),
+                              e.seq.load(std::memory_order_relaxed),
+                              e.beginNs.load(std::memory_order_relaxed),
+                              e.durNs.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Slot i is rewritten by write index i + kCapacity; drop any the writer may have reached.
+        const std::uint64_t h2 = b->head.load(std::memory_order_relaxed);
+        const std::uint64_t firstIntact = h2 >= kCapacity ? h2 - kCapacity + 1 : 0;
+
+        for (std::uint64_t i = lo; i < h1; ++i) {
+            if (i < firstIntact) continue;
+            const Copied& c = copied[static_cast<std::size_t>(i - lo)];
+            if (!c.name) continue;
+            const double tsUs = static_cast<double>(c.beginNs) / 1000.0;
+            const double durUs = static_cast<double>(c.durNs) / 1000.0;
+            if (c.seq == kNoSeq) {
+                std::snprintf(line, sizeof(line),
+                              ",\n{\"name\":\"%s\",\"cat\":\"livim\",\"ph\":\"X\",\"pid\":1,"
+                              "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                              c.name, b->tid, tsUs, durUs);
+            } else {
+                std::snprintf(line, sizeof(line),
+                              ",\n{\"name\":\"%s\",\"cat\":\"livim\",\"ph\":\"X\",\"pid\":1,"
+                              "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"seq\":%llu}}",
+                              c.name, b->tid, tsUs, durUs, static_cast<unsigned long long>(c.seq));
+            }
+            out << line;
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+void clear() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lg(r.m);
+    std::erase_if(r.buffers,
+                  [](const auto& b) { return b->retired.load(std::memory_order_acquire); });
+    // A live buffer's head belongs to its owning thread; hide the old spans instead of rewinding.
+    for (const auto& b : r.buffers)
+        b->floor.store(b->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+} // namespace livim::trace
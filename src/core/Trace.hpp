@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "core/Clock.hpp"
+
+// Chrome trace-event recorder (chrome://tracing, ui.perfetto.dev). Each thread appends complete
+// ('X') spans to its own lock-free ring buffer, so recording never contends with other threads;
+// dumpJson() snapshots every buffer. Off by default: a disabled Span costs one relaxed load.
+namespace livim::trace {
+
+inline constexpr std::uint64_t kNoSeq = std::numeric_limits<std::uint64_t>::max();
+
+namespace detail {
+inline std::atomic<bool> gEnabled{false};
+} // namespace detail
+
+inline bool enabled() { return detail::gEnabled.load(std::memory_order_relaxed); }
+
+void setEnabled(bool on);
+
+// Names the calling thread in the trace. `name` must be a string literal (stored, not copied).
+void setThreadName(const char* name);
+
+// Appends one span to the calling thread's ring (the oldest span is overwritten when full).
+// `name` must be a string literal; `seq` tags the Frame::seq it belongs to (kNoSeq for none).
+void complete(const char* name, std::uint64_t seq, Timestamp begin, Timestamp end);
+
+// Writes every buffered span as trace-event JSON. Safe while threads keep recording; spans being
+// overwritten during the dump are skipped. Returns false if the file could not be written.
+bool dumpJson(const std::string& path);
+
+// Drops all buffered spans (and the buffers of threads that have exited).
+void clear();
+
+// Records the enclosing scope as one span; setSeq() for scopes that learn the frame late (pop).
+class Span {
+public:
+    explicit Span(const char* name, std::uint64_t seq = kNoSeq)
+        : name_(name), seq_(seq), active_(enabled()), begin_(active_ ? now() : Timestamp{}) {}
+    ~Span() {
+        if (active_) complete(name_, seq_, begin_, now());
+    }
+
+    void setSeq(std::uint64_t seq) { seq_ = seq; }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name_;
+    std::uint64_t seq_;
+    bool active_;
+    Timestamp begin_;
+};
+
+} // namespace livim::trace
@@ -0,0 +1,281 @@
+#include "export/ExportQueue.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <utility>
+
+#include "core/Trace.hpp"
+
+namespace livim {
+namespace {
+
+constexpr auto kPollInterval = std::chrono::milliseconds(100);
+constexpr double kRateWindowS = 1.0;
+// Each second in the queue takes this many frames off a job's cost, so a long job eventually
+// outranks newly queued short ones.
+constexpr double kAgingFramesPerSecond = 250.0;
+// Default shares where a request doesn't set them: decode and encode are one thread each, the
+// chain thread gets one pool worker beside it.
+constexpr int kDecoderCores = 1;
+constexpr int kChainCores = 2;
+constexpr int kEncoderCores = 1;
+constexpr std::int64_t kUnknownCost = std::numeric_limits<std::int64_t>::max() / 2;
+
+// The request's thread counts, defaults filled in.
+void fillShares(ExportRequest& r) {
+    if (r.decoderThreads <= 0) r.decoderThreads = kDecoderCores;
+    if (r.poolThreads <= 0) r.poolThreads = kChainCores;
+    if (r.encoderThreads <= 0) r.encoderThreads = kEncoderCores;
+}
+
+// Shrinks the largest share until the three fit `cores`; each keeps at least one thread.
+void fitShares(ExportRequest& r, int cores) {
+    int* const shares[] = {&r.poolThreads, &r.encoderThreads, &r.decoderThreads};
+    for (;;) {
+        int total = 0;
+        int* largest = shares[0];
+        for (int* s : shares) {
+            total += *s;
+            if (*s > *largest) largest = s;
+        }
+        if (total <= cores || *largest <= 1) return;
+        --*largest;
+    }
+}
+
+bool finished(ExportPhase p) {
+    return p == ExportPhase::Done || p == ExportPhase::Error || p == ExportPhase::Aborted;
+}
+
+double seconds(Clock::duration d) { return std::chrono::duration<double>(d).count(); }
+
+} // namespace
+
+ExportQueue::ExportQueue(Options options)
+    : coreBudget_(options.coreBudget > 0
+                      ? options.coreBudget
+                      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))) {
+    scheduler_ = std::thread([this] {
+        trace::setThreadName("export-queue");
+        schedulerLoop();
+    });
+}
+
+ExportQueue::~ExportQueue() {
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    scheduler_.join();
+}
+
+int ExportQueue::coresFor(const ExportRequest& request) {
+    ExportRequest r = request; // every queued job takes the pipelined path, see enqueue()
+    fillShares(r);
+    return r.decoderThreads + r.poolThreads + r.encoderThreads;
+}
+
+int ExportQueue::enqueue(std::unique_ptr<IExportFrameSource> source, ExportRequest request,
+                         std::string label, std::int64_t estimatedFrames) {
+    auto job = std::make_unique<Job>();
+    std::int64_t cost = estimatedFrames;
+    if (cost < 0) cost = source->frameCount(); // known up front for a buffer, not for a file
+    if (cost < 0 && request.endFrame > request.startFrame)
+        cost = request.endFrame - request.startFrame;
+    job->status.cost = cost >= 0 ? cost : kUnknownCost;
+    job->status.label = std::move(label);
+    // Parallelism comes from running jobs side by side; a segmented job would need a source
+    // factory and would fight its neighbours for the same cores.
+    request.segments = 1;
+    request.verifySeams = false;
+    fillShares(request);
+    fitShares(request, std::min(coresFor(request), coreBudget_));
+    job->status.cores = coresFor(request);
+    job->source = std::move(source);
+    job->request = std::move(request);
+    job->enqueuedAt = now();
+
+    int id = 0;
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        id = nextId_++;
+        job->status.id = id;
+        jobs_.push_back(std::move(job));
+    }
+    cv_.notify_all();
+    return id;
+}
+
+void ExportQueue::abort(int id) {
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        for (auto& job : jobs_) {
+            if (job->status.id != id) continue;
+            if (job->exporter) {
+                job->exporter->abort(); // reaped by the scheduler once it stops
+            } else if (!job->status.started) {
+                job->status.progress.phase = ExportPhase::Aborted;
+                job->source.reset();
+            }
+        }
+    }
+    cv_.notify_all();
+}
+
+void ExportQueue::abortAll() {
+    {
+        std::lock_guard<std::mutex> lg(m_);
+        for (auto& job : jobs_) {
+            if (job->exporter) {
+                job->exporter->abort();
+            } else if (!job->status.started) {
+                job->status.progress.phase = ExportPhase::Aborted;
+                job->source.reset();
+            }
+        }
+    }
+    cv_.notify_all();
+}
+
+void ExportQueue::waitIdle() {
+    std::unique_lock<std::mutex> lk(m_);
+    idleCv_.wait(lk, [&] {
+        return joining_ == 0 &&
+               std::all_of(jobs_.begin(), jobs_.end(), [](const std::unique_ptr<Job>& j) {
+                   return finished(j->status.progress.phase) && !j->exporter;
+               });
+    });
+}
+
+std::vector<ExportJobStatus> ExportQueue::jobs() const {
+    std::lock_guard<std::mutex> lg(m_);
+    std::vector<ExportJobStatus> out;
+    out.reserve(jobs_.size());
+    for (const auto& job : jobs_) out.push_back(job->status);
+    return out;
+}
+
+ExportQueueStats ExportQueue::stats() const {
+    std::lock_guard<std::mutex> lg(m_);
+    ExportQueueStats s;
+    s.coreBudget = coreBudget_;
+    s.coresInUse = coresInUse_;
+    for (const auto& job : jobs_) {
+        const ExportPhase p = job->status.progress.phase;
+        if (job->exporter) ++s.running;
+        else if (finished(p)) ++s.finished;
+        else ++s.queued;
+        if (p == ExportPhase::Error) ++s.failed;
+        s.framesDone += static_cast<std::uint64_t>(std::max(0, job->status.progress.framesDone));
+    }
+    s.framesPerSec = framesPerSec_;
+    if (anyStarted_) {
+        const double elapsed = seconds(now() - firstStart_);
+        s.meanFramesPerSec = elapsed > 0.0 ? static_cast<double>(s.framesDone) / elapsed : 0.0;
+    }
+    return s;
+}
+
+int ExportQueue::runningCount() const {
+    return static_cast<int>(std::count_if(
+        jobs_.begin(), jobs_.end(), [](const std::unique_ptr<Job>& j) { return !!j->exporter; }));
+}
+
+std::vector<std::unique_ptr<Exporter>> ExportQueue::reap() {
+    std::vector<std::unique_ptr<Exporter>> done;
+    for (auto& job : jobs_) {
+        if (!job->exporter) continue;
+        job->status.progress = job->exporter->progress();
+        if (!finished(job->status.progress.phase)) continue;
+        done.push_back(std::move(job->exporter));
+        coresInUse_ -= job->status.cores;
+    }
+    return done;
+}
+
+void ExportQueue::startFitting() {
+    for (;;) {
+        const Timestamp t = now();
+        Job* best = nullptr;
+        double bestKey = 0.0;
+        for (auto& job : jobs_) {
+            if (job->status.started || finished(job->status.progress.phase)) continue;
+            const double key = static_cast<double>(job->status.cost) -
+                               seconds(t - job->enqueuedAt) * kAgingFramesPerSecond;
+            if (!best || key < bestKey) {
+                best = job.get();
+                bestKey = key;
+            }
+        }
+        if (!best) return;
+        // Strict priority: the front job waits for room rather than being overtaken.
+        if (coresInUse_ > 0 && coresInUse_ + best->status.cores > coreBudget_) return;
+
+        best->exporter = std::make_unique<Exporter>();
+        best->exporter->start(std::move(best->source), best->request);
+        best->status.started = true;
+        best->status.progress.phase = ExportPhase::Processing;
+        coresInUse_ += best->status.cores;
+        if (!anyStarted_) {
+            anyStarted_ = true;
+            firstStart_ = t;
+            rateTs_ = t;
+        }
+    }
+}
+
+void ExportQueue::schedulerLoop() {
+    std::unique_lock<std::mutex> lk(m_);
+    while (!stop_) {
+        if (std::vector<std::unique_ptr<Exporter>> done = reap(); !done.empty()) {
+            // Their threads are already on the way out, but a final flush can still take a while:
+            // status() and enqueue() don't wait for it.
+            joining_ = static_cast<int>(done.size());
+            lk.unlock();
+            for (auto& exporter : done) exporter->join();
+            done.clear();
+            lk.lock();
+            joining_ = 0;
+            if (stop_) break;
+        }
+        startFitting();
+
+        if (anyStarted_) {
+            const Timestamp t = now();
+            const double dt = seconds(t - rateTs_);
+            if (dt >= kRateWindowS) {
+                std::uint64_t total = 0;
+                for (const auto& job : jobs_)
+                    total += static_cast<std::uint64_t>(
+                        std::max(0, job->status.progress.framesDone));
+                framesPerSec_ = static_cast<double>(total - rateFrames_) / dt;
+                rateFrames_ = total;
+                rateTs_ = t;
+            }
+        }
+        if (runningCount() == 0) idleCv_.notify_all();
+        cv_.wait_for(lk, kPollInterval);
+    }
+
+    for (auto& job : jobs_) {
+        if (job->exporter) {
+            job->exporter->abort();
+        } else if (!finished(job->status.progress.phase)) {
+            job->status.progress.phase = ExportPhase::Aborted;
+            job->source.reset();
+        }
+    }
+    std::vector<std::pair<Job*, std::unique_ptr<Exporter>>> stopping;
+    for (auto& job : jobs_)
+        if (job->exporter) stopping.emplace_back(job.get(), std::move(job->exporter));
+    lk.unlock();
+    for (auto& [job, exporter] : stopping) exporter->join();
+    lk.lock();
+    for (auto& [job, exporter] : stopping) job->status.progress = exporter->progress();
+    coresInUse_ = 0;
+    idleCv_.notify_all();
+}
+
+} // namespace livim
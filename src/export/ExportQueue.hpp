@@ -0,0 +1,114 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/Clock.hpp"
+#include "export/ExportTypes.hpp"
+#include "export/Exporter.hpp"
+#include "export/IExportFrameSource.hpp"
+
+namespace livim {
+
+// One queued export as seen by the caller.
+struct ExportJobStatus {
+    int            id = 0;
+    std::string    label;
+    std::int64_t   cost = 0;   // frames; the shortest-job-first key
+    int            cores = 0;  // budget the job holds while running
+    bool           started = false;
+    ExportProgress progress;   // phase Idle while queued
+};
+
+struct ExportQueueStats {
+    int    queued = 0;
+    int    running = 0;
+    int    finished = 0;         // Done, Error or Aborted
+    int    failed = 0;           // Error (Aborted is counted in finished only)
+    int    coresInUse = 0;
+    int    coreBudget = 0;
+    std::uint64_t framesDone = 0; // across all jobs
+    double framesPerSec = 0.0;   // aggregate, over the scheduler's last second
+    double meanFramesPerSec = 0.0; // aggregate since the first job started
+};
+
+// Runs several Exporter jobs concurrently under a global core budget. Pending jobs start
+// shortest-first (by frame count, aged so a long job is not starved by a stream of short ones)
+// whenever their core share fits the unused budget; one job always runs even if it alone exceeds
+// it. A job is held to its share: its decoder and encoder get that many threads and its kernels
+// (and OpenCV's) a private task pool, so jobs side by side don't fan out over the same cores. A
+// scheduler thread starts, polls and reaps jobs; every public method is thread-safe.
+class ExportQueue {
+public:
+    struct Options {
+        int coreBudget = -1; // <= 0: hardware_concurrency()
+    };
+
+    explicit ExportQueue(Options options);
+    ~ExportQueue(); // aborts everything still queued or running
+
+    ExportQueue(const ExportQueue&) = delete;
+    ExportQueue& operator=(const ExportQueue&) = delete;
+
+    // Queues a job and returns its id; jobs always run unsegmented. `estimatedFrames` (< 0 = derive
+    // it from the source or the request's range) only orders the queue; a job of unknown length
+    // sorts last.
+    int enqueue(std::unique_ptr<IExportFrameSource> source, ExportRequest request,
+                std::string label = {}, std::int64_t estimatedFrames = -1);
+
+    void abort(int id);   // dequeues a pending job, or aborts a running one
+    void abortAll();
+
+    // Blocks until no job is queued or running.
+    void waitIdle();
+
+    std::vector<ExportJobStatus> jobs() const;
+    ExportQueueStats stats() const;
+
+    // Cores a request keeps busy: its decoder threads, the chain thread and its pool, and its
+    // encoder threads (compose rides along), each at a default where the request leaves it 0.
+    static int coresFor(const ExportRequest& request);
+
+private:
+    struct Job {
+        ExportJobStatus status;
+        std::unique_ptr<IExportFrameSource> source; // until started
+        ExportRequest request;
+        Timestamp enqueuedAt{};
+        std::unique_ptr<Exporter> exporter;         // while running
+    };
+
+    void schedulerLoop();
+    // Takes finished exporters out of their jobs and frees their cores; the caller joins them
+    // with m_ released.
+    std::vector<std::unique_ptr<Exporter>> reap();
+    void startFitting(); // start pending jobs in priority order while they fit
+    int runningCount() const;
+
+    const int coreBudget_;
+
+    mutable std::mutex m_;
+    std::condition_variable cv_;      // wakes the scheduler (enqueue, abort, stop)
+    std::condition_variable idleCv_;  // wakes waitIdle()
+    bool stop_ = false;
+    std::vector<std::unique_ptr<Job>> jobs_;
+    int nextId_ = 1;
+    int coresInUse_ = 0;
+    int joining_ = 0; // reaped exporters the scheduler is joining; waitIdle() waits for them too
+
+    // Throughput bookkeeping, scheduler thread + m_.
+    bool      anyStarted_ = false;
+    Timestamp firstStart_{};
+    Timestamp rateTs_{};
+    std::uint64_t rateFrames_ = 0;
+    double    framesPerSec_ = 0.0;
+
+    std::thread scheduler_;
+};
+
+} // namespace livim
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "processing/IProcessor.hpp"
 
@@ -13,6 +14,12 @@ enum class SplitMode { None, LeftRight, TopBottom };
 // Output container + codec. FFV1 is mathematically lossless (large files).
 enum class ExportFormat { Mp4H264, AviMjpg, MkvFfv1 };
 
+// Which library encodes (see IVideoEncoder.hpp). Auto = libav, falling back to OpenCV's writer.
+enum class EncoderBackend { Auto, Libav, OpenCv };
+
+// Speed/size trade-off of the libav encoders; FFV1 stays lossless at every preset.
+enum class EncodePreset { Fast, Balanced, Quality };
+
 // Everything the exporter needs. The algorithm capture rate lives in `config.magnification.framerate`;
 // [startFrame, endFrame) trims a file's range (a camera buffer ignores it).
 struct ExportRequest {
@@ -24,6 +31,33 @@ struct ExportRequest {
     std::string     outputPath;
     int             startFrame = 0;    // inclusive (file only)
     int             endFrame = -1;     // exclusive; -1 = to the end (file only)
+    // Segment-parallel export (file only, see Exporter::startSegmented).
+    int             segments = 1;      // > 1 renders the range as that many parallel segments
+    int             warmupFrames = -1; // pre-roll per segment; -1 = enough for the chosen mode
+    bool            verifySeams = false; // also run the serial chain and diff it at each seam
+    // Encoder tuning (libav only; OpenCV's writer ignores it).
+    EncoderBackend  encoder = EncoderBackend::Auto;
+    EncodePreset    preset = EncodePreset::Balanced;
+    int             quality = -1;        // H.264 CRF or MJPEG/MPEG-4 qscale; -1 = the preset's
+    int             encoderThreads = 0;  // 0 = the codec's choice
+    // Threads for the rest of the job (ExportQueue fills these in from its core share).
+    int             decoderThreads = 0;  // the source's decoder; 0 = its own choice
+    int             poolThreads = 0;     // > 0: the chain's kernels run on a private pool of
+                                         // this many threads (caller included), not the shared one
+};
+
+// Parameter sweep (see Exporter::startSweep): Files = one file per variant next to the requested
+// path (<stem>_v1.<ext>, ...), ContactSheet = all variants tiled into the requested file.
+enum class SweepLayout { Files, ContactSheet };
+
+// `base` supplies everything but the processing config: range, file rate, format, split, labels
+// and the output path. The capture rate is taken from base.config for every variant.
+struct SweepRequest {
+    ExportRequest                base;
+    std::vector<ProcessorConfig> variants;
+    std::vector<std::string>     labels;   // per variant, burned in with base.textOverlay
+    SweepLayout                  layout = SweepLayout::Files;
+    int                          sheetColumns = 0; // contact sheet: 0 = near-square grid
 };
 
 enum class ExportPhase { Idle, Processing, Finalizing, Done, Aborted, Error };
@@ -36,6 +70,12 @@ struct ExportProgress {
     std::string error;            // set when phase == Error
     std::string codecUsed;        // the fourcc actually opened (may differ after a fallback)
     std::string outputPath;       // the file actually written (may differ from the request on fallback)
+    std::vector<double> seamMaxDiff; // per seam when verifying: max |segmented - serial|, 0-255
+    std::vector<std::string> variantOutputs; // sweep to files: the file written per variant
+    // Throughput each side could sustain alone (frames / busy seconds): which one bounds the run.
+    double      decodeFps = 0.0;      // source reads
+    double      processFps = 0.0;     // decode-free chain time
+    double      encodeFps = 0.0;      // encoder time, across all encoder threads
 };
 
 // Extension without the leading dot.
@@ -1,10 +1,14 @@
 #include "export/Exporter.hpp"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdint>
 #include <exception>
 #include <filesystem>
+#include <functional>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -13,26 +17,83 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/videoio.hpp>
 
+#include "core/BoundedQueue.hpp"
 #include "core/Clock.hpp"
 #include "core/Frame.hpp"
+#include "core/FrameFormat.hpp"
 #include "core/LatestFrameMailbox.hpp"
+#include "core/TaskPool.hpp"
+#include "export/VideoEncoderFactory.hpp"
 #include "processing/ChainBuilder.hpp"
+#include "processing/GrayscaleProcessor.hpp"
+#include "processing/MagnificationProcessor.hpp"
+#include "processing/PreprocessProcessor.hpp"
+#include "processing/magnification/TemporalFilter.hpp" // getOptimalBufferSize
 
 namespace livim {
 namespace {
 
-// A frame's pixels as 3-channel BGR8 (grayscale expanded).
-cv::Mat toBgr(const FrameRef& f) {
-    const cv::Mat& m = f->image;
-    if (m.empty()) return cv::Mat();
-    if (m.channels() == 1) {
-        cv::Mat bgr;
-        cv::cvtColor(m, bgr, cv::COLOR_GRAY2BGR);
-        return bgr;
-    }
-    return m; // already BGR8, and callers only read it
+constexpr std::size_t kDecodeAhead = 8; // raw frames decoded ahead of the chain
+constexpr std::size_t kStageDepth = 4;  // hand-offs between chain -> compose -> encode
+constexpr int kMinSegmentFrames = 32;   // shorter segments spend more on warm-up than they save
+constexpr std::size_t kSeamCheckFrames = 8; // frames compared after each seam when verifying
+
+struct ComposeJob {
+    std::uint64_t seq = 0;
+    FrameRef      original;
+    FrameRef      processed;
+};
+
+struct EncodeJob {
+    std::uint64_t seq = 0;
+    cv::Mat       canvas;
+};
+
+// One frame for a sweep output: a single variant, or every variant for a contact sheet.
+struct SweepJob {
+    std::uint64_t         seq = 0;
+    FrameRef              original;
+    std::vector<FrameRef> processed;
+};
+
+// Capture FPS (the algorithm rate) is separate from the file FPS (output cadence; 0 = follow the
+// capture rate), e.g. process a 1000 fps slow-mo at its true rate but write a 30 fps file.
+double captureFpsOf(const ExportRequest& r) {
+    return r.config.magnification.framerate > 0.0 ? r.config.magnification.framerate : 30.0;
+}
+
+double fileFpsOf(const ExportRequest& r) {
+    return r.fileFps > 0.0 ? r.fileFps : captureFpsOf(r);
 }
 
+// Only the processed pane is written, in gray: the source may skip colour altogether.
+bool lumaOnly(const ExportRequest& r) { return r.config.grayscale && r.split == SplitMode::None; }
+
+// IIR state decays geometrically; a few seconds leaves it well below one 8-bit step for the usual
+// cutoffs. The Color window is exact once refilled.
+int defaultWarmupFrames(const ExportRequest& r, double captureFps) {
+    const int seconds = static_cast<int>(std::lround(4.0 * captureFps));
+    if (r.config.magnification.mode == MagnificationMode::Color)
+        return std::max(seconds, getOptimalBufferSize(static_cast<int>(captureFps)));
+    return seconds;
+}
+
+// `seq` counts from the export's first frame; pts follows the capture rate, not the file's.
+FrameRef makeInputFrame(cv::Mat raw, std::uint64_t seq, double frameIntervalUs) {
+    auto in = std::make_shared<Frame>();
+    in->seq = seq;
+    in->captureTs = now();
+    in->ptsUs = static_cast<std::int64_t>(static_cast<double>(seq) * frameIntervalUs);
+    in->width = raw.cols;
+    in->height = raw.rows;
+    in->format = raw.channels() == 1 ? PixelFormat::Gray8 : PixelFormat::BGR8;
+    in->image = std::move(raw);
+    return in;
+}
+
+// A frame's pixels as 3-channel BGR8 (grayscale expanded, YUV converted).
+cv::Mat toBgr(const FrameRef& f) { return bgrOf(*f); }
+
 void drawLabel(cv::Mat& canvas, const std::string& text, int x, int y, double scale) {
     const int font = cv::FONT_HERSHEY_SIMPLEX;
     const int thickness = std::max(1, static_cast<int>(std::lround(scale)));
@@ -87,34 +148,63 @@ cv::Mat compose(const FrameRef& orig, const FrameRef& proc, SplitMode split, boo
     return canvas;
 }
 
-// On success `codecOut` names the fourcc actually opened and `path` is updated to the file
-// actually created, which a fallback may have changed.
-bool openWriter(cv::VideoWriter& w, ExportFormat fmt, std::string& path, double fps, cv::Size size,
-                std::string& codecOut) {
-    auto tryOpen = [&](int fourcc, const std::string& p, const char* name) {
-        if (w.open(p, fourcc, fps, size, true)) {
-            codecOut = name;
-            path = p;
-            return true;
-        }
-        return false;
-    };
-    switch (fmt) {
-    case ExportFormat::Mp4H264:
-        if (tryOpen(cv::VideoWriter::fourcc('a', 'v', 'c', '1'), path, "avc1")) return true;
-        if (tryOpen(cv::VideoWriter::fourcc('m', 'p', '4', 'v'), path, "mp4v")) return true;
-        break;
-    case ExportFormat::AviMjpg:
-        if (tryOpen(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), path, "MJPG")) return true;
-        break;
-    case ExportFormat::MkvFfv1:
-        if (tryOpen(cv::VideoWriter::fourcc('F', 'F', 'V', '1'), path, "FFV1")) return true;
-        break;
+// Tiles row-major in a grid of `columns` (0 = near-square), each the size of the first variant;
+// with `withOriginal` the unprocessed frame is the first tile.
+cv::Mat composeSheet(const FrameRef& orig, const std::vector<FrameRef>& procs,
+                     const std::vector<std::string>& labels, bool withOriginal, int columns,
+                     bool overlay) {
+    std::vector<cv::Mat> tiles;
+    std::vector<std::string> names;
+    if (withOriginal) {
+        tiles.push_back(toBgr(orig));
+        names.emplace_back("Original");
+    }
+    for (std::size_t i = 0; i < procs.size(); ++i) {
+        tiles.push_back(toBgr(procs[i]));
+        names.push_back(i < labels.size() && !labels[i].empty() ? labels[i]
+                                                                : "#" + std::to_string(i + 1));
+    }
+    const cv::Mat& lead = tiles[withOriginal ? 1 : 0];
+    const int tw = lead.cols & ~1, th = lead.rows & ~1;
+    if (tw <= 0 || th <= 0) return cv::Mat();
+    const int count = static_cast<int>(tiles.size());
+    const int cols = columns > 0
+                         ? std::min(columns, count)
+                         : static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = (count + cols - 1) / cols;
+    const double scale = std::clamp(tw / 800.0, 0.4, 1.5);
+
+    cv::Mat canvas(rows * th, cols * tw, CV_8UC3, cv::Scalar(0, 0, 0));
+    for (int i = 0; i < count; ++i) {
+        cv::Mat t = tiles[static_cast<std::size_t>(i)];
+        if (t.empty()) continue;
+        const cv::Rect cell((i % cols) * tw, (i / cols) * th, tw, th);
+        cv::Mat dst = canvas(cell);
+        if (t.cols >= tw && t.rows >= th)
+            t(cv::Rect(0, 0, tw, th)).copyTo(dst);
+        else
+            cv::resize(t, dst, cell.size(), 0, 0, cv::INTER_AREA);
+        if (overlay) drawLabel(canvas, names[static_cast<std::size_t>(i)], cell.x + 6, cell.y + 6,
+                               scale);
     }
-    // Last resort: Motion JPEG into a sibling .avi.
-    std::filesystem::path fb(path);
-    fb.replace_extension(".avi");
-    return tryOpen(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fb.string(), "MJPG (fallback .avi)");
+    return canvas;
+}
+
+// <stem>_v<index+1><ext> next to `base`.
+std::string variantPath(const std::string& base, std::size_t index) {
+    std::filesystem::path p(base);
+    const std::string ext = p.extension().string();
+    p.replace_extension();
+    return p.string() + "_v" + std::to_string(index + 1) + ext;
+}
+
+// Opens the request's encoder for `format` (segment temp files override it). On success `path`
+// is the file actually created, which a fallback may have changed.
+std::unique_ptr<IVideoEncoder> openEncoder(const ExportRequest& r, ExportFormat format,
+                                           std::string& path, double fps, cv::Size size) {
+    VideoEncoderSettings settings = encoderSettingsFor(r, fps, size);
+    settings.format = format;
+    return openVideoEncoder(r.encoder, path, settings);
 }
 
 } // namespace
@@ -126,21 +216,54 @@ Exporter::~Exporter() {
 
 void Exporter::start(std::unique_ptr<IExportFrameSource> source, ExportRequest request,
                      LatestFrameMailbox* preview) {
+    begin(preview, request.poolThreads);
+    thread_ = std::thread([this, src = std::move(source), req = std::move(request)]() mutable {
+        trace::setThreadName("exporter");
+        run(std::move(src), std::move(req));
+    });
+}
+
+void Exporter::startSegmented(ExportSourceFactory factory, ExportRequest request,
+                              LatestFrameMailbox* preview) {
+    begin(preview, request.poolThreads);
+    thread_ = std::thread([this, f = std::move(factory), req = std::move(request)]() mutable {
+        trace::setThreadName("exporter");
+        runSegmented(std::move(f), std::move(req));
+    });
+}
+
+void Exporter::startSweep(std::unique_ptr<IExportFrameSource> source, SweepRequest request,
+                          LatestFrameMailbox* preview) {
+    begin(preview, request.base.poolThreads);
+    thread_ = std::thread([this, src = std::move(source), req = std::move(request)]() mutable {
+        trace::setThreadName("exporter");
+        runSweep(std::move(src), std::move(req));
+    });
+}
+
+void Exporter::begin(LatestFrameMailbox* preview, int poolThreads) {
     join();
     preview_ = preview;
+    pool_.reset();
+    if (poolThreads > 0) pool_ = std::make_unique<TaskPool>(TaskPool::Options{poolThreads - 1});
     abort_.store(false, std::memory_order_release);
+    failed_.store(false, std::memory_order_release);
     phase_.store(ExportPhase::Processing);
     framesDone_.store(0);
     framesTotal_.store(-1);
-    {
-        std::lock_guard<std::mutex> lg(msgMu_);
-        error_.clear();
-        codecUsed_.clear();
-        outputPath_.clear();
-    }
-    thread_ = std::thread([this, src = std::move(source), req = std::move(request)]() mutable {
-        run(std::move(src), std::move(req));
-    });
+    decodeNs_.store(0);
+    processNs_.store(0);
+    encodeNs_.store(0);
+    framesDecoded_.store(0);
+    framesProcessed_.store(0);
+    framesEncoded_.store(0);
+    instr_.reset();
+    std::lock_guard<std::mutex> lg(msgMu_);
+    error_.clear();
+    codecUsed_.clear();
+    outputPath_.clear();
+    seamMaxDiff_.clear();
+    variantOutputs_.clear();
 }
 
 void Exporter::abort() { abort_.store(true, std::memory_order_release); }
@@ -149,54 +272,116 @@ void Exporter::join() {
     if (thread_.joinable()) thread_.join();
 }
 
+bool Exporter::stopped() const {
+    return abort_.load(std::memory_order_acquire) || failed_.load(std::memory_order_acquire);
+}
+
+void Exporter::fail(const std::string& msg) {
+    {
+        std::lock_guard<std::mutex> lg(msgMu_);
+        if (failed_.exchange(true, std::memory_order_acq_rel)) return;
+        error_ = msg;
+    }
+    phase_.store(ExportPhase::Error, std::memory_order_release);
+}
+
+template <class F>
+void Exporter::guarded(F&& body) {
+    const TaskPoolScope scope(pool_.get());
+    try {
+        body();
+    } catch (const std::exception& e) {
+        fail(std::string("Export failed: ") + e.what());
+    } catch (...) {
+        fail("Export failed: unknown error.");
+    }
+}
+
 ExportProgress Exporter::progress() const {
     ExportProgress p;
     p.phase = phase_.load(std::memory_order_acquire);
     p.framesDone = framesDone_.load(std::memory_order_relaxed);
     p.framesTotal = framesTotal_.load(std::memory_order_relaxed);
+    auto rate = [](std::uint64_t frames, std::uint64_t ns) {
+        return ns > 0 ? static_cast<double>(frames) * 1e9 / static_cast<double>(ns) : 0.0;
+    };
+    p.decodeFps = rate(framesDecoded_.load(std::memory_order_relaxed),
+                       decodeNs_.load(std::memory_order_relaxed));
+    p.processFps = rate(framesProcessed_.load(std::memory_order_relaxed),
+                        processNs_.load(std::memory_order_relaxed));
+    p.encodeFps = rate(framesEncoded_.load(std::memory_order_relaxed),
+                       encodeNs_.load(std::memory_order_relaxed));
     std::lock_guard<std::mutex> lg(msgMu_);
     p.error = error_;
     p.codecUsed = codecUsed_;
     p.outputPath = outputPath_;
+    p.seamMaxDiff = seamMaxDiff_;
+    p.variantOutputs = variantOutputs_;
     return p;
 }
 
+void Exporter::decode(IExportFrameSource& source, FrameQueue& out, double captureFps) {
+    std::uint64_t seq = 0;
+    const double frameIntervalUs = 1'000'000.0 / captureFps;
+    while (!stopped()) {
+        cv::Mat raw;
+        if (!readFrame(source, raw, seq)) break;
+        if (raw.empty()) continue;
+        instr_.onCaptured();
+        if (!out.push(makeInputFrame(std::move(raw), seq++, frameIntervalUs))) break;
+    }
+}
+
 void Exporter::run(std::unique_ptr<IExportFrameSource> source, ExportRequest request) {
-    auto fail = [&](const std::string& msg) {
-        {
-            std::lock_guard<std::mutex> lg(msgMu_);
-            error_ = msg;
-        }
-        phase_.store(ExportPhase::Error, std::memory_order_release);
+    FrameQueue               decoded(kDecodeAhead);
+    BoundedQueue<ComposeJob> processed(kStageDepth);
+    BoundedQueue<EncodeJob>  composed(kStageDepth);
+    auto stopAll = [&] {
+        decoded.stop();
+        processed.stop();
+        composed.stop();
     };
+    const double captureFps = captureFpsOf(request);
+    const double fileFps = fileFpsOf(request);
 
-    cv::VideoWriter writer;
-    bool writerOpen = false;
+    // Everything the stage threads reference lives at this scope, which outlives them.
+    std::unique_ptr<IVideoEncoder> encoder;
+    cv::Size outSize;
+    std::string outPath = request.outputPath;
 
-    // RAII: on EVERY exit path (return or exception) flush+release the writer and close the source
+    // RAII: on EVERY exit path (return or exception) finalize the encoder and close the source
     // exactly once; both are no-ops if already done.
     struct Finalizer {
-        cv::VideoWriter& writer;
-        bool& open;
+        std::unique_ptr<IVideoEncoder>& encoder;
         IExportFrameSource* source;
         ~Finalizer() {
-            if (open) { writer.release(); open = false; }
+            encoder.reset();
             if (source) source->close();
         }
-    } finalizer{writer, writerOpen, source.get()};
+    } finalizer{encoder, source.get()};
+
+    // Declared after the finalizer so the stage threads are stopped and joined before it runs.
+    struct StageThreads {
+        std::function<void()> stopAll;
+        std::thread decoder, composer, encoder;
+        void join() {
+            for (std::thread* t : {&decoder, &composer, &encoder})
+                if (t->joinable()) t->join();
+        }
+        ~StageThreads() {
+            stopAll();
+            join();
+        }
+    } stages{stopAll, {}, {}, {}};
 
-    try {
+    guarded([&] {
+        source->setLumaOnly(lumaOnly(request));
+        source->setDecoderThreads(request.decoderThreads);
         if (!source->open()) {
             fail("Could not open the export source.");
             return;
         }
 
-        // Capture FPS (the algorithm rate) is separate from fileFps (output cadence; 0 = follow the
-        // capture rate), e.g. process a 1000 fps slow-mo at its true rate but write a 30 fps file.
-        const double captureFps = request.config.magnification.framerate > 0.0
-                                      ? request.config.magnification.framerate
-                                      : 30.0;
-        const double fileFps = request.fileFps > 0.0 ? request.fileFps : captureFps;
         framesTotal_.store(source->frameCount(), std::memory_order_relaxed);
 
         // Same factory the live pipeline uses, built once and fed in order so the stateful
@@ -206,29 +391,70 @@ void Exporter::run(std::unique_ptr<IExportFrameSource> source, ExportRequest req
         ProcessorConfig cfg = request.config;     // by value -> fixed output size for the whole file
         cfg.magnification.framerate = captureFps;
 
-        cv::Size outSize;
-        std::string outPath = request.outputPath;
-
-        std::uint64_t seq = 0;
-        const double frameIntervalUs = 1'000'000.0 / captureFps;
-        cv::Mat raw;
-        while (!abort_.load(std::memory_order_acquire)) {
-            if (!source->next(raw)) break;
-            if (raw.empty()) continue;
-
-            auto in = std::make_shared<Frame>();
-            in->seq = seq++;
-            in->captureTs = now();
-            in->ptsUs = static_cast<std::int64_t>(static_cast<double>(in->seq) * frameIntervalUs);
-            in->width = raw.cols;
-            in->height = raw.rows;
-            in->format = raw.channels() == 1 ? PixelFormat::Gray8 : PixelFormat::BGR8;
-            // With a preview the display reads this frame asynchronously, so it must own its pixels
-            // (the next next() decodes into `raw` in place); the encode-only path can alias.
-            in->image = preview_ ? raw.clone() : raw;
-
+        // Decode runs ahead of the chain. Every frame gets its own cv::Mat: the chain, the preview
+        // and the compose stage may all still hold earlier ones.
+        stages.decoder = std::thread([&] {
+            trace::setThreadName("export-decode");
+            guarded([&] { decode(*source, decoded, captureFps); });
+            if (stopped()) stopAll();
+            decoded.stop(); // end of stream: the chain drains what is already queued
+        });
+
+        // Compose (pane layout, grey->BGR, labels) on its own thread, strictly in order.
+        stages.composer = std::thread([&] {
+            trace::setThreadName("export-compose");
+            guarded([&] {
+                ComposeJob job;
+                while (!stopped() && processed.pop(job)) {
+                    const std::uint64_t seq = job.seq;
+                    cv::Mat canvas;
+                    {
+                        StageTimer timer(&instr_, Stage::Compose, seq);
+                        canvas = compose(job.original, job.processed, request.split,
+                                         request.textOverlay);
+                    }
+                    job = ComposeJob{}; // drop the frames before possibly blocking below
+                    if (canvas.empty()) continue;
+                    if (!composed.push(EncodeJob{seq, std::move(canvas)})) break;
+                }
+            });
+            if (stopped()) stopAll();
+            composed.stop();
+        });
+
+        // The encoder is opened lazily from the first canvas and only ever touched here.
+        stages.encoder = std::thread([&] {
+            trace::setThreadName("export-encode");
+            guarded([&] {
+                EncodeJob job;
+                while (!stopped() && composed.pop(job)) {
+                    if (!encoder) {
+                        outSize = job.canvas.size();
+                        encoder = openEncoder(request, request.format, outPath, fileFps, outSize);
+                        if (!encoder) {
+                            fail("Could not open a video writer for the chosen format.");
+                            return;
+                        }
+                        std::lock_guard<std::mutex> lg(msgMu_);
+                        codecUsed_ = encoder->codecName();
+                        outputPath_ = outPath;
+                    }
+                    if (job.canvas.size() != outSize)
+                        cv::resize(job.canvas, job.canvas, outSize); // defensive; sizes are fixed
+                    encodeFrame(*encoder, job.canvas, job.seq);
+                    framesDone_.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            if (stopped()) stopAll();
+        });
+
+        // The magnification chain stays on this thread: its temporal filters need strict order.
+        FrameRef in;
+        while (!stopped() && decoded.pop(in)) {
+            const Timestamp t0 = now();
             FrameRef original;
-            const FrameRef cur = runChainOnce(chain, in, cfg, original);
+            const FrameRef cur = runChainOnce(chain, in, cfg, original, &instr_);
+            countProcessed(t0);
 
             if (preview_) {
                 auto df = std::make_shared<DisplayFrame>();
@@ -236,34 +462,24 @@ void Exporter::run(std::unique_ptr<IExportFrameSource> source, ExportRequest req
                 df->original = original;
                 preview_->publish(std::move(df));
             }
-
-            cv::Mat canvas = compose(original, cur, request.split, request.textOverlay);
-            if (canvas.empty()) continue;
-
-            if (!writerOpen) {
-                outSize = canvas.size();
-                std::string codec;
-                if (!openWriter(writer, request.format, outPath, fileFps, outSize, codec)) {
-                    fail("Could not open a video writer for the chosen format.");
-                    return;
-                }
-                {
-                    std::lock_guard<std::mutex> lg(msgMu_);
-                    codecUsed_ = codec;
-                    outputPath_ = outPath;
-                }
-                writerOpen = true;
-            }
-            if (canvas.size() != outSize)
-                cv::resize(canvas, canvas, outSize); // defensive; sizes are fixed
-            writer.write(canvas);
-            framesDone_.fetch_add(1, std::memory_order_relaxed);
+            if (!processed.push(ComposeJob{in->seq, std::move(original), cur})) break;
+        }
+        in.reset();
+        if (stopped()) stopAll();
+        processed.stop();
+
+        if (!failed_.load(std::memory_order_acquire))
+            phase_.store(ExportPhase::Finalizing, std::memory_order_release);
+        stages.join(); // compose and encode drain what is queued; at most a few frames
+        if (failed_.load(std::memory_order_acquire)) return;
+
+        // Finalize BEFORE the possible partial-file remove: Windows can't delete an open file.
+        const bool wroteFile = encoder != nullptr;
+        if (encoder) {
+            StageTimer timer(&instr_, Stage::Encode);
+            encoder->close(); // drains the codec's delayed frames
+            encoder.reset();
         }
-
-        phase_.store(ExportPhase::Finalizing, std::memory_order_release);
-        // Release BEFORE the possible partial-file remove: Windows can't delete an open file.
-        const bool wroteFile = writerOpen;
-        if (writerOpen) { writer.release(); writerOpen = false; }
 
         // Surface an empty range rather than reporting a 0-frame "success".
         if (!wroteFile && !abort_.load(std::memory_order_acquire)) {
@@ -280,12 +496,526 @@ void Exporter::run(std::unique_ptr<IExportFrameSource> source, ExportRequest req
         } else {
             phase_.store(ExportPhase::Done, std::memory_order_release);
         }
-    } catch (const std::exception& e) {
-        // An exception escaping the worker thread would std::terminate the app.
-        fail(std::string("Export failed: ") + e.what());
-    } catch (...) {
-        fail("Export failed: unknown error.");
+    });
+}
+
+void Exporter::runSegmented(ExportSourceFactory factory, ExportRequest request) {
+    const double captureFps = captureFpsOf(request);
+    const double fileFps = fileFpsOf(request);
+    const double frameIntervalUs = 1'000'000.0 / captureFps;
+
+    // Resolve the range; a file's length is only known once opened.
+    const int first = std::max(0, request.startFrame);
+    int count = -1;
+    guarded([&] {
+        std::unique_ptr<IExportFrameSource> probe = factory(first, request.endFrame);
+        if (!probe->open()) {
+            fail("Could not open the export source.");
+            return;
+        }
+        count = probe->frameCount();
+        probe->close();
+    });
+    if (stopped()) {
+        if (!failed_.load(std::memory_order_acquire))
+            phase_.store(ExportPhase::Aborted, std::memory_order_release);
+        return;
+    }
+    const int segCount = std::min(request.segments, count / kMinSegmentFrames);
+    if (segCount < 2) {
+        run(factory(first, request.endFrame), std::move(request));
+        return;
+    }
+    framesTotal_.store(count, std::memory_order_relaxed);
+
+    const int warmup = request.warmupFrames >= 0 ? request.warmupFrames
+                                                 : defaultWarmupFrames(request, captureFps);
+    const bool verify = request.verifySeams;
+
+    struct Segment {
+        int begin = 0;      // first frame written
+        int end = 0;        // exclusive
+        int warmBegin = 0;  // first frame decoded
+        std::string tempPath;
+        std::vector<cv::Mat> head; // first processed frames, when verifying
+    };
+    std::vector<Segment> segs(static_cast<std::size_t>(segCount));
+    for (int i = 0; i < segCount; ++i) {
+        Segment& sg = segs[static_cast<std::size_t>(i)];
+        sg.begin = first + static_cast<int>(static_cast<std::int64_t>(count) * i / segCount);
+        sg.end = first + static_cast<int>(static_cast<std::int64_t>(count) * (i + 1) / segCount);
+        sg.warmBegin = std::max(first, sg.begin - warmup);
+        sg.tempPath = request.outputPath + ".seg" + std::to_string(i) + ".mkv";
+    }
+
+    // Temp files go on every exit path; the final output only if it is not a finished export.
+    struct TempFiles {
+        std::vector<Segment>& segs;
+        ~TempFiles() {
+            std::error_code ec;
+            for (const Segment& sg : segs) std::filesystem::remove(sg.tempPath, ec);
+        }
+    } tempFiles{segs};
+
+    ProcessorConfig cfg = request.config;
+    cfg.magnification.framerate = captureFps;
+
+    // Processes [from, to) with a fresh chain, handing every frame at or after `keepFrom` to
+    // `sink(frameIndex, original, processed)`. Returns false when stopped early.
+    auto renderRange = [&](int from, int to, int keepFrom, auto&& sink) {
+        std::unique_ptr<IExportFrameSource> source = factory(from, to);
+        source->setLumaOnly(lumaOnly(request));
+        source->setDecoderThreads(request.decoderThreads);
+        if (!source->open()) {
+            fail("Could not open the export source.");
+            return false;
+        }
+        struct Closer {
+            IExportFrameSource* s;
+            ~Closer() { s->close(); }
+        } closer{source.get()};
+        std::vector<std::unique_ptr<IProcessor>> chain = buildProcessors();
+        for (int idx = from; idx < to && !stopped(); ++idx) {
+            const auto seq = static_cast<std::uint64_t>(idx - first);
+            cv::Mat raw;
+            if (!readFrame(*source, raw, seq)) break;
+            if (raw.empty()) continue;
+            instr_.onCaptured();
+            const Timestamp t0 = now();
+            FrameRef original;
+            const FrameRef cur = runChainOnce(
+                chain, makeInputFrame(std::move(raw), seq, frameIntervalUs), cfg, original, &instr_);
+            countProcessed(t0);
+            if (idx >= keepFrom) sink(idx, original, cur);
+        }
+        return !stopped();
+    };
+
+    // Temp files are lossless at any preset: pick the fastest, one encoder thread per segment.
+    ExportRequest tempRequest = request;
+    tempRequest.preset = EncodePreset::Fast;
+    tempRequest.encoderThreads = 1;
+
+    auto renderSegment = [&](std::size_t i) {
+        Segment& sg = segs[i];
+        std::unique_ptr<IVideoEncoder> tmp;
+        renderRange(sg.warmBegin, sg.end, sg.begin,
+                    [&](int, const FrameRef& original, const FrameRef& cur) {
+            if (i == 0 && preview_) {
+                auto df = std::make_shared<DisplayFrame>();
+                df->processed = cur;
+                df->original = original;
+                preview_->publish(std::move(df));
+            }
+            if (verify && i > 0 && sg.head.size() < kSeamCheckFrames)
+                sg.head.push_back(cur->image.clone());
+            cv::Mat canvas;
+            {
+                StageTimer timer(&instr_, Stage::Compose, cur->seq);
+                canvas = compose(original, cur, request.split, request.textOverlay);
+            }
+            if (canvas.empty()) return;
+            if (!tmp) {
+                tmp = openEncoder(tempRequest, ExportFormat::MkvFfv1, sg.tempPath, fileFps,
+                                  canvas.size());
+                if (!tmp) throw std::runtime_error("could not open a temporary segment file");
+            }
+            encodeFrame(*tmp, canvas, cur->seq);
+            framesDone_.fetch_add(1, std::memory_order_relaxed);
+        });
+        if (tmp) tmp->close();
+    };
+
+    // The serial reference only has to reach the last seam's check window.
+    std::vector<std::vector<cv::Mat>> serialHeads(segs.size());
+    auto renderSerial = [&] {
+        const int to = std::min(first + count, segs.back().begin + static_cast<int>(kSeamCheckFrames));
+        renderRange(first, to, segs[1].begin, [&](int idx, const FrameRef&, const FrameRef& cur) {
+            for (std::size_t i = 1; i < segs.size(); ++i) {
+                if (idx >= segs[i].begin &&
+                    idx < segs[i].begin + static_cast<int>(kSeamCheckFrames))
+                    serialHeads[i].push_back(cur->image.clone());
+            }
+        });
+    };
+
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(segs.size() + 1);
+        for (std::size_t i = 0; i < segs.size(); ++i) {
+            threads.emplace_back([&, i] {
+                trace::setThreadName("export-segment");
+                guarded([&] { renderSegment(i); });
+            });
+        }
+        if (verify) {
+            threads.emplace_back([&] {
+                trace::setThreadName("export-serial");
+                guarded(renderSerial);
+            });
+        }
+        for (std::thread& t : threads) t.join();
+    }
+    if (failed_.load(std::memory_order_acquire)) return;
+
+    // Concatenate in order into the requested format.
+    std::string outPath = request.outputPath;
+    std::unique_ptr<IVideoEncoder> encoder;
+    guarded([&] {
+        if (!abort_.load(std::memory_order_acquire))
+            phase_.store(ExportPhase::Finalizing, std::memory_order_release);
+        for (const Segment& sg : segs) {
+            cv::VideoCapture cap;
+            if (!cap.open(sg.tempPath)) continue; // a segment that produced no canvas
+            cv::Mat canvas;
+            while (!stopped() && cap.read(canvas)) {
+                if (!encoder) {
+                    encoder = openEncoder(request, request.format, outPath, fileFps, canvas.size());
+                    if (!encoder) {
+                        fail("Could not open a video writer for the chosen format.");
+                        return;
+                    }
+                    std::lock_guard<std::mutex> lg(msgMu_);
+                    codecUsed_ = encoder->codecName();
+                    outputPath_ = outPath;
+                }
+                encodeFrame(*encoder, canvas, 0);
+            }
+            if (stopped()) return;
+        }
+        if (encoder) encoder->close();
+    });
+    const bool wroteFile = encoder != nullptr;
+    encoder.reset(); // before any remove: Windows can't delete an open file
+    if (failed_.load(std::memory_order_acquire)) return;
+
+    if (abort_.load(std::memory_order_acquire)) {
+        if (wroteFile) {
+            std::error_code ec;
+            std::filesystem::remove(outPath, ec);
+        }
+        phase_.store(ExportPhase::Aborted, std::memory_order_release);
+        return;
+    }
+    if (!wroteFile) {
+        fail("No frames to export (empty range?).");
+        return;
+    }
+
+    if (verify) {
+        std::vector<double> diffs;
+        for (std::size_t i = 1; i < segs.size(); ++i) {
+            double worst = 0.0;
+            const std::size_t n = std::min(segs[i].head.size(), serialHeads[i].size());
+            for (std::size_t k = 0; k < n; ++k) {
+                const cv::Mat& a = segs[i].head[k];
+                const cv::Mat& b = serialHeads[i][k];
+                if (a.size() == b.size() && a.type() == b.type())
+                    worst = std::max(worst, cv::norm(a, b, cv::NORM_INF));
+            }
+            diffs.push_back(worst);
+        }
+        std::lock_guard<std::mutex> lg(msgMu_);
+        seamMaxDiff_ = std::move(diffs);
+    }
+    phase_.store(ExportPhase::Done, std::memory_order_release);
+}
+
+bool Exporter::readFrame(IExportFrameSource& source, cv::Mat& raw, std::uint64_t seq) {
+    const Timestamp t0 = now();
+    bool more = false;
+    {
+        StageTimer timer(&instr_, Stage::SourceRead, seq);
+        more = source.next(raw);
+    }
+    if (!more) return false;
+    decodeNs_.fetch_add(static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(now() - t0)
+                                .count()),
+                        std::memory_order_relaxed);
+    framesDecoded_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Exporter::encodeFrame(IVideoEncoder& encoder, const cv::Mat& canvas, std::uint64_t seq) {
+    const Timestamp t0 = now();
+    {
+        StageTimer timer(&instr_, Stage::Encode, seq);
+        encoder.write(canvas);
+    }
+    encodeNs_.fetch_add(static_cast<std::uint64_t>(
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(now() - t0)
+                                .count()),
+                        std::memory_order_relaxed);
+    framesEncoded_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Exporter::countProcessed(Timestamp since) {
+    instr_.onProcessed();
+    processNs_.fetch_add(static_cast<std::uint64_t>(
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(now() - since)
+                                 .count()),
+                         std::memory_order_relaxed);
+    framesProcessed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Exporter::runSweep(std::unique_ptr<IExportFrameSource> source, SweepRequest sweep) {
+    const ExportRequest& request = sweep.base;
+    const double captureFps = captureFpsOf(request);
+    const double fileFps = fileFpsOf(request);
+    const bool sheet = sweep.layout == SweepLayout::ContactSheet;
+    const std::size_t n = sweep.variants.size();
+
+    // The capture rate belongs to the footage, not to a variant.
+    std::vector<ProcessorConfig> cfgs = sweep.variants;
+    for (ProcessorConfig& c : cfgs) c.magnification.framerate = captureFps;
+
+    // Variants that agree on grayscale + preprocess share those stages' output.
+    std::vector<std::size_t> groupOf(n), groupLead;
+    for (std::size_t v = 0; v < n; ++v) {
+        std::size_t g = 0;
+        while (g < groupLead.size() && (cfgs[groupLead[g]].grayscale != cfgs[v].grayscale ||
+                                        cfgs[groupLead[g]].preprocess != cfgs[v].preprocess))
+            ++g;
+        if (g == groupLead.size()) groupLead.push_back(v);
+        groupOf[v] = g;
     }
+
+    struct Output {
+        std::string path;
+        std::unique_ptr<IVideoEncoder> encoder;
+        cv::Size size;
+        BoundedQueue<SweepJob> queue{kStageDepth};
+        std::thread thread;
+        std::atomic<int> encoded{0}; // frames through the encoder (or dropped as empty)
+    };
+    std::vector<std::unique_ptr<Output>> outputs(sheet ? 1 : n);
+    for (std::size_t i = 0; i < outputs.size(); ++i) {
+        outputs[i] = std::make_unique<Output>();
+        outputs[i]->path = sheet ? request.outputPath : variantPath(request.outputPath, i);
+    }
+    // Progress counts a frame once every output has encoded it, as the pipelined path does.
+    auto countEncoded = [&](Output& o) {
+        o.encoded.fetch_add(1, std::memory_order_relaxed);
+        int slowest = std::numeric_limits<int>::max();
+        for (const auto& out : outputs)
+            slowest = std::min(slowest, out->encoded.load(std::memory_order_relaxed));
+        int done = framesDone_.load(std::memory_order_relaxed);
+        while (done < slowest &&
+               !framesDone_.compare_exchange_weak(done, slowest, std::memory_order_relaxed)) {
+        }
+    };
+    FrameQueue decoded(kDecodeAhead);
+    auto stopAll = [&] {
+        decoded.stop();
+        for (auto& o : outputs) o->queue.stop();
+    };
+
+    // RAII: on every exit path stop and join the stage threads, then finalize the encoders and
+    // close the source.
+    struct Teardown {
+        std::function<void()> stopAll;
+        std::vector<std::unique_ptr<Output>>& outputs;
+        IExportFrameSource* source;
+        std::thread decoder;
+        void join() {
+            if (decoder.joinable()) decoder.join();
+            for (auto& o : outputs)
+                if (o->thread.joinable()) o->thread.join();
+        }
+        ~Teardown() {
+            stopAll();
+            join();
+            for (auto& o : outputs) o->encoder.reset();
+            source->close();
+        }
+    } teardown{stopAll, outputs, source.get(), {}};
+
+    guarded([&] {
+        if (n == 0) {
+            fail("The sweep has no variants.");
+            return;
+        }
+        source->setLumaOnly(request.split == SplitMode::None &&
+                            std::all_of(cfgs.begin(), cfgs.end(),
+                                        [](const ProcessorConfig& c) { return c.grayscale; }));
+        source->setDecoderThreads(request.decoderThreads);
+        if (!source->open()) {
+            fail("Could not open the export source.");
+            return;
+        }
+        framesTotal_.store(source->frameCount(), std::memory_order_relaxed);
+
+        teardown.decoder = std::thread([&] {
+            trace::setThreadName("export-decode");
+            guarded([&] { decode(*source, decoded, captureFps); });
+            if (stopped()) stopAll();
+            decoded.stop();
+        });
+
+        // Compose and encode per output, each on its own thread; encoders open lazily.
+        for (std::size_t i = 0; i < outputs.size(); ++i) {
+            Output& o = *outputs[i];
+            o.thread = std::thread([&, &o = o] {
+                trace::setThreadName("export-encode");
+                guarded([&] {
+                    SweepJob job;
+                    while (!stopped() && o.queue.pop(job)) {
+                        const std::uint64_t seq = job.seq;
+                        cv::Mat canvas;
+                        {
+                            StageTimer timer(&instr_, Stage::Compose, seq);
+                            canvas = sheet ? composeSheet(job.original, job.processed,
+                                                          sweep.labels,
+                                                          request.split != SplitMode::None,
+                                                          sweep.sheetColumns, request.textOverlay)
+                                           : compose(job.original, job.processed.front(),
+                                                     request.split, request.textOverlay);
+                        }
+                        job = SweepJob{};
+                        if (canvas.empty()) {
+                            countEncoded(o);
+                            continue;
+                        }
+                        if (!o.encoder) {
+                            o.size = canvas.size();
+                            o.encoder = openEncoder(request, request.format, o.path, fileFps,
+                                                    o.size);
+                            if (!o.encoder) {
+                                fail("Could not open a video writer for the chosen format.");
+                                return;
+                            }
+                            std::lock_guard<std::mutex> lg(msgMu_);
+                            if (codecUsed_.empty()) codecUsed_ = o.encoder->codecName();
+                        }
+                        if (canvas.size() != o.size) cv::resize(canvas, canvas, o.size);
+                        encodeFrame(*o.encoder, canvas, seq);
+                        countEncoded(o);
+                    }
+                    if (o.encoder) o.encoder->close(); // drain on this thread, in parallel
+                });
+                if (stopped()) stopAll();
+            });
+        }
+
+        std::vector<PreprocessProcessor> pre(groupLead.size());
+        std::vector<GrayscaleProcessor> gray(groupLead.size());
+        std::vector<MagnificationProcessor> mags(n);
+
+        struct SpatialKey {
+            std::size_t group;
+            MagnificationMode mode;
+            int levels;
+        };
+        std::vector<FrameRef> originals(groupLead.size()), shared(groupLead.size());
+        std::vector<SpatialKey> keys;
+        std::vector<magcore::SpatialInput> spatials;
+        std::vector<int> spatialOf(n);
+        std::vector<FrameRef> outs(n);
+
+        FrameRef in;
+        while (!stopped() && decoded.pop(in)) {
+            const Timestamp t0 = now();
+            const std::uint64_t seq = in->seq;
+            for (std::size_t g = 0; g < groupLead.size(); ++g) {
+                const ProcessorConfig& c = cfgs[groupLead[g]];
+                {
+                    StageTimer timer(&instr_, Stage::Preprocess, seq);
+                    originals[g] = pre[g].process(in, c);
+                }
+                StageTimer timer(&instr_, Stage::Grayscale, seq);
+                shared[g] = gray[g].process(originals[g], c);
+            }
+
+            // One spatial decomposition per (group, mode, levels); levels depend on the frame.
+            keys.clear();
+            for (std::size_t v = 0; v < n; ++v) {
+                const std::size_t g = groupOf[v];
+                const int levels = MagnificationProcessor::levelsFor(shared[g], cfgs[v]);
+                spatialOf[v] = -1;
+                if (levels < 1) continue;
+                const MagnificationMode mode = cfgs[v].magnification.mode;
+                std::size_t k = 0;
+                while (k < keys.size() && (keys[k].group != g || keys[k].mode != mode ||
+                                           keys[k].levels != levels))
+                    ++k;
+                if (k == keys.size()) keys.push_back({g, mode, levels});
+                spatialOf[v] = static_cast<int>(k);
+            }
+            spatials.assign(keys.size(), {});
+            parallelFor(0, static_cast<int>(keys.size()), 1, [&](int k0, int k1) {
+                for (int k = k0; k < k1; ++k) {
+                    const SpatialKey& key = keys[static_cast<std::size_t>(k)];
+                    spatials[static_cast<std::size_t>(k)] =
+                        magcore::prepareSpatial(*shared[key.group], key.mode, key.levels);
+                }
+            });
+
+            // Temporal filtering and reconstruction are per variant and independent.
+            parallelFor(0, static_cast<int>(n), 1, [&](int v0, int v1) {
+                for (int vi = v0; vi < v1; ++vi) {
+                    const auto v = static_cast<std::size_t>(vi);
+                    const FrameRef& src = shared[groupOf[v]];
+                    StageTimer timer(&instr_, Stage::Magnify, seq);
+                    outs[v] = spatialOf[v] < 0
+                                  ? mags[v].process(src, cfgs[v])
+                                  : mags[v].process(src, cfgs[v],
+                                                    spatials[static_cast<std::size_t>(
+                                                        spatialOf[v])]);
+                }
+            });
+            countProcessed(t0);
+
+            if (preview_) {
+                auto df = std::make_shared<DisplayFrame>();
+                df->processed = outs.front();
+                df->original = originals[groupOf.front()];
+                preview_->publish(std::move(df));
+            }
+            bool pushed = true;
+            if (sheet) {
+                pushed = outputs.front()->queue.push(
+                    SweepJob{seq, originals[groupOf.front()], outs});
+            } else {
+                for (std::size_t v = 0; v < n && pushed; ++v)
+                    pushed = outputs[v]->queue.push(
+                        SweepJob{seq, originals[groupOf[v]], {outs[v]}});
+            }
+            if (!pushed) break;
+        }
+        in.reset();
+        if (stopped()) stopAll();
+        for (auto& o : outputs) o->queue.stop();
+
+        if (!failed_.load(std::memory_order_acquire))
+            phase_.store(ExportPhase::Finalizing, std::memory_order_release);
+        teardown.join(); // the encoders drain what is queued
+        if (failed_.load(std::memory_order_acquire)) return;
+
+        // Finalize BEFORE any remove: Windows can't delete an open file.
+        std::vector<std::string> written;
+        for (auto& o : outputs) {
+            if (!o->encoder) continue;
+            o->encoder.reset();
+            written.push_back(o->path);
+        }
+        if (abort_.load(std::memory_order_acquire)) {
+            std::error_code ec;
+            for (const std::string& path : written) std::filesystem::remove(path, ec);
+            phase_.store(ExportPhase::Aborted, std::memory_order_release);
+            return;
+        }
+        if (written.empty()) {
+            fail("No frames to export (empty range?).");
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lg(msgMu_);
+            outputPath_ = written.front();
+            if (!sheet) variantOutputs_ = written;
+        }
+        phase_.store(ExportPhase::Done, std::memory_order_release);
+    });
 }
 
 } // namespace livim
@@ -1,23 +1,38 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <opencv2/core.hpp>
 
+#include "core/Clock.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/PipelineTypes.hpp"
+#include "core/TaskPool.hpp"
 #include "export/ExportTypes.hpp"
 #include "export/IExportFrameSource.hpp"
 
 namespace livim {
 
+class IVideoEncoder;
 class LatestFrameMailbox;
 
+// A fresh, independent source for [startFrame, endFrame) of the footage being exported; endFrame
+// < 0 means to the end.
+using ExportSourceFactory =
+    std::function<std::unique_ptr<IExportFrameSource>(int startFrame, int endFrame)>;
+
 // Offline render+encode worker shared by both export cases (file vs. recorded camera buffer). Runs a
 // FRESH magnification chain fed strictly in order (the temporal filters are stateful) on its OWN
-// thread, sharing no mutable state with the live pipeline.
+// thread, sharing no mutable state with the live pipeline. Decode, compose and encode each get a
+// thread of their own around it, linked by small blocking queues, so an export runs at the pace
+// of its slowest stage rather than the sum of all four.
 class Exporter {
 public:
     Exporter() = default;
@@ -31,30 +46,78 @@ public:
     void start(std::unique_ptr<IExportFrameSource> source, ExportRequest request,
                LatestFrameMailbox* preview = nullptr);
 
+    // Segment-parallel variant for random-access sources: request.[startFrame, endFrame) is split
+    // into request.segments parts rendered concurrently, each by its own chain into a lossless
+    // temp file, then concatenated in order. The temporal filters forget exponentially (Color:
+    // after one window), so each segment pre-rolls request.warmupFrames and discards their output.
+    // With request.verifySeams the serial chain runs alongside and progress().seamMaxDiff reports
+    // how far the first frames after each seam deviate from it. Falls back to start() when the
+    // range length is unknown.
+    void startSegmented(ExportSourceFactory factory, ExportRequest request,
+                        LatestFrameMailbox* preview = nullptr);
+
+    // Parameter sweep: every frame is decoded, preprocessed and spatially decomposed once and
+    // shared by all variants that agree on those settings; each variant keeps its own temporal
+    // state and its own encoder thread (or one shared contact-sheet encoder). The variants of a
+    // frame are magnified concurrently on the shared task pool.
+    void startSweep(std::unique_ptr<IExportFrameSource> source, SweepRequest request,
+                    LatestFrameMailbox* preview = nullptr);
+
     // Idempotent. The worker stops at the next frame boundary.
     void abort();
 
-    // Blocks for at most one frame's work.
+    // Blocks for at most one frame's work per stage.
     void join();
 
     // Thread-safe.
     ExportProgress progress() const;
 
+    // Per-stage timings (decode, each processor, compose, encode) of the current/last run. Like
+    // PlaybackController::stats(), call from one polling thread only.
+    StatsSnapshot stats() { return instr_.snapshot(); }
+
 private:
+    void begin(LatestFrameMailbox* preview, int poolThreads);
+    bool stopped() const;                 // aborted, or a stage failed
+    void fail(const std::string& msg);    // first error wins; later ones are teardown fallout
+    // Runs `body` on the export's pool; exceptions -> fail(), they never escape a thread.
+    template <class F> void guarded(F&& body);
     void run(std::unique_ptr<IExportFrameSource> source, ExportRequest request);
+    void runSegmented(ExportSourceFactory factory, ExportRequest request);
+    void runSweep(std::unique_ptr<IExportFrameSource> source, SweepRequest sweep);
+    // Reads `source` into `out` until it ends or the export stops; the caller stops `out`.
+    void decode(IExportFrameSource& source, FrameQueue& out, double captureFps);
+    // Reads one frame, timed into Stage::SourceRead and the decode throughput.
+    bool readFrame(IExportFrameSource& source, cv::Mat& raw, std::uint64_t seq);
+    // Encodes one canvas, timed into Stage::Encode and the encode throughput.
+    void encodeFrame(IVideoEncoder& encoder, const cv::Mat& canvas, std::uint64_t seq);
+    // One frame has been through the chain since `since`.
+    void countProcessed(Timestamp since);
 
     LatestFrameMailbox*     preview_ = nullptr; // set before the thread starts
+    std::unique_ptr<TaskPool> pool_;            // ExportRequest::poolThreads; null = shared
     std::thread             thread_;
     std::atomic<bool>       abort_{false};
+    std::atomic<bool>       failed_{false};
     std::atomic<ExportPhase> phase_{ExportPhase::Idle};
     std::atomic<int>        framesDone_{0};
     std::atomic<int>        framesTotal_{-1};
+    Instrumentation         instr_;
+    // Busy time per side, for ExportProgress::decodeFps / processFps / encodeFps.
+    std::atomic<std::uint64_t> decodeNs_{0};
+    std::atomic<std::uint64_t> processNs_{0};
+    std::atomic<std::uint64_t> encodeNs_{0};
+    std::atomic<std::uint64_t> framesDecoded_{0};
+    std::atomic<std::uint64_t> framesProcessed_{0};
+    std::atomic<std::uint64_t> framesEncoded_{0};
 
     // Guarded by msgMu_.
     mutable std::mutex      msgMu_;
     std::string             error_;
     std::string             codecUsed_;
     std::string             outputPath_; // actual file written, may differ after a fallback
+    std::vector<double>     seamMaxDiff_;
+    std::vector<std::string> variantOutputs_;
 };
 
 } // namespace livim
@@ -3,16 +3,20 @@
 #include <algorithm>
 #include <utility>
 
+#include "export/ImageSequenceExportFrameSource.hpp"
+#include "export/RawExportFrameSource.hpp"
+#include "export/SyntheticExportFrameSource.hpp"
+
 namespace livim {
 
 FileExportFrameSource::FileExportFrameSource(std::string path, int startFrame, int endFrame)
     : path_(std::move(path)), startFrame_(std::max(0, startFrame)), endFrame_(endFrame) {}
 
 bool FileExportFrameSource::open() {
-    if (!cap_.open(path_)) return false;
+    if (!decoder_.open(path_, threads_)) return false;
 
-    const double total = cap_.get(cv::CAP_PROP_FRAME_COUNT);
-    const int totalFrames = total > 0.0 ? static_cast<int>(total) : -1;
+    const std::int64_t total = decoder_.frameCount();
+    const int totalFrames = total > 0 ? static_cast<int>(total) : -1;
 
     // Resolve the trimmed range; unknown total -> deliver to natural EOF with an unknown count.
     int end = endFrame_;
@@ -25,31 +29,42 @@ bool FileExportFrameSource::open() {
     }
     endFrame_ = end;
 
-    if (startFrame_ > 0) cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(startFrame_));
+    // Frame-accurate, so a segment starts exactly on its first frame. Past the end: nothing left.
+    if (startFrame_ > 0 && !decoder_.seek(startFrame_)) {
+        endFrame_ = startFrame_;
+        frameCount_ = 0;
+    }
 
-    int w = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH));
-    int h = static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT));
-    if (w <= 0 || h <= 0) {
-        cv::Mat probe;
-        if (!cap_.read(probe)) return false;
-        w = probe.cols;
-        h = probe.rows;
-        cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(startFrame_)); // rewind to the in-point
+    size_ = decoder_.size();
+    if (size_.width <= 0 || size_.height <= 0) {
+        // Not in the stream header: decode the first frame for it (seek() leaves it to next()).
+        if (!decoder_.seek(startFrame_)) return false;
+        size_ = decoder_.size();
     }
-    size_ = cv::Size(w, h);
     delivered_ = 0;
     return true;
 }
 
 bool FileExportFrameSource::next(cv::Mat& outBgr) {
     if (endFrame_ >= 0 && startFrame_ + delivered_ >= endFrame_) return false; // out-point
-    if (!cap_.read(outBgr)) return false;                                       // natural EOF
+    if (!decoder_.decode()) return false;                                       // natural EOF
+    const bool luma = lumaOnly_ || decoder_.channels() == 1;
+    if (!(luma ? decoder_.toGray(outBgr) : decoder_.toBgr(outBgr))) return false;
     ++delivered_;
     return true;
 }
 
-void FileExportFrameSource::close() {
-    if (cap_.isOpened()) cap_.release();
+void FileExportFrameSource::close() { decoder_.close(); }
+
+std::unique_ptr<IExportFrameSource> makeFileExportFrameSource(const std::string& path,
+                                                              int startFrame, int endFrame) {
+    if (SyntheticVideo::handles(path)) // before the others: its options may end in ".raw" etc.
+        return std::make_unique<SyntheticExportFrameSource>(path, startFrame, endFrame);
+    if (RawVideoFile::handles(path))
+        return std::make_unique<RawExportFrameSource>(path, startFrame, endFrame);
+    if (ImageSequence::handles(path))
+        return std::make_unique<ImageSequenceExportFrameSource>(path, startFrame, endFrame);
+    return std::make_unique<FileExportFrameSource>(path, startFrame, endFrame);
 }
 
 } // namespace livim
@@ -1,15 +1,16 @@
 #pragma once
 
+#include <memory>
 #include <string>
 
-#include <opencv2/videoio.hpp>
-
 #include "export/IExportFrameSource.hpp"
+#include "source/LibavDecoder.hpp"
 
 namespace livim {
 
-// Re-decodes a video file (or a [start, end) sub-range) for export. Opens its OWN cv::VideoCapture,
-// independent of the live FileSource: a sequential, lossless read with no realtime pacing.
+// Re-decodes a video file (or a [start, end) sub-range) for export. Opens its OWN LibavDecoder,
+// independent of the live FileSource: a sequential, lossless read with no realtime pacing, on
+// the decoder's own threads.
 class FileExportFrameSource : public IExportFrameSource {
 public:
     // [startFrame, endFrame) trims the range; endFrame < 0 means to the end.
@@ -20,15 +21,27 @@ public:
     cv::Size size() const override { return size_; }
     bool     next(cv::Mat& outBgr) override;
     void     close() override;
+    void     setLumaOnly(bool enabled) override { lumaOnly_ = enabled; }
+    void     setDecoderThreads(int threads) override { threads_ = threads; }
 
 private:
-    std::string      path_;
-    int              startFrame_;
-    int              endFrame_;   // exclusive; -1 = to end
-    cv::VideoCapture cap_;
-    int              frameCount_ = -1; // frames that will be delivered (trimmed)
-    int              delivered_ = 0;
-    cv::Size         size_{0, 0};
+    std::string  path_;
+    int          startFrame_;
+    int          endFrame_;   // exclusive; -1 = to end
+    LibavDecoder decoder_;
+    int          frameCount_ = -1; // frames that will be delivered (trimmed)
+    int          delivered_ = 0;
+    cv::Size     size_{0, 0};
+    bool         lumaOnly_ = false;
+    int          threads_ = 0;
 };
 
+// The export source for a video file: RawExportFrameSource for uncompressed Y4M/raw footage
+// (RawVideoFile::handles()), ImageSequenceExportFrameSource for a directory or frame of numbered
+// stills (ImageSequence::handles()), SyntheticExportFrameSource for a "synthetic:" clip,
+// FileExportFrameSource for everything else.
+std::unique_ptr<IExportFrameSource> makeFileExportFrameSource(const std::string& path,
+                                                              int startFrame = 0,
+                                                              int endFrame = -1);
+
 } // namespace livim
@@ -24,6 +24,14 @@ public:
     virtual bool next(cv::Mat& outBgr) = 0;
 
     virtual void close() = 0;
+
+    // Deliver single-channel luma instead of BGR, when the export never shows colour. Set before
+    // open(); a source that can't do it cheaper than the Grayscale stage ignores it.
+    virtual void setLumaOnly(bool /*enabled*/) {}
+
+    // Threads a source that decodes in parallel may use (0 = its own choice). Set before open();
+    // the others ignore it.
+    virtual void setDecoderThreads(int /*threads*/) {}
 };
 
 } // namespace livim
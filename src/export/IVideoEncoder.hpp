@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/core.hpp>
+
+#include "export/ExportTypes.hpp"
+
+namespace livim {
+
+struct VideoEncoderSettings {
+    ExportFormat format = ExportFormat::Mp4H264;
+    double       fps = 30.0;
+    cv::Size     size{0, 0};             // even dimensions; every frame must match
+    EncodePreset preset = EncodePreset::Balanced;
+    int          quality = -1;           // see ExportRequest::quality
+    int          threads = 0;            // 0 = the codec's choice
+};
+
+// Encodes BGR8 frames of one fixed size into a file. Used from one thread at a time.
+class IVideoEncoder {
+public:
+    virtual ~IVideoEncoder() = default;
+
+    // On success `path` is the file actually created (a fallback may change the extension).
+    virtual bool open(std::string& path, const VideoEncoderSettings& settings) = 0;
+
+    // Encodes one BGR8 frame of the opened size. Throws std::runtime_error on an encoder error.
+    virtual void write(const cv::Mat& bgr) = 0;
+
+    // Flushes delayed frames and finalizes the file. Idempotent; the destructor calls it.
+    virtual void close() = 0;
+
+    // The codec actually opened, e.g. "libx264" or "MJPG (fallback .avi)".
+    virtual std::string codecName() const = 0;
+};
+
+} // namespace livim
@@ -0,0 +1,32 @@
+#include "export/ImageSequenceExportFrameSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace livim {
+
+ImageSequenceExportFrameSource::ImageSequenceExportFrameSource(std::string path, int startFrame,
+                                                               int endFrame)
+    : path_(std::move(path)), startFrame_(std::max(0, startFrame)), endFrame_(endFrame) {}
+
+bool ImageSequenceExportFrameSource::open() {
+    sequence_ = ImageSequence::open(path_);
+    if (!sequence_) return false;
+    const int total = static_cast<int>(sequence_->frameCount());
+    if (endFrame_ < 0 || endFrame_ > total) endFrame_ = total;
+    startFrame_ = std::min(startFrame_, endFrame_);
+    frameCount_ = endFrame_ - startFrame_;
+    reader_ = std::make_unique<ImageSequenceReader>(threads_);
+    reader_->start(sequence_, startFrame_, endFrame_, lumaOnly_);
+    return true;
+}
+
+bool ImageSequenceExportFrameSource::next(cv::Mat& outBgr) {
+    while (reader_ && reader_->next(outBgr))
+        if (!outBgr.empty()) return true;
+    return false;
+}
+
+void ImageSequenceExportFrameSource::close() { reader_.reset(); }
+
+} // namespace livim
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "export/IExportFrameSource.hpp"
+#include "source/ImageSequence.hpp"
+
+namespace livim {
+
+// Reads a numbered image sequence (or a [start, end) sub-range) for export, decoding ahead in
+// parallel on its own ImageSequenceReader so the export worker only waits on frames in order. A
+// file that fails to decode is skipped, so the output may come up short of frameCount().
+class ImageSequenceExportFrameSource : public IExportFrameSource {
+public:
+    // [startFrame, endFrame) trims the range; endFrame < 0 means to the end.
+    ImageSequenceExportFrameSource(std::string path, int startFrame = 0, int endFrame = -1);
+
+    bool     open() override;
+    int      frameCount() const override { return frameCount_; }
+    cv::Size size() const override { return sequence_ ? sequence_->size() : cv::Size(0, 0); }
+    bool     next(cv::Mat& outBgr) override;
+    void     close() override;
+    void     setLumaOnly(bool enabled) override { lumaOnly_ = enabled; }
+    void     setDecoderThreads(int threads) override { threads_ = threads; }
+
+private:
+    std::string path_;
+    int         startFrame_;
+    int         endFrame_;   // exclusive; -1 = to end
+    std::shared_ptr<const ImageSequence> sequence_;
+    std::unique_ptr<ImageSequenceReader> reader_; // from open(), with threads_
+    int         frameCount_ = -1;
+    bool        lumaOnly_ = false;
+    int         threads_ = 0;
+};
+
+} // namespace livim
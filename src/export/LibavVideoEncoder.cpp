@@ -0,0 +1,197 @@
+#include "export/LibavVideoEncoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/opt.h>
+#include <libswscale/swscale.h>
+}
+
+namespace livim {
+namespace {
+
+struct Candidate {
+    const char*   encoder;
+    AVPixelFormat pixFmt;
+};
+
+std::vector<Candidate> candidatesFor(ExportFormat f) {
+    switch (f) {
+    case ExportFormat::Mp4H264:
+        return {{"libx264", AV_PIX_FMT_YUV420P},
+                {"libopenh264", AV_PIX_FMT_YUV420P},
+                {"mpeg4", AV_PIX_FMT_YUV420P}};
+    case ExportFormat::AviMjpg: return {{"mjpeg", AV_PIX_FMT_YUVJ420P}};
+    case ExportFormat::MkvFfv1: return {{"ffv1", AV_PIX_FMT_GBRP}};
+    }
+    return {};
+}
+
+std::string avError(int err) {
+    char buf[AV_ERROR_MAX_STRING_SIZE] = {};
+    av_strerror(err, buf, sizeof(buf));
+    return buf;
+}
+
+void check(int err, const char* what) {
+    if (err < 0) throw std::runtime_error(std::string(what) + ": " + avError(err));
+}
+
+// Per-codec speed/quality knobs. `s.quality` overrides the preset's quantizer where there is one.
+void tune(const std::string& name, AVCodecContext* ctx, AVDictionary** opts,
+          const VideoEncoderSettings& s, double fps) {
+    const int p = static_cast<int>(s.preset); // Fast, Balanced, Quality
+    if (name == "libx264") {
+        static const char* const kPresets[] = {"ultrafast", "veryfast", "slow"};
+        static const int kCrf[] = {23, 20, 18};
+        av_dict_set(opts, "preset", kPresets[p], 0);
+        av_dict_set_int(opts, "crf", s.quality >= 0 ? std::min(s.quality, 51) : kCrf[p], 0);
+    } else if (name == "libopenh264") {
+        // Rate-controlled only: bits per pixel per frame.
+        static const double kBpp[] = {0.08, 0.12, 0.20};
+        ctx->bit_rate = static_cast<std::int64_t>(kBpp[p] * ctx->width * ctx->height * fps);
+    } else if (name == "mpeg4" || name == "mjpeg") {
+        static const int kQscale[] = {5, 3, 2};
+        const int q = s.quality >= 0 ? std::clamp(s.quality, 1, 31) : kQscale[p];
+        ctx->flags |= AV_CODEC_FLAG_QSCALE;
+        ctx->global_quality = FF_QP2LAMBDA * q;
+        if (name == "mjpeg") ctx->color_range = AVCOL_RANGE_JPEG;
+    } else if (name == "ffv1") {
+        // Version 3 slices are what the encoder threads over; the coder only trades speed for size.
+        static const char* const kCoder[] = {"rice", "range_def", "range_def"};
+        av_dict_set(opts, "level", "3", 0);
+        av_dict_set(opts, "slices", "16", 0);
+        av_dict_set(opts, "coder", kCoder[p], 0);
+        av_dict_set(opts, "context", p == 2 ? "1" : "0", 0);
+    }
+}
+
+} // namespace
+
+bool LibavVideoEncoder::open(std::string& path, const VideoEncoderSettings& settings) {
+    close();
+    for (const Candidate& c : candidatesFor(settings.format)) {
+        const AVCodec* codec = avcodec_find_encoder_by_name(c.encoder);
+        if (!codec) continue;
+        if (tryOpen(codec, c.pixFmt, path, settings)) {
+            codec_ = c.encoder;
+            return true;
+        }
+        release();
+    }
+    return false;
+}
+
+bool LibavVideoEncoder::tryOpen(const AVCodec* codec, int pixFmt, const std::string& path,
+                                const VideoEncoderSettings& settings) {
+    const int w = settings.size.width, h = settings.size.height;
+    if (w <= 0 || h <= 0) return false;
+    if (avformat_alloc_output_context2(&fmt_, nullptr, nullptr, path.c_str()) < 0 || !fmt_)
+        return false;
+
+    ctx_ = avcodec_alloc_context3(codec);
+    if (!ctx_) return false;
+    const double fps = settings.fps > 0.0 ? settings.fps : 30.0;
+    const AVRational rate = av_d2q(fps, 100000);
+    ctx_->width = w;
+    ctx_->height = h;
+    ctx_->pix_fmt = static_cast<AVPixelFormat>(pixFmt);
+    ctx_->framerate = rate;
+    ctx_->time_base = av_inv_q(rate);
+    ctx_->gop_size = std::max(1, static_cast<int>(std::lround(2.0 * fps)));
+    ctx_->thread_count = std::max(0, settings.threads);
+    ctx_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    if (fmt_->oformat->flags & AVFMT_GLOBALHEADER) ctx_->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+
+    AVDictionary* opts = nullptr;
+    tune(codec->name, ctx_, &opts, settings, fps);
+    const int err = avcodec_open2(ctx_, codec, &opts);
+    av_dict_free(&opts);
+    if (err < 0) return false;
+
+    stream_ = avformat_new_stream(fmt_, nullptr);
+    if (!stream_) return false;
+    stream_->time_base = ctx_->time_base;
+    stream_->avg_frame_rate = rate;
+    if (avcodec_parameters_from_context(stream_->codecpar, ctx_) < 0) return false;
+    if (!(fmt_->oformat->flags & AVFMT_NOFILE) &&
+        avio_open(&fmt_->pb, path.c_str(), AVIO_FLAG_WRITE) < 0)
+        return false;
+    if (avformat_write_header(fmt_, nullptr) < 0) return false;
+    headerWritten_ = true;
+
+    frame_ = av_frame_alloc();
+    packet_ = av_packet_alloc();
+    if (!frame_ || !packet_) return false;
+    frame_->format = pixFmt;
+    frame_->width = w;
+    frame_->height = h;
+    if (av_frame_get_buffer(frame_, 0) < 0) return false;
+
+    // Same size, so this is a pure colour-space pass; GBRP output is an exact byte shuffle.
+    sws_ = sws_getContext(w, h, AV_PIX_FMT_BGR24, w, h, ctx_->pix_fmt, SWS_BILINEAR, nullptr,
+                          nullptr, nullptr);
+    return sws_ != nullptr;
+}
+
+void LibavVideoEncoder::write(const cv::Mat& bgr) {
+    if (!ctx_ || !headerWritten_) throw std::runtime_error("encoder is not open");
+    if (bgr.type() != CV_8UC3 || bgr.cols != ctx_->width || bgr.rows != ctx_->height)
+        throw std::runtime_error("frame does not match the encoder's size or format");
+
+    // A frame-threaded encoder may still hold the previous frame; this reallocates only then.
+    check(av_frame_make_writable(frame_), "av_frame_make_writable");
+    const std::uint8_t* const src[] = {bgr.data};
+    const int stride[] = {static_cast<int>(bgr.step)};
+    sws_scale(sws_, src, stride, 0, bgr.rows, frame_->data, frame_->linesize);
+    frame_->pts = nextPts_++;
+    send(frame_);
+}
+
+void LibavVideoEncoder::send(const AVFrame* frame) {
+    check(avcodec_send_frame(ctx_, frame), "avcodec_send_frame");
+    for (;;) {
+        const int err = avcodec_receive_packet(ctx_, packet_);
+        if (err == AVERROR(EAGAIN) || err == AVERROR_EOF) return;
+        check(err, "avcodec_receive_packet");
+        av_packet_rescale_ts(packet_, ctx_->time_base, stream_->time_base);
+        packet_->stream_index = stream_->index;
+        check(av_interleaved_write_frame(fmt_, packet_), "av_interleaved_write_frame");
+    }
+}
+
+void LibavVideoEncoder::close() {
+    if (headerWritten_) {
+        try {
+            send(nullptr); // drain delayed frames
+        } catch (const std::exception&) {
+            // Still write the trailer so what was muxed stays playable.
+        }
+        av_write_trailer(fmt_);
+        headerWritten_ = false;
+    }
+    release();
+}
+
+void LibavVideoEncoder::release() {
+    sws_freeContext(sws_);
+    sws_ = nullptr;
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    avcodec_free_context(&ctx_);
+    if (fmt_) {
+        if (!(fmt_->oformat->flags & AVFMT_NOFILE) && fmt_->pb) avio_closep(&fmt_->pb);
+        avformat_free_context(fmt_);
+        fmt_ = nullptr;
+    }
+    stream_ = nullptr;
+    nextPts_ = 0;
+    headerWritten_ = false;
+}
+
+} // namespace livim
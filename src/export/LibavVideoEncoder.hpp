@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "export/IVideoEncoder.hpp"
+
+struct AVCodec;
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+struct SwsContext;
+
+namespace livim {
+
+// libavcodec/libavformat encoder. Each BGR8 frame is converted by one swscale pass straight into
+// the encoder's own frame buffer (no intermediate copy), and frame + slice threading are on.
+// H.264 tries libx264, then libopenh264, then MPEG-4 part 2 (an LGPL FFmpeg build has no H.264
+// encoder); MJPEG for .avi; FFV1 on planar RGB, so it stays lossless.
+class LibavVideoEncoder : public IVideoEncoder {
+public:
+    LibavVideoEncoder() = default;
+    ~LibavVideoEncoder() override { close(); }
+
+    LibavVideoEncoder(const LibavVideoEncoder&) = delete;
+    LibavVideoEncoder& operator=(const LibavVideoEncoder&) = delete;
+
+    bool        open(std::string& path, const VideoEncoderSettings& settings) override;
+    void        write(const cv::Mat& bgr) override;
+    void        close() override;
+    std::string codecName() const override { return codec_; }
+
+private:
+    bool tryOpen(const AVCodec* codec, int pixFmt, const std::string& path,
+                 const VideoEncoderSettings& settings);
+    void send(const AVFrame* frame); // nullptr flushes; muxes every packet that comes out
+    void release();
+
+    AVFormatContext* fmt_ = nullptr;
+    AVCodecContext*  ctx_ = nullptr;
+    AVStream*        stream_ = nullptr;
+    AVFrame*         frame_ = nullptr;
+    AVPacket*        packet_ = nullptr;
+    SwsContext*      sws_ = nullptr;
+    std::int64_t     nextPts_ = 0;
+    bool             headerWritten_ = false;
+    std::string      codec_;
+};
+
+} // namespace livim
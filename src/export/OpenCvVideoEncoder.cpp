@@ -0,0 +1,40 @@
+#include "export/OpenCvVideoEncoder.hpp"
+
+#include <filesystem>
+
+namespace livim {
+
+bool OpenCvVideoEncoder::open(std::string& path, const VideoEncoderSettings& settings) {
+    auto tryOpen = [&](int fourcc, const std::string& p, const char* name) {
+        if (writer_.open(p, fourcc, settings.fps, settings.size, true)) {
+            codec_ = name;
+            path = p;
+            return true;
+        }
+        return false;
+    };
+    switch (settings.format) {
+    case ExportFormat::Mp4H264:
+        if (tryOpen(cv::VideoWriter::fourcc('a', 'v', 'c', '1'), path, "avc1")) return true;
+        if (tryOpen(cv::VideoWriter::fourcc('m', 'p', '4', 'v'), path, "mp4v")) return true;
+        break;
+    case ExportFormat::AviMjpg:
+        if (tryOpen(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), path, "MJPG")) return true;
+        break;
+    case ExportFormat::MkvFfv1:
+        if (tryOpen(cv::VideoWriter::fourcc('F', 'F', 'V', '1'), path, "FFV1")) return true;
+        break;
+    }
+    // Last resort: Motion JPEG into a sibling .avi.
+    std::filesystem::path fb(path);
+    fb.replace_extension(".avi");
+    return tryOpen(cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fb.string(), "MJPG (fallback .avi)");
+}
+
+void OpenCvVideoEncoder::write(const cv::Mat& bgr) { writer_.write(bgr); }
+
+void OpenCvVideoEncoder::close() {
+    if (writer_.isOpened()) writer_.release();
+}
+
+} // namespace livim
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include <opencv2/videoio.hpp>
+
+#include "export/IVideoEncoder.hpp"
+
+namespace livim {
+
+// cv::VideoWriter with fourcc fallbacks (avc1 -> mp4v, last resort MJPEG into a sibling .avi).
+// No tuning: presets, quality and threads are ignored.
+class OpenCvVideoEncoder : public IVideoEncoder {
+public:
+    ~OpenCvVideoEncoder() override { close(); }
+
+    bool        open(std::string& path, const VideoEncoderSettings& settings) override;
+    void        write(const cv::Mat& bgr) override;
+    void        close() override;
+    std::string codecName() const override { return codec_; }
+
+private:
+    cv::VideoWriter writer_;
+    std::string     codec_;
+};
+
+} // namespace livim
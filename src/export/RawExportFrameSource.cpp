@@ -0,0 +1,36 @@
+#include "export/RawExportFrameSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace livim {
+namespace {
+
+constexpr int kReadAhead = 32; // frames paged in ahead of the reader
+
+} // namespace
+
+RawExportFrameSource::RawExportFrameSource(std::string path, int startFrame, int endFrame)
+    : path_(std::move(path)), startFrame_(std::max(0, startFrame)), endFrame_(endFrame) {}
+
+bool RawExportFrameSource::open() {
+    if (!file_.open(path_)) return false;
+    const int total = static_cast<int>(file_.frameCount());
+    if (endFrame_ < 0 || endFrame_ > total) endFrame_ = total;
+    startFrame_ = std::min(startFrame_, endFrame_);
+    frameCount_ = endFrame_ - startFrame_;
+    delivered_ = 0;
+    file_.mapping()->adviseSequential();
+    return true;
+}
+
+bool RawExportFrameSource::next(cv::Mat& outBgr) {
+    const int i = startFrame_ + delivered_;
+    if (i >= endFrame_) return false;
+    if (delivered_ % (kReadAhead / 2) == 0) file_.willNeed(i, kReadAhead);
+    if (!file_.frame(i, lumaOnly_, outBgr)) return false;
+    ++delivered_;
+    return true;
+}
+
+} // namespace livim
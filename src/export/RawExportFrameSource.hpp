@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "export/IExportFrameSource.hpp"
+#include "source/RawVideoFile.hpp"
+
+namespace livim {
+
+// Reads an uncompressed Y4M or raw planar file (or a [start, end) sub-range) for export, straight
+// out of its own memory mapping, advised for one sequential pass. Frames already in the delivered
+// layout come out as views into the mapping, which stays mapped until this object is destroyed
+// (close() keeps it, as the Exporter may still hold the last frames).
+class RawExportFrameSource : public IExportFrameSource {
+public:
+    // [startFrame, endFrame) trims the range; endFrame < 0 means to the end.
+    RawExportFrameSource(std::string path, int startFrame = 0, int endFrame = -1);
+
+    bool     open() override;
+    int      frameCount() const override { return frameCount_; }
+    cv::Size size() const override { return file_.size(); }
+    bool     next(cv::Mat& outBgr) override;
+    void     close() override {}
+    void     setLumaOnly(bool enabled) override { lumaOnly_ = enabled; }
+
+private:
+    std::string  path_;
+    int          startFrame_;
+    int          endFrame_;   // exclusive; -1 = to end
+    RawVideoFile file_;
+    int          frameCount_ = -1;
+    int          delivered_ = 0;
+    bool         lumaOnly_ = false;
+};
+
+} // namespace livim
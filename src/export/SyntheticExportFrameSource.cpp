@@ -0,0 +1,33 @@
+#include "export/SyntheticExportFrameSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace livim {
+
+SyntheticExportFrameSource::SyntheticExportFrameSource(std::string path, int startFrame,
+                                                       int endFrame)
+    : path_(std::move(path)), startFrame_(std::max(0, startFrame)), endFrame_(endFrame) {}
+
+bool SyntheticExportFrameSource::open() {
+    SyntheticParams params;
+    std::string error;
+    if (!SyntheticVideo::parse(path_, params, error)) return false;
+    video_ = std::make_unique<SyntheticVideo>(params);
+    const int total = static_cast<int>(std::min<std::int64_t>(params.frames, 1 << 30));
+    if (endFrame_ < 0 || endFrame_ > total) endFrame_ = total;
+    startFrame_ = std::min(startFrame_, endFrame_);
+    frameCount_ = endFrame_ - startFrame_;
+    delivered_ = 0;
+    return true;
+}
+
+bool SyntheticExportFrameSource::next(cv::Mat& outBgr) {
+    const int i = startFrame_ + delivered_;
+    if (i >= endFrame_) return false;
+    if (!video_->render(i, lumaOnly_, outBgr)) return false;
+    ++delivered_;
+    return true;
+}
+
+} // namespace livim
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "export/IExportFrameSource.hpp"
+#include "source/SyntheticVideo.hpp"
+
+namespace livim {
+
+// Renders a SyntheticVideo (or a [start, end) sub-range) for export: the same frames, bit for bit,
+// as the live SyntheticSource shows, so export throughput can be benchmarked with no decoder in
+// the measurement.
+class SyntheticExportFrameSource : public IExportFrameSource {
+public:
+    // [startFrame, endFrame) trims the range; endFrame < 0 means to the end.
+    SyntheticExportFrameSource(std::string path, int startFrame = 0, int endFrame = -1);
+
+    bool     open() override;
+    int      frameCount() const override { return frameCount_; }
+    cv::Size size() const override { return video_ ? video_->size() : cv::Size(0, 0); }
+    bool     next(cv::Mat& outBgr) override;
+    void     close() override {}
+    void     setLumaOnly(bool enabled) override { lumaOnly_ = enabled; }
+
+private:
+    std::string path_;
+    int         startFrame_;
+    int         endFrame_;   // exclusive; -1 = to end
+    std::unique_ptr<SyntheticVideo> video_;
+    int         frameCount_ = -1;
+    int         delivered_ = 0;
+    bool        lumaOnly_ = false;
+};
+
+} // namespace livim
@@ -0,0 +1,31 @@
+#include "export/VideoEncoderFactory.hpp"
+
+#include "export/LibavVideoEncoder.hpp"
+#include "export/OpenCvVideoEncoder.hpp"
+
+namespace livim {
+
+std::unique_ptr<IVideoEncoder> openVideoEncoder(EncoderBackend backend, std::string& path,
+                                                const VideoEncoderSettings& settings) {
+    if (backend != EncoderBackend::OpenCv) {
+        auto enc = std::make_unique<LibavVideoEncoder>();
+        if (enc->open(path, settings)) return enc;
+        if (backend == EncoderBackend::Libav) return nullptr;
+    }
+    auto enc = std::make_unique<OpenCvVideoEncoder>();
+    if (enc->open(path, settings)) return enc;
+    return nullptr;
+}
+
+VideoEncoderSettings encoderSettingsFor(const ExportRequest& r, double fps, cv::Size size) {
+    VideoEncoderSettings s;
+    s.format = r.format;
+    s.fps = fps;
+    s.size = size;
+    s.preset = r.preset;
+    s.quality = r.quality;
+    s.threads = r.encoderThreads;
+    return s;
+}
+
+} // namespace livim
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "export/ExportTypes.hpp"
+#include "export/IVideoEncoder.hpp"
+
+namespace livim {
+
+// Opens an encoder for `settings`: libav unless OpenCV is requested, then (for Auto) OpenCV's
+// writer with its own fourcc fallbacks. On success `path` is the file actually created; returns
+// nullptr when nothing could be opened.
+std::unique_ptr<IVideoEncoder> openVideoEncoder(EncoderBackend backend, std::string& path,
+                                                const VideoEncoderSettings& settings);
+
+// The request's encoder tuning at the given output rate and frame size.
+VideoEncoderSettings encoderSettingsFor(const ExportRequest& r, double fps, cv::Size size);
+
+} // namespace livim
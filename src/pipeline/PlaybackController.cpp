@@ -10,7 +10,14 @@
 #include "processing/magnification/SpatialFilter.hpp"
 #include "source/CameraSource.hpp"
 #include "source/FileSource.hpp"
+#include "source/ImageSequenceSource.hpp"
+#include "source/RawFileSource.hpp"
+#include "source/SyntheticSource.hpp"
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include "source/V4l2CameraSource.hpp"
+#endif
 #include "core/IVideoRenderer.hpp"
+#include "core/TaskPool.hpp"
 
 namespace livim {
 
@@ -35,7 +42,17 @@ bool PlaybackController::openFile(const std::string& path) {
     playbackFps_ = 0.0; // follow the source's reported FPS until overridden
     cameraSource_ = false;
     factory_ = [this, path] {
-        return std::make_unique<FileSource>(path, &queue_, &pool_, &instr_);
+        if (SyntheticVideo::handles(path)) // generated, for benchmarks
+            return std::unique_ptr<ISource>(
+                std::make_unique<SyntheticSource>(path, &queue_, &pool_, &instr_));
+        if (RawVideoFile::handles(path)) // uncompressed footage: mapped, not decoded
+            return std::unique_ptr<ISource>(
+                std::make_unique<RawFileSource>(path, &queue_, &pool_, &instr_));
+        if (ImageSequence::handles(path)) // a directory or one frame of numbered stills
+            return std::unique_ptr<ISource>(
+                std::make_unique<ImageSequenceSource>(path, &queue_, &pool_, &instr_));
+        return std::unique_ptr<ISource>(
+            std::make_unique<FileSource>(path, &queue_, &pool_, &instr_));
     };
     teardownThreads();
     if (!buildAndStart()) { // bad path / unsupported codec
@@ -47,12 +64,18 @@ bool PlaybackController::openFile(const std::string& path) {
     return true;
 }
 
-bool PlaybackController::openCamera(int deviceIndex) {
+bool PlaybackController::openCamera(int deviceIndex, const CameraMode& mode) {
     std::lock_guard<std::mutex> lg(mu_);
     playbackFps_ = 0.0; // follow the source's reported FPS until overridden
     cameraSource_ = true;
-    factory_ = [this, deviceIndex] {
-        return std::make_unique<CameraSource>(deviceIndex, &queue_, &pool_, &instr_);
+    factory_ = [this, deviceIndex, mode] {
+#if !defined(_WIN32) && !defined(__APPLE__)
+        if (V4l2CameraSource::usable(deviceIndex)) // zero-copy mmap capture, driver timestamps
+            return std::unique_ptr<ISource>(
+                std::make_unique<V4l2CameraSource>(deviceIndex, mode, &queue_, &pool_, &instr_));
+#endif
+        return std::unique_ptr<ISource>(
+            std::make_unique<CameraSource>(deviceIndex, mode, &queue_, &pool_, &instr_));
     };
     teardownThreads();
     if (!buildAndStart()) {
@@ -86,6 +109,7 @@ bool PlaybackController::buildAndStart() {
 
     source_ = std::move(source);
     source_->setLoop(loop_);
+    source_->setLumaOnly(lumaOnly());
 
     // Seed the playback cadence before the thread starts so the first frame is paced correctly.
     reportedFps_ = source_->reportedFps();
@@ -168,13 +192,28 @@ ProcessorConfig PlaybackController::composeConfig() const {
     cfg.grayscale = grayscale_;
     cfg.preprocess = preprocess_;
     cfg.magnification = magParams_;
+    // Camera pts are capture times; a file's advance one nominal frame per frame, which is one
+    // Capture FPS sample of the scene whatever the file's rate.
+    if (source_ && source_->kind() == SourceKind::Camera)
+        cfg.ptsScale = 1.0;
+    else if (reportedFps_ > 0.0 && magParams_.framerate > 0.0)
+        cfg.ptsScale = reportedFps_ / magParams_.framerate;
     // Original-only view: bypass magnification entirely -- its output isn't displayed.
     if (!magnifyActive_) cfg.magnification.mode = MagnificationMode::None;
     return cfg;
 }
 
 void PlaybackController::setGrayscale(bool enabled) {
-    mutateConfig([&] { grayscale_ = enabled; });
+    mutateConfig([&] {
+        grayscale_ = enabled;
+        if (source_) source_->setLumaOnly(lumaOnly());
+    });
+}
+
+void PlaybackController::setOriginalShown(bool shown) {
+    std::lock_guard<std::mutex> lg(mu_);
+    originalShown_ = shown;
+    if (source_) source_->setLumaOnly(lumaOnly());
 }
 
 bool PlaybackController::grayscaleEnabled() {
@@ -333,7 +372,23 @@ void PlaybackController::teardownThreads() {
 StatsSnapshot PlaybackController::stats() {
     instr_.setSourceDrops(queue_.drops());
     instr_.setQueueDepth(queue_.size());
-    return instr_.snapshot();
+    instr_.setQueueWaits(queue_.pushWaits(), queue_.pushBlockedNs());
+    instr_.setPoolWaits(pool_.waits(), pool_.blockedNs());
+    StatsSnapshot s = instr_.snapshot();
+    s.taskPool = sharedTaskPool().stats();
+    return s;
+}
+
+StatsSnapshot PlaybackController::sampleStats() const {
+    StatsSnapshot s = instr_.sample();
+    s.sourceDrops = queue_.drops();
+    s.queueDepth = queue_.size();
+    s.queueWaits = queue_.pushWaits();
+    s.queueBlockedMs = static_cast<double>(queue_.pushBlockedNs()) / 1e6;
+    s.poolWaits = pool_.waits();
+    s.poolBlockedMs = static_cast<double>(pool_.blockedNs()) / 1e6;
+    s.taskPool = sharedTaskPool().stats();
+    return s;
 }
 
 } // namespace livim
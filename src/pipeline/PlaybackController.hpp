@@ -11,6 +11,7 @@
 #include "core/LatestFrameMailbox.hpp"
 #include "core/PipelineTypes.hpp"
 #include "processing/IProcessor.hpp"
+#include "source/CameraMode.hpp"
 
 namespace livim {
 
@@ -32,7 +33,8 @@ public:
     void bindRenderer(IVideoRenderer* renderer);
 
     bool openFile(const std::string& path);
-    bool openCamera(int deviceIndex);
+    // `mode` as for CameraSource; the default picks automatically.
+    bool openCamera(int deviceIndex, const CameraMode& mode = {});
 
     void play();
     void pause();
@@ -65,6 +67,8 @@ public:
 
     void publishConfig(ProcessorConfig cfg) { config_.publish(std::move(cfg)); }
     StatsSnapshot stats();
+    // Side-effect-free variant of stats() (no fps/drop EMA) for the StatsExporter thread.
+    StatsSnapshot sampleStats() const;
 
     // --- Processing controls ---
 
@@ -72,6 +76,10 @@ public:
     void setGrayscale(bool enabled);
     bool grayscaleEnabled();
 
+    // Whether the view shows the original pane. With grayscale on and no original shown, a file
+    // source decodes straight to luma and skips the colour conversion. Remembered.
+    void setOriginalShown(bool shown);
+
     // Channels the active source produces (1 = already grayscale, 3 = BGR); 0 if no frame yet.
     int sourceChannels();
 
@@ -119,6 +127,9 @@ private:
     // Compose the live ProcessorConfig from the remembered preferences. Caller must hold mu_.
     ProcessorConfig composeConfig() const;
 
+    // Nothing on screen needs colour. Caller must hold mu_.
+    bool lumaOnly() const { return grayscale_ && !originalShown_; }
+
     // Lock mu_, apply the mutation to the remembered state, republish the composed config.
     template <class F>
     void mutateConfig(F&& mutate) {
@@ -147,6 +158,7 @@ private:
     bool loop_ = false;
     bool cameraSource_ = false; // true => camera (queue uses Drop); false => file (Block/lossless)
     bool grayscale_ = false;
+    bool originalShown_ = false; // the default view is Processed only
     PreprocessParams preprocess_;
     MagnificationParams magParams_;
     bool magnifyActive_ = true; // false (original-only view) -> bypass magnification
@@ -2,11 +2,24 @@
 
 #include <cstddef>
 
+#include "core/Instrumentation.hpp"
+
 #include "processing/GrayscaleProcessor.hpp"
 #include "processing/MagnificationProcessor.hpp"
 #include "processing/PreprocessProcessor.hpp"
 
 namespace livim {
+namespace {
+
+FrameStamp stampAfter(Stage s) {
+    switch (s) {
+    case Stage::Preprocess: return FrameStamp::Preprocessed;
+    case Stage::Grayscale:  return FrameStamp::Grayscaled;
+    default:                return FrameStamp::Magnified;
+    }
+}
+
+} // namespace
 
 std::vector<std::unique_ptr<IProcessor>> buildProcessors() {
     std::vector<std::unique_ptr<IProcessor>> procs;
@@ -17,11 +30,15 @@ std::vector<std::unique_ptr<IProcessor>> buildProcessors() {
 }
 
 FrameRef runChainOnce(const std::vector<std::unique_ptr<IProcessor>>& chain, const FrameRef& in,
-                      const ProcessorConfig& cfg, FrameRef& original) {
+                      const ProcessorConfig& cfg, FrameRef& original, Instrumentation* instr) {
     FrameRef cur = in;
     original = nullptr;
     for (std::size_t i = 0; i < chain.size(); ++i) {
-        cur = chain[i]->process(cur, cfg);
+        {
+            StageTimer timer(instr, chain[i]->stage(), in->seq);
+            cur = chain[i]->process(cur, cfg);
+        }
+        cur->stamp(stampAfter(chain[i]->stage()));
         if (i == 0) original = cur; // pre-magnification tap
     }
     if (!original) original = in;
@@ -8,6 +8,8 @@
 
 namespace livim {
 
+class Instrumentation;
+
 // Assembles and runs the magnification processing chain; shared by the live pipeline and the
 // offline Exporter so the two cannot drift.
 
@@ -16,8 +18,10 @@ namespace livim {
 std::vector<std::unique_ptr<IProcessor>> buildProcessors();
 
 // Run one frame through `chain` and return the final frame. `original` is set to the FIRST stage's
-// output (the pre-magnification tap); if the chain is empty, `original` == `in`.
+// output (the pre-magnification tap); if the chain is empty, `original` == `in`. With `instr`, each
+// stage's process() time is recorded into its Stage histogram.
 FrameRef runChainOnce(const std::vector<std::unique_ptr<IProcessor>>& chain, const FrameRef& in,
-                      const ProcessorConfig& cfg, FrameRef& original);
+                      const ProcessorConfig& cfg, FrameRef& original,
+                      Instrumentation* instr = nullptr);
 
 } // namespace livim
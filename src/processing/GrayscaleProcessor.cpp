@@ -1,16 +1,22 @@
 #include "processing/GrayscaleProcessor.hpp"
 
-#include <opencv2/imgproc.hpp>
+#include <memory>
+
+#include "core/FrameFormat.hpp"
 
 namespace livim {
 
 FrameRef GrayscaleProcessor::process(const FrameRef& in, const ProcessorConfig& cfg) {
     if (!cfg.grayscale) return in;
-    if (in->image.channels() == 1) return in;
+    if (in->format == PixelFormat::Gray8) return in;
 
     // Fresh Frame: never write into the pooled input buffer (frames are treated as immutable).
     auto out = std::make_shared<Frame>(*in);
-    cv::cvtColor(in->image, out->image, cv::COLOR_BGR2GRAY);
+    out->image = lumaOf(*in);
+    // A planar frame's Y plane is handed on as a view, which must keep the input alive; anything
+    // else is converted into a new buffer and lets go of the input's backing.
+    const bool view = in->format == PixelFormat::I420 || in->format == PixelFormat::NV12;
+    out->backing = view ? std::shared_ptr<const void>(in) : nullptr;
     out->format = PixelFormat::Gray8;
     return out;
 }
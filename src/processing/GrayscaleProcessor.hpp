@@ -4,11 +4,12 @@
 
 namespace livim {
 
-// Converts a BGR cv::Mat to single-channel Gray8. Identity when grayscale is disabled or the frame
-// is already single channel.
+// Converts a frame to single-channel Gray8: BGR is converted, YUV gives up its Y plane (a view for
+// I420/NV12). Identity when grayscale is disabled or the frame is already single channel.
 class GrayscaleProcessor : public IProcessor {
 public:
     FrameRef process(const FrameRef& in, const ProcessorConfig& cfg) override;
+    Stage stage() const override { return Stage::Grayscale; }
 };
 
 } // namespace livim
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/Frame.hpp"
+#include "core/Instrumentation.hpp" // Stage
 
 namespace livim {
 
@@ -45,6 +46,11 @@ struct ProcessorConfig {
     bool grayscale = false;
     PreprocessParams preprocess;
     MagnificationParams magnification;
+    // Capture time per unit of ptsUs: 1 where pts are capture times (a camera), file fps / Capture
+    // FPS where they run at a file's nominal rate however fast it was shot. Magnification counts
+    // the samples at magnification.framerate between two frames from their pts delta, so dropped
+    // or irregular frames keep time; 0 = every frame is one step.
+    double ptsScale = 0.0;
 };
 
 class IProcessor {
@@ -54,6 +60,9 @@ public:
     // Runs on the processing thread. Must preserve frame order and metadata (seq/pts/captureTs).
     virtual FrameRef process(const FrameRef& in, const ProcessorConfig& cfg) = 0;
 
+    // The histogram runChainOnce records this stage's process() time into.
+    virtual Stage stage() const = 0;
+
     // Drop any retained temporal state so the next process() behaves as the first frame (used to
     // recover after a stage throws mid-frame). Stateless stages need do nothing.
     virtual void reset() {}
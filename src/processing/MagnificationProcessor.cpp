@@ -3,18 +3,55 @@
 #include <algorithm>
 #include <utility>
 
+#include "core/FrameFormat.hpp"
 #include "processing/magnification/SpatialFilter.hpp" // calculateMaxLevels
 
 namespace livim {
+namespace {
+
+// A longer pts gap, or one backwards, is a seek, a loop or a resumed pause rather than dropped
+// frames: the filters carry on as if it were one frame.
+constexpr std::int64_t kMaxGapUs = 1'000'000;
+
+} // namespace
 
 void MagnificationProcessor::reset() {
     motion_.reset();
     color_.reset();
     riesz_.reset();
     tracker_.reset();
+    havePts_ = false;
+}
+
+double MagnificationProcessor::stepsTo(const Frame& in, const ProcessorConfig& cfg) {
+    const std::int64_t gap = in.ptsUs - lastPtsUs_;
+    const bool had = havePts_;
+    lastPtsUs_ = in.ptsUs;
+    havePts_ = true;
+    const double fps = cfg.magnification.framerate;
+    if (!had || cfg.ptsScale <= 0.0 || fps <= 0.0 || gap <= 0 || gap > kMaxGapUs) return 1.0;
+    // In samples of the rate the filters are designed at, not of the source's own rate.
+    const double sampleUs = 1'000'000.0 / fps;
+    return static_cast<double>(gap) * cfg.ptsScale / sampleUs;
+}
+
+int MagnificationProcessor::levelsFor(const FrameRef& in, const ProcessorConfig& cfg) {
+    if (cfg.magnification.mode == MagnificationMode::None || in->image.empty()) return 0;
+    const int maxLevels = calculateMaxLevels(cv::Size(in->width, in->height));
+    return maxLevels < 1 ? 0 : std::clamp(cfg.magnification.levels, 1, maxLevels);
 }
 
 FrameRef MagnificationProcessor::process(const FrameRef& in, const ProcessorConfig& cfg) {
+    return run(in, cfg, nullptr);
+}
+
+FrameRef MagnificationProcessor::process(const FrameRef& in, const ProcessorConfig& cfg,
+                                         const magcore::SpatialInput& spatial) {
+    return run(in, cfg, &spatial);
+}
+
+FrameRef MagnificationProcessor::run(const FrameRef& in, const ProcessorConfig& cfg,
+                                     const magcore::SpatialInput* spatial) {
     const MagnificationParams& p = cfg.magnification;
 
     // Identity when disabled; free state so a later re-enable starts cleanly.
@@ -24,16 +61,17 @@ FrameRef MagnificationProcessor::process(const FrameRef& in, const ProcessorConf
             color_.reset();
             riesz_.reset();
             tracker_.disable();
+            havePts_ = false;
         }
         return in;
     }
 
     // Clamp levels to what this frame size supports; too small to magnify (<=5px) -> identity.
-    const int maxLevels = calculateMaxLevels(in->image.size());
-    if (maxLevels < 1) return in;
-    const int levels = std::clamp(p.levels, 1, maxLevels);
-    const int channels = in->image.channels();
-    const cv::Size size = in->image.size();
+    const int levels = levelsFor(in, cfg);
+    if (levels < 1) return in;
+    const int channels = colourChannels(in->format);
+    const cv::Size size(in->width, in->height);
+    const double steps = stepsTo(*in, cfg);
 
     // Reset temporal state on any structural change (see StructuralTracker).
     if (tracker_.update(cfg, levels, channels, size)) {
@@ -45,23 +83,37 @@ FrameRef MagnificationProcessor::process(const FrameRef& in, const ProcessorConf
     cv::Mat out8u;
     PixelFormat fmt = in->format;
     bool produced = false;
+    // A sweep shares the spatial front half across variants; alone, build it here.
+    magcore::SpatialInput own;
+    if (!spatial) {
+        own = magcore::prepareSpatial(*in, p.mode, levels);
+        spatial = &own;
+    }
     switch (p.mode) {
     case MagnificationMode::Laplace:
-        produced = magcore::magnifyMotion(in->image, p, levels, channels, motion_, out8u, fmt);
+        produced = magcore::magnifyMotion(*spatial, p, motion_, steps, out8u, fmt);
         break;
     case MagnificationMode::Color:
-        produced = magcore::magnifyColor(in->image, p, levels, channels, color_, out8u, fmt);
+        produced = magcore::magnifyColor(*spatial, p, color_, steps, out8u, fmt);
         break;
     case MagnificationMode::Phase:
-        produced = magcore::magnifyRiesz(in->image, p, levels, channels, riesz_, out8u, fmt);
+        produced = magcore::magnifyRiesz(*spatial, p, riesz_, steps, out8u, fmt);
         break;
     case MagnificationMode::None:
         return in;
     }
     if (!produced) return in; // warmup / unsupported input: emit the input unchanged
+    if (isYuv(in->format) && fmt == PixelFormat::Gray8) {
+        // Only the luminance was magnified: put the input's chroma back beside it.
+        cv::Mat yuv;
+        replaceLuma(*in, out8u, yuv);
+        out8u = std::move(yuv);
+        fmt = in->format;
+    }
 
     auto out = std::make_shared<Frame>(*in);
     out->image = std::move(out8u); // fresh buffer; never aliases in->image
+    out->backing.reset();          // so it doesn't keep the input's driver buffer or mapping
     out->format = fmt;
     return out;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include <opencv2/core.hpp>
 
 #include "processing/IProcessor.hpp"
@@ -9,17 +11,35 @@ namespace livim {
 
 // CPU Eulerian video magnification stage wrapping magnification/MagnifyCore.hpp. Owns the per-mode
 // temporal state and self-resets on structural changes (mode/levels/size/channels/preprocess
-// geometry). Identity when mode == None.
+// geometry). Identity when mode == None. The temporal filters step by each frame's pts delta (see
+// ProcessorConfig::ptsScale), so frames the live queue drops don't shift the band.
 class MagnificationProcessor : public IProcessor {
 public:
     FrameRef process(const FrameRef& in, const ProcessorConfig& cfg) override;
+    Stage stage() const override { return Stage::Magnify; }
     void reset() override;
 
+    // process() on a spatial decomposition of `in` shared with other instances (a parameter
+    // sweep). `spatial` must come from magcore::prepareSpatial() on `in` with cfg's mode and
+    // levelsFor(in, cfg); `spatial` is only read.
+    FrameRef process(const FrameRef& in, const ProcessorConfig& cfg,
+                     const magcore::SpatialInput& spatial);
+
+    // The pyramid depth process() uses for `in`: cfg's levels clamped to what the frame supports,
+    // or 0 when it passes `in` through unchanged.
+    static int levelsFor(const FrameRef& in, const ProcessorConfig& cfg);
+
 private:
+    FrameRef run(const FrameRef& in, const ProcessorConfig& cfg,
+                 const magcore::SpatialInput* spatial);
+    double stepsTo(const Frame& in, const ProcessorConfig& cfg); // see magcore's `steps`
+
     magcore::StructuralTracker tracker_;
     magcore::MotionState       motion_;
     magcore::ColorState        color_;
     magcore::RieszState        riesz_;
+    std::int64_t               lastPtsUs_ = 0;
+    bool                       havePts_ = false;
 };
 
 } // namespace livim
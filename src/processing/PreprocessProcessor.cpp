@@ -5,7 +5,47 @@
 
 #include <opencv2/imgproc.hpp>
 
+#include "core/FrameFormat.hpp"
+
 namespace livim {
+namespace {
+
+// `from` cropped to `r`, into `to` (a view of the output), area-averaged if the sizes differ.
+void fit(const cv::Mat& from, const cv::Rect& r, cv::Mat to) {
+    if (r.size() == to.size()) from(r).copyTo(to);
+    else cv::resize(from(r), to, to.size(), 0, 0, cv::INTER_AREA);
+}
+
+// The same crop and downscale plane by plane, so the chroma is never converted: on even
+// coordinates, to keep it sited. NV12 stays NV12; I420 and YUYV come out as I420.
+cv::Mat cropYuv(const Frame& in, cv::Rect roi, int divisor, PixelFormat& format) {
+    roi.x &= ~1;
+    roi.y &= ~1;
+    roi.width = std::max(2, std::min(roi.width, in.width - roi.x) & ~1);
+    roi.height = std::max(2, std::min(roi.height, in.height - roi.y) & ~1);
+    const int dw = std::max(2, (roi.width / divisor) & ~1);
+    const int dh = std::max(2, (roi.height / divisor) & ~1);
+
+    format = in.format == PixelFormat::NV12 ? PixelFormat::NV12 : PixelFormat::I420;
+    cv::Mat packed;
+    if (in.format == PixelFormat::YUYV) yuyvToI420(in.image, packed);
+    const Planes420 src =
+        planes420(packed.empty() ? in.image : packed, in.width, in.height, format);
+
+    cv::Mat outMat(dh * 3 / 2, dw, CV_8UC1);
+    const Planes420 dst = planes420(outMat, dw, dh, format);
+    fit(src.y, roi, dst.y);
+    const cv::Rect half(roi.x / 2, roi.y / 2, roi.width / 2, roi.height / 2);
+    if (format == PixelFormat::NV12) {
+        fit(src.uv, half, dst.uv);
+    } else {
+        fit(src.u, half, dst.u);
+        fit(src.v, half, dst.v);
+    }
+    return outMat;
+}
+
+} // namespace
 
 FrameRef PreprocessProcessor::process(const FrameRef& in, const ProcessorConfig& cfg) {
     if (in->image.empty()) return in;
@@ -15,21 +55,31 @@ FrameRef PreprocessProcessor::process(const FrameRef& in, const ProcessorConfig&
     if (!p.roiEnabled && divisor == 1) return in;
 
     const cv::Mat& src = in->image;
+    const int cols = in->width, rows = in->height; // not src's: a YUV image has extra rows
 
     // ROI is normalized [0,1] against the FULL source frame; clamp inside the frame, keep >= 1px.
-    cv::Rect roi(0, 0, src.cols, src.rows);
+    cv::Rect roi(0, 0, cols, rows);
     if (p.roiEnabled) {
-        int x = static_cast<int>(std::lround(static_cast<double>(p.roiX) * src.cols));
-        int y = static_cast<int>(std::lround(static_cast<double>(p.roiY) * src.rows));
-        int w = static_cast<int>(std::lround(static_cast<double>(p.roiW) * src.cols));
-        int h = static_cast<int>(std::lround(static_cast<double>(p.roiH) * src.rows));
-        x = std::clamp(x, 0, src.cols - 1);
-        y = std::clamp(y, 0, src.rows - 1);
-        w = std::clamp(w, 1, src.cols - x);
-        h = std::clamp(h, 1, src.rows - y);
+        int x = static_cast<int>(std::lround(static_cast<double>(p.roiX) * cols));
+        int y = static_cast<int>(std::lround(static_cast<double>(p.roiY) * rows));
+        int w = static_cast<int>(std::lround(static_cast<double>(p.roiW) * cols));
+        int h = static_cast<int>(std::lround(static_cast<double>(p.roiH) * rows));
+        x = std::clamp(x, 0, cols - 1);
+        y = std::clamp(y, 0, rows - 1);
+        w = std::clamp(w, 1, cols - x);
+        h = std::clamp(h, 1, rows - y);
         roi = cv::Rect(x, y, w, h);
     }
 
+    if (isYuv(in->format)) {
+        auto out = std::make_shared<Frame>(*in);
+        out->image = cropYuv(*in, roi, divisor, out->format);
+        out->backing.reset(); // a copy: the input's driver buffer or mapping can go
+        out->width = out->image.cols;
+        out->height = out->image.rows * 2 / 3;
+        return out;
+    }
+
     // Crop first (header-only view), then resize. Downstream must get its own buffer: the pooled
     // input frame is recycled once we return, so a plain crop is copied out.
     cv::Mat cropped = src(roi);
@@ -45,6 +95,7 @@ FrameRef PreprocessProcessor::process(const FrameRef& in, const ProcessorConfig&
     // Update the size fields; the renderer keys on Frame::width/height, not the cv::Mat dims.
     auto out = std::make_shared<Frame>(*in);
     out->image = outMat;
+    out->backing.reset();
     out->width = outMat.cols;
     out->height = outMat.rows;
     return out;
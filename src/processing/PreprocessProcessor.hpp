@@ -9,6 +9,7 @@ namespace livim {
 class PreprocessProcessor : public IProcessor {
 public:
     FrameRef process(const FrameRef& in, const ProcessorConfig& cfg) override;
+    Stage stage() const override { return Stage::Preprocess; }
 };
 
 } // namespace livim
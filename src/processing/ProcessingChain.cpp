@@ -5,6 +5,7 @@
 
 #include "core/Instrumentation.hpp"
 #include "core/LatestFrameMailbox.hpp"
+#include "core/Trace.hpp"
 #include "processing/ChainBuilder.hpp"
 
 namespace livim {
@@ -22,7 +23,10 @@ void ProcessingChain::setProcessors(std::vector<std::unique_ptr<IProcessor>> pro
 void ProcessingChain::start() {
     if (thread_.joinable()) return;
     stop_.store(false, std::memory_order_release);
-    thread_ = std::thread([this] { run(); });
+    thread_ = std::thread([this] {
+        trace::setThreadName("processing");
+        run();
+    });
 }
 
 void ProcessingChain::stop() {
@@ -34,18 +38,27 @@ void ProcessingChain::stop() {
 void ProcessingChain::run() {
     FrameRef in;
     while (!stop_.load(std::memory_order_acquire)) {
-        if (!in_->pop(in)) break;
+        {
+            trace::Span span("queue_pop");
+            if (!in_->pop(in)) break;
+            span.setSeq(in->seq);
+        }
+        const Timestamp dequeued = now();
+        in->stamp(FrameStamp::Dequeued, dequeued);
+        if (instr_) instr_->recordStage(Stage::QueueWait, dequeued - in->captureTs);
 
         const std::shared_ptr<const ProcessorConfig> cfg = config_->read();
 
         try {
             FrameRef original;
-            const FrameRef cur = runChainOnce(chain_, in, *cfg, original);
+            const FrameRef cur = runChainOnce(chain_, in, *cfg, original, instr_);
 
             // Publish both in one object so the two panes are always the SAME frame.
             auto pair = std::make_shared<DisplayFrame>();
             pair->processed = cur;
             pair->original = original;
+            StageTimer timer(instr_, Stage::Publish, in->seq);
+            cur->stamp(FrameStamp::Published);
             out_->publish(std::move(pair));
         } catch (const std::exception&) {
             // A stage threw: don't let it std::terminate the app. Reset the stateful stages (a
@@ -55,6 +68,7 @@ void ProcessingChain::run() {
             auto pair = std::make_shared<DisplayFrame>();
             pair->processed = in;
             pair->original = in;
+            in->stamp(FrameStamp::Published);
             out_->publish(std::move(pair));
         } catch (...) {
             if (instr_) instr_->onProcessingError();
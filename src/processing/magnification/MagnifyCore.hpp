@@ -9,6 +9,8 @@
 #include <opencv2/imgproc.hpp>
 
 #include "core/Frame.hpp"
+#include "core/FrameFormat.hpp"
+#include "core/TaskPool.hpp"
 #include "processing/IProcessor.hpp"
 #include "processing/magnification/RieszPyramid.hpp"
 #include "processing/magnification/SpatialFilter.hpp"
@@ -16,8 +18,13 @@
 
 // Eulerian video magnification core: per-frame ports of the reference Magnificator's
 // laplaceMagnify / colorMagnify / rieszMagnify (src/main/magnification/Magnificator.cpp).
-// Each magnify*() returns true and fills (out8u, outFmt) with the 8-bit result, or false to
-// signal a passthrough (warmup, or a mode/input combination the reference did not process).
+// Each magnify*() takes prepareSpatial()'s decomposition of the frame, returns true and fills
+// (out8u, outFmt) with the 8-bit result, or false to signal a passthrough (warmup, or a mode/input
+// combination the reference did not process). `steps` is the time since the previous call in
+// samples at p.framerate: 1 when every frame arrives, 2 after a drop, and fractional for irregular
+// timestamps. The temporal filters adapt to it, so the magnified band stays where p puts it
+// whatever rate frames are processed at. Motion mode decays by the fractional count exactly;
+// colour and phase advance by whole samples and carry the fraction into the next frame.
 namespace livim::magcore {
 
 // --- per-mode temporal state ------------------------------------------------------------------
@@ -29,8 +36,10 @@ struct MotionState {
 };
 
 struct ColorState {
-    cv::Mat window; // rolling temporal window of the smallest Gaussian level, one column per frame
-    void reset() { window = cv::Mat(); }
+    cv::Mat window; // rolling temporal window of the smallest Gaussian level, one column per sample
+    cv::Mat last;   // the previous frame's smallest level, to interpolate missed samples from
+    double  owed = 0.0; // samples due since the last column, less those already added
+    void reset() { window = cv::Mat(); last = cv::Mat(); owed = 0.0; }
 };
 
 struct RieszState {
@@ -79,37 +88,107 @@ struct StructuralTracker {
     }
 };
 
-// --- Motion / Laplace (reference laplaceMagnify) ------------------------------------------------
-inline bool magnifyMotion(const cv::Mat& in8u, const MagnificationParams& p, int levels,
-                          int channels, MotionState& st, cv::Mat& out8u, PixelFormat& outFmt) {
-    const bool color = channels >= 3;
+// --- spatial front half -------------------------------------------------------------------------
+// The parameter-independent part of each magnify*(): float/Lab conversion and the spatial pyramid.
+// It depends only on the input, the mode and the level count, so a parameter sweep builds it once
+// per frame and hands it to every variant that shares them. The magnify*() overloads taking it
+// treat it as read-only.
+struct SpatialInput {
+    MagnificationMode mode = MagnificationMode::None;
+    int levels = 0;
+    bool color = false;
+    cv::Mat input;                // Laplace: Lab/gray in [0,1]; Color: BGR/gray in [0,255]
+    std::vector<cv::Mat> pyramid; // Laplace: levels+1 bands; Color: Gaussian levels
+    std::vector<cv::Mat> lab;     // Phase: split Lab planes, [0] is the magnified luminance; only
+                                  // that one for a YUV frame
+};
 
-    cv::Mat input;
-    if (color) {
-        in8u.convertTo(input, CV_32FC3, 1.0 / 255.0f);
-        cv::cvtColor(input, input, cv::COLOR_BGR2Lab);
-    } else {
-        in8u.convertTo(input, CV_32FC1, 1.0 / 255.0f);
+inline SpatialInput prepareSpatial(const cv::Mat& in8u, MagnificationMode mode, int levels,
+                                   int channels) {
+    SpatialInput s;
+    s.mode = mode;
+    s.levels = levels;
+    s.color = channels >= 3;
+    switch (mode) {
+    case MagnificationMode::Laplace:
+        if (s.color) {
+            in8u.convertTo(s.input, CV_32FC3, 1.0 / 255.0f);
+            cv::cvtColor(s.input, s.input, cv::COLOR_BGR2Lab);
+        } else {
+            in8u.convertTo(s.input, CV_32FC1, 1.0 / 255.0f);
+        }
+        buildLaplacePyrFromImg(s.input, levels, s.pyramid);
+        break;
+    case MagnificationMode::Color:
+        // Stays in [0,255] (NO 1/255 scaling); the output is rescaled by its min/max at the end.
+        in8u.convertTo(s.input, s.color ? CV_32FC3 : CV_32FC1);
+        buildGaussPyrFromImg(s.input, levels, s.pyramid);
+        break;
+    case MagnificationMode::Phase: {
+        // The reference processed only multi-channel input here (grayscale mode produced no
+        // frame). Lab, so only luminance is magnified.
+        if (!s.color) break;
+        cv::Mat lab;
+        in8u.convertTo(lab, CV_32FC3, 1.0 / 255.0);
+        cv::cvtColor(lab, lab, cv::COLOR_BGR2Lab);
+        cv::split(lab, s.lab);
+        break;
     }
+    case MagnificationMode::None:
+        break;
+    }
+    return s;
+}
+
+// A frame in any format. Laplace and Phase take a YUV frame's Y plane as its luminance (Laplace
+// as if the frame were gray, Phase as Lab's L), so nothing is converted; the result is Gray8 and
+// the caller carries the chroma over. Colour needs all three channels and converts to BGR.
+inline SpatialInput prepareSpatial(const Frame& in, MagnificationMode mode, int levels) {
+    if (!isYuv(in.format))
+        return prepareSpatial(in.image, mode, levels, colourChannels(in.format));
+    if (mode == MagnificationMode::Color) return prepareSpatial(bgrOf(in), mode, levels, 3);
+    SpatialInput s;
+    s.mode = mode;
+    s.levels = levels;
+    const cv::Mat y = lumaOf(in);
+    if (mode == MagnificationMode::Laplace) {
+        y.convertTo(s.input, CV_32FC1, 1.0 / 255.0);
+        buildLaplacePyrFromImg(s.input, levels, s.pyramid);
+    } else if (mode == MagnificationMode::Phase) {
+        s.lab.resize(1);
+        y.convertTo(s.lab[0], CV_32FC1, 100.0 / 255.0); // L's range in a float Lab image
+    }
+    return s;
+}
 
-    std::vector<cv::Mat> inputPyramid;
-    buildLaplacePyrFromImg(input, levels, inputPyramid);
+// --- Motion / Laplace (reference laplaceMagnify) ------------------------------------------------
+inline bool magnifyMotion(const SpatialInput& in, const MagnificationParams& p, MotionState& st,
+                          double steps, cv::Mat& out8u, PixelFormat& outFmt) {
+    const bool color = in.color;
+    const int levels = in.levels;
+    const cv::Mat& input = in.input;
+    const std::vector<cv::Mat>& inputPyramid = in.pyramid;
 
     const bool firstFrame = st.empty();
     cv::Mat output;
     if (firstFrame) {
-        st.lowpassHi = inputPyramid;
-        st.lowpassLo = inputPyramid;
-        output = input;
+        // The filters update their registers in place and `in` may be shared: own them.
+        st.lowpassHi.resize(inputPyramid.size());
+        for (std::size_t i = 0; i < inputPyramid.size(); ++i)
+            st.lowpassHi[i] = inputPyramid[i].clone();
+        st.lowpassLo = st.lowpassHi; // iirFilter separates the two on first use
+        output = input.clone();
     } else {
         std::vector<cv::Mat> motionPyramid(levels + 1);
         for (int curLevel = 0; curLevel < levels; ++curLevel) {
             iirFilter(inputPyramid.at(curLevel), motionPyramid.at(curLevel),
-                      st.lowpassHi.at(curLevel), st.lowpassLo.at(curLevel), p.coLow, p.coHigh);
+                      st.lowpassHi.at(curLevel), st.lowpassLo.at(curLevel), p.coLow, p.coHigh,
+                      steps);
         }
-        // The residual level is zeroed by the amplification below; seed it so it has the right
-        // size/type (the reference kept it in a member pyramid).
-        motionPyramid.at(levels) = inputPyramid.at(levels);
+        // The residual level is dropped; a fresh zero level, since `in` may be shared between
+        // variants and must not be written.
+        motionPyramid.at(levels) =
+            cv::Mat::zeros(inputPyramid.at(levels).size(), inputPyramid.at(levels).type());
 
         const int w = input.size().width;
         const int h = input.size().height;
@@ -123,13 +202,15 @@ inline bool magnifyMotion(const cv::Mat& in8u, const MagnificationParams& p, int
         // Representative wavelength; halved for every pyramid level below.
         float lambda = static_cast<float>(std::sqrt(double(w * w + h * h)) / 3.0);
 
-        // Zero the residual and the highest-resolution difference level, amplify the rest.
+        // Drop the residual and the highest-resolution difference level, amplify the rest. The
+        // dropped ones are replaced rather than scaled in place: cv::Mat::zeros never aliases.
         for (int curLevel = levels; curLevel >= 0; --curLevel) {
             const float currAlpha = (lambda / (delta * 8.0) - 1.0) * exaggeration_factor;
             cv::Mat& m = motionPyramid.at(curLevel);
-            m = (curLevel == levels || curLevel == 0)
-                    ? m * 0
-                    : m * std::min(static_cast<float>(p.amplification), currAlpha);
+            if (curLevel == 0)
+                m = cv::Mat::zeros(m.size(), m.type());
+            else if (curLevel < levels)
+                m = m * std::min(static_cast<float>(p.amplification), currAlpha);
             lambda /= 2.0;
         }
 
@@ -160,20 +241,33 @@ inline bool magnifyMotion(const cv::Mat& in8u, const MagnificationParams& p, int
 }
 
 // --- Colour (reference colorMagnify: Gaussian + ideal FFT bandpass) -----------------------------
-inline bool magnifyColor(const cv::Mat& in8u, const MagnificationParams& p, int levels,
-                         int channels, ColorState& st, cv::Mat& out8u, PixelFormat& outFmt) {
-    const bool color = channels >= 3;
-
-    // Stays in [0,255] (NO 1/255 scaling); the output is rescaled by its min/max at the end.
-    cv::Mat input;
-    in8u.convertTo(input, color ? CV_32FC3 : CV_32FC1);
-
-    std::vector<cv::Mat> inputPyramid;
-    buildGaussPyrFromImg(input, levels, inputPyramid);
-
-    // The rolling window holds one column per frame of the smallest pyramid level.
-    cv::Mat downSampledFrame = inputPyramid.at(levels - 1);
-    img2tempMat(downSampledFrame, st.window, getOptimalBufferSize(static_cast<int>(p.framerate)));
+inline bool magnifyColor(const SpatialInput& in, const MagnificationParams& p, ColorState& st,
+                         double steps, cv::Mat& out8u, PixelFormat& outFmt) {
+    const bool color = in.color;
+    const int levels = in.levels;
+    const cv::Mat& input = in.input;
+
+    // The rolling window holds the smallest pyramid level sampled evenly at p.framerate, which the
+    // ideal filter's Hz -> bin mapping assumes: one column per frame when every frame arrives,
+    // samples a dropped frame missed interpolated from its neighbours, and none for a frame that
+    // came early.
+    const cv::Mat& downSampledFrame = in.pyramid.at(levels - 1);
+    const int maxCols = getOptimalBufferSize(static_cast<int>(p.framerate));
+    if (st.last.empty()) {
+        img2tempMat(downSampledFrame, st.window, maxCols);
+    } else {
+        st.owed += steps;
+        const int n = std::min(static_cast<int>(std::floor(st.owed + 0.5)), maxCols);
+        st.owed = std::min(st.owed - n, 0.5); // a gap longer than the window isn't carried over
+        for (int k = 1; k < n; ++k) {
+            cv::Mat between;
+            const double w = static_cast<double>(k) / n;
+            cv::addWeighted(st.last, 1.0 - w, downSampledFrame, w, 0.0, between);
+            img2tempMat(between, st.window, maxCols);
+        }
+        if (n > 0) img2tempMat(downSampledFrame, st.window, maxCols);
+    }
+    st.last = downSampledFrame; // never written: prepareSpatial() builds a fresh pyramid per frame
 
     // The reference's processing buffer guaranteed at least two frames in the window before the
     // first magnification; until then the raw frame was shown.
@@ -206,19 +300,15 @@ inline bool magnifyColor(const cv::Mat& in8u, const MagnificationParams& p, int
 }
 
 // --- Riesz / Phase (reference rieszMagnify) ------------------------------------------------------
-inline bool magnifyRiesz(const cv::Mat& in8u, const MagnificationParams& p, int levels,
-                         int channels, RieszState& st, cv::Mat& out8u, PixelFormat& outFmt) {
-    // The reference processed only multi-channel input here (grayscale mode produced no frame).
-    if (channels < 3) return false;
+inline bool magnifyRiesz(const SpatialInput& in, const MagnificationParams& p, RieszState& st,
+                         double steps, cv::Mat& out8u, PixelFormat& outFmt) {
+    if (in.lab.empty()) return false; // grayscale input, see prepareSpatial()
+    const int levels = in.levels;
 
     static const double PI_PERCENT = CV_PI / 100.0;
 
-    // Lab, so only luminance is magnified.
-    cv::Mat buffer_in;
-    in8u.convertTo(buffer_in, CV_32FC3, 1.0 / 255.0);
-    cv::cvtColor(buffer_in, buffer_in, cv::COLOR_BGR2Lab);
-    std::vector<cv::Mat> labChannels;
-    cv::split(buffer_in, labChannels);
+    // Headers only; the luminance plane is replaced below, never written through.
+    std::vector<cv::Mat> labChannels = in.lab;
     cv::Mat input = labChannels[0];
 
     // If first frame ever (or the Butterworth coefficients degenerated to NaN), init pyramids and
@@ -253,15 +343,27 @@ inline bool magnifyRiesz(const cv::Mat& in8u, const MagnificationParams& p, int
         st.old->buildPyramid(input);
     }
 
+    // Both Butterworths stay designed for p.framerate and step over any missed frames.
+    st.lo->updateFramerate(p.framerate);
+    st.hi->updateFramerate(p.framerate);
+    st.lo->setSteps(steps);
+    st.hi->setSteps(steps);
+
     st.cur->buildPyramid(input);
     st.cur->computePhaseDifferenceAndAmplitude(*st.old);
 
-    for (int lvl = 0; lvl < st.cur->numLevels - 1; ++lvl) {
-        st.lo->IIRTemporalFilter(st.cur->pyrLevels[lvl].itsLowpassIIR,
-                                 st.cur->pyrLevels[lvl].itsPhaseDiff, lvl);
-        st.hi->IIRTemporalFilter(st.cur->pyrLevels[lvl].itsHighpassIIR,
-                                 st.cur->pyrLevels[lvl].itsPhaseDiff, lvl);
-    }
+    // Each (level, lowpass|highpass) filter only touches its own registers: one task each.
+    const int filtered = st.cur->numLevels - 1;
+    parallelFor(0, 2 * filtered, 1, [&](int t0, int t1) {
+        for (int t = t0; t < t1; ++t) {
+            const int lvl = t % filtered;
+            auto& level = st.cur->pyrLevels[lvl];
+            if (t < filtered)
+                st.lo->IIRTemporalFilter(level.itsLowpassIIR, level.itsPhaseDiff, lvl);
+            else
+                st.hi->IIRTemporalFilter(level.itsHighpassIIR, level.itsPhaseDiff, lvl);
+        }
+    });
 
     // Shift current to prior for the next iteration.
     *st.old = *st.cur;
@@ -269,7 +371,14 @@ inline bool magnifyRiesz(const cv::Mat& in8u, const MagnificationParams& p, int
     st.cur->amplify(p.amplification, p.coWavelength * PI_PERCENT);
     cv::Mat magnified = st.cur->collapsePyramid();
 
+    if (labChannels.size() == 1) { // a YUV frame's luma, see prepareSpatial(const Frame&, ...)
+        magnified.convertTo(out8u, CV_8UC1, 255.0 / 100.0);
+        outFmt = PixelFormat::Gray8;
+        return true;
+    }
+
     cv::Mat output;
+    labChannels[0] = cv::Mat(); // fresh buffer: the shared plane must stay intact
     magnified.convertTo(labChannels[0], CV_32FC1);
     cv::merge(labChannels, output);
     cv::cvtColor(output, output, cv::COLOR_Lab2BGR);
@@ -3,22 +3,62 @@
 #include <algorithm>
 #include <cmath>
 #include <complex>
+#include <utility>
+#include <vector>
+
+#include "core/TaskPool.hpp"
 
 namespace livim {
+namespace {
+
+constexpr int kRowGrain = 16; // rows per parallelFor chunk floor; small levels run inline
+// Cutoffs at or past Nyquist (a low sampling rate) design a near all-pass filter rather than the
+// bilinear transform's pole at tan(pi/2).
+constexpr double kMaxWn = 0.99;
+
+} // namespace
 
 void iirFilter(const cv::Mat& src, cv::Mat& dst, cv::Mat& lowpassHi, cv::Mat& lowpassLo,
-               double cutoffLo, double cutoffHi) {
+               double cutoffLo, double cutoffHi, double steps) {
     if (cutoffLo == 0)
         cutoffLo = 0.01;
+    // Each lowpass keeps (1 - cutoff) of itself per frame, so (1 - cutoff)^steps over `steps`.
+    if (steps != 1.0) {
+        cutoffHi = 1.0 - std::pow(1.0 - cutoffHi, steps);
+        cutoffLo = 1.0 - std::pow(1.0 - cutoffLo, steps);
+    }
 
     // A high cutoff weights new images over the retained lowpass, so long-lasting movements fade
     // out fast; a low cutoff instead evens out movements spanning only a few frames.
-    cv::Mat tmp1 = (1 - cutoffHi) * lowpassHi + cutoffHi * src;
-    cv::Mat tmp2 = (1 - cutoffLo) * lowpassLo + cutoffLo * src;
-    lowpassHi = tmp1;
-    lowpassLo = tmp2;
+    if (src.depth() != CV_32F) {
+        cv::Mat tmp1 = (1 - cutoffHi) * lowpassHi + cutoffHi * src;
+        cv::Mat tmp2 = (1 - cutoffLo) * lowpassLo + cutoffLo * src;
+        lowpassHi = tmp1;
+        lowpassLo = tmp2;
+        dst = lowpassHi - lowpassLo;
+        return;
+    }
 
-    dst = lowpassHi - lowpassLo;
+    // Fused single pass, row-parallel on the shared pool, updating the lowpasses in place. The
+    // first frame seeds both lowpasses with the same pyramid level, so split them before writing.
+    if (lowpassLo.data == lowpassHi.data) lowpassLo = lowpassLo.clone();
+    dst.create(src.size(), src.type());
+    const float aHi = static_cast<float>(cutoffHi);
+    const float aLo = static_cast<float>(cutoffLo);
+    const int n = src.cols * src.channels();
+    parallelFor(0, src.rows, kRowGrain, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* s = src.ptr<float>(y);
+            float* hi = lowpassHi.ptr<float>(y);
+            float* lo = lowpassLo.ptr<float>(y);
+            float* d = dst.ptr<float>(y);
+            for (int x = 0; x < n; ++x) {
+                hi[x] = (1.0f - aHi) * hi[x] + aHi * s[x];
+                lo[x] = (1.0f - aLo) * lo[x] + aLo * s[x];
+                d[x] = hi[x] - lo[x];
+            }
+        }
+    });
 }
 
 void idealFilter(const cv::Mat& src, cv::Mat& dst, double cutoffLo, double cutoffHi,
@@ -27,33 +67,36 @@ void idealFilter(const cv::Mat& src, cv::Mat& dst, double cutoffLo, double cutof
         cutoffLo += 0.01;
 
     int channelNrs = src.channels();
-    cv::Mat* channels = new cv::Mat[channelNrs];
-    cv::split(src, channels);
+    std::vector<cv::Mat> channels(static_cast<std::size_t>(channelNrs));
+    cv::split(src, channels.data());
 
-    for (int curChannel = 0; curChannel < channelNrs; ++curChannel) {
-        cv::Mat current = channels[curChannel];
-        cv::Mat tempImg;
+    // Channels are independent: one task each.
+    parallelFor(0, channelNrs, 1, [&](int c0, int c1) {
+        for (int curChannel = c0; curChannel < c1; ++curChannel) {
+            cv::Mat current = channels[static_cast<std::size_t>(curChannel)];
+            cv::Mat tempImg;
 
-        int width = current.cols;
-        int height = cv::getOptimalDFTSize(current.rows);
+            int width = current.cols;
+            int height = cv::getOptimalDFTSize(current.rows);
 
-        cv::copyMakeBorder(current, tempImg, 0, height - current.rows, 0, width - current.cols,
-                           cv::BORDER_CONSTANT, cv::Scalar::all(0));
+            cv::copyMakeBorder(current, tempImg, 0, height - current.rows, 0,
+                               width - current.cols, cv::BORDER_CONSTANT, cv::Scalar::all(0));
 
-        cv::dft(tempImg, tempImg, cv::DFT_ROWS | cv::DFT_SCALE);
+            cv::dft(tempImg, tempImg, cv::DFT_ROWS | cv::DFT_SCALE);
 
-        cv::Mat filter = tempImg.clone();
-        createIdealBandpassFilter(filter, cutoffLo, cutoffHi, framerate);
+            cv::Mat filter = tempImg.clone();
+            createIdealBandpassFilter(filter, cutoffLo, cutoffHi, framerate);
 
-        cv::mulSpectrums(tempImg, filter, tempImg, cv::DFT_ROWS);
-        cv::idft(tempImg, tempImg, cv::DFT_ROWS | cv::DFT_SCALE);
+            cv::mulSpectrums(tempImg, filter, tempImg, cv::DFT_ROWS);
+            cv::idft(tempImg, tempImg, cv::DFT_ROWS | cv::DFT_SCALE);
 
-        tempImg(cv::Rect(0, 0, current.cols, current.rows)).copyTo(channels[curChannel]);
-    }
-    cv::merge(channels, channelNrs, dst);
+            tempImg(cv::Rect(0, 0, current.cols, current.rows))
+                .copyTo(channels[static_cast<std::size_t>(curChannel)]);
+        }
+    });
+    cv::merge(channels.data(), static_cast<std::size_t>(channelNrs), dst);
 
     cv::normalize(dst, dst, 0, 1, cv::NORM_MINMAX);
-    delete[] channels;
 }
 
 void createIdealBandpassFilter(cv::Mat& filter, double cutoffLo, double cutoffHi,
@@ -321,9 +364,53 @@ void RieszTemporalFilter::updateFrequency(double f) {
     this->computeCoefficients();
 }
 
+void RieszTemporalFilter::updateFramerate(double fps) {
+    if (fps <= 0.0 || fps == itsFramerate) return;
+    this->itsFramerate = fps;
+    this->computeCoefficients();
+}
+
 void RieszTemporalFilter::computeCoefficients() {
     const double Wn = itsFramerate == 0.0 ? 0.0 : itsFrequency / (itsFramerate / 2.0);
-    butterworth(2, Wn, itsA, itsB);
+    butterworth(2, std::min(Wn, kMaxWn), itsA, itsB);
+    itsSteps.clear();
+    itsStep = nullptr;
+}
+
+void RieszTemporalFilter::setSteps(double steps) {
+    // Frames closer together than a sample still step once; the debt is capped, not carried.
+    const double due = steps + itsOwed;
+    const int k = std::max(1, static_cast<int>(std::floor(due + 0.5)));
+    itsOwed = std::clamp(due - k, -0.5, 0.5);
+    if (k == 1) {
+        itsStep = nullptr;
+        return;
+    }
+    auto it = itsSteps.find(k);
+    if (it == itsSteps.end()) {
+        // Run the scalar recursion below k times from each unit basis of the inputs; the update
+        // is linear, so the results are its coefficients.
+        StepCoefficients c{};
+        for (int basis = 0; basis < 4; ++basis) {
+            double r0 = basis == 0 ? 1.0 : 0.0;
+            double r1 = basis == 1 ? 1.0 : 0.0;
+            const double phase = basis == 2 ? 1.0 : 0.0;
+            const double prior = basis == 3 ? 1.0 : 0.0;
+            double y = 0.0;
+            for (int j = 1; j <= k; ++j) {
+                const double u = prior + (phase - prior) * j / k;
+                y = itsB[0] * u + r0;
+                const double next0 = itsB[1] * u + r1 - itsA[1] * y;
+                r1 = itsB[2] * u - itsA[2] * y;
+                r0 = next0;
+            }
+            c.out[basis] = y;
+            c.reg0[basis] = r0;
+            c.reg1[basis] = r1;
+        }
+        it = itsSteps.emplace(k, c).first;
+    }
+    itsStep = &it->second;
 }
 void RieszTemporalFilter::passEach(cv::Mat& result, const cv::Mat& phase, const cv::Mat& prior) {
     result = itsB[0] * phase + itsB[1] * prior - itsA[1] * result;
@@ -339,6 +426,20 @@ void RieszTemporalFilter::pass(CompExpMat& result, const CompExpMat& phase,
 // coefficients each and that A(1) == 1.
 void RieszTemporalFilter::IIRTemporalFilter(CompExpMat& result, const CompExpMat& phaseDiff,
                                             int lvl) {
+    if (itsStep) {
+        const CompExpMat prior = clone(itsPhase[lvl]);
+        itsPhase[lvl] += phaseDiff;
+        auto fold = [&](const double (&w)[4]) {
+            return itsRegister0[lvl] * w[0] + itsRegister1[lvl] * w[1] + itsPhase[lvl] * w[2] +
+                   prior * w[3];
+        };
+        result = fold(itsStep->out);
+        CompExpMat reg0 = fold(itsStep->reg0);
+        itsRegister1[lvl] = fold(itsStep->reg1);
+        itsRegister0[lvl] = std::move(reg0);
+        return;
+    }
+
     // Accumulating the quaternionic phase difference is equivalent to phase unwrapping.
     this->itsPhase[lvl] += phaseDiff;
 
@@ -351,6 +452,7 @@ void RieszTemporalFilter::IIRTemporalFilter(CompExpMat& result, const CompExpMat
 }
 
 void RieszTemporalFilter::resetMat() {
+    itsOwed = 0.0;
     for (size_t lvl = 0; lvl < numPyrLvls; ++lvl) {
         sin(itsRegister0[lvl]) = 0.f;
         cos(itsRegister0[lvl]) = 0.f;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <utility>
 #include <vector>
 
@@ -13,9 +14,11 @@ namespace livim {
 
 // First-order IIR temporal bandpass (motion): difference of two exponential lowpasses. coLow/coHigh
 // are blend coefficients in [0,1] (NOT Hz), coLow < coHigh; the lowpass state buffers are carried
-// frame-to-frame by the caller and updated in place. dst = lowpassHi - lowpassLo.
+// frame-to-frame by the caller and updated in place. dst = lowpassHi - lowpassLo. `steps` is the
+// time since the previous update in frames; the coefficients are those frames' combined decay,
+// so skipped frames don't shift the band.
 void iirFilter(const cv::Mat& src, cv::Mat& dst, cv::Mat& lowpassHi, cv::Mat& lowpassLo,
-               double cutoffLo, double cutoffHi);
+               double cutoffLo, double cutoffHi, double steps = 1.0);
 
 // Ideal (rectangular) temporal bandpass via FFT (colour mode). `src` rows are pixels, columns are
 // successive frames; the DFT runs along each row (time). cutoffLo/cutoffHi are Hz, mapped to bins
@@ -49,7 +52,18 @@ public:
     std::vector<double> itsB;
 
     void updateFrequency(double f);
+    // A new Capture FPS redesigns the filter; the registers carry over.
+    void updateFramerate(double fps);
     void computeCoefficients();
+    // Frames the next sample spans (1 when none were missed). The design stays at itsFramerate:
+    // k frames are k steps of the same recursion, fed the phase interpolated linearly from the
+    // previous sample, folded into one update. That is exact for the digital filter, so the
+    // registers stay consistent; only the missed samples are guessed. A fractional count is
+    // rounded to whole frames (at least one) and the remainder carried into the next call, so
+    // each update is off by at most half a frame and the recursion keeps time over a run. The
+    // folded coefficients are cached per k. Call before IIRTemporalFilter(), not concurrently
+    // with it.
+    void setSteps(double steps);
 
     void passEach(cv::Mat& result, const cv::Mat& phase, const cv::Mat& prior);
 
@@ -60,7 +74,18 @@ public:
     void resetMat();
 
 private:
+    // One update spanning k frames; each row is linear in (register 0, register 1, the phase,
+    // the previous sample's phase).
+    struct StepCoefficients {
+        double out[4];
+        double reg0[4];
+        double reg1[4];
+    };
+
     size_t numPyrLvls;
+    std::map<int, StepCoefficients> itsSteps; // by k > 1; cleared by computeCoefficients()
+    const StepCoefficients* itsStep = nullptr; // setSteps(); null = one frame
+    double itsOwed = 0.0; // setSteps()' rounding remainder, in [-0.5, 0.5]
     std::vector<CompExpMat> itsRegister0;
     std::vector<CompExpMat> itsRegister1;
     std::vector<CompExpMat> itsPhase;
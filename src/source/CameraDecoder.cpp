@@ -0,0 +1,56 @@
+#include "source/CameraDecoder.hpp"
+
+#include <utility>
+
+#include <opencv2/imgcodecs.hpp>
+
+#include "core/Instrumentation.hpp"
+#include "core/Trace.hpp"
+
+namespace livim {
+
+CameraDecoder::CameraDecoder(int threads, Deliver deliver, Instrumentation* instr)
+    : deliver_(std::move(deliver)),
+      instr_(instr),
+      workers_(threads, "camera-decode", &CameraDecoder::decode, [this](Job&& job) {
+          report();
+          return deliver_(std::move(job.frame));
+      }) {
+    report();
+}
+
+CameraDecoder::~CameraDecoder() {
+    workers_.shutdown(); // before the report below: a worker may still be delivering
+    if (instr_) instr_->setCameraDecode(0, 0);
+}
+
+int CameraDecoder::threadsFromEnvironment() {
+    return orderedWorkerThreadsFromEnvironment("LIVIM_CAMERA_DECODE_THREADS");
+}
+
+bool CameraDecoder::submit(MutableFrameRef frame, cv::Mat payload,
+                           std::shared_ptr<const void> backing, int flags) {
+    Job job;
+    job.frame = std::move(frame);
+    job.payload = std::move(payload);
+    job.backing = std::move(backing);
+    job.flags = flags;
+    if (!workers_.push(std::move(job))) return false;
+    report();
+    return true;
+}
+
+void CameraDecoder::decode(Job& job) {
+    {
+        trace::Span span("jpeg_decode", job.frame->seq);
+        cv::imdecode(job.payload, job.flags, &job.frame->image);
+    }
+    job.payload.release();
+    job.backing.reset(); // hands a driver buffer back as soon as it's decoded
+}
+
+void CameraDecoder::report() {
+    if (instr_) instr_->setCameraDecode(workers_.threads(), workers_.size());
+}
+
+} // namespace livim
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+
+#include <opencv2/core.hpp>
+
+#include "core/Frame.hpp"
+#include "core/OrderedWorkers.hpp"
+
+namespace livim {
+
+class Instrumentation;
+
+// Decodes a camera's compressed frames (MJPEG) on its own OrderedWorkers threads (the template
+// ImageSequenceReader builds on too; no threads are shared), so the grab thread only dequeues and
+// never falls behind the driver while a JPEG decodes. Frames come back
+// through `deliver` strictly in submission order and one at a time. submit() waits once the
+// window is full, which then shows up as driver drops rather than as an unbounded backlog.
+// Threads are taken from LIVIM_CAMERA_DECODE_THREADS (0 = decode on the grab thread), else
+// defaultOrderedWorkerThreads().
+class CameraDecoder {
+public:
+    // Gets every submitted frame, its image decoded (empty if the payload didn't decode). False
+    // means the pipeline is stopping: whatever is still in flight is dropped.
+    using Deliver = std::function<bool(MutableFrameRef)>;
+
+    CameraDecoder(int threads, Deliver deliver, Instrumentation* instr);
+    ~CameraDecoder(); // drops what is in flight
+
+    CameraDecoder(const CameraDecoder&) = delete;
+    CameraDecoder& operator=(const CameraDecoder&) = delete;
+
+    // See the class comment; 0 = don't split.
+    static int threadsFromEnvironment();
+
+    // Queues one compressed frame to be decoded into `frame->image` with cv::imdecode `flags`.
+    // `backing` keeps `payload`'s memory alive until then (e.g. a driver buffer's lease). Waits
+    // while the window is full; false once delivery has stopped.
+    bool submit(MutableFrameRef frame, cv::Mat payload, std::shared_ptr<const void> backing,
+                int flags);
+
+private:
+    struct Job {
+        MutableFrameRef             frame;
+        cv::Mat                     payload;
+        std::shared_ptr<const void> backing;
+        int                         flags = 0;
+    };
+
+    static void decode(Job& job);
+    void report(); // the window's size into instr_
+
+    Deliver             deliver_;
+    Instrumentation*    instr_;
+    OrderedWorkers<Job> workers_; // last: its threads use the members above
+};
+
+} // namespace livim
@@ -3,17 +3,25 @@
 #include <string>
 #include <vector>
 
+#include "source/CameraMode.hpp"
+
 namespace livim {
 
 // `index` is the ordinal to pass to cv::VideoCapture; it matches the enumeration order OpenCV uses.
 struct CameraDevice {
     int index = 0;
     std::string name;
+    std::vector<CameraMode> modes; // capture modes the driver lists; empty where it can't say
 };
 
 // One implementation per OS, selected by CMake: Media Foundation, V4L2, AVFoundation.
 std::vector<CameraDevice> enumerateCameras();
 
+// Every (format, size, fps) device `index` offers, fastest rate per size and format. Only V4L2
+// can list them; elsewhere this is empty and the backend's default mode is used unless a mode is
+// requested explicitly.
+std::vector<CameraMode> enumerateCameraModes(int index);
+
 // The cv::VideoCapture backend ids to try, in order, when opening an enumerated device.
 // Plain ints (not cv::VideoCaptureAPIs) so this header stays free of <opencv2/...>.
 std::vector<int> preferredCaptureApis();
@@ -13,6 +13,8 @@
 
 #include <opencv2/videoio.hpp>
 
+#include "source/V4l2Device.hpp"
+
 namespace livim {
 
 std::vector<CameraDevice> enumerateCameras() {
@@ -21,8 +23,7 @@ std::vector<CameraDevice> enumerateCameras() {
     // /dev/video<N>: N is exactly the index OpenCV's V4L2 backend opens for cv::VideoCapture(N,
     // CAP_V4L2), so device ordinal and cv index match by construction.
     for (int i = 0; i < 64; ++i) {
-        const std::string path = "/dev/video" + std::to_string(i);
-        const int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        const int fd = ::open(v4l2DevicePath(i).c_str(), O_RDONLY | O_NONBLOCK);
         if (fd < 0) continue;
 
         v4l2_capability cap{};
@@ -36,7 +37,8 @@ std::vector<CameraDevice> enumerateCameras() {
                 std::string name(reinterpret_cast<const char*>(cap.card),
                                  ::strnlen(reinterpret_cast<const char*>(cap.card), sizeof(cap.card)));
                 if (name.empty()) name = "Camera " + std::to_string(i);
-                out.push_back(CameraDevice{i, std::move(name)});
+                out.push_back(
+                    CameraDevice{i, std::move(name), listV4l2Modes(*systemV4l2Device(), fd)});
             }
         }
         ::close(fd);
@@ -44,6 +46,14 @@ std::vector<CameraDevice> enumerateCameras() {
     return out;
 }
 
+std::vector<CameraMode> enumerateCameraModes(int index) {
+    const int fd = ::open(v4l2DevicePath(index).c_str(), O_RDONLY | O_NONBLOCK);
+    if (fd < 0) return {};
+    std::vector<CameraMode> modes = listV4l2Modes(*systemV4l2Device(), fd);
+    ::close(fd);
+    return modes;
+}
+
 std::vector<int> preferredCaptureApis() {
     // CAP_ANY falls back if the V4L2 backend wasn't compiled into this OpenCV build.
     return {cv::CAP_V4L2, cv::CAP_ANY};
@@ -66,6 +66,10 @@ std::vector<CameraDevice> enumerateCameras() {
     return out;
 }
 
+std::vector<CameraMode> enumerateCameraModes(int /*index*/) {
+    return {}; // the OpenCV backend opens in its default mode unless one is requested
+}
+
 std::vector<int> preferredCaptureApis() {
     return {cv::CAP_MSMF, cv::CAP_DSHOW};
 }
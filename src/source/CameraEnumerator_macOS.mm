@@ -27,6 +27,10 @@ std::vector<CameraDevice> enumerateCameras() {
     return out;
 }
 
+std::vector<CameraMode> enumerateCameraModes(int /*index*/) {
+    return {}; // the OpenCV backend opens in its default mode unless one is requested
+}
+
 std::vector<int> preferredCaptureApis() {
     // CAP_ANY falls back if the AVFoundation backend wasn't compiled into this OpenCV build.
     return {cv::CAP_AVFOUNDATION, cv::CAP_ANY};
@@ -0,0 +1,112 @@
+#include "source/CameraMode.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+
+namespace livim {
+namespace {
+
+constexpr double kFpsTolerance = 0.5; // 29.97 and 30 are the same rate to the policy
+
+// True if `a` is the better pick of two modes that both fit.
+bool better(const CameraMode& a, const CameraMode& b) {
+    if (std::abs(a.fps - b.fps) > kFpsTolerance) return a.fps > b.fps;
+    const long areaA = static_cast<long>(a.width) * a.height;
+    const long areaB = static_cast<long>(b.width) * b.height;
+    if (areaA != areaB) return areaA > areaB;
+    return !compressedFourcc(a.fourcc) && compressedFourcc(b.fourcc);
+}
+
+} // namespace
+
+bool compressedFourcc(std::uint32_t fourcc) {
+    return fourcc == makeFourcc('M', 'J', 'P', 'G') || fourcc == makeFourcc('J', 'P', 'E', 'G');
+}
+
+std::string fourccName(std::uint32_t fourcc) {
+    std::string s;
+    for (int i = 0; i < 4 && fourcc != 0; ++i) {
+        const char c = static_cast<char>((fourcc >> (8 * i)) & 0xFF);
+        if (c != ' ' && c != '\0') s.push_back(c);
+    }
+    return s;
+}
+
+std::string describe(const CameraMode& mode) {
+    std::ostringstream out;
+    out.imbue(std::locale::classic());
+    if (mode.fourcc != 0) out << fourccName(mode.fourcc) << ' ';
+    out << mode.width << 'x' << mode.height;
+    if (mode.fps > 0.0) out << " @ " << std::round(mode.fps * 100.0) / 100.0 << " fps";
+    return out.str();
+}
+
+bool parseCameraMode(const std::string& s, CameraMode& out) {
+    CameraMode m;
+    std::string rest = s;
+    if (const std::size_t colon = rest.find(':'); colon != std::string::npos) {
+        const std::string code = rest.substr(0, colon);
+        if (code.empty() || code.size() > 4) return false;
+        const std::string c = code + std::string(4 - code.size(), ' ');
+        m.fourcc = makeFourcc(c[0], c[1], c[2], c[3]);
+        rest = rest.substr(colon + 1);
+    }
+    std::istringstream in(rest);
+    in.imbue(std::locale::classic());
+    char x = 0;
+    if (!(in >> m.width >> x) || x != 'x' || !(in >> m.height)) return false;
+    if (in.peek() == '@') {
+        in.get();
+        if (!(in >> m.fps) || m.fps <= 0.0) return false;
+    }
+    if (in.peek() != std::char_traits<char>::eof() || !m.valid()) return false;
+    out = m;
+    return true;
+}
+
+CameraModePolicy cameraModePolicyFromEnvironment() {
+    CameraModePolicy p;
+    if (const char* v = std::getenv("LIVIM_CAMERA_BUDGET"); v && *v)
+        p.pixelBudget = std::atof(v) * 1e6;
+    return p;
+}
+
+CameraMode pickCameraMode(const std::vector<CameraMode>& modes, const CameraModePolicy& policy) {
+    bool anyTall = false;
+    for (const CameraMode& m : modes) anyTall = anyTall || m.height >= policy.minHeight;
+
+    const CameraMode* best = nullptr;
+    const CameraMode* cheapest = nullptr;
+    for (const CameraMode& m : modes) {
+        if (!m.valid() || (anyTall && m.height < policy.minHeight)) continue;
+        if (!cheapest || m.pixelRate() < cheapest->pixelRate()) cheapest = &m;
+        if (policy.pixelBudget > 0.0 && m.pixelRate() > policy.pixelBudget) continue;
+        if (!best || better(m, *best)) best = &m;
+    }
+    if (best) return *best;
+    return cheapest ? *cheapest : CameraMode{};
+}
+
+CameraMode resolveCameraMode(const CameraMode& requested,
+                             const std::vector<CameraMode>& available) {
+    CameraMode want = requested;
+    if (!want.valid()) {
+        const char* v = std::getenv("LIVIM_CAMERA_MODE");
+        const std::string env = v ? v : "";
+        if (env.empty() || env == "auto" || !parseCameraMode(env, want))
+            return pickCameraMode(available, cameraModePolicyFromEnvironment());
+    }
+    // Complete the request from the best listed mode that agrees with what it does set.
+    const CameraMode* best = nullptr;
+    for (const CameraMode& m : available) {
+        if (m.width != want.width || m.height != want.height) continue;
+        if (want.fourcc != 0 && m.fourcc != want.fourcc) continue;
+        if (want.fps > 0.0 && std::abs(m.fps - want.fps) > kFpsTolerance) continue;
+        if (!best || better(m, *best)) best = &m;
+    }
+    return best ? *best : want;
+}
+
+} // namespace livim
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace livim {
+
+constexpr std::uint32_t makeFourcc(char a, char b, char c, char d) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(a)) |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(b)) << 8 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(c)) << 16 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(d)) << 24;
+}
+
+// One capture mode a camera offers. Zero fields are "whatever the driver picks", so a partly
+// filled mode is also a request.
+struct CameraMode {
+    std::uint32_t fourcc = 0; // as V4L2 and cv::VideoWriter::fourcc spell it, e.g. "YUYV"
+    int           width = 0;
+    int           height = 0;
+    double        fps = 0.0;
+
+    bool valid() const { return width > 0 && height > 0; }
+    double pixelRate() const { return static_cast<double>(width) * height * fps; }
+};
+
+std::string fourccName(std::uint32_t fourcc); // "YUYV"; "" for 0
+bool compressedFourcc(std::uint32_t fourcc);  // MJPG/JPEG: a decode per frame
+std::string describe(const CameraMode& mode);  // "YUYV 1280x720 @ 60 fps"
+
+// "1280x720", "1280x720@60" or "MJPG:1280x720@60". False if it isn't one of those.
+bool parseCameraMode(const std::string& s, CameraMode& out);
+
+// How a mode is picked when none is requested. Temporal magnification wants a high, steady
+// capture rate, so the fastest mode whose pixel rate the pipeline can take wins; among equally
+// fast ones, the largest, then an uncompressed one (no JPEG decode on the grab thread).
+struct CameraModePolicy {
+    double pixelBudget = 1920.0 * 1080.0 * 30.0; // pixels per second; <= 0 = unbounded
+    int    minHeight = 360;                      // smaller modes only if nothing else fits
+};
+
+// LIVIM_CAMERA_BUDGET sets the pixel budget in megapixels per second (default 62, 1080p30's).
+CameraModePolicy cameraModePolicyFromEnvironment();
+
+// The policy's pick among `modes`; an invalid mode if `modes` is empty. If nothing fits the
+// budget, the mode with the lowest pixel rate.
+CameraMode pickCameraMode(const std::vector<CameraMode>& modes, const CameraModePolicy& policy);
+
+// The mode to ask a camera for: `requested` if valid, else LIVIM_CAMERA_MODE unless it is unset or
+// "auto", else pickCameraMode() over `available`. A request's unset fields are filled from the
+// best matching entry of `available`. Invalid = leave the device in its current mode.
+CameraMode resolveCameraMode(const CameraMode& requested, const std::vector<CameraMode>& available);
+
+} // namespace livim
@@ -1,17 +1,30 @@
 #include "source/CameraSource.hpp"
 
 #include <chrono>
+#include <cstdint>
 #include <utility>
 
-#include "core/IFrameSink.hpp"
+#include <opencv2/imgcodecs.hpp>
+
 #include "core/Instrumentation.hpp"
-#include "core/LatestFrameMailbox.hpp"
+#include "source/CameraDecoder.hpp"
 #include "source/CameraEnumerator.hpp"
 
 namespace livim {
+namespace {
+
+// A raw retrieve() in an MJPEG mode: the compressed bytes as one row, starting with a JPEG SOI.
+bool rawJpeg(const cv::Mat& m) {
+    if (m.type() != CV_8UC1 || m.rows != 1 || m.cols < 2) return false;
+    const std::uint8_t* p = m.ptr<std::uint8_t>(0);
+    return p[0] == 0xFF && p[1] == 0xD8;
+}
+
+} // namespace
 
-CameraSource::CameraSource(int deviceIndex, FrameQueue* out, FramePool* pool, Instrumentation* instr)
-    : SourceBase(out, pool, instr), deviceIndex_(deviceIndex) {}
+CameraSource::CameraSource(int deviceIndex, const CameraMode& mode, FrameQueue* out,
+                           FramePool* pool, Instrumentation* instr)
+    : SourceBase(out, pool, instr), deviceIndex_(deviceIndex), requested_(mode) {}
 
 bool CameraSource::open() {
     bool opened = false;
@@ -27,13 +40,39 @@ bool CameraSource::open() {
     // returns false after the timeout. Not every backend honors this; harmless no-op where unsupported.
     cap_.set(cv::CAP_PROP_READ_TIMEOUT_MSEC, 5000);
 
+    // FOURCC before the size: some backends only offer a size in one format. A backend that
+    // can't set a property keeps its own value.
+    const CameraMode mode = resolveCameraMode(requested_, enumerateCameraModes(deviceIndex_));
+    if (mode.valid()) {
+        if (mode.fourcc != 0) cap_.set(cv::CAP_PROP_FOURCC, static_cast<double>(mode.fourcc));
+        cap_.set(cv::CAP_PROP_FRAME_WIDTH, mode.width);
+        cap_.set(cv::CAP_PROP_FRAME_HEIGHT, mode.height);
+        if (mode.fps > 0.0) cap_.set(cv::CAP_PROP_FPS, mode.fps);
+    }
+
     // Webcam backends often report 0/garbage FPS; fall back to 30 to keep pacing sane.
     const double fps = cap_.get(cv::CAP_PROP_FPS);
     reportedFps_ = (fps > 1.0) ? fps : 30.0;
 
-    // Probe channels/size once (OpenCV only reveals them by decoding a frame).
+    // An MJPEG mode can hand out its frames undecoded, so run() can decode them off this thread.
+    // Only a backend that really returns the JPEG (checked on one frame) gets the split.
     cv::Mat probe;
-    if (cap_.read(probe)) {
+    decodeThreads_ = 0;
+    const int threads = CameraDecoder::threadsFromEnvironment();
+    const auto fourcc = static_cast<std::uint32_t>(cap_.get(cv::CAP_PROP_FOURCC));
+    if (threads > 0 && compressedFourcc(fourcc) && cap_.set(cv::CAP_PROP_CONVERT_RGB, 0)) {
+        cv::Mat raw;
+        if (cap_.read(raw) && rawJpeg(raw)) {
+            decodeThreads_ = threads;
+            cv::imdecode(raw, cv::IMREAD_COLOR, &probe);
+        } else {
+            cap_.set(cv::CAP_PROP_CONVERT_RGB, 1);
+        }
+    }
+
+    // Probe channels/size once (OpenCV only reveals them by decoding a frame).
+    if (decodeThreads_ == 0) cap_.read(probe);
+    if (!probe.empty()) {
         setNativeChannels(probe.channels());
         setNativeSize(probe.cols, probe.rows);
     }
@@ -41,6 +80,10 @@ bool CameraSource::open() {
 }
 
 void CameraSource::run() {
+    if (decodeThreads_ > 0) {
+        runSplit();
+        return;
+    }
     // Never paced: reading slower than the hardware rate would grow latency and make the driver
     // silently drop frames.
     while (!stopRequested()) {
@@ -50,7 +93,12 @@ void CameraSource::run() {
         MutableFrameRef frame = acquireFrame();
         if (!frame) break; // pool stopped
 
-        if (!cap_.read(frame->image)) {
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            ok = cap_.read(frame->image);
+        }
+        if (!ok) {
             if (stopRequested()) break;
             if (instr_) instr_->onSourceReadError();
             continue; // assume a transient read failure and try again
@@ -63,25 +111,58 @@ void CameraSource::run() {
         const int channels = frame->image.channels();
         frame->format = (channels == 1) ? PixelFormat::Gray8 : PixelFormat::BGR8;
         setNativeChannels(channels);
-        // No source PTS for a live feed; use the capture instant.
-        frame->ptsUs = std::chrono::duration_cast<std::chrono::microseconds>(
-                           frame->captureTs.time_since_epoch())
-                           .count();
-
-        if (instr_) instr_->onCaptured();
-
-        if (const auto target = recordTarget()) {
-            if (target->sink) target->sink->append(frame->image);
-            if (target->preview) {
-                auto df = std::make_shared<DisplayFrame>();
-                df->processed = frame; // same raw frame in both panes while recording
-                df->original = frame;
-                target->preview->publish(std::move(df));
+        frame->ptsUs = livePtsUs(frame->captureTs);
+
+        if (!deliverCaptured(std::move(frame))) break;
+    }
+}
+
+// VideoCapture hands out no driver sequence numbers, so frames the driver drops are not counted on
+// either path here (cameraDrops stays 0); only V4l2CameraSource sees the gaps. runSplit()'s
+// CameraDecoder still reports the frames waiting on a decode.
+void CameraSource::runSplit() {
+    // The frame is stamped here, at the grab, and finished on the worker that decoded it.
+    CameraDecoder decoder(
+        decodeThreads_,
+        [this](MutableFrameRef frame) {
+            if (frame->image.empty()) {
+                if (instr_) instr_->onSourceReadError();
+                return !stopRequested(); // a corrupt JPEG: skip it
             }
-            continue; // do NOT emit() -> lossless
+            frame->width = frame->image.cols;
+            frame->height = frame->image.rows;
+            frame->format = PixelFormat::BGR8;
+            setNativeChannels(3);
+            return deliverCaptured(std::move(frame));
+        },
+        instr_);
+
+    while (!stopRequested()) {
+        waitWhilePaused();
+        if (stopRequested()) break;
+
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        // retrieve() has to follow its grab() on this thread, but with CONVERT_RGB off it only
+        // copies the JPEG out of the driver's buffer.
+        cv::Mat payload;
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            ok = cap_.grab() && cap_.retrieve(payload) && !payload.empty();
+        }
+        if (!ok) {
+            if (stopRequested()) break;
+            if (instr_) instr_->onSourceReadError();
+            continue; // assume a transient read failure and try again
         }
 
-        if (!emit(std::move(frame))) break;
+        frame->seq = seq_++;
+        frame->captureTs = now();
+        frame->ptsUs = livePtsUs(frame->captureTs);
+        if (!decoder.submit(std::move(frame), std::move(payload), nullptr, cv::IMREAD_COLOR))
+            break;
     }
 }
 
@@ -4,15 +4,21 @@
 
 #include <opencv2/videoio.hpp>
 
+#include "source/CameraMode.hpp"
 #include "source/SourceBase.hpp"
 
 namespace livim {
 
 // Captures from a webcam, free-running at the camera's delivery rate, pushing every frame losslessly
 // (BLOCK). Do NOT set CAP_PROP_BUFFERSIZE=1: dropping frames corrupts the temporal magnification.
+// In an MJPEG mode whose backend hands out the raw JPEGs (CAP_PROP_CONVERT_RGB off), this thread
+// only grabs and copies them out, and a CameraDecoder decodes them in order on its workers.
 class CameraSource : public SourceBase {
 public:
-    CameraSource(int deviceIndex, FrameQueue* out, FramePool* pool, Instrumentation* instr);
+    // `mode` is the capture mode to ask for; an invalid one picks by resolveCameraMode() (the
+    // fastest mode that fits the processing budget, where the platform can list modes).
+    CameraSource(int deviceIndex, const CameraMode& mode, FrameQueue* out, FramePool* pool,
+                 Instrumentation* instr);
 
     SourceKind kind() const override { return SourceKind::Camera; }
     bool open() override;
@@ -23,10 +29,14 @@ protected:
     void run() override;
 
 private:
+    void runSplit(); // run() with decoding on a CameraDecoder
+
     int deviceIndex_;
+    CameraMode requested_;
     cv::VideoCapture cap_;
     std::uint64_t seq_ = 0;
     double reportedFps_ = 0.0;
+    int decodeThreads_ = 0; // > 0 when run() splits grab and decode
 };
 
 } // namespace livim
@@ -1,35 +1,40 @@
 #include "source/FileSource.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <limits>
 #include <utility>
 
 #include "core/Instrumentation.hpp"
+#include "core/Trace.hpp"
 
 namespace livim {
 
 FileSource::FileSource(std::string path, FrameQueue* out, FramePool* pool, Instrumentation* instr)
-    : SourceBase(out, pool, instr), path_(std::move(path)) {}
+    : SourceBase(out, pool, instr), path_(std::move(path)) {
+    std::size_t mb = kDefaultCacheMb;
+    if (const char* v = std::getenv("LIVIM_FRAME_CACHE_MB"); v && *v)
+        mb = static_cast<std::size_t>(std::strtoull(v, nullptr, 10));
+    cache_.setCapacity(mb << 20);
+}
 
 bool FileSource::open() {
-    if (!cap_.open(path_)) return false;
-    const double fps = cap_.get(cv::CAP_PROP_FPS);
+    if (!decoder_.open(path_)) return false;
+    cache_.clear();
+    if (instr_) instr_->setFrameCacheBytes(0);
+    const double fps = decoder_.fps();
     reportedFps_ = (fps > 1.0) ? fps : 30.0; // fall back to 30 when unreported
     frameIntervalUs_ = 1'000'000.0 / reportedFps_;
 
-    // Containers reporting a 0/garbage frame count disable the timeline (seekable() == false).
-    const double count = cap_.get(cv::CAP_PROP_FRAME_COUNT);
-    frameCount_ = count > 0.0 ? static_cast<std::int64_t>(count) : 0;
+    // Containers with no usable frame count disable the timeline (seekable() == false).
+    frameCount_ = decoder_.frameCount();
     outFrame_.store(-1, std::memory_order_release); // default: to the end
 
-    // Probe channels/size once (OpenCV only reveals them by decoding a frame); rewind afterwards.
-    cv::Mat probe;
-    if (cap_.read(probe)) {
-        setNativeChannels(probe.channels());
-        setNativeSize(probe.cols, probe.rows);
-        cap_.set(cv::CAP_PROP_POS_FRAMES, 0);
-    }
-    pos_ = 0;
+    // The stream's own format and size, whatever luma-only mode later emits.
+    setNativeChannels(decoder_.channels());
+    setNativeSize(decoder_.size().width, decoder_.size().height);
+    if (instr_) instr_->setDecodeThreads(decoder_.threads());
     return true;
 }
 
@@ -45,6 +50,10 @@ void FileSource::seekFrame(std::int64_t frame) {
     reachedEnd_.store(false, std::memory_order_release);
     pendingSeekFrame_.store(std::clamp<std::int64_t>(frame, in, hi), std::memory_order_release);
     wakePauseWaiters(); // so a paused thread wakes and renders the scrubbed frame
+    {
+        std::lock_guard<std::mutex> lg(ringMu_); // and a pacer waiting on an empty ring
+    }
+    ringCv_.notify_all();
 }
 
 void FileSource::setInOut(std::int64_t in, std::int64_t out) {
@@ -56,8 +65,190 @@ void FileSource::setInOut(std::int64_t in, std::int64_t out) {
     outFrame_.store(o, std::memory_order_release);
 }
 
+void FileSource::indexLoop() {
+    std::shared_ptr<const KeyframeIndex> index = KeyframeIndex::loadOrBuild(path_, indexCancel_);
+    if (index) keyframes_.store(std::move(index), std::memory_order_release);
+}
+
+void FileSource::decodeLoop() {
+    bool indexed = false;          // decoder_ has the keyframe index
+    std::uint64_t gen = 0;
+    std::int64_t pos = 0;          // index of the NEXT frame to deliver
+    std::int64_t decoderPos = 0;   // index the decoder's next decode() returns; -1 = unknown
+    std::uint64_t readSeq = 0;
+    bool parked = false;           // end of range pushed; idle until the next reposition
+    bool wrapped = false;          // looped to the in-point and delivered nothing since
+    std::int64_t scrubEnd = 0;     // frames before this one, from the last seek on, are cached
+    for (;;) {
+        bool restart = false;
+        {
+            std::unique_lock<std::mutex> lk(ringMu_);
+            ringCv_.wait(lk, [&] {
+                return quit_ || gen_ != gen || (!parked && ring_.size() < kPrefetchDepth);
+            });
+            if (quit_) break;
+            if (gen_ != gen) {
+                gen = gen_;
+                pos = restartAt_;
+                restart = true;
+                scrubEnd = restartSeek_ ? pos + kScrubCacheFrames : 0;
+            }
+        }
+        if (restart) parked = wrapped = false;
+
+        // Looping wraps here, ahead of the pacer, so the in-point is already decoded when it's due.
+        const bool loop = loop_.load(std::memory_order_acquire);
+        if (pos >= effectiveOut()) {
+            if (loop && !wrapped) {
+                pos = inFrame_.load(std::memory_order_acquire);
+                wrapped = true;
+                continue;
+            }
+            pushPrefetched({nullptr, std::max<std::int64_t>(0, effectiveOut() - 1), gen});
+            parked = true;
+            continue;
+        }
+
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        // Luma-only skips the chroma planes entirely when nothing downstream shows colour.
+        const bool luma = decoder_.channels() == 1 || lumaOnly_.load(std::memory_order_acquire);
+        // 4:2:0 colour is emitted as it was decoded, so BGR is only made for what needs it.
+        const PixelFormat format = luma                   ? PixelFormat::Gray8
+                                   : decoder_.nativeI420() ? PixelFormat::I420
+                                                           : PixelFormat::BGR8;
+        frame->format = format;
+        if (cache_.get(pos, format, frame->image)) {
+            // Scrubbed back over, or another pass of a short loop: no decode, and the decoder
+            // stays where it is until a miss needs it.
+            if (instr_) instr_->onFrameCacheHit();
+            wrapped = false;
+            pushPrefetched({std::move(frame), pos++, gen});
+            continue;
+        }
+        if (instr_) instr_->onFrameCacheMiss();
+
+        bool ok = true;
+        if (decoderPos != pos) {
+            if (!indexed) {
+                if (std::shared_ptr<const KeyframeIndex> index = keyframes_.load()) {
+                    decoder_.setKeyframeIndex(std::move(index));
+                    indexed = true;
+                }
+            }
+            StageTimer timer(instr_, Stage::Seek);
+            ok = decoder_.seek(pos);
+        }
+        if (ok) {
+            StageTimer timer(instr_, Stage::SourceRead, readSeq++);
+            ok = decoder_.decode();
+            if (ok && format == PixelFormat::I420) ok = decoder_.toI420(frame->image);
+            else if (ok && luma) {
+                // The decoded Y plane itself, pinned by the frame; converted only when the
+                // format has no plain 8-bit one.
+                if (!decoder_.lumaPlane(frame->image, frame->backing))
+                    ok = decoder_.toGray(frame->image);
+            } else if (ok) {
+                ok = decoder_.toBgr(frame->image);
+            }
+        }
+        if (!ok) {
+            decoderPos = -1;
+            if (loop && !wrapped) {
+                pos = inFrame_.load(std::memory_order_acquire);
+                wrapped = true;
+                continue;
+            }
+            // Natural EOF: the pacer parks at the last frame.
+            const std::int64_t last = frameCount_ > 0 ? frameCount_ - 1 : pos - 1;
+            pushPrefetched({nullptr, std::max<std::int64_t>(0, last), gen});
+            parked = true;
+            continue;
+        }
+        decoderPos = pos + 1;
+        if (cacheWorthy(pos, frame->image.total() * frame->image.elemSize(), scrubEnd)) {
+            cache_.put(pos, frame->image, format);
+            if (instr_) instr_->setFrameCacheBytes(cache_.bytes());
+        }
+        wrapped = false;
+        pushPrefetched({std::move(frame), pos++, gen});
+    }
+    decoderDone_.store(true, std::memory_order_release);
+    ringCv_.notify_all();
+}
+
+void FileSource::pushPrefetched(Prefetched p) {
+    {
+        std::lock_guard<std::mutex> lg(ringMu_);
+        if (p.gen != gen_) return; // stale: the frame goes straight back to the pool
+        ring_.push_back(std::move(p));
+        if (instr_) instr_->setPrefetchDepth(ring_.size());
+    }
+    ringCv_.notify_all();
+}
+
+bool FileSource::cacheWorthy(std::int64_t pos, std::size_t frameBytes,
+                             std::int64_t scrubEnd) const {
+    if (frameBytes == 0 || frameBytes > cache_.capacity()) return false;
+    if (paused() || pos < scrubEnd) return true; // scrubbing: the same frames come up again
+    // A loop replays its range, but only a range that fits: otherwise LRU evicts each frame
+    // just before its next pass and every copy is wasted.
+    if (!loop_.load(std::memory_order_acquire)) return false;
+    const std::int64_t range = effectiveOut() - inFrame_.load(std::memory_order_acquire);
+    return range <= static_cast<std::int64_t>(cache_.capacity() / frameBytes);
+}
+
+void FileSource::reposition(std::int64_t frame, bool seek) {
+    std::deque<Prefetched> dropped; // released after the unlock: their deleters take the pool lock
+    {
+        std::lock_guard<std::mutex> lg(ringMu_);
+        ++gen_;
+        restartAt_ = frame;
+        restartSeek_ = seek;
+        dropped.swap(ring_);
+        if (instr_) instr_->setPrefetchDepth(0);
+    }
+    ringCv_.notify_all();
+}
+
+bool FileSource::popPrefetched(Prefetched& out, bool playing) {
+    std::unique_lock<std::mutex> lk(ringMu_);
+    bool counted = false;
+    while (ring_.empty()) {
+        if (stopRequested() || decoderDone_.load(std::memory_order_acquire) ||
+            pendingSeekFrame_.load(std::memory_order_acquire) >= 0)
+            return false;
+        if (playing && !counted) {
+            if (instr_) instr_->onPrefetchUnderrun();
+            counted = true;
+        }
+        // Sliced like paceFrame(), so a concurrent stop() is observed within ~20 ms.
+        ringCv_.wait_for(lk, std::chrono::milliseconds(20));
+    }
+    out = std::move(ring_.front());
+    ring_.pop_front();
+    if (instr_) instr_->setPrefetchDepth(ring_.size());
+    lk.unlock();
+    ringCv_.notify_all(); // room for the decoder
+    return true;
+}
+
 void FileSource::run() {
-    while (!stopRequested()) {
+    const char* useIndex = std::getenv("LIVIM_KEYFRAME_INDEX");
+    if (!keyframes_.load() && !(useIndex && useIndex[0] == '0')) {
+        indexCancel_.store(false, std::memory_order_relaxed);
+        indexThread_ = std::thread([this] {
+            trace::setThreadName("source-index");
+            indexLoop();
+        });
+    }
+    decodeThread_ = std::thread([this] {
+        trace::setThreadName("source-decode");
+        decodeLoop();
+    });
+
+    while (!stopRequested() && !decoderDone_.load(std::memory_order_acquire)) {
         // Also wake on a pending seek so the user can scrub while paused.
         const Clock::duration paused =
             waitWhilePaused([this] { return pendingSeekFrame_.load(std::memory_order_acquire) >= 0; });
@@ -68,8 +259,8 @@ void FileSource::run() {
         const bool didSeek = seekTo >= 0;
         if (didSeek) {
             const std::int64_t maxFrame = frameCount_ > 0 ? frameCount_ - 1 : seekTo;
-            pos_ = std::clamp<std::int64_t>(seekTo, 0, std::max<std::int64_t>(0, maxFrame));
-            cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(pos_));
+            reposition(std::clamp<std::int64_t>(seekTo, 0, std::max<std::int64_t>(0, maxFrame)),
+                       true);
             resetPacing();
             reachedEnd_.store(false, std::memory_order_release);
         }
@@ -77,60 +268,56 @@ void FileSource::run() {
         const bool isPaused = this->paused();
         if (isPaused && !didSeek) continue; // paused, nothing to scrub
 
-        // Enforce the OUT bound: loop back to IN, or park at the out-point.
-        if (!isPaused && pos_ >= effectiveOut()) {
+        Prefetched next;
+        if (!popPrefetched(next, !isPaused && !didSeek)) continue;
+
+        // The out-point may have moved in after this frame was decoded ahead.
+        if (next.frame && !isPaused && next.index >= effectiveOut()) {
             if (loop_.load(std::memory_order_acquire)) {
-                pos_ = inFrame_.load(std::memory_order_acquire);
-                cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(pos_));
-                resetPacing();
-            } else {
-                reachedEnd_.store(true, std::memory_order_release);
-                currentFrame_.store(std::max<std::int64_t>(0, effectiveOut() - 1),
-                                    std::memory_order_release);
-                pause();
+                reposition(inFrame_.load(std::memory_order_acquire), false);
                 resetPacing();
                 continue;
             }
+            next = {nullptr, std::max<std::int64_t>(0, effectiveOut() - 1), next.gen};
         }
-
-        MutableFrameRef frame = acquireFrame();
-        if (!frame) break; // pool stopped
-
-        if (!cap_.read(frame->image)) {
-            if (loop_.load(std::memory_order_acquire) && !isPaused) {
-                pos_ = inFrame_.load(std::memory_order_acquire);
-                cap_.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(pos_));
-                resetPacing();
-                continue;
-            }
-            // Natural EOF (non-looping): park at the end, stay alive so the user can still scrub.
+        if (!next.frame) {
+            // End of the range (non-looping): park there, stay alive so the user can still scrub.
             reachedEnd_.store(true, std::memory_order_release);
-            if (frameCount_ > 0) currentFrame_.store(frameCount_ - 1, std::memory_order_release);
+            currentFrame_.store(next.index, std::memory_order_release);
             pause();
             resetPacing();
             continue;
         }
 
-        const std::int64_t emitted = pos_;
-        ++pos_;
-
         // Drop a scrub-induced frame superseded by a newer pending seek.
         if (didSeek && pendingSeekFrame_.load(std::memory_order_acquire) >= 0) continue;
 
+        MutableFrameRef frame = std::move(next.frame);
         frame->seq = seq_++;
         frame->captureTs = now();
         frame->width = frame->image.cols;
-        frame->height = frame->image.rows;
-        const int channels = frame->image.channels();
-        frame->format = (channels == 1) ? PixelFormat::Gray8 : PixelFormat::BGR8;
-        setNativeChannels(channels);
-        frame->ptsUs = static_cast<std::int64_t>(static_cast<double>(emitted) * frameIntervalUs_);
-        currentFrame_.store(emitted, std::memory_order_release);
+        frame->height = frame->format == PixelFormat::I420 ? frame->image.rows * 2 / 3
+                                                           : frame->image.rows;
+        frame->ptsUs =
+            static_cast<std::int64_t>(static_cast<double>(next.index) * frameIntervalUs_);
+        currentFrame_.store(next.index, std::memory_order_release);
 
         if (instr_) instr_->onCaptured();
         if (!isPaused) paceFrame(); // scrub previews emit immediately, never paced
         if (!emit(std::move(frame))) break;
     }
+
+    {
+        std::lock_guard<std::mutex> lg(ringMu_);
+        quit_ = true;
+        std::deque<Prefetched>().swap(ring_);
+    }
+    ringCv_.notify_all();
+    decodeThread_.join();
+    if (indexThread_.joinable()) {
+        indexCancel_.store(true, std::memory_order_relaxed); // a scan stops at its next packet
+        indexThread_.join();
+    }
 }
 
 } // namespace livim
@@ -1,29 +1,49 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 
-#include <opencv2/videoio.hpp>
-
+#include "core/AtomicSharedPtr.hpp"
+#include "source/FrameCache.hpp"
+#include "source/KeyframeIndex.hpp"
+#include "source/LibavDecoder.hpp"
 #include "source/SourceBase.hpp"
 
 namespace livim {
 
-// Decodes a video file, paced at a fixed cadence (target playback FPS), emitting in decode order.
+// Decodes a video file with a threaded LibavDecoder, paced at a fixed cadence (target playback
+// FPS), emitting in decode order. Each frame is converted straight into its pooled buffer.
+// A decode thread keeps a small ring of frames ahead of the pacer (the source thread), which only
+// pops, sleeps and emits, so a slow keyframe or bitrate burst is absorbed instead of showing up
+// as jitter. Seeks and in/out loops restart the ring under a new generation.
+// An index thread loads (or scans once and caches) the file's KeyframeIndex in the background;
+// from then on a seek jumps straight to the keyframe it needs, or keeps decoding when the target
+// is in the GOP already being decoded. LIVIM_KEYFRAME_INDEX=0 turns it off for comparison.
+// A byte-capped FrameCache (LIVIM_FRAME_CACHE_MB, 0 = off) serves a scrub back over the same
+// region or another pass of a short loop from memory. It is only filled where a frame is likely to
+// be wanted again: while paused, just after a seek, and in a loop whose range fits the cache.
+// Linear playback copies nothing into it.
 // Assumes constant frame rate: ptsUs is synthesized as frameIndex * frameInterval, so a VFR source
 // plays at the wrong speed. Pushes losslessly (BLOCK): a slow consumer just backpressures the decoder.
 class FileSource : public SourceBase {
 public:
     FileSource(std::string path, FrameQueue* out, FramePool* pool, Instrumentation* instr);
+    ~FileSource() override { stop(); } // both threads use members below
 
     SourceKind kind() const override { return SourceKind::File; }
     bool open() override;
-    bool isOpen() const override { return cap_.isOpened(); }
+    bool isOpen() const override { return decoder_.isOpen(); }
     void setLoop(bool enabled) override { loop_.store(enabled, std::memory_order_release); }
+    void setLumaOnly(bool enabled) override { lumaOnly_.store(enabled, std::memory_order_release); }
     double reportedFps() const override { return reportedFps_; }
 
-    // Seeks go through CAP_PROP_POS_FRAMES, which is keyframe-approximate for long-GOP codecs,
-    // so scrub/trim positions are best-effort.
+    // Seeks are frame-accurate: back to the preceding keyframe, then decoded forward. Each one is
+    // timed into Stage::Seek.
     bool seekable() const override { return frameCount_ > 0; }
     std::int64_t frameCount() const override { return frameCount_; }
     std::int64_t currentFrame() const override { return currentFrame_.load(std::memory_order_acquire); }
@@ -35,21 +55,63 @@ protected:
     void run() override;
 
 private:
+    // One ring slot: a decoded frame, or (null frame) the end of the range, parked at `index`.
+    struct Prefetched {
+        MutableFrameRef frame;
+        std::int64_t    index = 0;
+        std::uint64_t   gen = 0;
+    };
+
+    // Held out of a 12-frame pool; the queue, chain and display hold most of the rest.
+    static constexpr std::size_t kPrefetchDepth = 4;
+    // About 80 1080p colour frames (240 luma-only): a few seconds of loop or scrub range.
+    static constexpr std::size_t kDefaultCacheMb = 512;
+    // Frames cached from a seek target on, even while playing: what a scrub preview decodes.
+    static constexpr std::int64_t kScrubCacheFrames = static_cast<std::int64_t>(kPrefetchDepth);
+
     std::int64_t effectiveOut() const; // out-point, or frameCount_ (or "infinite" if unknown)
 
+    void decodeLoop();                   // decode thread
+    void indexLoop();                    // index thread
+    void pushPrefetched(Prefetched p);   // decode thread; dropped if a reposition overtook it
+    // Pacer: drop the ring, decode from `frame`; `seek` (rather than a loop wrap) opens the
+    // scrub window of the cache.
+    void reposition(std::int64_t frame, bool seek);
+    // Decode thread: whether frame `pos` (of `frameBytes`) goes into the cache.
+    bool cacheWorthy(std::int64_t pos, std::size_t frameBytes, std::int64_t scrubEnd) const;
+    // Pacer: blocks for the next slot. False on stop or a pending seek; `playing` counts an empty
+    // ring as an underrun.
+    bool popPrefetched(Prefetched& out, bool playing);
+
     std::string path_;
-    cv::VideoCapture cap_;
+    LibavDecoder decoder_;         // decode thread only, after open()
+    FrameCache cache_;             // likewise
     std::uint64_t seq_ = 0;
     double reportedFps_ = 0.0;
     double frameIntervalUs_ = 0.0; // for the synthesized ptsUs
     std::int64_t frameCount_ = 0;  // 0 = unknown
-    std::int64_t pos_ = 0;         // index of the NEXT frame to read (source-thread only)
     std::atomic<bool> loop_{false};
+    std::atomic<bool> lumaOnly_{false};
     std::atomic<std::int64_t> currentFrame_{0};
     std::atomic<std::int64_t> pendingSeekFrame_{-1}; // -1 = no seek requested
     std::atomic<std::int64_t> inFrame_{0};        // inclusive
     std::atomic<std::int64_t> outFrame_{-1};      // exclusive; -1 = to the end
     std::atomic<bool> reachedEnd_{false};         // parked at the out-point / EOF (non-looping)
+
+    std::thread decodeThread_;
+    std::atomic<bool> decoderDone_{false};
+    std::mutex ringMu_;
+    std::condition_variable ringCv_;
+    // Guarded by ringMu_. The ring only ever holds generation gen_.
+    std::deque<Prefetched> ring_;
+    std::uint64_t gen_ = 0;
+    std::int64_t restartAt_ = 0; // where generation gen_ starts decoding
+    bool restartSeek_ = false;   // generation gen_ started at a seek
+    bool quit_ = false;
+
+    std::thread indexThread_;
+    std::atomic<bool> indexCancel_{false};
+    AtomicSharedPtr<const KeyframeIndex> keyframes_; // null until the index thread publishes it
 };
 
 } // namespace livim
@@ -0,0 +1,56 @@
+#include "source/FrameCache.hpp"
+
+#include <utility>
+
+namespace livim {
+
+void FrameCache::setCapacity(std::size_t bytes) {
+    capacity_ = bytes;
+    evictTo(bytes, nullptr);
+}
+
+bool FrameCache::get(std::int64_t index, PixelFormat format, cv::Mat& dst) {
+    const auto it = map_.find(index);
+    if (it == map_.end() || it->second->format != format) return false;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    it->second->image.copyTo(dst); // no reallocation when dst is a pooled buffer that fits
+    return true;
+}
+
+void FrameCache::put(std::int64_t index, const cv::Mat& image, PixelFormat format) {
+    const std::size_t need = bytesOf(image);
+    if (need == 0 || need > capacity_) return;
+
+    cv::Mat storage;
+    if (const auto it = map_.find(index); it != map_.end()) {
+        // Re-decoded (e.g. after a luma-only switch): replace in place.
+        storage = std::move(it->second->image);
+        bytes_ -= bytesOf(storage);
+        lru_.erase(it->second);
+        map_.erase(it);
+    }
+    if (bytes_ + need > capacity_) evictTo(capacity_ - need, storage.empty() ? &storage : nullptr);
+
+    image.copyTo(storage); // reuses the evicted buffer when its size and type match
+    bytes_ += need;
+    lru_.push_front({index, std::move(storage), format});
+    map_[index] = lru_.begin();
+}
+
+void FrameCache::clear() {
+    lru_.clear();
+    map_.clear();
+    bytes_ = 0;
+}
+
+void FrameCache::evictTo(std::size_t bytes, cv::Mat* reuse) {
+    while (bytes_ > bytes && !lru_.empty()) {
+        Entry& victim = lru_.back();
+        bytes_ -= bytesOf(victim.image);
+        map_.erase(victim.index);
+        if (reuse && reuse->empty()) *reuse = std::move(victim.image);
+        lru_.pop_back();
+    }
+}
+
+} // namespace livim
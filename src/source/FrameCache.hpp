@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include <opencv2/core.hpp>
+
+#include "core/Frame.hpp"
+
+namespace livim {
+
+// Byte-capped LRU of decoded frames keyed by frame index, so FileSource can serve a scrub back
+// over the same region or another pass of a short in/out loop without decoding again. Holds its
+// own copies (never a pooled buffer, which would starve the FramePool); a hit is one copy into
+// the caller's buffer, and an eviction's storage is reused by the insert that forced it.
+// Not thread-safe: FileSource's decode thread is the only user.
+class FrameCache {
+public:
+    explicit FrameCache(std::size_t capacityBytes = 0) : capacity_(capacityBytes) {}
+
+    // 0 disables the cache; shrinking evicts down to the new cap.
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const { return capacity_; }
+    std::size_t bytes() const { return bytes_; }
+    std::size_t size() const { return map_.size(); }
+
+    // Copies frame `index` into `dst` if it's cached in `format` (Gray8 in luma-only mode, else
+    // BGR8 or I420) and marks it most recently used.
+    bool get(std::int64_t index, PixelFormat format, cv::Mat& dst);
+
+    // Caches a copy of `image`, in `format`, as frame `index`, evicting least recently used frames
+    // to fit. A frame larger than the whole cap is not cached.
+    void put(std::int64_t index, const cv::Mat& image, PixelFormat format);
+
+    // The cached image of frame `index`, or null; leaves the LRU order alone.
+    const cv::Mat* peek(std::int64_t index) const {
+        const auto it = map_.find(index);
+        return it == map_.end() ? nullptr : &it->second->image;
+    }
+
+    void clear();
+
+private:
+    struct Entry {
+        std::int64_t index = 0;
+        cv::Mat      image;
+        PixelFormat  format = PixelFormat::BGR8;
+    };
+    static std::size_t bytesOf(const cv::Mat& m) { return m.total() * m.elemSize(); }
+    void evictTo(std::size_t bytes, cv::Mat* reuse);
+
+    std::list<Entry> lru_; // front = most recently used
+    std::unordered_map<std::int64_t, std::list<Entry>::iterator> map_;
+    std::size_t capacity_;
+    std::size_t bytes_ = 0;
+};
+
+} // namespace livim
@@ -35,6 +35,10 @@ public:
     // Only meaningful for finite sources (files); no-op for a live camera.
     virtual void setLoop(bool /*enabled*/) {}
 
+    // Emit single-channel luma instead of BGR, for when nothing downstream shows colour. A source
+    // that can't do it cheaper than the Grayscale stage ignores it.
+    virtual void setLumaOnly(bool /*enabled*/) {}
+
     // Native frame rate in Hz, read once at open(); 0 = unknown. Independent of playback cadence.
     virtual double reportedFps() const { return 0.0; }
 
@@ -0,0 +1,199 @@
+#include "source/ImageSequence.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <regex>
+#include <system_error>
+#include <utility>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "core/Trace.hpp"
+
+namespace livim {
+namespace {
+
+namespace fs = std::filesystem;
+
+bool isDigit(char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; }
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+bool isImageExtension(const std::string& ext) {
+    static const char* const kExtensions[] = {".png", ".tif", ".tiff", ".jpg", ".jpeg",
+                                              ".bmp", ".pgm", ".ppm", ".pnm"};
+    return std::find(std::begin(kExtensions), std::end(kExtensions), ext) != std::end(kExtensions);
+}
+
+// Digit runs compare by value, everything else case-insensitively: "f2" < "f10", "f007" ~ "f7".
+bool naturalLess(const std::string& a, const std::string& b) {
+    std::size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (isDigit(a[i]) && isDigit(b[j])) {
+            std::size_t ie = i, je = j;
+            while (ie < a.size() && isDigit(a[ie])) ++ie;
+            while (je < b.size() && isDigit(b[je])) ++je;
+            std::size_t is = i, js = j; // past leading zeros, keeping one digit
+            while (is + 1 < ie && a[is] == '0') ++is;
+            while (js + 1 < je && b[js] == '0') ++js;
+            if (ie - is != je - js) return ie - is < je - js;
+            if (const int c = a.compare(is, ie - is, b, js, je - js); c != 0) return c < 0;
+            i = ie;
+            j = je;
+            continue;
+        }
+        const int ca = std::tolower(static_cast<unsigned char>(a[i]));
+        const int cb = std::tolower(static_cast<unsigned char>(b[j]));
+        if (ca != cb) return ca < cb;
+        ++i;
+        ++j;
+    }
+    return a.size() - i < b.size() - j;
+}
+
+// The directory's image files of its most common type: a stray preview or two don't join in.
+std::vector<std::string> listDirectory(const fs::path& dir) {
+    std::map<std::string, std::vector<std::string>> byExtension;
+    std::error_code ec;
+    for (const fs::directory_entry& e : fs::directory_iterator(dir, ec)) {
+        const std::string ext = lower(e.path().extension().string());
+        if (isImageExtension(ext) && e.is_regular_file(ec))
+            byExtension[ext].push_back(e.path().string());
+    }
+    std::vector<std::string> best;
+    for (auto& [ext, files] : byExtension)
+        if (files.size() > best.size()) best = std::move(files);
+    return best;
+}
+
+// `file` and its siblings that differ from it only in its last run of digits.
+std::vector<std::string> listSiblings(const fs::path& file) {
+    const std::string stem = file.stem().string();
+    const std::size_t digitsEnd = [&] {
+        std::size_t k = stem.size();
+        while (k > 0 && !isDigit(stem[k - 1])) --k;
+        return k;
+    }();
+    if (digitsEnd == 0) return {file.string()}; // not numbered: a one-frame clip
+    std::size_t digitsBegin = digitsEnd;
+    while (digitsBegin > 0 && isDigit(stem[digitsBegin - 1])) --digitsBegin;
+    const std::string prefix = stem.substr(0, digitsBegin);
+    const std::string suffix = stem.substr(digitsEnd);
+    const std::string ext = lower(file.extension().string());
+
+    std::vector<std::string> out;
+    std::error_code ec;
+    const fs::path dir = file.has_parent_path() ? file.parent_path() : fs::path(".");
+    for (const fs::directory_entry& e : fs::directory_iterator(dir, ec)) {
+        const std::string s = e.path().stem().string();
+        if (lower(e.path().extension().string()) != ext ||
+            s.size() <= prefix.size() + suffix.size() || s.compare(0, prefix.size(), prefix) != 0 ||
+            s.compare(s.size() - suffix.size(), suffix.size(), suffix) != 0)
+            continue;
+        const auto middle = s.begin() + static_cast<std::ptrdiff_t>(prefix.size());
+        if (std::all_of(middle, s.end() - static_cast<std::ptrdiff_t>(suffix.size()), isDigit) &&
+            e.is_regular_file(ec))
+            out.push_back(e.path().string());
+    }
+    return out;
+}
+
+double fpsToken(const std::string& name) {
+    std::smatch m;
+    const std::string s = lower(name);
+    if (std::regex_search(s, m, std::regex(R"((\d+(?:\.\d+)?)fps)")))
+        return std::atof(m[1].str().c_str());
+    return 0.0;
+}
+
+int sequenceThreads() {
+    const int n = orderedWorkerThreadsFromEnvironment("LIVIM_SEQUENCE_THREADS");
+    return n > 0 ? n : defaultOrderedWorkerThreads();
+}
+
+} // namespace
+
+bool ImageSequence::handles(const std::string& path) {
+    std::error_code ec;
+    return fs::is_directory(path, ec) || isImageExtension(lower(fs::path(path).extension().string()));
+}
+
+std::shared_ptr<const ImageSequence> ImageSequence::open(const std::string& path) {
+    std::error_code ec;
+    fs::path p(path);
+    const bool isDir = fs::is_directory(p, ec);
+    if (isDir && !p.has_filename()) p = p.parent_path(); // "frames/" names the directory "frames"
+
+    auto seq = std::make_shared<ImageSequence>();
+    seq->files_ = isDir ? listDirectory(p) : listSiblings(p);
+    if (seq->files_.empty()) return nullptr;
+    std::sort(seq->files_.begin(), seq->files_.end(), naturalLess);
+
+    const fs::path dir = isDir ? p : p.parent_path();
+    seq->fps_ = fpsToken(dir.filename().string());
+    if (seq->fps_ <= 0.0) seq->fps_ = fpsToken(fs::path(seq->files_.front()).stem().string());
+
+    const cv::Mat first = cv::imread(seq->files_.front(), cv::IMREAD_UNCHANGED);
+    if (first.empty()) return nullptr;
+    seq->size_ = first.size();
+    seq->channels_ = first.channels() == 1 ? 1 : 3;
+    return seq;
+}
+
+cv::Mat ImageSequence::decode(std::int64_t i, bool gray) const {
+    if (i < 0 || i >= frameCount()) return {};
+    // IMREAD_GRAYSCALE also lets JPEG skip its chroma entirely.
+    cv::Mat image = cv::imread(file(i), gray || channels_ == 1 ? cv::IMREAD_GRAYSCALE
+                                                                : cv::IMREAD_COLOR);
+    if (!image.empty() && image.size() != size_)
+        cv::resize(image, image, size_, 0, 0, cv::INTER_AREA);
+    return image;
+}
+
+ImageSequenceReader::ImageSequenceReader(int threads)
+    : workers_(threads > 0 ? threads : sequenceThreads(), "sequence-decode",
+               [](Job& job) { job.image = job.seq->decode(job.index, job.gray); }) {}
+
+void ImageSequenceReader::start(std::shared_ptr<const ImageSequence> seq, std::int64_t first,
+                                std::int64_t end, bool gray) {
+    workers_.clear();
+    seq_ = std::move(seq);
+    gray_ = gray;
+    queuedTo_ = std::max<std::int64_t>(0, first);
+    end_ = seq_ ? std::min(end, seq_->frameCount()) : 0;
+    refill();
+}
+
+void ImageSequenceReader::stop() {
+    workers_.clear();
+    queuedTo_ = end_ = 0;
+    seq_.reset();
+}
+
+void ImageSequenceReader::refill() {
+    while (queuedTo_ < end_ && workers_.size() < workers_.capacity()) {
+        Job job;
+        job.seq = seq_;
+        job.index = queuedTo_++;
+        job.gray = gray_;
+        workers_.push(std::move(job));
+    }
+}
+
+bool ImageSequenceReader::next(cv::Mat& dst) {
+    Job job;
+    if (!workers_.pop(job)) return false;
+    dst = std::move(job.image);
+    refill();
+    return true;
+}
+
+} // namespace livim
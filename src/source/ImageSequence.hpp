@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "core/OrderedWorkers.hpp"
+
+namespace livim {
+
+// A numbered run of still images (PNG, TIFF, JPEG, BMP, PNM) played as one clip, as lab captures
+// often arrive. Opened from a directory (its most common image type, e.g. "frames/") or from any
+// one frame ("frames/img_0001.png": every sibling named "img_<digits>.png"). Frames are sorted
+// naturally, so "img_2" comes before "img_10" with or without zero padding. A "<N>fps" token in the
+// directory name gives the rate; otherwise it's unknown. Immutable once opened; shareable.
+class ImageSequence {
+public:
+    // A directory or an image file; open() still checks there is something decodable.
+    static bool handles(const std::string& path);
+
+    static std::shared_ptr<const ImageSequence> open(const std::string& path);
+
+    std::int64_t frameCount() const { return static_cast<std::int64_t>(files_.size()); }
+    const std::string& file(std::int64_t i) const { return files_[static_cast<std::size_t>(i)]; }
+    cv::Size size() const { return size_; }         // of the first frame; the rest are fitted
+    int      channels() const { return channels_; } // 1 for mono images, else 3
+    double   fps() const { return fps_; }           // 0 = unknown
+
+    // Frame `i` as delivered: single-channel if `gray` or the sequence is mono, else BGR, resized
+    // to size() if its file differs. Empty if the file can't be decoded. Thread-safe.
+    cv::Mat decode(std::int64_t i, bool gray) const;
+
+private:
+    std::vector<std::string> files_;
+    cv::Size size_{0, 0};
+    int      channels_ = 3;
+    double   fps_ = 0.0;
+};
+
+// Decodes an ImageSequence ahead of its reader on an OrderedWorkers pool of its own and hands the
+// frames back strictly in order. Image codecs are single-threaded, so this is where a sequence gets
+// its parallelism. Threads are taken from LIVIM_SEQUENCE_THREADS, else
+// defaultOrderedWorkerThreads(). One reader at a time.
+class ImageSequenceReader {
+public:
+    explicit ImageSequenceReader(int threads = 0); // 0 = default, see above
+
+    // Starts on frames [first, end) of `seq`, dropping whatever was in flight.
+    void start(std::shared_ptr<const ImageSequence> seq, std::int64_t first, std::int64_t end,
+               bool gray);
+    // Drops whatever is in flight; next() then returns false until the next start().
+    void stop();
+
+    // The next frame, waiting for it if it's still decoding. False once `end` is reached. An
+    // undecodable file comes back as an empty `dst`, so the caller decides whether to skip it.
+    bool next(cv::Mat& dst);
+
+private:
+    struct Job {
+        std::shared_ptr<const ImageSequence> seq;
+        std::int64_t index = 0;
+        bool         gray = false;
+        cv::Mat      image;
+    };
+
+    void refill(); // tops the window up
+
+    std::shared_ptr<const ImageSequence> seq_;
+    bool         gray_ = false;
+    std::int64_t queuedTo_ = 0; // next frame to queue
+    std::int64_t end_ = 0;
+    OrderedWorkers<Job> workers_;
+};
+
+} // namespace livim
@@ -0,0 +1,129 @@
+#include "source/ImageSequenceSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Instrumentation.hpp"
+
+namespace livim {
+
+ImageSequenceSource::ImageSequenceSource(std::string path, FrameQueue* out, FramePool* pool,
+                             Instrumentation* instr)
+    : SourceBase(out, pool, instr), path_(std::move(path)) {}
+
+bool ImageSequenceSource::open() {
+    sequence_ = ImageSequence::open(path_);
+    if (!sequence_) return false;
+    const double fps = sequence_->fps();
+    reportedFps_ = (fps > 1.0) ? fps : 30.0; // fall back to 30 when unreported
+    frameIntervalUs_ = 1'000'000.0 / reportedFps_;
+    frameCount_ = sequence_->frameCount();
+    outFrame_.store(-1, std::memory_order_release);
+    pos_ = 0;
+    readerPos_ = -1;
+
+    setNativeChannels(sequence_->channels());
+    setNativeSize(sequence_->size().width, sequence_->size().height);
+    return true;
+}
+
+std::int64_t ImageSequenceSource::effectiveOut() const {
+    const std::int64_t out = outFrame_.load(std::memory_order_acquire);
+    return out >= 0 ? out : frameCount_;
+}
+
+void ImageSequenceSource::seekFrame(std::int64_t frame) {
+    const std::int64_t in = inFrame_.load(std::memory_order_acquire);
+    const std::int64_t hi = std::max<std::int64_t>(in, effectiveOut() - 1);
+    reachedEnd_.store(false, std::memory_order_release);
+    pendingSeekFrame_.store(std::clamp<std::int64_t>(frame, in, hi), std::memory_order_release);
+    wakePauseWaiters(); // so a paused thread wakes and renders the scrubbed frame
+}
+
+void ImageSequenceSource::setInOut(std::int64_t in, std::int64_t out) {
+    const std::int64_t o = out < 0 ? -1 : std::clamp<std::int64_t>(out, 1, frameCount_);
+    const std::int64_t hi = (o < 0 ? frameCount_ : o) - 1;
+    inFrame_.store(std::clamp<std::int64_t>(in, 0, std::max<std::int64_t>(0, hi)),
+                   std::memory_order_release);
+    outFrame_.store(o, std::memory_order_release);
+}
+
+void ImageSequenceSource::run() {
+    while (!stopRequested()) {
+        // Also wake on a pending seek so the user can scrub while paused.
+        const Clock::duration paused =
+            waitWhilePaused([this] { return pendingSeekFrame_.load(std::memory_order_acquire) >= 0; });
+        if (stopRequested()) break;
+        if (paused > Clock::duration::zero()) resetPacing();
+
+        const std::int64_t seekTo = pendingSeekFrame_.exchange(-1, std::memory_order_acq_rel);
+        const bool didSeek = seekTo >= 0;
+        if (didSeek) {
+            pos_ = std::clamp<std::int64_t>(seekTo, 0, std::max<std::int64_t>(0, frameCount_ - 1));
+            resetPacing();
+            reachedEnd_.store(false, std::memory_order_release);
+        }
+
+        const bool isPaused = this->paused();
+        if (isPaused && !didSeek) continue; // paused, nothing to scrub
+
+        // Enforce the OUT bound (also the natural end): loop back to IN, or park at the end.
+        if (!isPaused && pos_ >= effectiveOut()) {
+            if (loop_.load(std::memory_order_acquire)) {
+                pos_ = inFrame_.load(std::memory_order_acquire);
+                resetPacing();
+            } else {
+                reachedEnd_.store(true, std::memory_order_release);
+                currentFrame_.store(std::max<std::int64_t>(0, effectiveOut() - 1),
+                                    std::memory_order_release);
+                pause();
+                resetPacing();
+                continue;
+            }
+        }
+
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        // A seek, a loop or a luma toggle moves the reader; so does an out-point that grew past
+        // where it stopped.
+        const bool luma = lumaOnly_.load(std::memory_order_acquire);
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            for (int attempt = 0; attempt < 2 && !ok; ++attempt) {
+                if (attempt > 0 || readerPos_ != pos_ || readerGray_ != luma) {
+                    reader_.start(sequence_, pos_, std::max(pos_ + 1, effectiveOut()), luma);
+                    readerPos_ = pos_;
+                    readerGray_ = luma;
+                }
+                ok = reader_.next(frame->image);
+            }
+        }
+        if (!ok) break; // only past the end, which the bound above rules out
+        ++readerPos_;
+        if (frame->image.empty()) { // undecodable file: skip it
+            ++pos_;
+            continue;
+        }
+
+        const std::int64_t emitted = pos_++;
+
+        // Drop a scrub-induced frame superseded by a newer pending seek.
+        if (didSeek && pendingSeekFrame_.load(std::memory_order_acquire) >= 0) continue;
+
+        frame->seq = seq_++;
+        frame->captureTs = now();
+        frame->width = frame->image.cols;
+        frame->height = frame->image.rows;
+        frame->format = (frame->image.channels() == 1) ? PixelFormat::Gray8 : PixelFormat::BGR8;
+        frame->ptsUs = static_cast<std::int64_t>(static_cast<double>(emitted) * frameIntervalUs_);
+        currentFrame_.store(emitted, std::memory_order_release);
+
+        if (instr_) instr_->onCaptured();
+        if (!isPaused) paceFrame(); // scrub previews emit immediately, never paced
+        if (!emit(std::move(frame))) break;
+    }
+}
+
+} // namespace livim
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "source/ImageSequence.hpp"
+#include "source/SourceBase.hpp"
+
+namespace livim {
+
+// Plays a directory of numbered stills (see ImageSequence). An ImageSequenceReader decodes a few
+// frames ahead in parallel, and this thread emits them strictly in order, paced like FileSource,
+// with the same synthesized ptsUs and BLOCK pushes. A seek or a loop restarts the reader at the
+// new frame; a file that fails to decode is skipped rather than ending playback.
+class ImageSequenceSource : public SourceBase {
+public:
+    ImageSequenceSource(std::string path, FrameQueue* out, FramePool* pool, Instrumentation* instr);
+    ~ImageSequenceSource() override { stop(); }
+
+    SourceKind kind() const override { return SourceKind::File; }
+    bool open() override;
+    bool isOpen() const override { return sequence_ != nullptr; }
+    void setLoop(bool enabled) override { loop_.store(enabled, std::memory_order_release); }
+    void setLumaOnly(bool enabled) override { lumaOnly_.store(enabled, std::memory_order_release); }
+    double reportedFps() const override { return reportedFps_; }
+
+    bool seekable() const override { return frameCount_ > 0; }
+    std::int64_t frameCount() const override { return frameCount_; }
+    std::int64_t currentFrame() const override { return currentFrame_.load(std::memory_order_acquire); }
+    void seekFrame(std::int64_t frame) override;
+    void setInOut(std::int64_t in, std::int64_t out) override;
+    bool atEnd() const override { return reachedEnd_.load(std::memory_order_acquire); }
+
+protected:
+    void run() override;
+
+private:
+    std::int64_t effectiveOut() const; // out-point, or frameCount_
+
+    std::string path_;
+    std::shared_ptr<const ImageSequence> sequence_;
+    ImageSequenceReader reader_;   // source thread only, after open()
+    std::int64_t pos_ = 0;         // index of the NEXT frame to emit
+    std::int64_t readerPos_ = -1;  // frame reader_.next() returns next; -1 = not started
+    bool readerGray_ = false;
+    std::uint64_t seq_ = 0;
+    double reportedFps_ = 0.0;
+    double frameIntervalUs_ = 0.0; // for the synthesized ptsUs
+    std::int64_t frameCount_ = 0;
+    std::atomic<bool> loop_{false};
+    std::atomic<bool> lumaOnly_{false};
+    std::atomic<std::int64_t> currentFrame_{0};
+    std::atomic<std::int64_t> pendingSeekFrame_{-1}; // -1 = no seek requested
+    std::atomic<std::int64_t> inFrame_{0};        // inclusive
+    std::atomic<std::int64_t> outFrame_{-1};      // exclusive; -1 = to the end
+    std::atomic<bool> reachedEnd_{false};         // parked at the out-point (non-looping)
+};
+
+} // namespace livim
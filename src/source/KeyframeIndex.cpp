@@ -0,0 +1,153 @@
+#include "source/KeyframeIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+#include "source/MediaCache.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+namespace livim {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr char          kMagic[4] = {'L', 'V', 'K', 'I'};
+constexpr std::uint32_t kVersion = 1;
+
+template <class T>
+void put(std::ostream& os, const T& v) {
+    os.write(reinterpret_cast<const char*>(&v), sizeof(v));
+}
+
+template <class T>
+bool get(std::istream& is, T& v) {
+    return static_cast<bool>(is.read(reinterpret_cast<char*>(&v), sizeof(v)));
+}
+
+} // namespace
+
+std::string KeyframeIndex::cachePathFor(const std::string& path) {
+    return mediaCachePath(path, "keyframes", ".lvki");
+}
+
+std::shared_ptr<const KeyframeIndex> KeyframeIndex::loadCached(const std::string& path) {
+    const std::string cachePath = cachePathFor(path);
+    return cachePath.empty() ? nullptr : load(cachePath);
+}
+
+std::shared_ptr<const KeyframeIndex> KeyframeIndex::loadOrBuild(const std::string& path,
+                                                                const std::atomic<bool>& cancel) {
+    const std::string cachePath = cachePathFor(path);
+    if (!cachePath.empty()) {
+        if (std::shared_ptr<KeyframeIndex> cached = load(cachePath)) return cached;
+    }
+    std::shared_ptr<KeyframeIndex> built = build(path, cancel);
+    if (built && !cachePath.empty()) built->save(cachePath); // best effort: may be read-only
+    return built;
+}
+
+std::shared_ptr<KeyframeIndex> KeyframeIndex::build(const std::string& path,
+                                                    const std::atomic<bool>& cancel) {
+    AVFormatContext* fmt = nullptr;
+    if (avformat_open_input(&fmt, path.c_str(), nullptr, nullptr) < 0) return nullptr;
+    const int streamIndex = avformat_find_stream_info(fmt, nullptr) < 0
+                                ? -1
+                                : av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    AVPacket* packet = av_packet_alloc();
+    if (streamIndex < 0 || !packet) {
+        av_packet_free(&packet);
+        avformat_close_input(&fmt);
+        return nullptr;
+    }
+    // Only the video stream's packets are wanted; the demuxer skips the rest cheaply.
+    for (unsigned i = 0; i < fmt->nb_streams; ++i)
+        if (static_cast<int>(i) != streamIndex) fmt->streams[i]->discard = AVDISCARD_ALL;
+    AVStream* stream = fmt->streams[streamIndex];
+
+    // Must number frames exactly like LibavDecoder::indexOf(), which opens the file the same way.
+    const AVRational guessed = av_guess_frame_rate(fmt, stream, nullptr);
+    const double fps = guessed.num > 0 && guessed.den > 0 ? av_q2d(guessed) : 0.0;
+    const double rate = fps > 0.0 ? fps : 30.0;
+    const double tb = av_q2d(stream->time_base);
+    const std::int64_t startPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    auto index = std::make_shared<KeyframeIndex>();
+    bool cancelled = false;
+    while (av_read_frame(fmt, packet) >= 0) {
+        if (cancel.load(std::memory_order_relaxed)) {
+            cancelled = true;
+            av_packet_unref(packet);
+            break;
+        }
+        if (packet->stream_index == streamIndex) {
+            ++index->frameCount_;
+            const std::int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if ((packet->flags & AV_PKT_FLAG_KEY) && ts != AV_NOPTS_VALUE) {
+                const std::int64_t frame =
+                    std::llround(static_cast<double>(ts - startPts) * tb * rate);
+                index->entries_.push_back({std::max<std::int64_t>(0, frame), ts, packet->pos});
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    avformat_close_input(&fmt);
+    if (cancelled) return nullptr;
+
+    // Decode order is not presentation order for every muxer; lookups need ascending frames.
+    std::sort(index->entries_.begin(), index->entries_.end(),
+              [](const Entry& a, const Entry& b) { return a.frame < b.frame; });
+    return index;
+}
+
+const KeyframeIndex::Entry* KeyframeIndex::keyframeAtOrBefore(std::int64_t frame) const {
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), frame,
+                               [](std::int64_t f, const Entry& e) { return f < e.frame; });
+    return it == entries_.begin() ? nullptr : &*std::prev(it);
+}
+
+// Layout (host byte order; the cache never leaves this machine): magic, version, frame count,
+// entry count, then {frame, pts, pos} per entry.
+std::shared_ptr<KeyframeIndex> KeyframeIndex::load(const std::string& cachePath) {
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in) return nullptr;
+    char magic[4] = {};
+    std::uint32_t version = 0;
+    std::uint64_t n = 0;
+    auto index = std::make_shared<KeyframeIndex>();
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + 4, kMagic) ||
+        !get(in, version) || version != kVersion || !get(in, index->frameCount_) || !get(in, n))
+        return nullptr;
+    // Bounded by what the file can hold, so a truncated cache can't ask for a huge allocation.
+    std::error_code ec;
+    const std::uintmax_t bytes = fs::file_size(cachePath, ec);
+    if (ec || n > bytes / sizeof(Entry)) return nullptr;
+    index->entries_.resize(static_cast<std::size_t>(n));
+    for (Entry& e : index->entries_)
+        if (!get(in, e.frame) || !get(in, e.pts) || !get(in, e.pos)) return nullptr;
+    return index;
+}
+
+bool KeyframeIndex::save(const std::string& cachePath) const {
+    return writeCacheFile(cachePath, [this](std::ostream& out) {
+        out.write(kMagic, sizeof(kMagic));
+        put(out, kVersion);
+        put(out, frameCount_);
+        put(out, static_cast<std::uint64_t>(entries_.size()));
+        for (const Entry& e : entries_) {
+            put(out, e.frame);
+            put(out, e.pts);
+            put(out, e.pos);
+        }
+        return static_cast<bool>(out);
+    });
+}
+
+} // namespace livim
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace livim {
+
+// Where the keyframes of one file's best video stream are, found by demuxing it once (packets
+// only, nothing decoded) and cached on disk so reopening the same file skips the scan. Lets
+// LibavDecoder::seek() jump straight to the keyframe a target frame needs and keep decoding
+// forward when the target is still inside the current GOP. Immutable once built; shareable.
+class KeyframeIndex {
+public:
+    struct Entry {
+        std::int64_t frame = 0; // same numbering as LibavDecoder::frameIndex()
+        std::int64_t pts = 0;   // stream time base
+        std::int64_t pos = -1;  // byte offset of the packet; -1 = unknown
+    };
+
+    // The cached index if it still matches the file, else a fresh scan, which is then cached.
+    // Null if the file can't be demuxed or `cancel` was raised mid-scan.
+    static std::shared_ptr<const KeyframeIndex> loadOrBuild(const std::string& path,
+                                                            const std::atomic<bool>& cancel);
+
+    // Scans `path` without touching the cache.
+    static std::shared_ptr<KeyframeIndex> build(const std::string& path,
+                                                const std::atomic<bool>& cancel);
+
+    // The cached index for `path`, or null if it hasn't been scanned (since it last changed).
+    static std::shared_ptr<const KeyframeIndex> loadCached(const std::string& path);
+
+    // Cache file for `path` (see mediaCachePath()); empty if there is none.
+    static std::string cachePathFor(const std::string& path);
+
+    // The keyframe `frame` decodes from; null before the first one (or for an empty index).
+    const Entry* keyframeAtOrBefore(std::int64_t frame) const;
+
+    const std::vector<Entry>& entries() const { return entries_; }
+    std::size_t  size() const { return entries_.size(); }
+    std::int64_t frameCount() const { return frameCount_; } // packets seen, so exact
+
+private:
+    static std::shared_ptr<KeyframeIndex> load(const std::string& cachePath);
+    bool save(const std::string& cachePath) const;
+
+    std::vector<Entry> entries_; // ascending frame
+    std::int64_t       frameCount_ = 0;
+};
+
+} // namespace livim
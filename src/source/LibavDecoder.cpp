@@ -0,0 +1,249 @@
+#include "source/LibavDecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "source/KeyframeIndex.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+namespace livim {
+namespace {
+
+// Without a keyframe index, a forward seek this short decodes straight through instead of going
+// back to a keyframe.
+constexpr std::int64_t kDecodeThroughFrames = 32;
+
+} // namespace
+
+bool LibavDecoder::open(const std::string& path, int threads) {
+    close();
+    if (avformat_open_input(&fmt_, path.c_str(), nullptr, nullptr) < 0) return false;
+    const AVCodec* codec = nullptr;
+    const int streamIndex =
+        avformat_find_stream_info(fmt_, nullptr) < 0
+            ? -1
+            : av_find_best_stream(fmt_, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    if (streamIndex < 0 || !codec) {
+        close();
+        return false;
+    }
+    stream_ = fmt_->streams[streamIndex];
+
+    ctx_ = avcodec_alloc_context3(codec);
+    if (!ctx_ || avcodec_parameters_to_context(ctx_, stream_->codecpar) < 0) {
+        close();
+        return false;
+    }
+    ctx_->pkt_timebase = stream_->time_base;
+    ctx_->thread_count = std::max(0, threads);
+    ctx_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    frame_ = av_frame_alloc();
+    packet_ = av_packet_alloc();
+    if (avcodec_open2(ctx_, codec, nullptr) < 0 || !frame_ || !packet_) {
+        close();
+        return false;
+    }
+
+    const AVRational rate = av_guess_frame_rate(fmt_, stream_, nullptr);
+    fps_ = rate.num > 0 && rate.den > 0 ? av_q2d(rate) : 0.0;
+    startPts_ = stream_->start_time != AV_NOPTS_VALUE ? stream_->start_time : 0;
+
+    // Containers that don't store a frame count get one from the duration; 0 = still unknown.
+    const double tb = av_q2d(stream_->time_base);
+    if (stream_->nb_frames > 0)
+        frameCount_ = stream_->nb_frames;
+    else if (stream_->duration != AV_NOPTS_VALUE && fps_ > 0.0)
+        frameCount_ = std::llround(static_cast<double>(stream_->duration) * tb * fps_);
+    else if (fmt_->duration != AV_NOPTS_VALUE && fps_ > 0.0)
+        frameCount_ = std::llround(static_cast<double>(fmt_->duration) / AV_TIME_BASE * fps_);
+
+    size_ = cv::Size(ctx_->width, ctx_->height);
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(ctx_->pix_fmt);
+    gray_ = desc && desc->nb_components <= 2 &&
+            !(desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL));
+    i420_ = ctx_->pix_fmt == AV_PIX_FMT_YUV420P && ctx_->color_range != AVCOL_RANGE_JPEG &&
+            ctx_->width % 2 == 0 && ctx_->height % 2 == 0;
+    threads_ = ctx_->thread_count; // resolved by avcodec_open2 when 0 was asked for
+    codec_ = codec->name;
+    return true;
+}
+
+void LibavDecoder::close() {
+    sws_freeContext(sws_);
+    sws_ = nullptr;
+    av_frame_free(&frame_);
+    av_packet_free(&packet_);
+    avcodec_free_context(&ctx_);
+    avformat_close_input(&fmt_);
+    stream_ = nullptr;
+    fps_ = 0.0;
+    frameCount_ = 0;
+    startPts_ = 0;
+    index_ = -1;
+    corrupt_ = 0;
+    size_ = cv::Size(0, 0);
+    threads_ = 0;
+    gray_ = i420_ = draining_ = held_ = false;
+    codec_.clear();
+    keyframes_.reset();
+}
+
+std::int64_t LibavDecoder::indexOf(std::int64_t pts) const {
+    if (pts == AV_NOPTS_VALUE) return index_ + 1;
+    return std::llround(static_cast<double>(pts - startPts_) * av_q2d(stream_->time_base) *
+                        rate());
+}
+
+bool LibavDecoder::decode() {
+    if (!ctx_) return false;
+    if (held_) {
+        held_ = false;
+        return true;
+    }
+    for (;;) {
+        const int err = avcodec_receive_frame(ctx_, frame_);
+        if (err == 0) {
+            index_ = indexOf(frame_->best_effort_timestamp);
+            size_ = cv::Size(frame_->width, frame_->height);
+            return true;
+        }
+        if (err == AVERROR_INVALIDDATA) {
+            ++corrupt_;
+            continue;
+        }
+        if (err != AVERROR(EAGAIN) || draining_) return false; // drained, or fatal
+
+        if (av_read_frame(fmt_, packet_) < 0) {
+            // End of file: flush the frames the (frame-threaded) decoder still holds.
+            draining_ = true;
+            avcodec_send_packet(ctx_, nullptr);
+            continue;
+        }
+        if (packet_->stream_index == stream_->index && avcodec_send_packet(ctx_, packet_) < 0)
+            ++corrupt_;
+        av_packet_unref(packet_);
+    }
+}
+
+bool LibavDecoder::seek(std::int64_t frame) {
+    if (!ctx_) return false;
+    frame = std::max<std::int64_t>(0, frame);
+    if (held_ && index_ == frame) return true;
+
+    const std::int64_t next = held_ ? index_ : index_ + 1;
+    bool decodeOn = frame >= next;
+    if (decodeOn) {
+        if (keyframes_) {
+            // Only a keyframe between here and the target makes going back to the demuxer pay.
+            const KeyframeIndex::Entry* k = keyframes_->keyframeAtOrBefore(frame);
+            decodeOn = !k || k->frame <= next;
+        } else {
+            decodeOn = frame - next <= kDecodeThroughFrames;
+        }
+    }
+    if (!decodeOn && !reseek(frame)) return false;
+
+    held_ = false;
+    while (decode()) {
+        if (index_ >= frame) {
+            held_ = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LibavDecoder::seekToKeyframe(std::int64_t frame) {
+    if (!ctx_) return false;
+    held_ = false;
+    return reseek(std::max<std::int64_t>(0, frame));
+}
+
+bool LibavDecoder::reseek(std::int64_t frame) {
+    const KeyframeIndex::Entry* k = keyframes_ ? keyframes_->keyframeAtOrBefore(frame) : nullptr;
+    int err = -1;
+    if (k) {
+        // Straight onto the keyframe, so the demuxer's own (possibly coarse) search is skipped.
+        err = av_seek_frame(fmt_, stream_->index, k->pts, AVSEEK_FLAG_BACKWARD);
+        if (err < 0 && k->pos >= 0)
+            err = av_seek_frame(fmt_, stream_->index, k->pos, AVSEEK_FLAG_BYTE);
+    }
+    if (err < 0) {
+        const double tb = av_q2d(stream_->time_base);
+        const std::int64_t ts =
+            startPts_ + std::llround(static_cast<double>(frame) / rate() / tb);
+        err = av_seek_frame(fmt_, stream_->index, ts, AVSEEK_FLAG_BACKWARD);
+    }
+    if (err < 0) return false;
+    avcodec_flush_buffers(ctx_);
+    draining_ = false;
+    index_ = -1;
+    return true;
+}
+
+bool LibavDecoder::convert(cv::Mat& dst, int dstFormat, int dstType, cv::Size size) {
+    if (!frame_ || index_ < 0) return false;
+    const int w = frame_->width, h = frame_->height;
+    const bool scaled = size.width > 0 && size.height > 0 && size != cv::Size(w, h);
+    const int dw = scaled ? size.width : w, dh = scaled ? size.height : h;
+    dst.create(dh, dw, dstType); // no-op for a pooled buffer that already fits
+    // Same size, this is one colour-conversion pass; bicubic chroma like OpenCV's reader. A
+    // downscale averages (like INTER_AREA) so thumbnails don't alias.
+    sws_ = sws_getCachedContext(sws_, w, h, static_cast<AVPixelFormat>(frame_->format), dw, dh,
+                                static_cast<AVPixelFormat>(dstFormat),
+                                scaled ? SWS_AREA : SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (!sws_) return false;
+    std::uint8_t* const out[] = {dst.data};
+    const int stride[] = {static_cast<int>(dst.step)};
+    sws_scale(sws_, frame_->data, frame_->linesize, 0, h, out, stride);
+    return true;
+}
+
+bool LibavDecoder::toBgr(cv::Mat& dst) { return convert(dst, AV_PIX_FMT_BGR24, CV_8UC3, {}); }
+
+bool LibavDecoder::toGray(cv::Mat& dst) { return convert(dst, AV_PIX_FMT_GRAY8, CV_8UC1, {}); }
+
+bool LibavDecoder::toI420(cv::Mat& dst) {
+    if (!frame_ || index_ < 0) return false;
+    const int w = frame_->width, h = frame_->height;
+    if (w % 2 != 0 || h % 2 != 0) return false;
+    dst.create(h * 3 / 2, w, CV_8UC1);
+    // Same format and size, swscale just copies the planes.
+    sws_ = sws_getCachedContext(sws_, w, h, static_cast<AVPixelFormat>(frame_->format), w, h,
+                                AV_PIX_FMT_YUV420P, SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (!sws_) return false;
+    const std::size_t luma = dst.step * static_cast<std::size_t>(h);
+    std::uint8_t* const out[] = {dst.data, dst.data + luma, dst.data + luma + luma / 4};
+    const int stride[] = {static_cast<int>(dst.step), static_cast<int>(dst.step / 2),
+                          static_cast<int>(dst.step / 2)};
+    sws_scale(sws_, frame_->data, frame_->linesize, 0, h, out, stride);
+    return true;
+}
+
+bool LibavDecoder::toBgr(cv::Mat& dst, cv::Size size) {
+    return convert(dst, AV_PIX_FMT_BGR24, CV_8UC3, size);
+}
+
+bool LibavDecoder::lumaPlane(cv::Mat& y, std::shared_ptr<const void>& owner) const {
+    if (!frame_ || index_ < 0) return false;
+    const AVPixFmtDescriptor* desc =
+        av_pix_fmt_desc_get(static_cast<AVPixelFormat>(frame_->format));
+    if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_PAL))) return false;
+    const AVComponentDescriptor& c = desc->comp[0];
+    if (c.plane != 0 || c.step != 1 || c.depth != 8) return false; // e.g. packed YUYV, 10-bit
+    // A new reference to the picture's buffers: libavcodec decodes on into others meanwhile.
+    std::shared_ptr<AVFrame> ref(av_frame_clone(frame_), [](AVFrame* f) { av_frame_free(&f); });
+    if (!ref) return false;
+    y = cv::Mat(ref->height, ref->width, CV_8UC1, ref->data[0],
+                static_cast<std::size_t>(ref->linesize[0]));
+    owner = std::move(ref);
+    return true;
+}
+
+} // namespace livim
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <opencv2/core.hpp>
+
+struct AVCodecContext;
+struct AVFormatContext;
+struct AVFrame;
+struct AVPacket;
+struct AVStream;
+struct SwsContext;
+
+namespace livim {
+
+class KeyframeIndex;
+
+// libavformat/libavcodec decoder for one file's best video stream, shared by the live FileSource
+// and the export FileExportFrameSource. Frame + slice threading are on, so a long-GOP clip
+// decodes on several cores while the caller sees frames strictly in order. Decoded pictures live
+// in libavcodec's own refcounted buffer pool; toBgr()/toGray() convert one with a single swscale
+// pass straight into the caller's (pooled) cv::Mat, toI420() copies a 4:2:0 picture out as it is,
+// and lumaPlane() hands out the Y plane with no copy at all. Not thread-safe: one decoding thread
+// at a time.
+class LibavDecoder {
+public:
+    LibavDecoder() = default;
+    ~LibavDecoder() { close(); }
+
+    LibavDecoder(const LibavDecoder&) = delete;
+    LibavDecoder& operator=(const LibavDecoder&) = delete;
+
+    // `threads` = 0 lets libavcodec pick one per core.
+    bool open(const std::string& path, int threads = 0);
+    void close();
+    bool isOpen() const { return ctx_ != nullptr; }
+
+    double       fps() const { return fps_; }               // 0 = unknown
+    std::int64_t frameCount() const { return frameCount_; } // 0 = unknown
+    cv::Size     size() const { return size_; }             // last frame's, else the header's
+    int          channels() const { return gray_ ? 1 : 3; } // 1 = a mono source
+    // 8-bit limited-range 4:2:0 of an even size, so toI420() is a copy rather than a conversion.
+    bool         nativeI420() const { return i420_; }
+    int          threads() const { return threads_; }       // decoder threads actually running
+    const std::string& codecName() const { return codec_; }
+
+    // Decodes the next frame in presentation order. False at end of stream or on a fatal error;
+    // a corrupt packet is skipped and counted instead.
+    bool decode();
+
+    // Positions frame-accurately: seeks to the keyframe at or before `frame` and decodes forward,
+    // so the next decode() returns `frame` itself. False past the end. With a keyframe index a
+    // target still inside the current GOP is decoded straight on (no flush, no re-decoding from
+    // the keyframe); without one only a short hop forward is.
+    bool seek(std::int64_t frame);
+
+    // Coarse positioning for previews: the next decode() returns the keyframe at or before
+    // `frame` (or the first frame after it that decodes) instead of `frame` itself, so nothing
+    // between the two is decoded. False if the demuxer can't seek.
+    bool seekToKeyframe(std::int64_t frame);
+
+    // Built for the same file (see KeyframeIndex); null goes back to the demuxer's own seeking.
+    void setKeyframeIndex(std::shared_ptr<const KeyframeIndex> index) {
+        keyframes_ = std::move(index);
+    }
+
+    // Of the last decoded frame, from its timestamp (so it survives seeks and dropped packets).
+    std::int64_t frameIndex() const { return index_; }
+    std::int64_t corruptPackets() const { return corrupt_; }
+
+    // The last decoded frame, converted into `dst` (reallocated only if its size or type differ).
+    // toBgr() of a mono source and toGray() of a colour one convert too. False if the frame's
+    // format has no swscale path.
+    bool toBgr(cv::Mat& dst);
+    bool toGray(cv::Mat& dst);
+    // As PixelFormat::I420 (see core/Frame.hpp); false for an odd size.
+    bool toI420(cv::Mat& dst);
+    // Scaled to `size` in the same swscale pass (area-averaged), e.g. for thumbnails.
+    bool toBgr(cv::Mat& dst, cv::Size size);
+
+    // Zero-copy view of the last frame's 8-bit luma plane, in its own range like an I420 frame's
+    // Y plane. `owner` references the decoded picture (e.g. for Frame::backing), so the view stays
+    // valid however far decoding moves on. False for RGB, paletted or deeper-than-8-bit formats,
+    // which toGray() converts instead.
+    bool lumaPlane(cv::Mat& y, std::shared_ptr<const void>& owner) const;
+
+private:
+    bool convert(cv::Mat& dst, int dstFormat, int dstType, cv::Size size);
+    double rate() const { return fps_ > 0.0 ? fps_ : 30.0; } // for indices when fps is unknown
+    std::int64_t indexOf(std::int64_t pts) const;
+    bool reseek(std::int64_t frame); // demuxer back to the keyframe `frame` needs; decoder flushed
+
+    AVFormatContext* fmt_ = nullptr;
+    AVCodecContext*  ctx_ = nullptr;
+    AVStream*        stream_ = nullptr;
+    AVFrame*         frame_ = nullptr;
+    AVPacket*        packet_ = nullptr;
+    SwsContext*      sws_ = nullptr;
+    double           fps_ = 0.0;
+    std::int64_t     frameCount_ = 0;
+    std::int64_t     startPts_ = 0;
+    std::int64_t     index_ = -1;
+    std::int64_t     corrupt_ = 0;
+    cv::Size         size_{0, 0};
+    int              threads_ = 0;
+    bool             gray_ = false;
+    bool             i420_ = false;
+    bool             draining_ = false; // demuxer at EOF, decoder being flushed
+    bool             held_ = false;     // seek() left the target frame for the next decode()
+    std::string      codec_;
+    std::shared_ptr<const KeyframeIndex> keyframes_;
+};
+
+} // namespace livim
@@ -0,0 +1,99 @@
+#include "source/MediaCache.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace livim {
+namespace {
+
+namespace fs = std::filesystem;
+
+std::uint64_t fnv1a(const void* data, std::size_t n, std::uint64_t h) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+fs::path cacheRoot() {
+#ifdef _WIN32
+    if (const char* d = std::getenv("LOCALAPPDATA"); d && *d) return fs::path(d) / "livim";
+#else
+    if (const char* d = std::getenv("XDG_CACHE_HOME"); d && *d) return fs::path(d) / "livim";
+    if (const char* h = std::getenv("HOME"); h && *h) return fs::path(h) / ".cache" / "livim";
+#endif
+    return {};
+}
+
+// Unique per writer, so two threads or processes writing the same entry never share a temp file:
+// each rename publishes a complete file, and the last one wins.
+fs::path tempPathFor(const std::string& path) {
+#ifdef _WIN32
+    const long long pid = _getpid();
+#else
+    const long long pid = getpid();
+#endif
+    const std::size_t tid = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    char tag[48];
+    std::snprintf(tag, sizeof(tag), ".%lld.%zx.tmp", pid, tid);
+    return fs::path(path + tag);
+}
+
+} // namespace
+
+std::string mediaCachePath(const std::string& mediaPath, const std::string& kind,
+                           const std::string& suffix) {
+    const fs::path root = cacheRoot();
+    if (root.empty()) return {};
+    std::error_code ec;
+    const fs::path abs = fs::absolute(mediaPath, ec);
+    if (ec) return {};
+    const std::uint64_t size = fs::file_size(abs, ec);
+    if (ec) return {};
+    const fs::file_time_type t = fs::last_write_time(abs, ec);
+    if (ec) return {};
+    const std::int64_t mtime = static_cast<std::int64_t>(t.time_since_epoch().count());
+    const std::string name = abs.generic_string();
+
+    std::uint64_t h = 14695981039346656037ull;
+    h = fnv1a(name.data(), name.size(), h);
+    h = fnv1a(&size, sizeof(size), h);
+    h = fnv1a(&mtime, sizeof(mtime), h);
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+    return (root / kind / (hex + suffix)).string();
+}
+
+bool writeCacheFile(const std::string& path, const std::function<bool(std::ostream&)>& write) {
+    std::error_code ec;
+    const fs::path target(path);
+    fs::create_directories(target.parent_path(), ec);
+    if (ec) return false;
+    const fs::path tmp = tempPathFor(path);
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        if (!write(out) || !out.flush()) {
+            out.close();
+            fs::remove(tmp, ec);
+            return false;
+        }
+    }
+    fs::rename(tmp, target, ec);
+    if (!ec) return true;
+    fs::remove(tmp, ec);
+    return false;
+}
+
+} // namespace livim
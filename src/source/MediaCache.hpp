@@ -0,0 +1,24 @@
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace livim {
+
+// Per-user disk cache for data derived from a media file (keyframe index, timeline thumbnails).
+// Entries live under <cache dir>/livim/<kind>/ and are named by a hash of the file's absolute
+// path, size and mtime, so a rewritten or replaced file simply gets a new entry.
+
+// Cache file for `mediaPath`, e.g. ~/.cache/livim/keyframes/0123abcd....lvki. `suffix` is
+// appended to the hash (a variant tag and the extension). Empty if there is no cache dir or the
+// media file can't be stat'ed.
+std::string mediaCachePath(const std::string& mediaPath, const std::string& kind,
+                           const std::string& suffix);
+
+// Writes `path` through a temporary sibling (unique to the process and thread) renamed into place,
+// so a concurrent reader never sees half a file and concurrent writers never interleave. Creates
+// the directory. False (and nothing left behind) if `write` fails.
+bool writeCacheFile(const std::string& path, const std::function<bool(std::ostream&)>& write);
+
+} // namespace livim
@@ -0,0 +1,126 @@
+#include "source/RawFileSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Instrumentation.hpp"
+
+namespace livim {
+
+RawFileSource::RawFileSource(std::string path, FrameQueue* out, FramePool* pool,
+                             Instrumentation* instr)
+    : SourceBase(out, pool, instr), path_(std::move(path)) {}
+
+bool RawFileSource::open() {
+    if (!file_.open(path_)) return false;
+    const double fps = file_.fps();
+    reportedFps_ = (fps > 1.0) ? fps : 30.0; // fall back to 30 when unreported
+    frameIntervalUs_ = 1'000'000.0 / reportedFps_;
+    frameCount_ = file_.frameCount();
+    outFrame_.store(-1, std::memory_order_release);
+    pos_ = hintedTo_ = 0;
+
+    setNativeChannels(file_.channels());
+    setNativeSize(file_.size().width, file_.size().height);
+    return true;
+}
+
+std::int64_t RawFileSource::effectiveOut() const {
+    const std::int64_t out = outFrame_.load(std::memory_order_acquire);
+    return out >= 0 ? out : frameCount_;
+}
+
+void RawFileSource::seekFrame(std::int64_t frame) {
+    const std::int64_t in = inFrame_.load(std::memory_order_acquire);
+    const std::int64_t hi = std::max<std::int64_t>(in, effectiveOut() - 1);
+    reachedEnd_.store(false, std::memory_order_release);
+    pendingSeekFrame_.store(std::clamp<std::int64_t>(frame, in, hi), std::memory_order_release);
+    wakePauseWaiters(); // so a paused thread wakes and renders the scrubbed frame
+}
+
+void RawFileSource::setInOut(std::int64_t in, std::int64_t out) {
+    const std::int64_t o = out < 0 ? -1 : std::clamp<std::int64_t>(out, 1, frameCount_);
+    const std::int64_t hi = (o < 0 ? frameCount_ : o) - 1;
+    inFrame_.store(std::clamp<std::int64_t>(in, 0, std::max<std::int64_t>(0, hi)),
+                   std::memory_order_release);
+    outFrame_.store(o, std::memory_order_release);
+}
+
+void RawFileSource::run() {
+    while (!stopRequested()) {
+        // Also wake on a pending seek so the user can scrub while paused.
+        const Clock::duration paused =
+            waitWhilePaused([this] { return pendingSeekFrame_.load(std::memory_order_acquire) >= 0; });
+        if (stopRequested()) break;
+        if (paused > Clock::duration::zero()) resetPacing();
+
+        const std::int64_t seekTo = pendingSeekFrame_.exchange(-1, std::memory_order_acq_rel);
+        const bool didSeek = seekTo >= 0;
+        if (didSeek) {
+            pos_ = std::clamp<std::int64_t>(seekTo, 0, std::max<std::int64_t>(0, frameCount_ - 1));
+            hintedTo_ = pos_; // the old window is no use now
+            resetPacing();
+            reachedEnd_.store(false, std::memory_order_release);
+        }
+
+        const bool isPaused = this->paused();
+        if (isPaused && !didSeek) continue; // paused, nothing to scrub
+
+        // Enforce the OUT bound (also the natural end): loop back to IN, or park at the end.
+        if (!isPaused && pos_ >= effectiveOut()) {
+            if (loop_.load(std::memory_order_acquire)) {
+                pos_ = hintedTo_ = inFrame_.load(std::memory_order_acquire);
+                resetPacing();
+            } else {
+                reachedEnd_.store(true, std::memory_order_release);
+                currentFrame_.store(std::max<std::int64_t>(0, effectiveOut() - 1),
+                                    std::memory_order_release);
+                pause();
+                resetPacing();
+                continue;
+            }
+        }
+        if (!isPaused && pos_ + kReadAhead / 2 >= hintedTo_) {
+            file_.willNeed(pos_, kReadAhead);
+            hintedTo_ = pos_ + kReadAhead;
+        }
+
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        const bool luma = lumaOnly_.load(std::memory_order_acquire);
+        // Colour YUV footage goes down the pipeline as I420, never converted to BGR.
+        const RawVideoFile::Layout layout = file_.layout();
+        const bool yuv = !luma && layout != RawVideoFile::Layout::Gray8 &&
+                         layout != RawVideoFile::Layout::Bgr24;
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            ok = yuv ? file_.frameI420(pos_, frame->image) : file_.frame(pos_, luma, frame->image);
+        }
+        if (!ok) break; // only past the end, which the bound above rules out
+        // A view into the mapping keeps it alive until the last copy of the frame is gone.
+        if (file_.zeroCopy(luma) || (yuv && layout == RawVideoFile::Layout::I420))
+            frame->backing = file_.mapping();
+
+        const std::int64_t emitted = pos_++;
+
+        // Drop a scrub-induced frame superseded by a newer pending seek.
+        if (didSeek && pendingSeekFrame_.load(std::memory_order_acquire) >= 0) continue;
+
+        frame->seq = seq_++;
+        frame->captureTs = now();
+        frame->width = file_.size().width;
+        frame->height = file_.size().height;
+        frame->format = yuv ? PixelFormat::I420
+                            : frame->image.channels() == 1 ? PixelFormat::Gray8 : PixelFormat::BGR8;
+        frame->ptsUs = static_cast<std::int64_t>(static_cast<double>(emitted) * frameIntervalUs_);
+        currentFrame_.store(emitted, std::memory_order_release);
+
+        if (instr_) instr_->onCaptured();
+        if (!isPaused) paceFrame(); // scrub previews emit immediately, never paced
+        if (!emit(std::move(frame))) break;
+    }
+}
+
+} // namespace livim
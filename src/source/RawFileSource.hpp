@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "source/RawVideoFile.hpp"
+#include "source/SourceBase.hpp"
+
+namespace livim {
+
+// Plays an uncompressed Y4M or raw planar file (see RawVideoFile) out of a memory mapping, for
+// high-speed camera footage where a decoder would only add cost. A frame whose layout is already
+// what's delivered is emitted as a view into the mapping, pinned by Frame::backing, so the source
+// copies nothing; otherwise it is one colour conversion into the pooled buffer. Seeks are O(1)
+// and need no decode-ahead thread: the kernel pages the next frames in from a WILLNEED hint.
+// Paced and emitted in order like FileSource, with the same synthesized ptsUs and BLOCK pushes.
+class RawFileSource : public SourceBase {
+public:
+    RawFileSource(std::string path, FrameQueue* out, FramePool* pool, Instrumentation* instr);
+    ~RawFileSource() override { stop(); }
+
+    SourceKind kind() const override { return SourceKind::File; }
+    bool open() override;
+    bool isOpen() const override { return file_.isOpen(); }
+    void setLoop(bool enabled) override { loop_.store(enabled, std::memory_order_release); }
+    void setLumaOnly(bool enabled) override { lumaOnly_.store(enabled, std::memory_order_release); }
+    double reportedFps() const override { return reportedFps_; }
+
+    bool seekable() const override { return frameCount_ > 0; }
+    std::int64_t frameCount() const override { return frameCount_; }
+    std::int64_t currentFrame() const override { return currentFrame_.load(std::memory_order_acquire); }
+    void seekFrame(std::int64_t frame) override;
+    void setInOut(std::int64_t in, std::int64_t out) override;
+    bool atEnd() const override { return reachedEnd_.load(std::memory_order_acquire); }
+
+protected:
+    void run() override;
+
+private:
+    // Frames paged in ahead of the playhead; refreshed every half window.
+    static constexpr std::int64_t kReadAhead = 16;
+
+    std::int64_t effectiveOut() const; // out-point, or frameCount_
+
+    std::string path_;
+    RawVideoFile file_;            // source thread only, after open()
+    std::int64_t pos_ = 0;         // index of the NEXT frame to emit
+    std::int64_t hintedTo_ = 0;    // read-ahead requested up to here (exclusive)
+    std::uint64_t seq_ = 0;
+    double reportedFps_ = 0.0;
+    double frameIntervalUs_ = 0.0; // for the synthesized ptsUs
+    std::int64_t frameCount_ = 0;
+    std::atomic<bool> loop_{false};
+    std::atomic<bool> lumaOnly_{false};
+    std::atomic<std::int64_t> currentFrame_{0};
+    std::atomic<std::int64_t> pendingSeekFrame_{-1}; // -1 = no seek requested
+    std::atomic<std::int64_t> inFrame_{0};        // inclusive
+    std::atomic<std::int64_t> outFrame_{-1};      // exclusive; -1 = to the end
+    std::atomic<bool> reachedEnd_{false};         // parked at the out-point (non-looping)
+};
+
+} // namespace livim
@@ -0,0 +1,256 @@
+#include "source/RawVideoFile.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <regex>
+#include <sstream>
+#include <string_view>
+
+#include <opencv2/imgproc.hpp>
+
+namespace livim {
+namespace {
+
+constexpr std::string_view kY4mMagic = "YUV4MPEG2 ";
+constexpr std::string_view kY4mFrame = "FRAME";
+constexpr std::size_t      kMaxHeaderLine = 1024; // a longer "header" isn't Y4M
+
+std::string lowerExtension(const std::string& path) {
+    std::string ext = std::filesystem::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+// Offset just past the '\n' ending the line at `pos`, or 0 if there is none within `limit`.
+std::size_t lineEnd(const std::uint8_t* data, std::size_t size, std::size_t pos,
+                    std::size_t limit) {
+    const std::size_t end = std::min(size, pos + limit);
+    const void* nl = std::memchr(data + pos, '\n', end - pos);
+    return nl ? static_cast<std::size_t>(static_cast<const std::uint8_t*>(nl) - data) + 1 : 0;
+}
+
+bool startsWith(const std::uint8_t* data, std::size_t size, std::size_t pos,
+                std::string_view s) {
+    return pos + s.size() <= size && std::memcmp(data + pos, s.data(), s.size()) == 0;
+}
+
+} // namespace
+
+bool RawVideoFile::handles(const std::string& path) {
+    const std::string ext = lowerExtension(path);
+    return ext == ".y4m" || ext == ".yuv" || ext == ".raw" || ext == ".gray" || ext == ".bgr";
+}
+
+bool RawVideoFile::open(const std::string& path) {
+    close();
+    map_ = MappedFile::open(path);
+    if (!map_) return false;
+    const bool ok = startsWith(map_->data(), map_->size(), 0, kY4mMagic) ? openY4m()
+                                                                       : openDump(path);
+    if (!ok || frameCount_ <= 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void RawVideoFile::close() {
+    map_.reset();
+    size_ = cv::Size(0, 0);
+    layout_ = Layout::Gray8;
+    fps_ = 0.0;
+    frameCount_ = 0;
+    payload_ = first_ = stride_ = 0;
+    offsets_.clear();
+    i420_.release();
+}
+
+bool RawVideoFile::setGeometry(int w, int h, Layout layout) {
+    if (w <= 0 || h <= 0) return false;
+    const std::size_t luma = static_cast<std::size_t>(w) * static_cast<std::size_t>(h);
+    switch (layout) {
+    case Layout::Gray8: payload_ = luma; break;
+    case Layout::Bgr24: payload_ = luma * 3; break;
+    case Layout::I420:
+        if (w % 2 || h % 2) return false;
+        payload_ = luma * 3 / 2;
+        break;
+    case Layout::I422:
+        if (w % 2 || h % 2) return false; // even height too: it is resampled to 4:2:0
+        payload_ = luma * 2;
+        break;
+    case Layout::I444: payload_ = luma * 3; break;
+    }
+    size_ = cv::Size(w, h);
+    layout_ = layout;
+    return true;
+}
+
+bool RawVideoFile::openY4m() {
+    const std::uint8_t* data = map_->data();
+    const std::size_t size = map_->size();
+    const std::size_t headerEnd = lineEnd(data, size, 0, kMaxHeaderLine);
+    if (headerEnd == 0) return false;
+
+    int w = 0, h = 0;
+    Layout layout = Layout::I420; // the format's default colour space
+    std::istringstream tokens(std::string(reinterpret_cast<const char*>(data) + kY4mMagic.size(),
+                                          headerEnd - 1 - kY4mMagic.size()));
+    for (std::string t; tokens >> t;) {
+        const std::string v = t.substr(1);
+        switch (t[0]) {
+        case 'W': w = std::atoi(v.c_str()); break;
+        case 'H': h = std::atoi(v.c_str()); break;
+        case 'F': {
+            const std::size_t colon = v.find(':');
+            const double num = std::atof(v.c_str());
+            const double den = colon == std::string::npos ? 1.0 : std::atof(v.c_str() + colon + 1);
+            fps_ = den > 0.0 ? num / den : 0.0;
+            break;
+        }
+        case 'C':
+            if (v == "mono") layout = Layout::Gray8;
+            else if (v == "420" || v == "420jpeg" || v == "420paldv" || v == "420mpeg2")
+                layout = Layout::I420;
+            else if (v == "422") layout = Layout::I422;
+            else if (v == "444") layout = Layout::I444;
+            else return false; // high bit depth, alpha, ...
+            break;
+        default: break; // interlacing, aspect, comments: irrelevant here
+        }
+    }
+    if (!setGeometry(w, h, layout)) return false;
+
+    // Every FRAME header is normally the bare "FRAME\n", so frames sit at a fixed stride. Check
+    // that against the last frame; only a file with per-frame parameters pays for a full walk.
+    if (!startsWith(data, size, headerEnd, kY4mFrame)) return false;
+    const std::size_t frameHeader = lineEnd(data, size, headerEnd, kMaxHeaderLine);
+    if (frameHeader == 0) return false;
+    first_ = frameHeader;
+    stride_ = (frameHeader - headerEnd) + payload_;
+    frameCount_ = static_cast<std::int64_t>((size - headerEnd) / stride_);
+    if (frameCount_ > 0 &&
+        startsWith(data, size, headerEnd + static_cast<std::size_t>(frameCount_ - 1) * stride_,
+                   kY4mFrame))
+        return true;
+
+    for (std::size_t pos = headerEnd; startsWith(data, size, pos, kY4mFrame);) {
+        const std::size_t pixels = lineEnd(data, size, pos, kMaxHeaderLine);
+        if (pixels == 0 || pixels + payload_ > size) break; // truncated last frame
+        offsets_.push_back(pixels);
+        pos = pixels + payload_;
+    }
+    frameCount_ = static_cast<std::int64_t>(offsets_.size());
+    return true;
+}
+
+bool RawVideoFile::openDump(const std::string& path) {
+    std::string name = std::filesystem::path(path).stem().string();
+    std::transform(name.begin(), name.end(), name.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    std::smatch m;
+    if (!std::regex_search(name, m, std::regex(R"((\d+)x(\d+))"))) return false;
+    const int w = std::atoi(m[1].str().c_str());
+    const int h = std::atoi(m[2].str().c_str());
+    if (std::regex_search(name, m, std::regex(R"((\d+(?:\.\d+)?)fps)")))
+        fps_ = std::atof(m[1].str().c_str());
+
+    const std::string ext = lowerExtension(path);
+    Layout layout = ext == ".yuv" ? Layout::I420 : ext == ".bgr" ? Layout::Bgr24 : Layout::Gray8;
+    const auto token = [&](const char* re) {
+        return std::regex_search(name, std::regex(std::string(R"((^|[_.\-]))") + re +
+                                                  R"(($|[_.\-]))"));
+    };
+    if (token("(gray8?|y8|mono)")) layout = Layout::Gray8;
+    else if (token("bgr(24)?")) layout = Layout::Bgr24;
+    else if (token("(i420|yuv420p?)")) layout = Layout::I420;
+    else if (token("yuv422p?")) layout = Layout::I422;
+    else if (token("yuv444p?")) layout = Layout::I444;
+    if (!setGeometry(w, h, layout)) return false;
+
+    first_ = 0;
+    stride_ = payload_;
+    frameCount_ = static_cast<std::int64_t>(map_->size() / payload_); // a partial tail is ignored
+    return true;
+}
+
+const std::uint8_t* RawVideoFile::frameData(std::int64_t i) const {
+    if (!map_ || i < 0 || i >= frameCount_) return nullptr;
+    const std::size_t off = offsets_.empty() ? first_ + static_cast<std::size_t>(i) * stride_
+                                             : offsets_[static_cast<std::size_t>(i)];
+    return map_->data() + off;
+}
+
+bool RawVideoFile::zeroCopy(bool lumaOnly) const {
+    switch (layout_) {
+    case Layout::Gray8: return true;
+    case Layout::Bgr24: return !lumaOnly;
+    default:            return lumaOnly; // the Y plane leads each frame
+    }
+}
+
+bool RawVideoFile::frame(std::int64_t i, bool lumaOnly, cv::Mat& dst) {
+    const std::uint8_t* p = frameData(i);
+    if (!p) return false;
+    const int w = size_.width, h = size_.height;
+    // cv::Mat has no read-only flavour; nothing downstream writes into a source frame.
+    const auto view = [&](int rows, int type, const std::uint8_t* at) {
+        return cv::Mat(rows, w, type, const_cast<std::uint8_t*>(at));
+    };
+    if (zeroCopy(lumaOnly)) {
+        dst = view(h, layout_ == Layout::Bgr24 ? CV_8UC3 : CV_8UC1, p);
+        return true;
+    }
+
+    if (!dst.u) dst.release(); // a view from an earlier frame() must not be written through
+    if (layout_ == Layout::Bgr24) {
+        cv::cvtColor(view(h, CV_8UC3, p), dst, cv::COLOR_BGR2GRAY);
+        return true;
+    }
+    frameI420(i, i420_);
+    cv::cvtColor(i420_, dst, cv::COLOR_YUV2BGR_I420);
+    return true;
+}
+
+bool RawVideoFile::frameI420(std::int64_t i, cv::Mat& dst) {
+    const std::uint8_t* p = frameData(i);
+    if (!p || layout_ == Layout::Gray8 || layout_ == Layout::Bgr24) return false;
+    const int w = size_.width, h = size_.height;
+    const auto view = [&](int rows, int cols, const std::uint8_t* at) {
+        return cv::Mat(rows, cols, CV_8UC1, const_cast<std::uint8_t*>(at));
+    };
+    if (layout_ == Layout::I420) {
+        dst = view(h * 3 / 2, w, p);
+        return true;
+    }
+    // 4:2:2 / 4:4:4: area-average the chroma planes down to 4:2:0.
+    if (!dst.u) dst.release(); // a view from an earlier call must not be written through
+    const int cw = w / 2, ch = h / 2;
+    const int srcCw = layout_ == Layout::I444 ? w : w / 2;
+    const std::size_t luma = static_cast<std::size_t>(w) * static_cast<std::size_t>(h);
+    const std::size_t srcChroma = static_cast<std::size_t>(srcCw) * static_cast<std::size_t>(h);
+    dst.create(h * 3 / 2, w, CV_8UC1);
+    cv::Mat y = dst.rowRange(0, h);
+    view(h, w, p).copyTo(y);
+    for (int plane = 0; plane < 2; ++plane) {
+        const cv::Mat src = view(h, srcCw, p + luma + srcChroma * plane);
+        cv::Mat out(ch, cw, CV_8UC1, dst.data + luma + static_cast<std::size_t>(cw * ch) * plane);
+        cv::resize(src, out, out.size(), 0, 0, cv::INTER_AREA);
+    }
+    return true;
+}
+
+void RawVideoFile::willNeed(std::int64_t first, std::int64_t count) const {
+    const std::uint8_t* a = frameData(std::max<std::int64_t>(0, first));
+    if (!a || count <= 0) return;
+    const std::int64_t last = std::min(frameCount_ - 1, first + count - 1);
+    const std::size_t begin = static_cast<std::size_t>(a - map_->data());
+    const std::size_t end = static_cast<std::size_t>(frameData(last) - map_->data()) + payload_;
+    map_->willNeed(begin, end - begin);
+}
+
+} // namespace livim
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "core/MappedFile.hpp"
+
+namespace livim {
+
+// An uncompressed video file read straight out of a memory mapping, shared by RawFileSource and
+// RawExportFrameSource. Two containers:
+//  - YUV4MPEG2 (.y4m): 8-bit mono, 4:2:0, 4:2:2 or 4:4:4, geometry and rate from its header.
+//  - Headerless dumps (.raw, .yuv, .gray, .bgr): back-to-back frames whose geometry comes from the
+//    file name, e.g. "run3_1920x1080_1000fps_gray.raw". A "gray"/"y8", "bgr24", "i420"/"yuv420p",
+//    "yuv422p" or "yuv444p" token picks the layout; otherwise .yuv is 4:2:0, .bgr is BGR, and
+//    .raw/.gray are 8-bit mono. No "fps" token means the rate is unknown.
+// Seeking is O(1): frame i is at a fixed offset. A frame whose layout already is what's delivered
+// (mono, BGR, or the luma plane in luma-only mode) is handed out as a view into the mapping;
+// anything else is one colour conversion out of it.
+class RawVideoFile {
+public:
+    enum class Layout { Gray8, Bgr24, I420, I422, I444 };
+
+    // By extension only; open() still validates the contents.
+    static bool handles(const std::string& path);
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return map_ != nullptr; }
+
+    cv::Size     size() const { return size_; }
+    double       fps() const { return fps_; } // 0 = unknown
+    std::int64_t frameCount() const { return frameCount_; }
+    int          channels() const { return layout_ == Layout::Gray8 ? 1 : 3; }
+    Layout       layout() const { return layout_; }
+    const std::shared_ptr<const MappedFile>& mapping() const { return map_; }
+
+    // True if frame() returns a view (no copy, no conversion) in this mode.
+    bool zeroCopy(bool lumaOnly) const;
+
+    // Frame `i` as delivered: single-channel for a mono file or in luma-only mode, else BGR.
+    // Either a read-only view into the mapping (see zeroCopy(); valid while the mapping lives),
+    // or converted into `dst`; a view left there by an earlier call is replaced, never written
+    // through. False past the end.
+    bool frame(std::int64_t i, bool lumaOnly, cv::Mat& dst);
+
+    // Frame `i` of a YUV file as PixelFormat::I420, with no colour conversion: a view into the
+    // mapping for 4:2:0, else the chroma area-averaged down into `dst`. False for a mono or BGR
+    // file, or past the end.
+    bool frameI420(std::int64_t i, cv::Mat& dst);
+
+    // Read-ahead hint for frames [first, first + count).
+    void willNeed(std::int64_t first, std::int64_t count) const;
+
+private:
+    bool openY4m();
+    bool openDump(const std::string& path);
+    bool setGeometry(int w, int h, Layout layout); // false for odd sizes a subsampling can't take
+    const std::uint8_t* frameData(std::int64_t i) const;
+
+    std::shared_ptr<const MappedFile> map_;
+    cv::Size     size_{0, 0};
+    Layout       layout_ = Layout::Gray8;
+    double       fps_ = 0.0;
+    std::int64_t frameCount_ = 0;
+    std::size_t  payload_ = 0;  // pixel bytes per frame
+    std::size_t  first_ = 0;    // offset of frame 0's pixels
+    std::size_t  stride_ = 0;   // frame to frame, including any per-frame header
+    std::vector<std::size_t> offsets_; // Y4M whose FRAME headers vary in length; else empty
+    cv::Mat      i420_;         // frameI420()'s, for the colour conversion
+};
+
+} // namespace livim
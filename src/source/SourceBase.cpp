@@ -5,8 +5,12 @@
 #include <thread>
 #include <utility>
 
+#include "core/FrameFormat.hpp"
 #include "core/FramePool.hpp"
 #include "core/IFrameSink.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/LatestFrameMailbox.hpp"
+#include "core/Trace.hpp"
 
 namespace livim {
 
@@ -18,6 +22,7 @@ SourceBase::~SourceBase() { stop(); }
 void SourceBase::start() {
     if (thread_.joinable()) return;
     thread_ = std::thread([this] {
+        trace::setThreadName("source");
         run();
         // Distinguish a natural end (EOF) from an external stop().
         finished_.store(!stop_.load(std::memory_order_acquire), std::memory_order_release);
@@ -94,6 +99,7 @@ void SourceBase::paceFrame() {
         nextDeadline_ = now(); // behind: drop the deficit, resume cadence from now (never sprint)
         return;
     }
+    trace::Span span("pace_sleep");
     // Sleep in slices: sleep_until is not interruptible, so cap each slice so a concurrent stop()
     // is observed within ~20 ms.
     while (!stopRequested()) {
@@ -105,12 +111,31 @@ void SourceBase::paceFrame() {
 
 MutableFrameRef SourceBase::acquireFrame() {
     if (stopRequested()) return nullptr;
+    trace::Span span("pool_acquire");
     return pool_->acquire();
 }
 
 bool SourceBase::emit(FrameRef f) {
     if (stopRequested()) return false;
+    trace::Span span("queue_push", f->seq);
     return out_->push(std::move(f));
 }
 
+bool SourceBase::deliverCaptured(MutableFrameRef frame) {
+    if (instr_) instr_->onCaptured();
+
+    if (const auto target = recordTarget()) {
+        if (target->sink)
+            target->sink->append(isYuv(frame->format) ? bgrOf(*frame) : frame->image);
+        if (target->preview) {
+            auto df = std::make_shared<DisplayFrame>();
+            df->processed = frame; // same raw frame in both panes while recording
+            df->original = frame;
+            target->preview->publish(std::move(df));
+        }
+        return true; // do NOT emit() -> lossless
+    }
+    return emit(std::move(frame));
+}
+
 } // namespace livim
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -88,6 +90,17 @@ protected:
     // Push a frame downstream (BLOCK / lossless). Returns false if stopping.
     bool emit(FrameRef f);
 
+    // A live feed has no PTS of its own, so it uses the capture instant.
+    static std::int64_t livePtsUs(Timestamp captureTs) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(captureTs.time_since_epoch())
+            .count();
+    }
+
+    // The tail of a live capture loop: counts `frame` as captured, then tees it to the record
+    // target (bypassing the queue) or emits it. False if stopping. Callable from any one thread
+    // at a time, e.g. a CameraDecoder worker.
+    bool deliverCaptured(MutableFrameRef frame);
+
     // resetPacing() re-anchors the cadence clock; call it whenever playback (re)starts. paceFrame()
     // blocks until this frame's scheduled emit time; if behind, it drops the deficit (never bursts).
     void resetPacing() { pacingValid_ = false; }
@@ -0,0 +1,115 @@
+#include "source/SyntheticSource.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Instrumentation.hpp"
+
+namespace livim {
+
+SyntheticSource::SyntheticSource(std::string path, FrameQueue* out, FramePool* pool,
+                             Instrumentation* instr)
+    : SourceBase(out, pool, instr), path_(std::move(path)) {}
+
+bool SyntheticSource::open() {
+    SyntheticParams params;
+    std::string error;
+    if (!SyntheticVideo::parse(path_, params, error)) return false;
+    video_ = std::make_unique<SyntheticVideo>(params);
+    reportedFps_ = params.fps;
+    frameIntervalUs_ = 1'000'000.0 / reportedFps_;
+    frameCount_ = params.frames;
+    outFrame_.store(-1, std::memory_order_release);
+    pos_ = 0;
+
+    setNativeChannels(params.channels);
+    setNativeSize(params.width, params.height);
+    return true;
+}
+
+std::int64_t SyntheticSource::effectiveOut() const {
+    const std::int64_t out = outFrame_.load(std::memory_order_acquire);
+    return out >= 0 ? out : frameCount_;
+}
+
+void SyntheticSource::seekFrame(std::int64_t frame) {
+    const std::int64_t in = inFrame_.load(std::memory_order_acquire);
+    const std::int64_t hi = std::max<std::int64_t>(in, effectiveOut() - 1);
+    reachedEnd_.store(false, std::memory_order_release);
+    pendingSeekFrame_.store(std::clamp<std::int64_t>(frame, in, hi), std::memory_order_release);
+    wakePauseWaiters(); // so a paused thread wakes and renders the scrubbed frame
+}
+
+void SyntheticSource::setInOut(std::int64_t in, std::int64_t out) {
+    const std::int64_t o = out < 0 ? -1 : std::clamp<std::int64_t>(out, 1, frameCount_);
+    const std::int64_t hi = (o < 0 ? frameCount_ : o) - 1;
+    inFrame_.store(std::clamp<std::int64_t>(in, 0, std::max<std::int64_t>(0, hi)),
+                   std::memory_order_release);
+    outFrame_.store(o, std::memory_order_release);
+}
+
+void SyntheticSource::run() {
+    while (!stopRequested()) {
+        // Also wake on a pending seek so the user can scrub while paused.
+        const Clock::duration paused =
+            waitWhilePaused([this] { return pendingSeekFrame_.load(std::memory_order_acquire) >= 0; });
+        if (stopRequested()) break;
+        if (paused > Clock::duration::zero()) resetPacing();
+
+        const std::int64_t seekTo = pendingSeekFrame_.exchange(-1, std::memory_order_acq_rel);
+        const bool didSeek = seekTo >= 0;
+        if (didSeek) {
+            pos_ = std::clamp<std::int64_t>(seekTo, 0, std::max<std::int64_t>(0, frameCount_ - 1));
+            resetPacing();
+            reachedEnd_.store(false, std::memory_order_release);
+        }
+
+        const bool isPaused = this->paused();
+        if (isPaused && !didSeek) continue; // paused, nothing to scrub
+
+        // Enforce the OUT bound (also the natural end): loop back to IN, or park at the end.
+        if (!isPaused && pos_ >= effectiveOut()) {
+            if (loop_.load(std::memory_order_acquire)) {
+                pos_ = inFrame_.load(std::memory_order_acquire);
+                resetPacing();
+            } else {
+                reachedEnd_.store(true, std::memory_order_release);
+                currentFrame_.store(std::max<std::int64_t>(0, effectiveOut() - 1),
+                                    std::memory_order_release);
+                pause();
+                resetPacing();
+                continue;
+            }
+        }
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        const bool luma = lumaOnly_.load(std::memory_order_acquire);
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            ok = video_->render(pos_, luma, frame->image);
+        }
+        if (!ok) break; // only past the end, which the bound above rules out
+
+        const std::int64_t emitted = pos_++;
+
+        // Drop a scrub-induced frame superseded by a newer pending seek.
+        if (didSeek && pendingSeekFrame_.load(std::memory_order_acquire) >= 0) continue;
+
+        frame->seq = seq_++;
+        frame->captureTs = now();
+        frame->width = frame->image.cols;
+        frame->height = frame->image.rows;
+        frame->format = (frame->image.channels() == 1) ? PixelFormat::Gray8 : PixelFormat::BGR8;
+        frame->ptsUs = static_cast<std::int64_t>(static_cast<double>(emitted) * frameIntervalUs_);
+        currentFrame_.store(emitted, std::memory_order_release);
+
+        if (instr_) instr_->onCaptured();
+        // Scrub previews emit immediately, never paced; an unpaced clip never is.
+        if (!isPaused && !video_->params().unpaced) paceFrame();
+        if (!emit(std::move(frame))) break;
+    }
+}
+
+} // namespace livim
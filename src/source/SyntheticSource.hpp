@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "source/SourceBase.hpp"
+#include "source/SyntheticVideo.hpp"
+
+namespace livim {
+
+// Plays a SyntheticVideo, so the live pipeline can be driven and measured without a file or a
+// camera. Behaves like a file (seeks, loops, in/out range, synthesized ptsUs, BLOCK pushes); with
+// the clip's "unpaced" option it skips pacing and emits as fast as the pipeline takes frames,
+// which makes the stats a throughput measurement of the chain.
+class SyntheticSource : public SourceBase {
+public:
+    SyntheticSource(std::string path, FrameQueue* out, FramePool* pool, Instrumentation* instr);
+    ~SyntheticSource() override { stop(); }
+
+    SourceKind kind() const override { return SourceKind::File; }
+    bool open() override;
+    bool isOpen() const override { return video_ != nullptr; }
+    void setLoop(bool enabled) override { loop_.store(enabled, std::memory_order_release); }
+    void setLumaOnly(bool enabled) override { lumaOnly_.store(enabled, std::memory_order_release); }
+    double reportedFps() const override { return reportedFps_; }
+
+    bool seekable() const override { return frameCount_ > 0; }
+    std::int64_t frameCount() const override { return frameCount_; }
+    std::int64_t currentFrame() const override { return currentFrame_.load(std::memory_order_acquire); }
+    void seekFrame(std::int64_t frame) override;
+    void setInOut(std::int64_t in, std::int64_t out) override;
+    bool atEnd() const override { return reachedEnd_.load(std::memory_order_acquire); }
+
+protected:
+    void run() override;
+
+private:
+    std::int64_t effectiveOut() const; // out-point, or frameCount_
+
+    std::string path_;
+    std::unique_ptr<SyntheticVideo> video_; // set by open()
+    std::int64_t pos_ = 0;         // index of the NEXT frame to emit
+    std::uint64_t seq_ = 0;
+    double reportedFps_ = 0.0;
+    double frameIntervalUs_ = 0.0; // for the synthesized ptsUs
+    std::int64_t frameCount_ = 0;
+    std::atomic<bool> loop_{false};
+    std::atomic<bool> lumaOnly_{false};
+    std::atomic<std::int64_t> currentFrame_{0};
+    std::atomic<std::int64_t> pendingSeekFrame_{-1}; // -1 = no seek requested
+    std::atomic<std::int64_t> inFrame_{0};        // inclusive
+    std::atomic<std::int64_t> outFrame_{-1};      // exclusive; -1 = to the end
+    std::atomic<bool> reachedEnd_{false};         // parked at the out-point (non-looping)
+};
+
+} // namespace livim
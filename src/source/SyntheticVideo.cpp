@@ -0,0 +1,183 @@
+#include "source/SyntheticVideo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <locale>
+#include <numbers>
+#include <sstream>
+#include <string_view>
+
+namespace livim {
+namespace {
+
+constexpr std::string_view kPrefix = "synthetic:";
+
+// Scene layout, as fractions of full scale.
+constexpr float kBase = 0.45f;
+constexpr float kCoarse = 0.20f;
+constexpr float kFine = 0.08f;
+constexpr float kPatch = 0.35f;
+constexpr float kPatchBgr[3] = {0.35f, 0.45f, 0.75f}; // skin-like, so colour mode has a target
+
+constexpr double kTwoPi = 2.0 * std::numbers::pi;
+
+// Locale-independent: the GUI runs under the user's locale, where strtod may want a ','.
+template <class T>
+bool parseNumber(const std::string& s, T& v) {
+    std::istringstream in(s);
+    in.imbue(std::locale::classic());
+    in >> v;
+    return !in.fail() && in.peek() == std::char_traits<char>::eof();
+}
+
+// splitmix64: a counter-based generator, so any sample can be reproduced from its coordinates.
+std::uint64_t mix(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Unit-variance, near-Gaussian (Irwin-Hall, n = 4) from one 64-bit draw.
+float gaussian(std::uint64_t& state) {
+    const std::uint64_t r = mix(state);
+    const std::uint32_t sum = static_cast<std::uint32_t>((r & 0xFFFF) + ((r >> 16) & 0xFFFF) +
+                                                         ((r >> 32) & 0xFFFF) + (r >> 48));
+    return (static_cast<float>(sum) / 65536.0f - 2.0f) * 1.7320508f;
+}
+
+} // namespace
+
+bool SyntheticVideo::handles(const std::string& path) {
+    return path.compare(0, kPrefix.size(), kPrefix) == 0;
+}
+
+bool SyntheticVideo::parse(const std::string& path, SyntheticParams& out, std::string& error) {
+    if (!handles(path)) {
+        error = "not a synthetic clip";
+        return false;
+    }
+    SyntheticParams p;
+    std::istringstream items(path.substr(kPrefix.size()));
+    for (std::string item; std::getline(items, item, ',');) {
+        if (item.empty()) continue;
+        const std::size_t eq = item.find('=');
+        const std::string key = item.substr(0, eq);
+        const std::string v = eq == std::string::npos ? std::string() : item.substr(eq + 1);
+        bool ok = true;
+        if (eq == std::string::npos && key == "unpaced") {
+            p.unpaced = true;
+        } else if (eq == std::string::npos && key.find('x') != std::string::npos) {
+            const std::size_t x = key.find('x');
+            ok = parseNumber(key.substr(0, x), p.width) &&
+                 parseNumber(key.substr(x + 1), p.height) && p.width > 0 && p.height > 0 &&
+                 p.width <= 16384 && p.height <= 16384;
+        } else if (key == "channels") {
+            ok = parseNumber(v, p.channels) && (p.channels == 1 || p.channels == 3);
+        } else if (key == "fps") {
+            ok = parseNumber(v, p.fps) && p.fps > 0.0;
+        } else if (key == "frames") {
+            ok = parseNumber(v, p.frames) && p.frames > 0;
+        } else if (key == "motion") {
+            ok = parseNumber(v, p.motionPx);
+        } else if (key == "motion-hz") {
+            ok = parseNumber(v, p.motionHz);
+        } else if (key == "pulse") {
+            ok = parseNumber(v, p.pulse);
+        } else if (key == "pulse-hz") {
+            ok = parseNumber(v, p.pulseHz);
+        } else if (key == "noise") {
+            ok = parseNumber(v, p.noise) && p.noise >= 0.0;
+        } else if (key == "seed") {
+            ok = parseNumber(v, p.seed);
+        } else {
+            error = "unknown synthetic option '" + key + "'";
+            return false;
+        }
+        if (!ok) {
+            error = "bad synthetic option '" + item + "'";
+            return false;
+        }
+    }
+    out = p;
+    return true;
+}
+
+SyntheticVideo::SyntheticVideo(const SyntheticParams& params) : params_(params) {
+    coarse_ = std::max(8.0, std::min(params_.width, params_.height) / 6.0);
+    fine_ = std::max(4.0, coarse_ / 3.7); // not a harmonic of the coarse grating
+    sigma_ = std::min(params_.width, params_.height) / 8.0;
+    const double cy = params_.height / 2.0;
+    const std::size_t h = static_cast<std::size_t>(std::max(0, params_.height));
+    rowCoarse_.resize(h);
+    rowFine_.resize(h);
+    rowPatch_.resize(h);
+    for (std::size_t y = 0; y < h; ++y) {
+        const double fy = static_cast<double>(y);
+        rowCoarse_[y] = static_cast<float>(std::sin(kTwoPi * fy / coarse_ + 0.7));
+        rowFine_[y] = static_cast<float>(std::cos(kTwoPi * fy / fine_));
+        rowPatch_[y] =
+            static_cast<float>(std::exp(-(fy - cy) * (fy - cy) / (2.0 * sigma_ * sigma_)));
+    }
+}
+
+double SyntheticVideo::displacement(std::int64_t i) const {
+    return params_.motionPx * std::sin(kTwoPi * params_.motionHz * static_cast<double>(i) /
+                                       params_.fps);
+}
+
+double SyntheticVideo::pulseFactor(std::int64_t i) const {
+    return 1.0 + params_.pulse * std::sin(kTwoPi * params_.pulseHz * static_cast<double>(i) /
+                                          params_.fps);
+}
+
+bool SyntheticVideo::render(std::int64_t i, bool gray, cv::Mat& dst) const {
+    if (i < 0 || i >= params_.frames) return false;
+    const int w = params_.width, h = params_.height;
+    const int channels = (gray || params_.channels == 1) ? 1 : 3;
+    dst.create(h, w, channels == 1 ? CV_8UC1 : CV_8UC3);
+
+    // The scene moves as a whole, so only the column factors change from frame to frame.
+    const double dx = displacement(i);
+    const double cx = w / 2.0;
+    std::vector<float> colCoarse(static_cast<std::size_t>(w)), colFine(colCoarse.size()),
+        colPatch(colCoarse.size());
+    for (std::size_t x = 0; x < colCoarse.size(); ++x) {
+        const double fx = static_cast<double>(x) - dx;
+        colCoarse[x] = static_cast<float>(std::sin(kTwoPi * fx / coarse_));
+        colFine[x] = static_cast<float>(std::sin(kTwoPi * fx / fine_));
+        colPatch[x] =
+            static_cast<float>(std::exp(-(fx - cx) * (fx - cx) / (2.0 * sigma_ * sigma_)));
+    }
+
+    const float k = static_cast<float>(pulseFactor(i)) * kPatch * 255.0f;
+    const float luma = 0.114f * kPatchBgr[0] + 0.587f * kPatchBgr[1] + 0.299f * kPatchBgr[2];
+    const float colour[3] = {(channels == 1 ? luma : kPatchBgr[0]) * k, kPatchBgr[1] * k,
+                             kPatchBgr[2] * k};
+    const float noise = static_cast<float>(params_.noise);
+
+    // On the calling thread: the source and export threads render one frame at a time, and the
+    // shared pool is left to the processing chain.
+    for (int y = 0; y < h; ++y) {
+        const std::size_t r = static_cast<std::size_t>(y);
+        const float rc = rowCoarse_[r] * kCoarse * 255.0f;
+        const float rf = rowFine_[r] * kFine * 255.0f;
+        const float rp = rowPatch_[r];
+        std::uint64_t state = params_.seed;
+        state = mix(state) ^ static_cast<std::uint64_t>(i);
+        state = mix(state) ^ static_cast<std::uint64_t>(y);
+        std::uint8_t* out = dst.ptr<std::uint8_t>(y);
+        for (std::size_t x = 0; x < colCoarse.size(); ++x) {
+            const float base = kBase * 255.0f + colCoarse[x] * rc + colFine[x] * rf;
+            const float patch = colPatch[x] * rp;
+            for (int c = 0; c < channels; ++c) {
+                float v = base + colour[c] * patch;
+                if (noise > 0.0f) v += noise * gaussian(state);
+                *out++ = static_cast<std::uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace livim
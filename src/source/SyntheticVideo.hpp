@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace livim {
+
+struct SyntheticParams {
+    int           width = 640;
+    int           height = 480;
+    int           channels = 3;   // 1 or 3
+    double        fps = 30.0;
+    std::int64_t  frames = 600;
+    double        motionPx = 0.5; // peak horizontal displacement, px
+    double        motionHz = 1.0;
+    double        pulse = 0.05;   // peak relative change of the patch's brightness
+    double        pulseHz = 1.2;
+    double        noise = 0.0;    // std-dev of additive noise, 8-bit levels
+    std::uint64_t seed = 1;
+    bool          unpaced = false; // live playback emits as fast as the pipeline takes frames
+};
+
+// A clip generated from a formula instead of read from disk, for benchmarks that have to mean the
+// same thing on every machine. A two-scale grating with a Gaussian colour patch in the middle
+// moves as a whole by motionPx * sin(2 pi motionHz t), evaluated exactly, so the shift is truly
+// sub-pixel; the patch's colour pulses by the factor 1 + pulse * sin(2 pi pulseHz t). Noise comes
+// from a counter-based generator keyed by (seed, frame, row), so frame i is bit-identical however
+// it is reached; nothing depends on OpenCV's RNG.
+//
+// Named like a path, so it goes wherever a file does (livim-cli inputs, PlaybackController::
+// openFile): "synthetic:" plus comma-separated options, e.g.
+// "synthetic:1280x720,fps=120,frames=1200,motion=0.25,noise=2,seed=7,unpaced". Options: WxH,
+// channels, fps, frames, motion, motion-hz, pulse, pulse-hz, noise, seed, unpaced.
+class SyntheticVideo {
+public:
+    static bool handles(const std::string& path); // "synthetic:" prefix
+    static bool parse(const std::string& path, SyntheticParams& out, std::string& error);
+
+    explicit SyntheticVideo(const SyntheticParams& params);
+
+    const SyntheticParams& params() const { return params_; }
+    cv::Size size() const { return cv::Size(params_.width, params_.height); }
+
+    // Ground truth at frame `i`: the scene's horizontal shift in px and the patch's colour factor.
+    double displacement(std::int64_t i) const;
+    double pulseFactor(std::int64_t i) const;
+
+    // Frame `i` into `dst` (reallocated only if its size or type differs): single-channel if
+    // `gray` or channels == 1, else BGR. Rendered on the calling thread. False past the end.
+    // Thread-safe.
+    bool render(std::int64_t i, bool gray, cv::Mat& dst) const;
+
+private:
+    SyntheticParams     params_;
+    double              coarse_ = 0.0, fine_ = 0.0; // grating wavelengths, px
+    double              sigma_ = 0.0;               // of the patch, px
+    // Row factors of the separable terms; the column factors move, so they are per frame.
+    std::vector<float>  rowCoarse_, rowFine_, rowPatch_;
+};
+
+} // namespace livim
@@ -0,0 +1,195 @@
+#include "source/ThumbnailExtractor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+
+#include <opencv2/imgproc.hpp>
+
+#include "core/Trace.hpp"
+#include "source/ImageSequence.hpp"
+#include "source/KeyframeIndex.hpp"
+#include "source/LibavDecoder.hpp"
+#include "source/MediaCache.hpp"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+namespace livim {
+namespace {
+
+constexpr char          kMagic[4] = {'L', 'V', 'T', 'S'};
+constexpr std::uint32_t kVersion = 1;
+
+// Background work: yield the CPU to playback and processing whenever they want it.
+void lowerCurrentThreadPriority() {
+#ifdef __linux__
+    // Linux nice values are per thread; 0 means the calling one.
+    setpriority(PRIO_PROCESS, 0, 10);
+#endif
+}
+
+// 0, n/2, n/4, 3n/4, n/8, ...: every pass halves the gaps, so a partial strip is evenly spread.
+std::vector<int> coarseToFine(int n) {
+    std::vector<int> order;
+    std::vector<bool> seen(static_cast<std::size_t>(n), false);
+    order.reserve(static_cast<std::size_t>(n));
+    for (int step = std::max(1, n); ; step /= 2) {
+        for (int i = 0; i < n; i += step) {
+            if (seen[static_cast<std::size_t>(i)]) continue;
+            seen[static_cast<std::size_t>(i)] = true;
+            order.push_back(i);
+        }
+        if (step == 1) break;
+    }
+    return order;
+}
+
+// Layout (host byte order): magic, version, slot count, then per slot its width, height and
+// packed BGR pixels (width 0 = a slot that couldn't be decoded).
+bool loadStrip(const std::string& cachePath, int slots, std::vector<cv::Mat>& out) {
+    std::ifstream in(cachePath, std::ios::binary);
+    char magic[4] = {};
+    std::uint32_t version = 0;
+    std::int32_t n = 0;
+    if (!in || !in.read(magic, 4) || !std::equal(magic, magic + 4, kMagic) ||
+        !in.read(reinterpret_cast<char*>(&version), sizeof(version)) || version != kVersion ||
+        !in.read(reinterpret_cast<char*>(&n), sizeof(n)) || n != slots)
+        return false;
+    out.assign(static_cast<std::size_t>(slots), cv::Mat());
+    for (cv::Mat& m : out) {
+        std::int32_t wh[2] = {};
+        if (!in.read(reinterpret_cast<char*>(wh), sizeof(wh))) return false;
+        if (wh[0] <= 0) continue;
+        if (wh[0] > 4096 || wh[1] <= 0 || wh[1] > 4096) return false; // not ours
+        m.create(wh[1], wh[0], CV_8UC3);
+        if (!in.read(reinterpret_cast<char*>(m.data),
+                     static_cast<std::streamsize>(m.total() * m.elemSize())))
+            return false;
+    }
+    return true;
+}
+
+bool saveStrip(const std::string& cachePath, const std::vector<cv::Mat>& strip) {
+    return writeCacheFile(cachePath, [&](std::ostream& out) {
+        out.write(kMagic, 4);
+        out.write(reinterpret_cast<const char*>(&kVersion), sizeof(kVersion));
+        const std::int32_t n = static_cast<std::int32_t>(strip.size());
+        out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+        for (const cv::Mat& m : strip) {
+            const std::int32_t wh[2] = {m.cols, m.rows};
+            out.write(reinterpret_cast<const char*>(wh), sizeof(wh));
+            for (int y = 0; y < m.rows; ++y) // rows, in case a Mat isn't continuous
+                out.write(reinterpret_cast<const char*>(m.ptr(y)),
+                          static_cast<std::streamsize>(m.cols * m.elemSize()));
+        }
+        return static_cast<bool>(out);
+    });
+}
+
+} // namespace
+
+void ThumbnailExtractor::start(const std::string& path, int slots, int height) {
+    stop();
+    if (slots <= 0 || height <= 0) return;
+    cancel_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this, path, slots, height] {
+        trace::setThreadName("thumbnails");
+        lowerCurrentThreadPriority();
+        run(path, slots, height);
+    });
+}
+
+void ThumbnailExtractor::stop() {
+    cancel_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) thread_.join();
+    std::lock_guard<std::mutex> lg(mu_);
+    ready_.clear();
+}
+
+std::vector<ThumbnailExtractor::Thumb> ThumbnailExtractor::takeReady() {
+    std::vector<Thumb> out;
+    std::lock_guard<std::mutex> lg(mu_);
+    out.swap(ready_);
+    return out;
+}
+
+void ThumbnailExtractor::publish(int slot, cv::Mat bgr) {
+    std::lock_guard<std::mutex> lg(mu_);
+    ready_.push_back({slot, std::move(bgr)});
+}
+
+void ThumbnailExtractor::run(std::string path, int slots, int height) {
+    if (ImageSequence::handles(path)) {
+        runSequence(path, slots, height);
+        return;
+    }
+    const std::string cachePath = mediaCachePath(
+        path, "thumbnails", "-" + std::to_string(slots) + "x" + std::to_string(height) + ".lvts");
+    std::vector<cv::Mat> strip;
+    if (!cachePath.empty() && loadStrip(cachePath, slots, strip)) {
+        for (int i = 0; i < slots; ++i)
+            if (!strip[static_cast<std::size_t>(i)].empty())
+                publish(i, strip[static_cast<std::size_t>(i)]);
+        return;
+    }
+
+    LibavDecoder decoder;
+    if (!decoder.open(path, 1)) return; // one decode thread: this is the background budget
+    const std::shared_ptr<const KeyframeIndex> index = KeyframeIndex::loadCached(path);
+    if (index) decoder.setKeyframeIndex(index);
+    const std::int64_t total = index ? index->frameCount() : decoder.frameCount();
+    const cv::Size full = decoder.size();
+    if (total <= 0 || full.width <= 0 || full.height <= 0) return;
+    const int width = std::max(1, static_cast<int>(std::lround(
+                                      static_cast<double>(height) * full.width / full.height)));
+
+    strip.assign(static_cast<std::size_t>(slots), cv::Mat());
+    for (int slot : coarseToFine(slots)) {
+        if (cancel_.load(std::memory_order_relaxed)) return; // incomplete: nothing cached
+        const std::int64_t begin = total * slot / slots;
+        const std::int64_t end = total * (slot + 1) / slots;
+        std::int64_t target = (begin + end) / 2;
+        if (index) {
+            // A keyframe inside the slot is shown exactly where it is; otherwise the one before.
+            const std::vector<KeyframeIndex::Entry>& keys = index->entries();
+            auto it = std::lower_bound(
+                keys.begin(), keys.end(), begin,
+                [](const KeyframeIndex::Entry& e, std::int64_t f) { return e.frame < f; });
+            if (it != keys.end() && it->frame < end) target = it->frame;
+        }
+        cv::Mat thumb;
+        if (decoder.seekToKeyframe(target) && decoder.decode() &&
+            decoder.toBgr(thumb, cv::Size(width, height))) {
+            strip[static_cast<std::size_t>(slot)] = thumb;
+            publish(slot, std::move(thumb));
+        }
+    }
+    if (!cachePath.empty()) saveStrip(cachePath, strip);
+}
+
+void ThumbnailExtractor::runSequence(const std::string& path, int slots, int height) {
+    // One still per slot is cheap to decode, and a directory has no size or mtime to key a cache
+    // on, so there is nothing to gain from one.
+    const std::shared_ptr<const ImageSequence> seq = ImageSequence::open(path);
+    if (!seq || seq->size().height <= 0) return;
+    const cv::Size full = seq->size();
+    const int width = std::max(1, static_cast<int>(std::lround(
+                                      static_cast<double>(height) * full.width / full.height)));
+    const std::int64_t total = seq->frameCount();
+    for (int slot : coarseToFine(slots)) {
+        if (cancel_.load(std::memory_order_relaxed)) return;
+        const std::int64_t target = (total * slot / slots + total * (slot + 1) / slots) / 2;
+        const cv::Mat image = seq->decode(target, false);
+        if (image.empty()) continue;
+        cv::Mat thumb;
+        cv::resize(image, thumb, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+        if (thumb.channels() == 1) cv::cvtColor(thumb, thumb, cv::COLOR_GRAY2BGR);
+        publish(slot, std::move(thumb));
+    }
+}
+
+} // namespace livim
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace livim {
+
+// Decodes a row of small previews spread evenly over a file, for the timeline's thumbnail strip.
+// Runs on its own low-priority thread with its own single-threaded decoder, so it never shares
+// state or cores with playback. Each slot decodes just one keyframe: from the file's cached
+// KeyframeIndex when there is one, else from a plain demuxer seek. Slots are filled coarse to fine,
+// so the strip sharpens as it goes, and a finished strip is cached on disk for the next open. An
+// ImageSequence simply decodes the middle still of each slot.
+class ThumbnailExtractor {
+public:
+    struct Thumb {
+        int     slot = 0;
+        cv::Mat bgr;
+    };
+
+    ThumbnailExtractor() = default;
+    ~ThumbnailExtractor() { stop(); }
+
+    ThumbnailExtractor(const ThumbnailExtractor&) = delete;
+    ThumbnailExtractor& operator=(const ThumbnailExtractor&) = delete;
+
+    // Restarts for `path`: `slots` previews, each `height` px tall at the clip's aspect ratio.
+    void start(const std::string& path, int slots, int height);
+    // Cancels and joins; previews not yet taken are dropped.
+    void stop();
+
+    // Previews finished since the last call, in the order they were decoded.
+    std::vector<Thumb> takeReady();
+
+private:
+    void run(std::string path, int slots, int height);
+    void runSequence(const std::string& path, int slots, int height); // ImageSequence stills
+    void publish(int slot, cv::Mat bgr);
+
+    std::thread        thread_;
+    std::atomic<bool>  cancel_{false};
+    std::mutex         mu_;
+    std::vector<Thumb> ready_; // guarded by mu_
+};
+
+} // namespace livim
@@ -0,0 +1,449 @@
+#include "source/V4l2CameraSource.hpp"
+
+// Compiled only on Linux / non-Apple Unix (selected in CMakeLists.txt).
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include <linux/videodev2.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "core/FrameFormat.hpp"
+#include "core/Instrumentation.hpp"
+#include "source/CameraDecoder.hpp"
+
+namespace livim {
+namespace {
+
+constexpr unsigned kDefaultBuffers = 8;
+// Below this many buffers left with the driver, frames are copied out instead of lent, so a slow
+// consumer can never starve the capture.
+constexpr int kMinQueued = 2;
+constexpr int kPollSliceMs = 100;         // stop() is noticed within one slice
+constexpr int kReadTimeoutMs = 5000;      // like CameraSource's CAP_PROP_READ_TIMEOUT_MSEC
+
+enum class Layout { Grey, Bgr24, Yuyv, Nv12, Mjpeg };
+
+// The order formats are asked for when the device's current one isn't usable.
+constexpr std::uint32_t kPreferred[] = {V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_NV12, V4L2_PIX_FMT_MJPEG,
+                                        V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_BGR24};
+
+bool layoutOf(std::uint32_t fourcc, Layout& out) {
+    switch (fourcc) {
+    case V4L2_PIX_FMT_GREY:  out = Layout::Grey; return true;
+    case V4L2_PIX_FMT_BGR24: out = Layout::Bgr24; return true;
+    case V4L2_PIX_FMT_YUYV:  out = Layout::Yuyv; return true;
+    case V4L2_PIX_FMT_NV12:  out = Layout::Nv12; return true;
+    case V4L2_PIX_FMT_MJPEG: out = Layout::Mjpeg; return true;
+    default:                 return false;
+    }
+}
+
+// What a buffer in this layout is delivered as: YUYV and NV12 go down the pipeline as they are.
+PixelFormat deliveredAs(Layout layout, bool luma) {
+    if (luma) return PixelFormat::Gray8;
+    switch (layout) {
+    case Layout::Grey: return PixelFormat::Gray8;
+    case Layout::Yuyv: return PixelFormat::YUYV;
+    case Layout::Nv12: return PixelFormat::NV12;
+    default:           return PixelFormat::BGR8;
+    }
+}
+
+// True if a buffer in this layout is already the frame delivered in this mode.
+bool lendable(Layout layout, bool luma) {
+    switch (layout) {
+    case Layout::Grey:  return true;
+    case Layout::Bgr24: return !luma;
+    case Layout::Yuyv:  return !luma;
+    case Layout::Nv12:  return true; // in luma-only mode, the Y plane leading the buffer
+    default:            return false;
+    }
+}
+
+bool streamingCapture(IV4l2Device& io, int fd) {
+    v4l2_capability cap{};
+    if (io.ioctl(fd, VIDIOC_QUERYCAP, &cap) != 0) return false;
+    const unsigned caps =
+        (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    return (caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_STREAMING);
+}
+
+bool offers(IV4l2Device& io, int fd, std::uint32_t fourcc) {
+    v4l2_fmtdesc desc{};
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    for (desc.index = 0; io.ioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; ++desc.index)
+        if (desc.pixelformat == fourcc) return true;
+    return false;
+}
+
+bool nativeDisabled() {
+    const char* v = std::getenv("LIVIM_V4L2");
+    return v && v[0] == '0';
+}
+
+} // namespace
+
+struct V4l2CameraSource::Device {
+    struct Buffer {
+        void*       start = MAP_FAILED;
+        std::size_t length = 0;
+    };
+
+    std::shared_ptr<IV4l2Device> io;
+    int fd = -1;
+    Layout layout = Layout::Yuyv;
+    int width = 0;
+    int height = 0;
+    std::size_t bytesPerLine = 0;
+    std::vector<Buffer> buffers;
+    std::atomic<int> queued{0}; // buffers the driver holds; the rest are out in frames
+    bool streaming = false;
+
+    ~Device() {
+        if (streaming) {
+            int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            io->ioctl(fd, VIDIOC_STREAMOFF, &type);
+        }
+        for (const Buffer& b : buffers)
+            if (b.start != MAP_FAILED) io->munmap(b.start, b.length);
+        if (fd >= 0) io->close(fd);
+    }
+
+    bool queue(unsigned index) {
+        v4l2_buffer b{};
+        b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        b.memory = V4L2_MEMORY_MMAP;
+        b.index = index;
+        if (io->ioctl(fd, VIDIOC_QBUF, &b) != 0) return false;
+        queued.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Keeps the device (and the buffer's mapping) alive while a frame views buffer `index`, and
+    // queues the buffer back once the last copy of that frame is gone.
+    static std::shared_ptr<const void> lease(const std::shared_ptr<Device>& d, unsigned index) {
+        return std::shared_ptr<const void>(d->buffers[index].start,
+                                           [d, index](const void*) { d->queue(index); });
+    }
+
+    // Waits for a filled buffer, in slices so a stop request is seen. False on error, on timeout
+    // or when `stop` returns true.
+    template <class StopFn>
+    bool dequeue(v4l2_buffer& b, StopFn&& stop) {
+        for (int waited = 0; waited < kReadTimeoutMs;) {
+            if (stop()) return false;
+            b = v4l2_buffer{};
+            b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            b.memory = V4L2_MEMORY_MMAP;
+            if (io->ioctl(fd, VIDIOC_DQBUF, &b) == 0) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (errno != EAGAIN) return false;
+            const int r = io->poll(fd, kPollSliceMs);
+            if (r < 0 && errno != EINTR) return false;
+            if (r == 0) waited += kPollSliceMs;
+        }
+        return false;
+    }
+
+    // A lendable buffer (see lendable()) as the delivered frame, in place.
+    cv::Mat view(const std::uint8_t* data, bool luma) const {
+        auto* p = const_cast<std::uint8_t*>(data); // cv::Mat has no read-only flavour
+        switch (deliveredAs(layout, luma)) {
+        case PixelFormat::BGR8: return cv::Mat(height, width, CV_8UC3, p, bytesPerLine);
+        case PixelFormat::YUYV: return cv::Mat(height, width, CV_8UC2, p, bytesPerLine);
+        case PixelFormat::NV12: return cv::Mat(height * 3 / 2, width, CV_8UC1, p, bytesPerLine);
+        default:                return cv::Mat(height, width, CV_8UC1, p, bytesPerLine);
+        }
+    }
+
+    // Buffer contents as the delivered frame, copied or converted into `dst`.
+    bool convert(const std::uint8_t* data, std::size_t bytesUsed, bool luma, cv::Mat& dst) const {
+        auto* p = const_cast<std::uint8_t*>(data);
+        const std::size_t step = bytesPerLine;
+        if (lendable(layout, luma)) {
+            view(data, luma).copyTo(dst);
+            return true;
+        }
+        switch (layout) {
+        case Layout::Bgr24:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC3, p, step), dst, cv::COLOR_BGR2GRAY);
+            return true;
+        case Layout::Yuyv:
+            cv::cvtColor(cv::Mat(height, width, CV_8UC2, p, step), dst, cv::COLOR_YUV2GRAY_YUYV);
+            return true;
+        case Layout::Grey:
+        case Layout::Nv12:
+            return false; // always lendable
+        case Layout::Mjpeg:
+            cv::imdecode(cv::Mat(1, static_cast<int>(bytesUsed), CV_8UC1, p),
+                         luma ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR, &dst);
+            return !dst.empty();
+        }
+        return false;
+    }
+};
+
+V4l2CameraSource::V4l2CameraSource(int deviceIndex, const CameraMode& mode, FrameQueue* out,
+                                   FramePool* pool, Instrumentation* instr,
+                                   std::shared_ptr<IV4l2Device> io)
+    : SourceBase(out, pool, instr),
+      deviceIndex_(deviceIndex),
+      requested_(mode),
+      io_(std::move(io)) {}
+
+V4l2CameraSource::~V4l2CameraSource() { stop(); }
+
+bool V4l2CameraSource::usable(int deviceIndex, IV4l2Device& io) {
+    if (nativeDisabled()) return false;
+    const int fd = io.open(v4l2DevicePath(deviceIndex), O_RDWR | O_NONBLOCK);
+    if (fd < 0) return false;
+    bool ok = streamingCapture(io, fd);
+    if (ok) {
+        Layout layout;
+        v4l2_format fmt{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        ok = (io.ioctl(fd, VIDIOC_G_FMT, &fmt) == 0 && layoutOf(fmt.fmt.pix.pixelformat, layout));
+        for (std::uint32_t fourcc : kPreferred) ok = ok || offers(io, fd, fourcc);
+    }
+    io.close(fd);
+    return ok;
+}
+
+bool V4l2CameraSource::open() {
+    auto dev = std::make_shared<Device>();
+    dev->io = io_;
+    IV4l2Device& io = *io_;
+    dev->fd = io.open(v4l2DevicePath(deviceIndex_), O_RDWR | O_NONBLOCK);
+    if (dev->fd < 0 || !streamingCapture(io, dev->fd)) return false;
+
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (io.ioctl(dev->fd, VIDIOC_G_FMT, &fmt) != 0) return false;
+
+    // The requested mode, else the policy's pick among those this source can take. The driver
+    // adjusts what it can't do to the nearest it can.
+    std::vector<CameraMode> takeable;
+    for (const CameraMode& m : listV4l2Modes(io, dev->fd)) {
+        Layout layout;
+        if (layoutOf(m.fourcc, layout)) takeable.push_back(m);
+    }
+    const CameraMode mode = resolveCameraMode(requested_, takeable);
+    if (mode.valid()) {
+        v4l2_format want = fmt;
+        want.fmt.pix.width = static_cast<std::uint32_t>(mode.width);
+        want.fmt.pix.height = static_cast<std::uint32_t>(mode.height);
+        if (mode.fourcc != 0) want.fmt.pix.pixelformat = mode.fourcc;
+        want.fmt.pix.field = V4L2_FIELD_ANY;
+        want.fmt.pix.bytesperline = 0;
+        if (io.ioctl(dev->fd, VIDIOC_S_FMT, &want) == 0) fmt = want;
+    }
+
+    // Keep the format when it can be taken as is; otherwise ask for the first preferred one the
+    // device offers, at the same size.
+    if (!layoutOf(fmt.fmt.pix.pixelformat, dev->layout)) {
+        bool set = false;
+        for (std::uint32_t fourcc : kPreferred) {
+            if (!offers(io, dev->fd, fourcc)) continue;
+            v4l2_format want = fmt;
+            want.fmt.pix.pixelformat = fourcc;
+            want.fmt.pix.field = V4L2_FIELD_ANY;
+            if (io.ioctl(dev->fd, VIDIOC_S_FMT, &want) == 0 &&
+                layoutOf(want.fmt.pix.pixelformat, dev->layout)) {
+                fmt = want;
+                set = true;
+                break;
+            }
+        }
+        if (!set) return false;
+    }
+    dev->width = static_cast<int>(fmt.fmt.pix.width);
+    dev->height = static_cast<int>(fmt.fmt.pix.height);
+    dev->bytesPerLine = fmt.fmt.pix.bytesperline;
+    if (dev->width <= 0 || dev->height <= 0) return false;
+    if (dev->bytesPerLine == 0 && dev->layout != Layout::Mjpeg) {
+        const std::size_t bpp = dev->layout == Layout::Bgr24  ? 3
+                                : dev->layout == Layout::Yuyv ? 2
+                                                              : 1;
+        dev->bytesPerLine = static_cast<std::size_t>(dev->width) * bpp;
+    }
+
+    // Webcams often report 0/garbage FPS; fall back to 30 to keep pacing sane.
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (mode.fps > 0.0) {
+        parm.parm.capture.timeperframe.numerator = 1000;
+        parm.parm.capture.timeperframe.denominator =
+            static_cast<std::uint32_t>(std::lround(mode.fps * 1000.0));
+        io.ioctl(dev->fd, VIDIOC_S_PARM, &parm); // unsupported: the driver keeps its own rate
+        parm = v4l2_streamparm{};
+        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    }
+    reportedFps_ = 30.0;
+    if (io.ioctl(dev->fd, VIDIOC_G_PARM, &parm) == 0 &&
+        (parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME) &&
+        parm.parm.capture.timeperframe.numerator > 0) {
+        const double fps = static_cast<double>(parm.parm.capture.timeperframe.denominator) /
+                           parm.parm.capture.timeperframe.numerator;
+        if (fps > 1.0) reportedFps_ = fps;
+    }
+
+    unsigned count = kDefaultBuffers;
+    if (const char* v = std::getenv("LIVIM_V4L2_BUFFERS"); v && std::atoi(v) >= 2)
+        count = static_cast<unsigned>(std::atoi(v));
+    v4l2_requestbuffers req{};
+    req.count = count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (io.ioctl(dev->fd, VIDIOC_REQBUFS, &req) != 0 || req.count < 2) return false;
+    dev->buffers.resize(req.count);
+    for (unsigned i = 0; i < req.count; ++i) {
+        v4l2_buffer b{};
+        b.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        b.memory = V4L2_MEMORY_MMAP;
+        b.index = i;
+        if (io.ioctl(dev->fd, VIDIOC_QUERYBUF, &b) != 0) return false;
+        dev->buffers[i].length = b.length;
+        dev->buffers[i].start = io.mmap(b.length, dev->fd, static_cast<off_t>(b.m.offset));
+        if (dev->buffers[i].start == MAP_FAILED) return false;
+        if (!dev->queue(i)) return false;
+    }
+    int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (io.ioctl(dev->fd, VIDIOC_STREAMON, &type) != 0) return false;
+    dev->streaming = true;
+
+    device_ = std::move(dev);
+    setNativeChannels(device_->layout == Layout::Grey ? 1 : 3);
+    setNativeSize(device_->width, device_->height);
+    if (instr_) instr_->setCameraBuffers(device_->queued.load(), static_cast<int>(req.count));
+    return true;
+}
+
+void V4l2CameraSource::run() {
+    // Never paced: reading slower than the hardware rate would grow latency and make the driver
+    // silently drop frames.
+    Device& dev = *device_;
+    const int total = static_cast<int>(dev.buffers.size());
+
+    // MJPEG is decoded off this thread, so the dequeue keeps up with the driver.
+    std::unique_ptr<CameraDecoder> decoder;
+    const int decodeThreads = CameraDecoder::threadsFromEnvironment();
+    if (dev.layout == Layout::Mjpeg && decodeThreads > 0) {
+        decoder = std::make_unique<CameraDecoder>(
+            decodeThreads,
+            [this](MutableFrameRef frame) {
+                if (frame->image.empty()) {
+                    if (instr_) instr_->onSourceReadError();
+                    return !stopRequested(); // a corrupt JPEG: skip it
+                }
+                frame->width = frame->image.cols;
+                frame->height = frame->image.rows;
+                setNativeChannels(colourChannels(frame->format));
+                return deliverCaptured(std::move(frame));
+            },
+            instr_);
+    }
+    bool haveSequence = false;
+    std::uint32_t lastSequence = 0;
+    while (!stopRequested()) {
+        waitWhilePaused();
+        if (stopRequested()) break;
+
+        MutableFrameRef frame = acquireFrame();
+        if (!frame) break; // pool stopped
+
+        v4l2_buffer buf{};
+        bool ok = false;
+        {
+            StageTimer timer(instr_, Stage::SourceRead, seq_);
+            ok = dev.dequeue(buf, [this] { return stopRequested(); });
+        }
+        if (!ok) {
+            if (stopRequested()) break;
+            if (instr_) instr_->onSourceReadError();
+            continue; // assume a transient failure and try again
+        }
+        if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+            dev.queue(buf.index);
+            if (instr_) instr_->onSourceReadError();
+            continue;
+        }
+        if (haveSequence && buf.sequence > lastSequence + 1 && instr_)
+            instr_->addCameraDrops(buf.sequence - lastSequence - 1);
+        haveSequence = true;
+        lastSequence = buf.sequence;
+
+        // The driver's timestamp, when it is CLOCK_MONOTONIC, which is steady_clock on Linux. A
+        // value that isn't plausibly just before now means the clocks differ after all.
+        const Timestamp dequeued = now();
+        frame->captureTs = dequeued;
+        if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+            const Timestamp driver(std::chrono::duration_cast<Clock::duration>(
+                std::chrono::seconds(buf.timestamp.tv_sec) +
+                std::chrono::microseconds(buf.timestamp.tv_usec)));
+            if (driver <= dequeued && dequeued - driver < std::chrono::seconds(1))
+                frame->captureTs = driver;
+        }
+
+        const bool luma = lumaOnly_.load(std::memory_order_acquire);
+        const auto* data = static_cast<const std::uint8_t*>(dev.buffers[buf.index].start);
+        const bool headroom = dev.queued.load(std::memory_order_relaxed) >= kMinQueued;
+        if (decoder) {
+            // Decoded on a worker: straight from the driver's buffer while the driver has
+            // headroom, else from a copy so the buffer goes back at once.
+            cv::Mat jpeg(1, static_cast<int>(buf.bytesused), CV_8UC1,
+                         const_cast<std::uint8_t*>(data));
+            std::shared_ptr<const void> backing;
+            if (headroom) {
+                backing = Device::lease(device_, buf.index);
+            } else {
+                jpeg = jpeg.clone();
+                dev.queue(buf.index);
+            }
+            if (instr_) instr_->setCameraBuffers(dev.queued.load(std::memory_order_relaxed), total);
+            frame->seq = seq_++;
+            frame->format = deliveredAs(dev.layout, luma);
+            frame->ptsUs = livePtsUs(frame->captureTs);
+            const int flags = luma ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR;
+            if (!decoder->submit(std::move(frame), std::move(jpeg), std::move(backing), flags))
+                break;
+            continue;
+        }
+        if (lendable(dev.layout, luma) && headroom) {
+            frame->image = dev.view(data, luma);
+            frame->backing = Device::lease(device_, buf.index);
+        } else {
+            ok = dev.convert(data, buf.bytesused, luma, frame->image);
+            dev.queue(buf.index);
+            if (!ok) {
+                if (instr_) instr_->onSourceReadError();
+                continue;
+            }
+        }
+        if (instr_) instr_->setCameraBuffers(dev.queued.load(std::memory_order_relaxed), total);
+
+        frame->seq = seq_++;
+        frame->format = deliveredAs(dev.layout, luma);
+        frame->width = frame->image.cols;
+        frame->height = frame->format == PixelFormat::NV12 ? frame->image.rows * 2 / 3
+                                                           : frame->image.rows;
+        setNativeChannels(colourChannels(frame->format));
+        frame->ptsUs = livePtsUs(frame->captureTs);
+
+        if (!deliverCaptured(std::move(frame))) break;
+    }
+}
+
+} // namespace livim
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "source/CameraMode.hpp"
+#include "source/SourceBase.hpp"
+#include "source/V4l2Device.hpp"
+
+namespace livim {
+
+// Captures straight from a V4L2 device's mmap'ed streaming buffers (Linux), instead of through
+// cv::VideoCapture, which copies every buffer and converts it to BGR. YUYV and NV12 go down the
+// pipeline as they are (PixelFormat::YUYV/NV12), so a buffer is emitted as a view (GREY; BGR24;
+// YUYV; NV12, or its Y plane in luma-only mode), and a lease in Frame::backing hands it back to
+// the driver (VIDIOC_QBUF) once the last reference to the frame drops. While the driver is short
+// of queued buffers, or the layout needs converting (MJPEG; YUYV in luma-only mode), the frame is
+// copied or converted into its pooled buffer and requeued at once.
+// captureTs is the driver's monotonic timestamp, so latency includes the time before the
+// dequeue. Gaps in the driver's sequence numbers are counted as camera drops. Free-running and
+// lossless like CameraSource. LIVIM_V4L2=0 falls back to CameraSource; LIVIM_V4L2_BUFFERS sets
+// the buffer count (default 8). Every call on the device goes through `io`.
+class V4l2CameraSource : public SourceBase {
+public:
+    // `mode` as for CameraSource.
+    V4l2CameraSource(int deviceIndex, const CameraMode& mode, FrameQueue* out, FramePool* pool,
+                     Instrumentation* instr,
+                     std::shared_ptr<IV4l2Device> io = systemV4l2Device());
+    ~V4l2CameraSource() override;
+
+    // True if /dev/video<deviceIndex> streams through mmap in a format this source can take, and
+    // LIVIM_V4L2 isn't 0. Cheap: nothing is allocated or started.
+    static bool usable(int deviceIndex, IV4l2Device& io = *systemV4l2Device());
+
+    SourceKind kind() const override { return SourceKind::Camera; }
+    bool open() override;
+    bool isOpen() const override { return device_ != nullptr; }
+    void setLumaOnly(bool enabled) override { lumaOnly_.store(enabled, std::memory_order_release); }
+    double reportedFps() const override { return reportedFps_; }
+
+protected:
+    void run() override;
+
+private:
+    struct Device; // the fd and its mappings, shared with every frame still holding a buffer
+
+    int deviceIndex_;
+    CameraMode requested_;
+    std::shared_ptr<IV4l2Device> io_;
+    std::shared_ptr<Device> device_;
+    std::uint64_t seq_ = 0;
+    double reportedFps_ = 0.0;
+    std::atomic<bool> lumaOnly_{false};
+};
+
+} // namespace livim
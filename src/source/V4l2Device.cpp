@@ -0,0 +1,98 @@
+#include "source/V4l2Device.hpp"
+
+// Compiled only on Linux / non-Apple Unix (selected in CMakeLists.txt).
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <linux/videodev2.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+
+namespace livim {
+namespace {
+
+class SystemV4l2Device : public IV4l2Device {
+public:
+    int open(const std::string& path, int flags) override { return ::open(path.c_str(), flags); }
+    int close(int fd) override { return ::close(fd); }
+
+    int ioctl(int fd, unsigned long request, void* arg) override {
+        int r;
+        do r = ::ioctl(fd, request, arg);
+        while (r < 0 && errno == EINTR);
+        return r;
+    }
+
+    void* mmap(std::size_t length, int fd, off_t offset) override {
+        return ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    }
+
+    int munmap(void* addr, std::size_t length) override { return ::munmap(addr, length); }
+
+    int poll(int fd, int timeoutMs) override {
+        pollfd p{fd, POLLIN, 0};
+        return ::poll(&p, 1, timeoutMs);
+    }
+};
+
+// The fastest rate the driver lists for one format and size; 0 if it lists none.
+double fastestFps(IV4l2Device& io, int fd, std::uint32_t fourcc, std::uint32_t w,
+                  std::uint32_t h) {
+    v4l2_frmivalenum iv{};
+    iv.pixel_format = fourcc;
+    iv.width = w;
+    iv.height = h;
+    double best = 0.0;
+    for (iv.index = 0; io.ioctl(fd, VIDIOC_ENUM_FRAMEINTERVALS, &iv) == 0; ++iv.index) {
+        // Stepwise and continuous ranges come as one entry; their minimum is the fastest.
+        const v4l2_fract f = iv.type == V4L2_FRMIVAL_TYPE_DISCRETE ? iv.discrete : iv.stepwise.min;
+        if (f.numerator > 0)
+            best = std::max(best, static_cast<double>(f.denominator) / f.numerator);
+        if (iv.type != V4L2_FRMIVAL_TYPE_DISCRETE) break;
+    }
+    return best;
+}
+
+} // namespace
+
+std::shared_ptr<IV4l2Device> systemV4l2Device() {
+    static const auto device = std::make_shared<SystemV4l2Device>();
+    return device;
+}
+
+std::string v4l2DevicePath(int index) { return "/dev/video" + std::to_string(index); }
+
+std::vector<CameraMode> listV4l2Modes(IV4l2Device& io, int fd) {
+    std::vector<CameraMode> out;
+    v4l2_fmtdesc desc{};
+    desc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    for (desc.index = 0; io.ioctl(fd, VIDIOC_ENUM_FMT, &desc) == 0; ++desc.index) {
+        v4l2_frmsizeenum size{};
+        size.pixel_format = desc.pixelformat;
+        for (size.index = 0; io.ioctl(fd, VIDIOC_ENUM_FRAMESIZES, &size) == 0; ++size.index) {
+            if (size.type == V4L2_FRMSIZE_TYPE_DISCRETE) {
+                const std::uint32_t w = size.discrete.width, h = size.discrete.height;
+                out.push_back({desc.pixelformat, static_cast<int>(w), static_cast<int>(h),
+                               fastestFps(io, fd, desc.pixelformat, w, h)});
+                continue;
+            }
+            // A range (virtual or scaling devices): its two ends are the useful choices.
+            const v4l2_frmsize_stepwise& r = size.stepwise;
+            for (const auto& [w, h] : {std::pair{r.min_width, r.min_height},
+                                       std::pair{r.max_width, r.max_height}})
+                out.push_back({desc.pixelformat, static_cast<int>(w), static_cast<int>(h),
+                               fastestFps(io, fd, desc.pixelformat, w, h)});
+            break;
+        }
+    }
+    return out;
+}
+
+} // namespace livim
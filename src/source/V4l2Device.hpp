@@ -0,0 +1,39 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "source/CameraMode.hpp"
+
+namespace livim {
+
+// The system calls made on a V4L2 device node, behind an interface so a test can stand in a fake
+// driver. Each behaves like its POSIX namesake: -1 (MAP_FAILED for mmap) with errno set on
+// failure. ioctl() retries EINTR itself. Linux only.
+class IV4l2Device {
+public:
+    virtual ~IV4l2Device() = default;
+
+    virtual int   open(const std::string& path, int flags) = 0;
+    virtual int   close(int fd) = 0;
+    virtual int   ioctl(int fd, unsigned long request, void* arg) = 0;
+    virtual void* mmap(std::size_t length, int fd, off_t offset) = 0; // shared, read/write
+    virtual int   munmap(void* addr, std::size_t length) = 0;
+    // > 0 once `fd` is readable, 0 on timeout.
+    virtual int   poll(int fd, int timeoutMs) = 0;
+};
+
+// The kernel's, process-wide.
+std::shared_ptr<IV4l2Device> systemV4l2Device();
+
+std::string v4l2DevicePath(int index); // /dev/video<index>
+
+// Every (format, size, fps) the open device `fd` lists, fastest rate per size and format. A
+// stepwise or continuous size range contributes its two ends.
+std::vector<CameraMode> listV4l2Modes(IV4l2Device& io, int fd);
+
+} // namespace livim
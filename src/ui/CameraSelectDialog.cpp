@@ -1,6 +1,10 @@
 #include "ui/CameraSelectDialog.hpp"
 
+#include <algorithm>
+
+#include <QComboBox>
 #include <QDialogButtonBox>
+#include <QHBoxLayout>
 #include <QLabel>
 #include <QListWidget>
 #include <QPushButton>
@@ -18,6 +22,14 @@ CameraSelectDialog::CameraSelectDialog(QWidget* parent) : QDialog(parent) {
     list_ = new QListWidget(this);
     layout->addWidget(list_);
 
+    auto* modeRow = new QHBoxLayout;
+    modeRow->addWidget(new QLabel("Mode:", this));
+    modeCombo_ = new QComboBox(this);
+    modeCombo_->setToolTip("Automatic picks the highest frame rate the processing can keep up "
+                           "with; temporal magnification works best at a high, steady rate.");
+    modeRow->addWidget(modeCombo_, 1);
+    layout->addLayout(modeRow);
+
     auto* buttons = new QDialogButtonBox(this);
     okButton_ = buttons->addButton("Open", QDialogButtonBox::AcceptRole);
     buttons->addButton(QDialogButtonBox::Cancel);
@@ -29,6 +41,7 @@ CameraSelectDialog::CameraSelectDialog(QWidget* parent) : QDialog(parent) {
     connect(refreshButton, &QPushButton::clicked, this, &CameraSelectDialog::refresh);
     connect(list_, &QListWidget::itemDoubleClicked, this, &CameraSelectDialog::accept);
     connect(list_, &QListWidget::itemSelectionChanged, this, &CameraSelectDialog::updateOkEnabled);
+    connect(list_, &QListWidget::currentRowChanged, this, &CameraSelectDialog::updateModes);
 
     refresh();
 }
@@ -47,6 +60,25 @@ void CameraSelectDialog::refresh() {
         list_->setCurrentRow(0);
     }
     updateOkEnabled();
+    updateModes();
+}
+
+void CameraSelectDialog::updateModes() {
+    modeCombo_->clear();
+    modeCombo_->addItem("Automatic (highest frame rate)");
+    const int row = list_->currentRow();
+    if (row < 0 || row >= static_cast<int>(devices_.size())) return;
+    // Fastest first, then largest; the index into the device's list rides along as item data.
+    const std::vector<CameraMode>& modes = devices_[row].modes;
+    std::vector<int> order(modes.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        const CameraMode& ma = modes[a];
+        const CameraMode& mb = modes[b];
+        if (ma.fps != mb.fps) return ma.fps > mb.fps;
+        return ma.width * ma.height > mb.width * mb.height;
+    });
+    for (int i : order) modeCombo_->addItem(QString::fromStdString(describe(modes[i])), i);
 }
 
 void CameraSelectDialog::updateOkEnabled() {
@@ -59,6 +91,8 @@ void CameraSelectDialog::accept() {
     if (row < 0 || row >= static_cast<int>(devices_.size())) return;
     selectedIndex_ = devices_[row].index;
     selectedName_ = QString::fromStdString(devices_[row].name);
+    const QVariant mode = modeCombo_->currentData();
+    selectedMode_ = mode.isValid() ? devices_[row].modes[mode.toInt()] : CameraMode{};
     QDialog::accept();
 }
 
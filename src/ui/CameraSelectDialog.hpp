@@ -7,12 +7,14 @@
 
 #include "source/CameraEnumerator.hpp"
 
+class QComboBox;
 class QListWidget;
 class QPushButton;
 
 namespace livim {
 
-// Lists capture devices; selectedDeviceIndex() is the cv::VideoCapture ordinal.
+// Lists capture devices; selectedDeviceIndex() is the cv::VideoCapture ordinal. Where the platform
+// lists capture modes, one can be picked; selectedMode() is invalid for "Automatic".
 class CameraSelectDialog : public QDialog {
     Q_OBJECT
 public:
@@ -20,6 +22,7 @@ public:
 
     int selectedDeviceIndex() const { return selectedIndex_; }     // -1 if none chosen
     QString selectedDeviceName() const { return selectedName_; }
+    CameraMode selectedMode() const { return selectedMode_; }
 
 private slots:
     void refresh();
@@ -27,12 +30,15 @@ private slots:
 
 private:
     void updateOkEnabled();
+    void updateModes(); // for the current device
 
     QListWidget* list_ = nullptr;
+    QComboBox* modeCombo_ = nullptr;
     QPushButton* okButton_ = nullptr;
     std::vector<CameraDevice> devices_;
     int selectedIndex_ = -1;
     QString selectedName_;
+    CameraMode selectedMode_;
 };
 
 } // namespace livim
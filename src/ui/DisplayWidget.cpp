@@ -9,8 +9,10 @@
 #include <QRubberBand>
 #include <QTimer>
 
+#include "core/FrameFormat.hpp"
 #include "core/Instrumentation.hpp"
 #include "core/LatestFrameMailbox.hpp"
+#include "core/Trace.hpp"
 
 namespace livim {
 namespace {
@@ -35,22 +37,49 @@ void main() {
 )";
 
 // Colour textures hold BGR bytes uploaded as RGB, so the shader outputs .bgr to swizzle back;
-// gray is a single-channel GL_R8 texture replicated across RGB. Requires GLSL 330 core.
+// gray is a single-channel GL_R8 texture replicated across RGB. YUV arrives as its planes and is
+// converted here, with the BT.601 limited-range matrix OpenCV's COLOR_YUV2BGR_* use, so the CPU
+// never converts a frame just to show it. Requires GLSL 330 core.
 constexpr char kFragmentShader[] = R"(#version 330 core
 in vec2 vTex;
 out vec4 FragColor;
-uniform sampler2D uTex;
-uniform int uGrayscale; // 1 = single-channel texture, 0 = BGR-in-RGB texture
+uniform sampler2D uTex;     // BGR, gray, or the Y plane (in .r)
+uniform sampler2D uChroma0; // I420: U; NV12: UV; YUYV: Y0 U Y1 V quads
+uniform sampler2D uChroma1; // I420: V
+uniform int uFormat;        // 0 = BGR, 1 = gray, 2 = I420, 3 = NV12, 4 = YUYV
 void main() {
-    if (uGrayscale == 1) {
-        float g = texture(uTex, vTex).r;
-        FragColor = vec4(g, g, g, 1.0);
-    } else {
+    if (uFormat == 0) {
         FragColor = vec4(texture(uTex, vTex).bgr, 1.0);
+        return;
+    }
+    float y = texture(uTex, vTex).r;
+    if (uFormat == 1) {
+        FragColor = vec4(y, y, y, 1.0);
+        return;
     }
+    vec2 c;
+    if (uFormat == 2) c = vec2(texture(uChroma0, vTex).r, texture(uChroma1, vTex).r);
+    else if (uFormat == 3) c = texture(uChroma0, vTex).rg;
+    else c = texture(uChroma0, vTex).ga;
+    y = 1.164383 * (y - 16.0 / 255.0);
+    c -= 128.0 / 255.0;
+    FragColor = vec4(clamp(vec3(y + 1.596027 * c.y,
+                                y - 0.391762 * c.x - 0.812968 * c.y,
+                                y + 2.017232 * c.x), 0.0, 1.0), 1.0);
 }
 )";
 
+int shaderFormat(PixelFormat f) {
+    switch (f) {
+    case PixelFormat::BGR8:  return 0;
+    case PixelFormat::Gray8: return 1;
+    case PixelFormat::I420:  return 2;
+    case PixelFormat::NV12:  return 3;
+    case PixelFormat::YUYV:  return 4;
+    }
+    return 0;
+}
+
 } // namespace
 
 DisplayWidget::DisplayWidget(QWidget* parent) : QOpenGLWidget(parent) {
@@ -74,9 +103,11 @@ DisplayWidget::~DisplayWidget() {
     if (context()) {
         makeCurrent();
         for (Tex* t : {&texProc_, &texOrig_}) {
-            if (t->id != 0) {
-                glDeleteTextures(1, &t->id);
-                t->id = 0;
+            for (unsigned int* id : {&t->id, &t->chroma[0], &t->chroma[1]}) {
+                if (*id != 0) {
+                    glDeleteTextures(1, id);
+                    *id = 0;
+                }
             }
         }
         vbo_.destroy();
@@ -114,12 +145,14 @@ void DisplayWidget::initializeGL() {
     vao_.release();
 
     for (Tex* t : {&texProc_, &texOrig_}) {
-        glGenTextures(1, &t->id);
-        glBindTexture(GL_TEXTURE_2D, t->id);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        for (unsigned int* id : {&t->id, &t->chroma[0], &t->chroma[1]}) {
+            glGenTextures(1, id);
+            glBindTexture(GL_TEXTURE_2D, *id);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
     }
     glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -130,28 +163,55 @@ void DisplayWidget::resizeGL(int /*w*/, int /*h*/) {
     // Letterbox viewports are computed per-frame in paintGL from the current frame's aspect.
 }
 
+void DisplayWidget::uploadPlane(unsigned int id, const cv::Mat& plane, int internalFormat,
+                                unsigned int format, bool allocate) {
+    glBindTexture(GL_TEXTURE_2D, id);
+    // Handle a non-contiguous cv::Mat (row padding) via row length in pixels.
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(plane.step / plane.elemSize()));
+    if (allocate) {
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, plane.cols, plane.rows, 0, format,
+                     GL_UNSIGNED_BYTE, plane.data);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, plane.cols, plane.rows, format, GL_UNSIGNED_BYTE,
+                        plane.data);
+    }
+}
+
 void DisplayWidget::uploadFrame(const Frame& f, Tex& tex) {
     const cv::Mat& src = f.image;
+    const bool allocate = f.width != tex.w || f.height != tex.h || f.format != tex.format;
 
-    const int channels = src.channels();
-    const GLint internalFormat = (channels == 1) ? GL_R8 : GL_RGB8;
-    const GLenum pixelFormat = (channels == 1) ? GL_RED : GL_RGB;
-
-    glBindTexture(GL_TEXTURE_2D, tex.id);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    // Handle a non-contiguous cv::Mat (row padding) via row length in pixels.
-    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(src.step / src.elemSize()));
-
-    if (f.width != tex.w || f.height != tex.h || channels != tex.channels) {
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, f.width, f.height, 0, pixelFormat,
-                     GL_UNSIGNED_BYTE, src.data);
-        tex.w = f.width;
-        tex.h = f.height;
-        tex.channels = channels;
-    } else {
-        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, f.width, f.height, pixelFormat, GL_UNSIGNED_BYTE,
-                        src.data);
+    switch (f.format) {
+    case PixelFormat::BGR8:
+        uploadPlane(tex.id, src, GL_RGB8, GL_RGB, allocate);
+        break;
+    case PixelFormat::Gray8:
+        uploadPlane(tex.id, src, GL_R8, GL_RED, allocate);
+        break;
+    case PixelFormat::I420:
+    case PixelFormat::NV12: {
+        const Planes420 p = planes420(src, f.width, f.height, f.format);
+        uploadPlane(tex.id, p.y, GL_R8, GL_RED, allocate);
+        if (f.format == PixelFormat::NV12) {
+            uploadPlane(tex.chroma[0], p.uv, GL_RG8, GL_RG, allocate);
+        } else {
+            uploadPlane(tex.chroma[0], p.u, GL_R8, GL_RED, allocate);
+            uploadPlane(tex.chroma[1], p.v, GL_R8, GL_RED, allocate);
+        }
+        break;
     }
+    case PixelFormat::YUYV: {
+        // The same bytes twice: (Y, U|V) pairs at full width for luma, quads at half for chroma.
+        const cv::Mat quads(f.height, f.width / 2, CV_8UC4, src.data, src.step);
+        uploadPlane(tex.id, src, GL_RG8, GL_RG, allocate);
+        uploadPlane(tex.chroma[0], quads, GL_RGBA8, GL_RGBA, allocate);
+        break;
+    }
+    }
+    tex.w = f.width;
+    tex.h = f.height;
+    tex.format = f.format;
 
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -174,12 +234,20 @@ void DisplayWidget::drawTexture(const Tex& tex, int vx, int vy, int vw, int vh)
 
     program_->bind();
     vao_.bind();
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, tex.id);
+    const unsigned int units[] = {tex.id, tex.chroma[0], tex.chroma[1]};
+    for (int i = 2; i >= 0; --i) { // ending on unit 0
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        glBindTexture(GL_TEXTURE_2D, units[i]);
+    }
     program_->setUniformValue("uTex", 0);
-    program_->setUniformValue("uGrayscale", tex.channels == 1 ? 1 : 0);
+    program_->setUniformValue("uChroma0", 1);
+    program_->setUniformValue("uChroma1", 2);
+    program_->setUniformValue("uFormat", shaderFormat(tex.format));
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    for (int i = 2; i >= 0; --i) {
+        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(i));
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
     vao_.release();
     program_->release();
 }
@@ -211,6 +279,7 @@ int DisplayWidget::layoutPanes(Pane panes[2]) const {
 }
 
 void DisplayWidget::paintGL() {
+    trace::Span span("present"); // one present-timer tick; tagged with the frame it uploads
     const qreal dpr = devicePixelRatioF();
     const int fbW = static_cast<int>(width() * dpr);
     const int fbH = static_cast<int>(height() * dpr);
@@ -227,9 +296,17 @@ void DisplayWidget::paintGL() {
         if (proc.seq != lastSeq_) {
             const bool needProc = (viewMode_ != ViewMode::Original);
             const bool needOrig = (viewMode_ != ViewMode::Processed);
-            if (needProc) uploadFrame(proc, texProc_);
-            if (needOrig && presentable(df->original)) uploadFrame(*df->original, texOrig_);
+            {
+                span.setSeq(proc.seq);
+                StageTimer timer(instr_, Stage::Upload, proc.seq);
+                if (needProc) uploadFrame(proc, texProc_);
+                if (needOrig && presentable(df->original)) uploadFrame(*df->original, texOrig_);
+            }
+            // A view-mode switch re-uploads the same frame; only its first upload is its latency.
+            const bool firstUpload = proc.stampOf(FrameStamp::Uploaded) == Timestamp{};
+            proc.stamp(FrameStamp::Uploaded);
             if (instr_) {
+                if (firstUpload) instr_->recordPresented(proc);
                 if (lastSeq_ != kNoSeq && proc.seq > lastSeq_ + 1)
                     instr_->addDisplaySkipped(proc.seq - lastSeq_ - 1);
                 instr_->onDisplayed();
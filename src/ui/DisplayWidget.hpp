@@ -63,11 +63,14 @@ protected:
     void mouseReleaseEvent(QMouseEvent* e) override;
 
 private:
+    // One texture per plane: BGR, gray and packed YUYV's luma use `id`; the chroma goes in
+    // `chroma` (I420: U and V; NV12: UV; YUYV: the buffer again as half-width RGBA).
     struct Tex {
         unsigned int id = 0; // GLuint
+        unsigned int chroma[2] = {0, 0};
         int w = 0;
         int h = 0;
-        int channels = 0;
+        PixelFormat format = PixelFormat::BGR8;
     };
 
     struct Pane {
@@ -76,6 +79,9 @@ private:
     };
 
     void uploadFrame(const Frame& f, Tex& tex);
+    // (Re)specifies texture `id` when `allocate`, else updates it in place.
+    void uploadPlane(unsigned int id, const cv::Mat& plane, int internalFormat, unsigned int format,
+                     bool allocate);
     // Letterbox-fits `tex` into the framebuffer-pixel region [vx,vy,vw,vh].
     void drawTexture(const Tex& tex, int vx, int vy, int vw, int vh);
 
@@ -18,6 +18,7 @@
 #include <QMessageBox>
 #include <QPushButton>
 #include <QSpinBox>
+#include <QThread>
 #include <QVBoxLayout>
 
 #include "ui/MagnificationControls.hpp"
@@ -146,6 +147,27 @@ ExportSettingsDialog::ExportSettingsDialog(const Seed& seed, QWidget* parent)
         endSpin_->setValue(std::clamp(end, 1, seed.frameCount));
         endSpin_->setToolTip("End frame (exclusive).");
         layout->addWidget(labeledRow("End frame", endSpin_, this));
+
+        segmentsSpin_ = new QSpinBox(this);
+        segmentsSpin_->setRange(1, std::max(1, QThread::idealThreadCount()));
+        segmentsSpin_->setValue(1);
+        segmentsSpin_->setToolTip("Render the range as this many segments in parallel, each with "
+                                  "its own magnification state. 1 = one serial pass.");
+        layout->addWidget(labeledRow("Parallel segments", segmentsSpin_, this));
+
+        warmupSpin_ = new QSpinBox(this);
+        warmupSpin_->setRange(-1, 100000);
+        warmupSpin_->setValue(-1);
+        warmupSpin_->setSpecialValueText("Auto");
+        warmupSpin_->setSuffix(" frames");
+        warmupSpin_->setToolTip("Frames each segment processes before its first written frame, so "
+                                "the temporal filters settle. Auto picks enough for the mode.");
+        layout->addWidget(labeledRow("Segment warm-up", warmupSpin_, this));
+
+        verifySeamsSwitch_ = new ToggleSwitch(this);
+        verifySeamsSwitch_->setToolTip("Also run one serial pass up to the last seam and report the "
+                                       "largest pixel difference right after each seam.");
+        layout->addWidget(labeledRow("Check seams", verifySeamsSwitch_, this));
     }
 
     formatCombo_ = new QComboBox(this);
@@ -157,6 +179,17 @@ ExportSettingsDialog::ExportSettingsDialog(const Seed& seed, QWidget* parent)
     formatCombo_->setFixedWidth(fieldW);
     layout->addWidget(labeledRow("Format", formatCombo_, this));
 
+    presetCombo_ = new QComboBox(this);
+    // Item order must match EncodePreset.
+    presetCombo_->addItem("Fast");
+    presetCombo_->addItem("Balanced");
+    presetCombo_->addItem("Quality");
+    presetCombo_->setCurrentIndex(static_cast<int>(EncodePreset::Balanced));
+    presetCombo_->setToolTip("Encoder speed versus file size. Fast keeps the encoder from holding "
+                             "back the render; MKV stays lossless at every preset.");
+    presetCombo_->setFixedWidth(fieldW);
+    layout->addWidget(labeledRow("Encoder", presetCombo_, this));
+
     auto* outRow = new QWidget(this);
     auto* outLayout = new QHBoxLayout(outRow);
     outLayout->setContentsMargins(0, 0, 0, 0);
@@ -180,12 +213,15 @@ ExportSettingsDialog::ExportSettingsDialog(const Seed& seed, QWidget* parent)
         const QString ext = extensionFor(static_cast<ExportFormat>(formatCombo_->currentIndex()));
         pathEdit_->setText(fi.absolutePath() + "/" + fi.completeBaseName() + "." + ext);
     });
+    if (segmentsSpin_)
+        connect(segmentsSpin_, &QSpinBox::valueChanged, this, [this](int) { syncSegmentsEnabled(); });
     connect(browseBtn, &QPushButton::clicked, this, &ExportSettingsDialog::browse);
     connect(grayscaleSwitch_, &ToggleSwitch::toggled, magControls_, &MagnificationControls::setGrayscale);
     connect(buttons, &QDialogButtonBox::accepted, this, &ExportSettingsDialog::accept);
     connect(buttons, &QDialogButtonBox::rejected, this, &ExportSettingsDialog::reject);
 
     syncOverlayEnabled();
+    syncSegmentsEnabled();
     updateApplyEnabled();
 
     resize(300, sizeHint().height());
@@ -197,6 +233,14 @@ void ExportSettingsDialog::syncOverlayEnabled() {
     if (!split) overlaySwitch_->setChecked(false);
 }
 
+void ExportSettingsDialog::syncSegmentsEnabled() {
+    if (!segmentsSpin_) return;
+    const bool segmented = segmentsSpin_->value() > 1;
+    warmupSpin_->setEnabled(segmented);
+    verifySeamsSwitch_->setEnabled(segmented);
+    if (!segmented) verifySeamsSwitch_->setChecked(false);
+}
+
 void ExportSettingsDialog::updateApplyEnabled() {
     applyButton_->setEnabled(!pathEdit_->text().isEmpty());
 }
@@ -259,11 +303,17 @@ void ExportSettingsDialog::accept() {
     r.split = static_cast<SplitMode>(splitCombo_->currentIndex());
     r.textOverlay = (r.split != SplitMode::None) && overlaySwitch_->isChecked();
     r.format = static_cast<ExportFormat>(formatCombo_->currentIndex());
+    r.preset = static_cast<EncodePreset>(presetCombo_->currentIndex());
     r.outputPath = pathEdit_->text().toStdString();
     if (startSpin_ && endSpin_) {
         r.startFrame = startSpin_->value();
         r.endFrame = endSpin_->value();
     }
+    if (segmentsSpin_) {
+        r.segments = segmentsSpin_->value();
+        r.warmupFrames = warmupSpin_->value();
+        r.verifySeams = r.segments > 1 && verifySeamsSwitch_->isChecked();
+    }
     request_ = r;
 
     QDialog::accept();
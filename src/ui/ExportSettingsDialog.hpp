@@ -43,6 +43,7 @@ public:
 private:
     void browse();
     void syncOverlayEnabled();
+    void syncSegmentsEnabled();
     void updateApplyEnabled();
     void accept() override;
 
@@ -57,8 +58,12 @@ private:
     QComboBox*        splitCombo_ = nullptr;
     ToggleSwitch*     overlaySwitch_ = nullptr;   // split modes only
     QComboBox*        formatCombo_ = nullptr;
+    QComboBox*        presetCombo_ = nullptr;
     QSpinBox*         startSpin_ = nullptr; // file only
     QSpinBox*         endSpin_ = nullptr;
+    QSpinBox*         segmentsSpin_ = nullptr; // file only
+    QSpinBox*         warmupSpin_ = nullptr;
+    ToggleSwitch*     verifySeamsSwitch_ = nullptr;
     QLineEdit*        pathEdit_ = nullptr;
     QPushButton*      applyButton_ = nullptr;
 };
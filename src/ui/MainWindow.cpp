@@ -2,20 +2,26 @@
 
 #include <deque>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include <QApplication>
 #include <QCloseEvent>
 #include <QComboBox>
+#include <QDateTime>
+#include <QDir>
 #include <QEvent>
 #include <QFileDialog>
 #include <QFont>
 #include <QFileInfo>
 #include <QHBoxLayout>
+#include <QImage>
 #include <QKeyEvent>
+#include <QKeySequence>
 #include <QLabel>
 #include <QMessageBox>
 #include <QPushButton>
+#include <QShortcut>
 #include <QSizePolicy>
 #include <QSplitter>
 #include <QStackedWidget>
@@ -25,6 +31,7 @@
 #include <QVBoxLayout>
 #include <QWidget>
 
+#include "core/Trace.hpp"
 #include "export/BufferExportFrameSource.hpp"
 #include "export/FileExportFrameSource.hpp"
 #include "export/RecordingBuffer.hpp"
@@ -49,6 +56,9 @@ namespace {
 // Cap the in-RAM camera capture so a long recording can't OOM-kill the process. When hit,
 // recording auto-stops cleanly and the frames captured so far are still exported.
 constexpr std::size_t kRecordingCapBytes = 8ULL * 1024 * 1024 * 1024;
+// Timeline previews: twice the strip's height, so they stay sharp on a HiDPI screen.
+constexpr int kThumbnailSlots = 48;
+constexpr int kThumbnailHeight = 72;
 } // namespace
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
@@ -201,6 +211,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
         display_->setViewMode(mode);
         // "Original" shows only the untouched frame, so skip the (heavy) magnification.
         controller_.setMagnificationActive(mode != DisplayWidget::ViewMode::Original);
+        controller_.setOriginalShown(mode != DisplayWidget::ViewMode::Processed);
     });
     connect(fullscreenBtn_, &QPushButton::clicked, this, [this] { setFullscreen(!isFullScreen()); });
     connect(inspectorToggleBtn_, &QPushButton::toggled, this,
@@ -275,6 +286,11 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     timelineTimer_->setInterval(60);
     connect(timelineTimer_, &QTimer::timeout, this, [this] {
         if (!timeline_->isVisible()) return;
+        for (const ThumbnailExtractor::Thumb& t : thumbnails_.takeReady()) {
+            const QImage view(t.bgr.data, t.bgr.cols, t.bgr.rows, static_cast<int>(t.bgr.step),
+                              QImage::Format_BGR888);
+            timeline_->setThumbnail(t.slot, view.copy()); // view borrows the cv::Mat's pixels
+        }
         timeline_->setFrameCount(controller_.frameCount());
         if (controller_.isPlaying())
             timeline_->setPlayheadFrame(controller_.currentFrame());
@@ -287,6 +303,25 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     exportTimer_ = new QTimer(this);
     exportTimer_->setInterval(100);
     connect(exportTimer_, &QTimer::timeout, this, &MainWindow::pollExport);
+
+    // Chrome-trace timeline of the pipeline threads. An application shortcut so it works whatever
+    // has focus, including during an export.
+    trace::setThreadName("gui");
+    tracePath_ = qEnvironmentVariable("LIVIM_TRACE");
+    if (!tracePath_.isEmpty()) {
+        trace::setEnabled(true);
+        setWindowTitle("LiViM [tracing]");
+    }
+    auto* traceShortcut = new QShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_T), this);
+    traceShortcut->setContext(Qt::ApplicationShortcut);
+    connect(traceShortcut, &QShortcut::activated, this, &MainWindow::toggleTrace);
+
+    // Headless monitoring feed; runs on its own thread so it keeps going while the GUI is busy.
+    if (std::optional<StatsExportConfig> cfg = StatsExportConfig::fromEnvironment()) {
+        statsExporter_ = std::make_unique<StatsExporter>(
+            [this] { return controller_.sampleStats(); }, std::move(*cfg));
+        statsExporter_->start();
+    }
 }
 
 void MainWindow::showControls(SourceControlsView* view) {
@@ -338,9 +373,33 @@ void MainWindow::closeEvent(QCloseEvent* event) {
         event->ignore();
         return;
     }
+    if (!tracePath_.isEmpty() && trace::enabled()) trace::dumpJson(tracePath_.toStdString());
     QMainWindow::closeEvent(event);
 }
 
+void MainWindow::toggleTrace() {
+    if (!trace::enabled()) {
+        trace::clear();
+        trace::setEnabled(true);
+        setWindowTitle("LiViM [tracing]");
+        return;
+    }
+    trace::setEnabled(false);
+    setWindowTitle("LiViM");
+    const QString path = QDir(QDir::tempPath())
+                             .filePath(QStringLiteral("livim-trace-%1.json")
+                                           .arg(QDateTime::currentDateTime().toString(
+                                               QStringLiteral("yyyyMMdd-HHmmss"))));
+    if (trace::dumpJson(path.toStdString())) {
+        QMessageBox::information(this, "Trace saved",
+                                 "Timeline trace written to\n" + QDir::toNativeSeparators(path) +
+                                     "\n\nOpen it in ui.perfetto.dev or chrome://tracing.");
+    } else {
+        QMessageBox::warning(this, "Trace failed",
+                             "Could not write " + QDir::toNativeSeparators(path));
+    }
+}
+
 // Only REQUESTS a window-state change; the chrome is reconciled in changeEvent once the window
 // manager actually grants it (a Wayland fullscreen request can be refused).
 void MainWindow::setFullscreen(bool on) {
@@ -431,21 +490,31 @@ void MainWindow::onOpenFile() {
     if (exportActive_) return;
     const QString path = QFileDialog::getOpenFileName(
         this, "Open video file", QString(),
-        "Video files (*.mp4 *.mov *.avi *.mkv *.webm);;All files (*.*)");
-    if (path.isEmpty()) return;
+        "Video files (*.mp4 *.mov *.avi *.mkv *.webm *.y4m *.yuv *.raw *.gray *.bgr);;"
+        // Any one frame opens its whole numbered sequence.
+        "Image sequences (*.png *.tif *.tiff *.jpg *.jpeg *.bmp *.pgm *.ppm *.pnm);;"
+        "All files (*.*)");
+    if (!path.isEmpty()) openPath(path);
+}
 
+bool MainWindow::openPath(const QString& path) {
+    if (exportActive_) return false;
     if (!controller_.openFile(path.toStdString())) {
         QMessageBox::warning(this, "Open failed",
                              "Could not open the video file. Is the codec supported by ffmpeg?");
-        return;
+        return false;
     }
     currentFilePath_ = path;
+    // Previews decode on their own low-priority thread and fill in while playback starts.
+    timeline_->setThumbnailCount(kThumbnailSlots);
+    thumbnails_.start(path.toStdString(), kThumbnailSlots, kThumbnailHeight);
     sourceKind_ = SourceKind::File;
     sourceOpen_ = true;
     resetRoi(); // a new source has a new frame geometry
     exportButton_->setEnabled(true);
     controller_.play();
     showControls(fileControls_);
+    return true;
 }
 
 void MainWindow::onOpenCamera() {
@@ -456,12 +525,14 @@ void MainWindow::onOpenCamera() {
     const int index = dlg.selectedDeviceIndex();
     if (index < 0) return;
 
-    if (!controller_.openCamera(index)) {
+    if (!controller_.openCamera(index, dlg.selectedMode())) {
         QMessageBox::warning(this, "Open failed",
                              QString("Could not open camera \"%1\".").arg(dlg.selectedDeviceName()));
         return;
     }
     currentFilePath_.clear();
+    thumbnails_.stop();
+    timeline_->setThumbnailCount(0);
     sourceKind_ = SourceKind::Camera;
     sourceOpen_ = true;
     resetRoi(); // a new source has a new frame geometry
@@ -567,9 +638,16 @@ void MainWindow::setExportUiActive(bool active) {
 void MainWindow::startFileProcessing() {
     // Publishing to the display mailbox previews the render live; the paused live source is not
     // touching the mailbox.
-    exporter_.start(std::make_unique<FileExportFrameSource>(currentFilePath_.toStdString(),
-                                                            exportRequest_.startFrame,
-                                                            exportRequest_.endFrame),
+    if (exportRequest_.segments > 1) {
+        exporter_.startSegmented(
+            [path = currentFilePath_.toStdString()](int start, int end) {
+                return makeFileExportFrameSource(path, start, end);
+            },
+            exportRequest_, controller_.mailbox());
+        return;
+    }
+    exporter_.start(makeFileExportFrameSource(currentFilePath_.toStdString(),
+                                              exportRequest_.startFrame, exportRequest_.endFrame),
                     exportRequest_, controller_.mailbox());
 }
 
@@ -625,9 +703,20 @@ void MainWindow::pollExport() {
         const int frames = p.framesDone;
         const QString path = QString::fromStdString(p.outputPath.empty() ? exportRequest_.outputPath
                                                                           : p.outputPath);
+        QString text = QString("Wrote %1 frames to\n%2").arg(frames).arg(path);
+        if (p.processFps > 0.0 && p.encodeFps > 0.0)
+            text += QString("\n\nDecoding %1 fps, processing %2 fps, encoding (%3) %4 fps")
+                        .arg(p.decodeFps, 0, 'f', 1)
+                        .arg(p.processFps, 0, 'f', 1)
+                        .arg(QString::fromStdString(p.codecUsed))
+                        .arg(p.encodeFps, 0, 'f', 1);
+        if (!p.seamMaxDiff.empty()) {
+            text += "\n\nMax pixel difference vs. a serial export at each seam:";
+            for (std::size_t i = 0; i < p.seamMaxDiff.size(); ++i)
+                text += QString("\n  seam %1: %2").arg(i + 1).arg(p.seamMaxDiff[i], 0, 'f', 0);
+        }
         finishExport();
-        QMessageBox::information(this, "Export complete",
-                                 QString("Wrote %1 frames to\n%2").arg(frames).arg(path));
+        QMessageBox::information(this, "Export complete", text);
         break;
     }
     case ExportPhase::Error: {
@@ -6,9 +6,11 @@
 #include <QMainWindow>
 #include <QString>
 
+#include "core/StatsExporter.hpp"
 #include "export/Exporter.hpp"
 #include "pipeline/PlaybackController.hpp"
 #include "source/ISource.hpp" // SourceKind
+#include "source/ThumbnailExtractor.hpp"
 
 class QEvent;
 class QKeyEvent;
@@ -37,6 +39,10 @@ class MainWindow : public QMainWindow {
 public:
     explicit MainWindow(QWidget* parent = nullptr);
 
+    // Opens and plays a file, image sequence or "synthetic:" clip, as if picked in the open
+    // dialog. False (after telling the user) if it can't be opened.
+    bool openPath(const QString& path);
+
 protected:
     void closeEvent(QCloseEvent* event) override;
     void changeEvent(QEvent* event) override;
@@ -56,6 +62,7 @@ private:
     void updatePlayPauseButton();
     void syncFpsControls();
     void refreshToolbarIcons();
+    void toggleTrace();               // Ctrl+Shift+T: start a trace, or stop and write it out
 
     void setFullscreen(bool on);      // requests the window-state change only
     void applyFullscreenUi(bool on);  // hides/shows chrome to match the state actually granted
@@ -83,6 +90,7 @@ private:
     StatusStrip* statusStrip_ = nullptr;
     QTimer* statsTimer_ = nullptr;
     QTimer* timelineTimer_ = nullptr;
+    ThumbnailExtractor thumbnails_; // file only; drained into timeline_ by timelineTimer_
 
     bool scrubActive_ = false;  // true while the user is dragging the timeline handle
     bool scrubResume_ = false;  // playback was running when the scrub began, so resume on drop
@@ -103,6 +111,7 @@ private:
     bool         sourceOpen_ = false;
     SourceKind   sourceKind_ = SourceKind::File;
     QString      currentFilePath_;         // so the exporter can re-decode the file
+    QString      tracePath_;               // LIVIM_TRACE: trace from launch, written here on close
 
     Exporter                         exporter_;
     std::shared_ptr<RecordingBuffer> recBuf_;
@@ -113,6 +122,9 @@ private:
     bool                             exportActive_ = false;
     bool                             exportResume_ = false;   // resume playback when the flow ends
     bool                             recordingPhase_ = false; // camera: recording, not yet processing
+
+    // Declared after controller_ so it is destroyed (and joined) first.
+    std::unique_ptr<StatsExporter> statsExporter_; // only when LIVIM_STATS_OUT is set
 };
 
 } // namespace livim
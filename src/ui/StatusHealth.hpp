@@ -10,6 +10,8 @@ inline constexpr double kSpeedOk = 0.95;    // file: achieved/target at/above th
 inline constexpr double kSpeedWarn = 0.80;  // above this but below kSpeedOk -> warn, else bad
 inline constexpr double kDropWarn = 0.02;   // camera shedding >2% of frames -> warn
 inline constexpr double kDropBad = 0.15;    // camera shedding >15% -> bad
+inline constexpr double kStallWarn = 0.10;  // source blocked >10% of the time -> warn
+inline constexpr double kStallBad = 0.50;   // blocked more often than not -> bad
 
 struct Inputs {
     bool   live = false;         // a source is open AND frames are flowing
@@ -17,6 +19,7 @@ struct Inputs {
     double fps = 0.0;            // processed fps (EMA)
     double targetFps = 0.0;      // file playback target (0 = unknown); unused for a camera
     double dropFraction = 0.0;   // EMA share of frames shed before processing (0 for a file)
+    double stallFraction = 0.0;  // EMA share of wall time the source spent blocked downstream
 };
 
 // Severity of a camera's shed-share.
@@ -35,4 +38,12 @@ inline Health speed(const Inputs& in) {
     return r >= kSpeedOk ? Health::Ok : (r >= kSpeedWarn ? Health::Warn : Health::Bad);
 }
 
+// Backpressure: how much of its time the source spends waiting on the queue or the frame pool.
+inline Health stall(const Inputs& in) {
+    if (!in.live) return Health::Idle;
+    if (in.stallFraction < kStallWarn) return Health::Ok;
+    if (in.stallFraction < kStallBad) return Health::Warn;
+    return Health::Bad;
+}
+
 } // namespace livim::statushealth
@@ -1,6 +1,7 @@
 #include "ui/StatusStrip.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 #include <QAbstractSpinBox>
 #include <QDoubleSpinBox>
@@ -93,6 +94,31 @@ StatusStrip::StatusStrip(QWidget* parent) : QWidget(parent) {
     connect(playbackSpin_, &QDoubleSpinBox::valueChanged, this, &StatusStrip::playbackFpsChanged);
 
     row->addWidget(speed_.root);
+    row->addSpacing(metrics::space4);
+
+    // Stall cell:  STALL  ●  <blocked share>
+    stall_.root = new QWidget(this);
+    auto* stl = new QHBoxLayout(stall_.root);
+    stl->setContentsMargins(0, 0, 0, 0);
+    stl->setSpacing(kCellSpacing);
+
+    auto* stallCap = new QLabel("Stall", stall_.root);
+    stallCap->setObjectName("statCaption");
+    stallCap->setFont(captionFont_);
+
+    stall_.dot = new QLabel(stall_.root);
+    stall_.dot->setObjectName("statDot");
+
+    stall_.value = new QLabel(stall_.root);
+    stall_.value->setObjectName("statValue");
+    stall_.value->setFont(valueFont_);
+    stall_.value->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+    stall_.value->setMinimumWidth(vfm.horizontalAdvance(QStringLiteral("100%")));
+
+    stl->addWidget(stallCap);
+    stl->addWidget(stall_.dot);
+    stl->addWidget(stall_.value);
+    row->addWidget(stall_.root);
 
     row->addStretch(1);
 
@@ -130,12 +156,66 @@ void StatusStrip::setStats(const StatsSnapshot& s, double targetFps, bool hasSou
     in.fps = s.fps;
     in.targetFps = targetFps;
     in.dropFraction = s.dropFraction;
+    in.stallFraction = s.stallFraction;
 
     const Health speedH = statushealth::speed(in);
 
     setCell(speed_, speedH,
             live ? QString::number(std::min(s.fps, 999.9), 'f', 1) : QStringLiteral("—"));
 
+    // Per-stage breakdown on hover: which stage owns a latency spike.
+    QString breakdown;
+    for (int i = 0; i < kStageCount; ++i) {
+        const StageTiming& t = s.stages[i];
+        if (t.count == 0) continue;
+        breakdown += QStringLiteral("%1  p50 %2 / p95 %3 / p99 %4 ms\n")
+                         .arg(QString::fromLatin1(stageName(static_cast<Stage>(i))), -12)
+                         .arg(t.p50Ms, 0, 'f', 2)
+                         .arg(t.p95Ms, 0, 'f', 2)
+                         .arg(t.p99Ms, 0, 'f', 2);
+    }
+    // A camera's read is paced by the device, so only a file's decoder gets a capacity line.
+    if (s.decodeThreads > 0 && s.decodeFps > 0.0) {
+        breakdown += QStringLiteral("%1  %2 fps alone, %3 threads\n")
+                         .arg(QStringLiteral("decode"), -12)
+                         .arg(s.decodeFps, 0, 'f', 0)
+                         .arg(s.decodeThreads);
+    }
+    breakdown.chop(1);
+    if (speed_.root->toolTip() != breakdown) speed_.root->setToolTip(breakdown);
+
+    setCell(stall_, statushealth::stall(in),
+            live ? QStringLiteral("%1%").arg(std::lround(s.stallFraction * 100.0))
+                 : QStringLiteral("—"));
+    const QString stallTip =
+        QStringLiteral("Share of time the source waits on a full queue or an empty frame pool.\n"
+                       "Queue  %1 waits, %2 ms blocked\nPool   %3 waits, %4 ms blocked")
+            .arg(s.queueWaits)
+            .arg(s.queueBlockedMs, 0, 'f', 0)
+            .arg(s.poolWaits)
+            .arg(s.poolBlockedMs, 0, 'f', 0) +
+        (s.decodeThreads > 0
+             ? QStringLiteral("\nAhead  %1 frames decoded, %2 underruns"
+                              "\nCache  %3 hits, %4 misses, %5 MB")
+                   .arg(s.prefetchDepth)
+                   .arg(s.prefetchUnderruns)
+                   .arg(s.frameCacheHits)
+                   .arg(s.frameCacheMisses)
+                   .arg(static_cast<double>(s.frameCacheBytes) / (1 << 20), 0, 'f', 0)
+             : QString()) +
+        (s.cameraBuffers > 0
+             ? QStringLiteral("\nDriver %1 of %2 buffers queued, %3 frames dropped")
+                   .arg(s.cameraBuffersQueued)
+                   .arg(s.cameraBuffers)
+                   .arg(s.cameraDrops)
+             : QString()) +
+        (s.cameraDecodeThreads > 0
+             ? QStringLiteral("\nDecode %1 frames waiting on %2 JPEG threads")
+                   .arg(s.cameraDecodeBacklog)
+                   .arg(s.cameraDecodeThreads)
+             : QString());
+    if (stall_.root->toolTip() != stallTip) stall_.root->setToolTip(stallTip);
+
     const bool showInput = hasSource && !cameraSource;
     const bool showReported = hasSource && cameraSource && targetFps > 0.0;
     playbackSpin_->setVisible(showInput);
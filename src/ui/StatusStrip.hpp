@@ -48,6 +48,8 @@ private:
     QLabel*         reported_ = nullptr;     // camera only
     QLabel*         slash_ = nullptr;
 
+    Cell stall_; // share of time the source is blocked on the queue / frame pool
+
     QLabel* hint_ = nullptr; // hidden unless the pipeline is strained
 };
 
@@ -14,6 +14,8 @@ namespace {
 constexpr int kTimeTextW = 120; // reserved width for the "cur / total" label, px
 constexpr int kMargin = 10;
 constexpr int kHitPx = 9;       // grab threshold for the in/out handles, px
+constexpr int kBarH = 34;       // the scrub bar itself
+constexpr int kStripH = 36;     // thumbnail strip above it, when shown
 
 QString formatTime(double seconds) {
     if (seconds < 0.0 || !std::isfinite(seconds)) seconds = 0.0;
@@ -30,10 +32,28 @@ QString formatTime(double seconds) {
 
 TimelineView::TimelineView(QWidget* parent) : QWidget(parent) {
     setMouseTracking(false);
-    setMinimumHeight(34);
+    setMinimumHeight(kBarH);
 }
 
-QSize TimelineView::sizeHint() const { return QSize(400, 34); }
+QSize TimelineView::sizeHint() const { return QSize(400, barTop() + kBarH); }
+
+int TimelineView::barTop() const { return thumbs_.empty() ? 0 : kStripH + 4; }
+
+void TimelineView::setThumbnailCount(int n) {
+    const bool resize = thumbs_.empty() != (n <= 0);
+    thumbs_.assign(static_cast<std::size_t>(std::max(0, n)), QImage());
+    if (resize) {
+        setMinimumHeight(barTop() + kBarH);
+        updateGeometry();
+    }
+    update();
+}
+
+void TimelineView::setThumbnail(int slot, const QImage& image) {
+    if (slot < 0 || slot >= static_cast<int>(thumbs_.size())) return;
+    thumbs_[static_cast<std::size_t>(slot)] = image;
+    update();
+}
 
 double TimelineView::trackLeft() const { return kMargin; }
 double TimelineView::trackRight() const { return width() - kTimeTextW - kMargin; }
@@ -100,7 +120,8 @@ void TimelineView::paintEvent(QPaintEvent*) {
     p.setRenderHint(QPainter::Antialiasing, true);
 
     const double left = trackLeft(), right = trackRight();
-    const int cy = height() / 2;
+    const int top = barTop();
+    const int cy = top + (height() - top) / 2;
     const bool active = total_ > 0;
 
     // accent2 isn't a standard QPalette role, so it comes from the design tokens directly.
@@ -108,6 +129,41 @@ void TimelineView::paintEvent(QPaintEvent*) {
     const bool dark = pal.color(QPalette::Window).lightnessF() < 0.5;
     const QColor range = theme::palette(dark ? ColorScheme::Dark : ColorScheme::Light).accent2;
 
+    if (!thumbs_.empty() && right > left) {
+        // Each slot fills its share of the track, centre-cropped to the cell's aspect ratio.
+        const double cellW = (right - left) / static_cast<double>(thumbs_.size());
+        p.setPen(Qt::NoPen);
+        p.setBrush(pal.color(QPalette::Mid));
+        p.drawRoundedRect(QRectF(left, 2, right - left, kStripH), 3, 3);
+        p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        for (std::size_t i = 0; i < thumbs_.size(); ++i) {
+            const QImage& img = thumbs_[i];
+            if (img.isNull()) continue;
+            const QRectF cell(left + cellW * static_cast<double>(i), 2, cellW, kStripH);
+            QRectF src(img.rect());
+            const double cellAspect = cell.width() / cell.height();
+            if (src.width() / src.height() > cellAspect) {
+                const double w = src.height() * cellAspect;
+                src = QRectF(src.center().x() - w / 2, 0, w, src.height());
+            } else {
+                const double h = src.width() / cellAspect;
+                src = QRectF(0, src.center().y() - h / 2, src.width(), h);
+            }
+            p.drawImage(cell, img, src);
+        }
+        if (active) {
+            // Dim what's outside the in/out range so the strip echoes the bar below it.
+            QColor shade = pal.color(QPalette::Window);
+            shade.setAlphaF(0.6f);
+            p.setBrush(shade);
+            const int inX = frameToX(in_), outX = frameToX(out_);
+            p.drawRect(QRectF(left, 2, inX - left, kStripH));
+            p.drawRect(QRectF(outX, 2, right - outX, kStripH));
+            p.setBrush(pal.color(QPalette::Text));
+            p.drawRect(QRectF(frameToX(playhead_) - 1, 2, 2, kStripH));
+        }
+    }
+
     QRectF groove(left, cy - 2, std::max(0.0, right - left), 4);
     p.setPen(Qt::NoPen);
     p.setBrush(pal.color(QPalette::Mid));
@@ -130,7 +186,8 @@ void TimelineView::paintEvent(QPaintEvent*) {
     QColor timeColor = pal.color(QPalette::WindowText);
     timeColor.setAlphaF(0.7f);
     p.setPen(timeColor);
-    p.drawText(QRect(static_cast<int>(right) + kMargin, 0, kTimeTextW - kMargin, height()),
+    p.drawText(QRect(static_cast<int>(right) + kMargin, top, kTimeTextW - kMargin,
+                     height() - top),
                Qt::AlignVCenter | Qt::AlignRight, timeText());
 }
 
@@ -1,13 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
+#include <QImage>
 #include <QWidget>
 
 namespace livim {
 
 // Frame-based scrub timeline with draggable IN/OUT handles bounding the active range [in, out).
-// Time is derived from frame / playback fps, not from the file's native rate.
+// Time is derived from frame / playback fps, not from the file's native rate. An optional
+// thumbnail strip above the bar shows evenly spaced previews, painted as they arrive.
 class TimelineView : public QWidget {
     Q_OBJECT
 public:
@@ -19,6 +22,10 @@ public:
     void setInOut(std::int64_t in, std::int64_t out); // out exclusive; clamps to the clip
     void resetToStart();                         // snaps the playhead to the in-point
 
+    // Slot i previews frames [i, i+1) * total / n. 0 hides the strip; any count clears it.
+    void setThumbnailCount(int n);
+    void setThumbnail(int slot, const QImage& image);
+
     std::int64_t frameCount() const { return total_; }
     std::int64_t inFrame() const { return in_; }
     std::int64_t outFrame() const { return out_; } // exclusive
@@ -40,6 +47,7 @@ protected:
 private:
     enum class Drag { None, Playhead, In, Out };
 
+    int          barTop() const; // below the thumbnail strip, if any
     double       trackLeft() const;
     double       trackRight() const;
     int          frameToX(std::int64_t f) const;
@@ -53,6 +61,7 @@ private:
     std::int64_t out_ = 0;   // exclusive; == total_ when the whole clip is selected
     double       fps_ = 30.0;
     Drag         drag_ = Drag::None;
+    std::vector<QImage> thumbs_; // one per slot; null until extracted
 };
 
 } // namespace livim
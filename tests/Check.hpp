@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+// Just enough to write a test without a framework: a failed CHECK is reported and counted, and
+// main() returns livim::test::result().
+namespace livim::test {
+
+inline int& failures() {
+    static int n = 0;
+    return n;
+}
+
+inline int result() {
+    if (failures() == 0) return 0;
+    std::fprintf(stderr, "%d check(s) failed\n", failures());
+    return 1;
+}
+
+} // namespace livim::test
+
+#define CHECK(cond)                                                                           \
+    do {                                                                                      \
+        if (!(cond)) {                                                                        \
+            ++livim::test::failures();                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);     \
+        }                                                                                     \
+    } while (0)
@@ -0,0 +1,87 @@
+// FrameCache: the byte cap evicts least recently used frames, an eviction's buffer is reused by
+// the insert that forced it, and a hit copies into the caller's buffer without reallocating.
+
+#include <cstddef>
+#include <cstdint>
+
+#include <opencv2/core.hpp>
+
+#include "Check.hpp"
+#include "source/FrameCache.hpp"
+
+namespace livim {
+namespace {
+
+constexpr int         kSide = 16;
+constexpr std::size_t kFrameBytes = kSide * kSide * 3;
+
+cv::Mat frame(int value) { return cv::Mat(kSide, kSide, CV_8UC3, cv::Scalar::all(value)); }
+
+void testByteCapEvictsLeastRecentlyUsed() {
+    FrameCache cache(3 * kFrameBytes);
+    for (int i = 0; i < 3; ++i) cache.put(i, frame(i), PixelFormat::BGR8);
+    CHECK(cache.size() == 3);
+    CHECK(cache.bytes() == 3 * kFrameBytes);
+
+    cv::Mat hit;
+    CHECK(cache.get(0, PixelFormat::BGR8, hit)); // 0 is now the most recent, 1 the least
+    CHECK(hit.at<cv::Vec3b>(0, 0)[0] == 0);
+    cache.put(3, frame(3), PixelFormat::BGR8);
+    CHECK(cache.size() == 3);
+    CHECK(cache.bytes() == 3 * kFrameBytes);
+    CHECK(cache.peek(1) == nullptr);
+    CHECK(cache.peek(0) != nullptr && cache.peek(2) != nullptr && cache.peek(3) != nullptr);
+
+    CHECK(!cache.get(2, PixelFormat::Gray8, hit)); // cached, but in another format
+
+    cache.setCapacity(kFrameBytes); // shrinking keeps only the most recent
+    CHECK(cache.size() == 1);
+    CHECK(cache.peek(3) != nullptr);
+
+    cache.put(9, cv::Mat(kSide * 2, kSide, CV_8UC3), PixelFormat::BGR8); // bigger than the cap
+    CHECK(cache.peek(9) == nullptr);
+    CHECK(cache.bytes() == kFrameBytes);
+
+    cache.setCapacity(0);
+    CHECK(cache.size() == 0 && cache.bytes() == 0);
+    cache.put(0, frame(0), PixelFormat::BGR8);
+    CHECK(cache.size() == 0);
+}
+
+void testEvictedStorageIsReused() {
+    FrameCache cache(2 * kFrameBytes);
+    cache.put(0, frame(0), PixelFormat::BGR8);
+    cache.put(1, frame(1), PixelFormat::BGR8);
+    const cv::Mat* oldest = cache.peek(0);
+    CHECK(oldest != nullptr);
+    if (!oldest) return;
+    const std::uint8_t* buffer = oldest->data;
+
+    cache.put(2, frame(2), PixelFormat::BGR8); // evicts 0 and takes over its buffer
+    CHECK(cache.peek(0) == nullptr);
+    const cv::Mat* newest = cache.peek(2);
+    CHECK(newest != nullptr && newest->data == buffer);
+    if (newest) CHECK(newest->at<cv::Vec3b>(kSide - 1, kSide - 1)[2] == 2);
+
+    // Re-putting a cached index replaces it in place.
+    cache.put(2, frame(7), PixelFormat::BGR8);
+    CHECK(cache.size() == 2 && cache.bytes() == 2 * kFrameBytes);
+    newest = cache.peek(2);
+    CHECK(newest != nullptr && newest->data == buffer);
+
+    // A hit into a buffer that fits is a copy, not an allocation.
+    cv::Mat dst = frame(0);
+    const std::uint8_t* dstBuffer = dst.data;
+    CHECK(cache.get(2, PixelFormat::BGR8, dst));
+    CHECK(dst.data == dstBuffer);
+    CHECK(dst.at<cv::Vec3b>(0, 0)[1] == 7);
+}
+
+} // namespace
+} // namespace livim
+
+int main() {
+    livim::testByteCapEvictsLeastRecentlyUsed();
+    livim::testEvictedStorageIsReused();
+    return livim::test::result();
+}
@@ -0,0 +1,184 @@
+// Every magnification mode, at its UI defaults, on a synthetic clip whose motion and colour pulse
+// sit inside the default bands: frames keep their size, format and metadata, and the output
+// eventually differs from the input. Then motion magnification's gain: a grating whose contrast
+// oscillates inside the band comes out amplified by alpha times the temporal filter's own gain at
+// that frequency, and one oscillating far below the band is left about as it was.
+
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Check.hpp"
+#include "processing/MagnificationParamsUi.hpp"
+#include "processing/MagnificationProcessor.hpp"
+#include "source/SyntheticVideo.hpp"
+
+namespace livim {
+namespace {
+
+constexpr int kFrames = 90; // three seconds: past every mode's warmup
+
+void testMode(MagnificationMode mode) {
+    SyntheticParams clip;
+    clip.width = 128;
+    clip.height = 96;
+    clip.frames = kFrames;
+    clip.motionPx = 0.5;
+    clip.motionHz = 1.2;
+    clip.pulse = 0.05;
+    clip.pulseHz = 1.2;
+    const SyntheticVideo video(clip);
+
+    MagUiValues ui = defaultsFor(mode);
+    ui.captureFps = clip.fps;
+    ProcessorConfig cfg;
+    cfg.magnification = toParams(ui);
+    cfg.ptsScale = 1.0;
+    const double frameIntervalUs = 1'000'000.0 / clip.fps;
+
+    MagnificationProcessor processor;
+    bool changed = false;
+    for (int i = 0; i < kFrames; ++i) {
+        auto in = std::make_shared<Frame>();
+        CHECK(video.render(i, false, in->image));
+        in->seq = static_cast<std::uint64_t>(i);
+        in->ptsUs = static_cast<std::int64_t>(i * frameIntervalUs);
+        in->width = clip.width;
+        in->height = clip.height;
+        in->format = PixelFormat::BGR8;
+
+        const FrameRef out = processor.process(in, cfg);
+        CHECK(out != nullptr);
+        if (!out) return;
+        CHECK(out->seq == in->seq);
+        CHECK(out->ptsUs == in->ptsUs);
+        CHECK(out->format == PixelFormat::BGR8);
+        CHECK(out->image.size() == in->image.size());
+        CHECK(out->image.type() == in->image.type());
+        if (out != in && cv::norm(out->image, in->image, cv::NORM_INF) > 0.0) changed = true;
+    }
+    CHECK(changed);
+}
+
+constexpr double kFps = 30.0;
+constexpr int    kWidth = 128;
+constexpr int    kHeight = 96;
+constexpr double kPeriodPx = 16.0; // mostly in the amplified pyramid levels (1..levels-1)
+constexpr double kContrast = 6.0;  // grey levels
+constexpr int    kWarmup = 60;     // frames left out of the fit
+
+double grating(int x) { return std::cos(2.0 * CV_PI * x / kPeriodPx); }
+
+// Projection of (image - 128) onto the grating: its contrast in this frame.
+double contrastOf(const cv::Mat& m) {
+    double dot = 0.0, norm = 0.0;
+    for (int y = 0; y < m.rows; ++y)
+        for (int x = 0; x < m.cols; ++x) {
+            dot += (m.at<std::uint8_t>(y, x) - 128.0) * grating(x);
+            norm += grating(x) * grating(x);
+        }
+    return dot / norm;
+}
+
+// Least-squares amplitude of the `hz` sinusoid in samples[kWarmup..].
+double amplitudeAt(const std::vector<double>& samples, double hz) {
+    double ss = 0.0, cc = 0.0, sc = 0.0, sy = 0.0, cy = 0.0;
+    for (std::size_t n = kWarmup; n < samples.size(); ++n) {
+        const double w = 2.0 * CV_PI * hz * static_cast<double>(n) / kFps;
+        const double s = std::sin(w), c = std::cos(w);
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        sy += s * samples[n];
+        cy += c * samples[n];
+    }
+    const double det = ss * cc - sc * sc;
+    const double a = (sy * cc - cy * sc) / det;
+    const double b = (cy * ss - sy * sc) / det;
+    return std::hypot(a, b);
+}
+
+// |H| of iirFilter's bandpass at `hz`: the difference of two first-order lowpasses.
+double bandpassGain(const MagnificationParams& p, double hz) {
+    const std::complex<double> zInv = std::polar(1.0, -2.0 * CV_PI * hz / kFps);
+    auto lowpass = [&](double a) { return a / (1.0 - (1.0 - a) * zInv); };
+    return std::abs(lowpass(p.coHigh) - lowpass(p.coLow));
+}
+
+struct Gain {
+    double filter = 0.0;   // alpha times the temporal filter's gain at the frequency
+    double response = 0.0; // the added contrast over the input's
+    double total = 0.0;    // the output's contrast over the input's
+};
+
+// Gray frames of the grating, its contrast oscillating at `hz`, through Laplace magnification
+// (alpha 10, the default 1-5 Hz band, a cutoff wavelength short enough to amplify every level).
+Gain laplaceGain(double hz, int frames) {
+    MagUiValues ui = defaultsFor(MagnificationMode::Laplace);
+    ui.amplification = 10;
+    ui.wavelength = 1.0;
+    ui.captureFps = kFps;
+    ProcessorConfig cfg;
+    cfg.magnification = toParams(ui);
+    cfg.ptsScale = 1.0;
+
+    MagnificationProcessor processor;
+    std::vector<double> in, out, added;
+    for (int i = 0; i < frames; ++i) {
+        const double level = kContrast * std::sin(2.0 * CV_PI * hz * i / kFps);
+        auto frame = std::make_shared<Frame>();
+        frame->image.create(kHeight, kWidth, CV_8UC1);
+        for (int y = 0; y < kHeight; ++y)
+            for (int x = 0; x < kWidth; ++x)
+                frame->image.at<std::uint8_t>(y, x) =
+                    cv::saturate_cast<std::uint8_t>(128.0 + level * grating(x));
+        frame->seq = static_cast<std::uint64_t>(i);
+        frame->ptsUs = static_cast<std::int64_t>(i * 1'000'000.0 / kFps);
+        frame->width = kWidth;
+        frame->height = kHeight;
+        frame->format = PixelFormat::Gray8;
+
+        const FrameRef result = processor.process(frame, cfg);
+        CHECK(result != nullptr && result->format == PixelFormat::Gray8);
+        if (!result || result->format != PixelFormat::Gray8) return {};
+        in.push_back(contrastOf(frame->image));
+        out.push_back(contrastOf(result->image));
+        added.push_back(out.back() - in.back());
+    }
+    const double inAmp = amplitudeAt(in, hz);
+    return {ui.amplification * bandpassGain(cfg.magnification, hz),
+            amplitudeAt(added, hz) / inAmp, amplitudeAt(out, hz) / inAmp};
+}
+
+void testLaplaceAmplifiesThePassband() {
+    // Below the filter's prediction by the grating's share in the levels that are not amplified
+    // (about 0.85).
+    const Gain g = laplaceGain(2.5, 240);
+    CHECK(g.filter > 6.0); // alpha 10 times about 0.66
+    CHECK(g.response > 0.7 * g.filter && g.response < 1.1 * g.filter);
+    CHECK(g.total > 5.0);
+}
+
+void testLaplaceLeavesSlowChangesAlone() {
+    // 0.05 Hz, a twentieth of the low cutoff: a 30 s clip for one and a half periods.
+    const Gain g = laplaceGain(0.05, 900);
+    CHECK(g.filter < 0.5);
+    CHECK(g.total > 0.9 && g.total < 1.2);
+}
+
+} // namespace
+} // namespace livim
+
+int main() {
+    livim::testMode(livim::MagnificationMode::Laplace);
+    livim::testMode(livim::MagnificationMode::Phase);
+    livim::testMode(livim::MagnificationMode::Color);
+    livim::testLaplaceAmplifiesThePassband();
+    livim::testLaplaceLeavesSlowChangesAlone();
+    return livim::test::result();
+}
@@ -0,0 +1,77 @@
+// The live SyntheticSource and SyntheticExportFrameSource must deliver the same frames, bit for
+// bit, in colour and in luma-only mode.
+
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "Check.hpp"
+#include "core/FramePool.hpp"
+#include "core/PipelineTypes.hpp"
+#include "export/SyntheticExportFrameSource.hpp"
+#include "source/SyntheticSource.hpp"
+
+namespace livim {
+namespace {
+
+constexpr int kFrames = 12;
+const std::string kClip = "synthetic:96x72,frames=12,motion=0.7,noise=3,seed=5,unpaced";
+
+bool identical(const cv::Mat& a, const cv::Mat& b) {
+    return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0.0;
+}
+
+void testSourceMatchesExport(bool luma) {
+    FramePool pool(kFrames + 4); // outlives the frames taken from it
+    FrameQueue queue(kFrames + 4);
+    std::vector<FrameRef> frames;
+    {
+        SyntheticSource source(kClip, &queue, &pool, nullptr);
+        CHECK(source.open());
+        source.setLumaOnly(luma);
+        source.start();
+        source.play();
+        for (int i = 0; i < kFrames; ++i) {
+            FrameRef f;
+            CHECK(queue.pop(f));
+            if (f) frames.push_back(std::move(f));
+        }
+    }
+    CHECK(frames.size() == kFrames);
+
+    SyntheticExportFrameSource exported(kClip);
+    CHECK(exported.open());
+    CHECK(exported.frameCount() == kFrames);
+    exported.setLumaOnly(luma);
+    cv::Mat image;
+    for (const FrameRef& f : frames) {
+        CHECK(exported.next(image));
+        CHECK(f->format == (luma ? PixelFormat::Gray8 : PixelFormat::BGR8));
+        CHECK(identical(f->image, image));
+    }
+    CHECK(!exported.next(image));
+}
+
+void testRenderIsRepeatable() { // frame i is the same however it is reached
+    SyntheticParams params;
+    std::string error;
+    CHECK(SyntheticVideo::parse(kClip, params, error));
+    const SyntheticVideo video(params);
+    cv::Mat first, again;
+    CHECK(video.render(7, false, first));
+    CHECK(video.render(3, false, again));
+    CHECK(video.render(7, false, again));
+    CHECK(identical(first, again));
+    CHECK(!video.render(kFrames, false, again));
+}
+
+} // namespace
+} // namespace livim
+
+int main() {
+    livim::testSourceMatchesExport(false);
+    livim::testSourceMatchesExport(true);
+    livim::testRenderIsRepeatable();
+    return livim::test::result();
+}
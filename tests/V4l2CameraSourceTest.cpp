@@ -0,0 +1,328 @@
+// V4l2CameraSource against a fake driver: buffer setup, lending and requeueing, sequence-gap
+// counting, STREAMOFF waiting for the last lent frame, and processed frames letting go of it.
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <linux/videodev2.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Check.hpp"
+#include "core/FramePool.hpp"
+#include "core/Instrumentation.hpp"
+#include "core/PipelineTypes.hpp"
+#include "processing/GrayscaleProcessor.hpp"
+#include "processing/MagnificationParamsUi.hpp"
+#include "processing/MagnificationProcessor.hpp"
+#include "processing/PreprocessProcessor.hpp"
+#include "source/V4l2CameraSource.hpp"
+
+namespace livim {
+namespace {
+
+// /dev/video0 as a YUYV camera with a fixed 32x16 mode. Each DQBUF hands out the next of the
+// scripted sequence numbers, then the driver runs dry (EAGAIN).
+class FakeV4l2Device : public IV4l2Device {
+public:
+    static constexpr int           kFd = 42;
+    static constexpr std::uint32_t kWidth = 32; // big enough for a 2-level pyramid
+    static constexpr std::uint32_t kHeight = 16;
+    static constexpr std::uint32_t kBytesPerLine = kWidth * 2;
+    static constexpr std::size_t   kBufferBytes = 4096;
+
+    struct Counts {
+        unsigned requested = 0; // REQBUFS count
+        int      mapped = 0;
+        int      unmapped = 0;
+        int      withDriver = 0; // queued and not yet dequeued
+        int      qbufs = 0;
+        int      doubleQueued = 0; // QBUF of a buffer the driver already held
+        int      streamOns = 0;
+        int      streamOffs = 0;
+        int      closes = 0;
+    };
+
+    explicit FakeV4l2Device(std::vector<std::uint32_t> sequences)
+        : sequences_(std::move(sequences)) {}
+
+    Counts counts() const {
+        std::lock_guard<std::mutex> lg(mu_);
+        Counts c = counts_;
+        c.withDriver = static_cast<int>(driverQueue_.size());
+        return c;
+    }
+
+    int open(const std::string& path, int) override {
+        if (path != "/dev/video0") {
+            errno = ENOENT;
+            return -1;
+        }
+        return kFd;
+    }
+
+    int close(int fd) override {
+        std::lock_guard<std::mutex> lg(mu_);
+        if (fd == kFd) ++counts_.closes;
+        return 0;
+    }
+
+    void* mmap(std::size_t length, int, off_t offset) override {
+        std::lock_guard<std::mutex> lg(mu_);
+        const auto index = static_cast<std::size_t>(offset) / kBufferBytes;
+        if (index >= storage_.size() || length != kBufferBytes) {
+            errno = EINVAL;
+            return MAP_FAILED;
+        }
+        ++counts_.mapped;
+        return storage_[index].data();
+    }
+
+    int munmap(void*, std::size_t) override {
+        std::lock_guard<std::mutex> lg(mu_);
+        ++counts_.unmapped;
+        return 0;
+    }
+
+    int poll(int, int) override { // never readable; the source's slices keep stop() responsive
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return 0;
+    }
+
+    int ioctl(int fd, unsigned long request, void* arg) override {
+        std::lock_guard<std::mutex> lg(mu_);
+        if (fd != kFd) return fail(EBADF);
+        switch (request) {
+        case VIDIOC_QUERYCAP: {
+            auto* cap = static_cast<v4l2_capability*>(arg);
+            cap->capabilities = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+            return 0;
+        }
+        case VIDIOC_ENUM_FMT: {
+            auto* desc = static_cast<v4l2_fmtdesc*>(arg);
+            if (desc->index != 0) return fail(EINVAL);
+            desc->pixelformat = V4L2_PIX_FMT_YUYV;
+            return 0;
+        }
+        case VIDIOC_ENUM_FRAMESIZES: {
+            auto* size = static_cast<v4l2_frmsizeenum*>(arg);
+            if (size->index != 0 || size->pixel_format != V4L2_PIX_FMT_YUYV) return fail(EINVAL);
+            size->type = V4L2_FRMSIZE_TYPE_DISCRETE;
+            size->discrete = {kWidth, kHeight};
+            return 0;
+        }
+        case VIDIOC_ENUM_FRAMEINTERVALS: {
+            auto* iv = static_cast<v4l2_frmivalenum*>(arg);
+            if (iv->index != 0) return fail(EINVAL);
+            iv->type = V4L2_FRMIVAL_TYPE_DISCRETE;
+            iv->discrete = {1, 30};
+            return 0;
+        }
+        case VIDIOC_G_FMT:
+        case VIDIOC_S_FMT: { // the only mode there is, whatever was asked for
+            v4l2_pix_format& pix = static_cast<v4l2_format*>(arg)->fmt.pix;
+            pix.width = kWidth;
+            pix.height = kHeight;
+            pix.pixelformat = V4L2_PIX_FMT_YUYV;
+            pix.field = V4L2_FIELD_NONE;
+            pix.bytesperline = kBytesPerLine;
+            pix.sizeimage = kBytesPerLine * kHeight;
+            return 0;
+        }
+        case VIDIOC_G_PARM:
+        case VIDIOC_S_PARM: {
+            v4l2_captureparm& capture = static_cast<v4l2_streamparm*>(arg)->parm.capture;
+            capture.capability = V4L2_CAP_TIMEPERFRAME;
+            capture.timeperframe = {1, 30};
+            return 0;
+        }
+        case VIDIOC_REQBUFS: {
+            auto* req = static_cast<v4l2_requestbuffers*>(arg);
+            counts_.requested = req->count;
+            storage_.assign(req->count, std::vector<std::uint8_t>(kBufferBytes));
+            withDriver_.assign(req->count, false);
+            return 0;
+        }
+        case VIDIOC_QUERYBUF: {
+            auto* b = static_cast<v4l2_buffer*>(arg);
+            if (b->index >= storage_.size()) return fail(EINVAL);
+            b->length = static_cast<std::uint32_t>(kBufferBytes);
+            b->m.offset = static_cast<std::uint32_t>(b->index * kBufferBytes);
+            return 0;
+        }
+        case VIDIOC_QBUF: {
+            const unsigned index = static_cast<v4l2_buffer*>(arg)->index;
+            if (index >= storage_.size()) return fail(EINVAL);
+            if (withDriver_[index]) {
+                ++counts_.doubleQueued;
+                return fail(EINVAL);
+            }
+            withDriver_[index] = true;
+            driverQueue_.push_back(index);
+            ++counts_.qbufs;
+            return 0;
+        }
+        case VIDIOC_DQBUF: {
+            if (!streaming_ || driverQueue_.empty() || next_ >= sequences_.size())
+                return fail(EAGAIN);
+            auto* b = static_cast<v4l2_buffer*>(arg);
+            b->index = driverQueue_.front();
+            driverQueue_.pop_front();
+            withDriver_[b->index] = false;
+            b->sequence = sequences_[next_];
+            b->bytesused = kBytesPerLine * kHeight;
+            b->flags = 0;
+            storage_[b->index][0] = static_cast<std::uint8_t>(next_); // which frame filled it
+            ++next_;
+            return 0;
+        }
+        case VIDIOC_STREAMON:
+            streaming_ = true;
+            ++counts_.streamOns;
+            return 0;
+        case VIDIOC_STREAMOFF: // like the kernel, takes every buffer back from the driver
+            streaming_ = false;
+            ++counts_.streamOffs;
+            driverQueue_.clear();
+            withDriver_.assign(withDriver_.size(), false);
+            return 0;
+        default:
+            return fail(ENOTTY);
+        }
+    }
+
+private:
+    static int fail(int error) {
+        errno = error;
+        return -1;
+    }
+
+    mutable std::mutex                     mu_;
+    std::vector<std::uint32_t>             sequences_;
+    std::size_t                            next_ = 0;
+    std::vector<std::vector<std::uint8_t>> storage_; // the "mapped" buffers
+    std::vector<bool>                      withDriver_;
+    std::deque<unsigned>                   driverQueue_;
+    bool                                   streaming_ = false;
+    Counts                                 counts_;
+};
+
+void testUsable() {
+    FakeV4l2Device fake({});
+    CHECK(V4l2CameraSource::usable(0, fake));
+    CHECK(!V4l2CameraSource::usable(1, fake)); // no /dev/video1
+}
+
+void testCapture() {
+    // Sequences 3 and 4 never arrive: two frames the driver dropped.
+    auto fake =
+        std::make_shared<FakeV4l2Device>(std::vector<std::uint32_t>{0, 1, 2, 5, 6, 7, 8, 9});
+    FramePool pool(16);
+    FrameQueue queue(16);
+    Instrumentation instr;
+    auto source = std::make_unique<V4l2CameraSource>(0, CameraMode{}, &queue, &pool, &instr, fake);
+
+    CHECK(source->open());
+    FakeV4l2Device::Counts c = fake->counts();
+    CHECK(c.requested == 8);
+    CHECK(c.mapped == 8);
+    CHECK(c.withDriver == 8);
+    CHECK(c.streamOns == 1);
+
+    source->start();
+    source->play();
+    std::vector<FrameRef> frames;
+    for (int i = 0; i < 8; ++i) {
+        FrameRef f;
+        CHECK(queue.pop(f));
+        frames.push_back(std::move(f));
+    }
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        const Frame& f = *frames[i];
+        CHECK(f.seq == i);
+        CHECK(f.format == PixelFormat::YUYV);
+        // Lent while the driver keeps kMinQueued (2) buffers; copied and requeued after that.
+        const bool lent = i < 6;
+        CHECK((f.backing != nullptr) == lent);
+        if (lent && f.backing) CHECK(f.image.data[0] == static_cast<std::uint8_t>(i));
+    }
+    c = fake->counts();
+    CHECK(c.withDriver == 2);
+    CHECK(c.doubleQueued == 0);
+    const StatsSnapshot stats = instr.snapshot();
+    CHECK(stats.cameraDrops == 2);
+    CHECK(stats.cameraBuffers == 8);
+    CHECK(stats.cameraBuffersQueued == 2);
+
+    // Dropping a lent frame queues its buffer back.
+    frames.erase(frames.begin() + 1, frames.end());
+    CHECK(fake->counts().withDriver == 7);
+
+    // Stopping while frame 0 still views its buffer: the device stays up until it is released.
+    source.reset();
+    c = fake->counts();
+    CHECK(c.streamOffs == 0);
+    CHECK(c.unmapped == 0);
+    CHECK(c.closes == 0);
+
+    frames.clear();
+    c = fake->counts();
+    CHECK(c.qbufs == 8 + 2 + 6); // initial, the two copies, the six lent frames
+    CHECK(c.doubleQueued == 0);
+    CHECK(c.streamOffs == 1);
+    CHECK(c.unmapped == 8);
+    CHECK(c.closes == 1);
+}
+
+// A stage that writes a new image must not carry the input's lease along: the display or the
+// recorder holding the processed frame would keep the driver short of buffers.
+void testProcessedFramesHoldNoLease() {
+    auto fake = std::make_shared<FakeV4l2Device>(std::vector<std::uint32_t>{0});
+    FramePool pool(16);
+    FrameQueue queue(16);
+    V4l2CameraSource source(0, CameraMode{}, &queue, &pool, nullptr, fake);
+    CHECK(source.open());
+    source.start();
+    source.play();
+    FrameRef in;
+    CHECK(queue.pop(in));
+    if (!in) return;
+    CHECK(in->backing != nullptr);
+
+    ProcessorConfig cfg;
+    cfg.grayscale = true;
+    cfg.preprocess.downscale = 2;
+    cfg.magnification = toParams(defaultsFor(MagnificationMode::Laplace));
+    PreprocessProcessor preprocess;
+    GrayscaleProcessor grayscale;
+    MagnificationProcessor magnify;
+    const std::vector<FrameRef> processed = {preprocess.process(in, cfg),
+                                             grayscale.process(in, cfg), magnify.process(in, cfg)};
+    for (const FrameRef& out : processed) {
+        CHECK(out != nullptr && out != in);
+        if (out && out != in) CHECK(out->backing == nullptr);
+    }
+
+    CHECK(fake->counts().withDriver == 7);
+    in.reset(); // only the processed frames are left: the buffer goes back
+    CHECK(fake->counts().withDriver == 8);
+}
+
+} // namespace
+} // namespace livim
+
+int main() {
+    alarm(30); // a hang (a frame that never arrives) fails rather than stalls the run
+    livim::testUsable();
+    livim::testCapture();
+    livim::testProcessedFramesHoldNoLease();
+    return livim::test::result();
+}